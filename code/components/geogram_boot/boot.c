@@ -0,0 +1,339 @@
+/**
+ * @file boot.c
+ * @brief Parallel boot stages and boot-time profile
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "boot.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "boot";
+
+#define BOOT_WORKER_PRIO    5
+
+// Stage table and results, guarded by s_lock while workers run
+static const geogram_boot_stage_t *s_stages = NULL;
+static geogram_boot_record_t s_records[GEOGRAM_BOOT_MAX_STAGES];
+static int8_t s_deps[GEOGRAM_BOOT_MAX_STAGES][GEOGRAM_BOOT_MAX_DEPS];   // Indices, -1 = none
+static size_t s_count = 0;
+static size_t s_remaining = 0;      // Stages not yet done, failed or skipped
+static size_t s_workers = 0;
+static SemaphoreHandle_t s_lock = NULL;
+static SemaphoreHandle_t s_wake = NULL;     // Given when a stage finishes
+static SemaphoreHandle_t s_finished = NULL; // Given by each helper worker on exit
+
+static geogram_boot_record_t s_marks[GEOGRAM_BOOT_MAX_MARKS];
+static size_t s_mark_count = 0;
+static portMUX_TYPE s_mark_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int find_stage(const geogram_boot_stage_t *stages, size_t count, const char *name)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(stages[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Resolve dependency names and reject cycles
+ */
+static esp_err_t resolve_deps(const geogram_boot_stage_t *stages, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        for (int d = 0; d < GEOGRAM_BOOT_MAX_DEPS; d++) {
+            s_deps[i][d] = -1;
+            if (stages[i].deps[d] == NULL) {
+                continue;
+            }
+            int dep = find_stage(stages, count, stages[i].deps[d]);
+            if (dep < 0 || dep == (int)i) {
+                ESP_LOGE(TAG, "Stage %s: bad dependency %s", stages[i].name, stages[i].deps[d]);
+                return ESP_ERR_INVALID_ARG;
+            }
+            s_deps[i][d] = (int8_t)dep;
+        }
+    }
+
+    // Peel off stages whose dependencies are all resolved; leftovers form a cycle
+    bool resolved[GEOGRAM_BOOT_MAX_STAGES] = { false };
+    size_t done = 0;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < count; i++) {
+            if (resolved[i]) {
+                continue;
+            }
+            bool ready = true;
+            for (int d = 0; d < GEOGRAM_BOOT_MAX_DEPS; d++) {
+                if (s_deps[i][d] >= 0 && !resolved[s_deps[i][d]]) {
+                    ready = false;
+                }
+            }
+            if (ready) {
+                resolved[i] = true;
+                done++;
+                progress = true;
+            }
+        }
+    }
+    if (done != count) {
+        ESP_LOGE(TAG, "Dependency cycle between boot stages");
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Pick the first stage whose dependencies completed (lock held)
+ *
+ * Stages behind a failed or skipped dependency are marked skipped on the way.
+ *
+ * @return Stage index, or -1 if none can start now
+ */
+static int next_ready_stage(void)
+{
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < s_count; i++) {
+            if (s_records[i].status != GEOGRAM_BOOT_PENDING) {
+                continue;
+            }
+            bool ready = true;
+            bool blocked = false;
+            for (int d = 0; d < GEOGRAM_BOOT_MAX_DEPS; d++) {
+                if (s_deps[i][d] < 0) {
+                    continue;
+                }
+                geogram_boot_status_t dep = s_records[s_deps[i][d]].status;
+                if (dep == GEOGRAM_BOOT_FAILED || dep == GEOGRAM_BOOT_SKIPPED) {
+                    blocked = true;
+                } else if (dep != GEOGRAM_BOOT_DONE) {
+                    ready = false;
+                }
+            }
+            if (blocked) {
+                ESP_LOGW(TAG, "Skipping %s: a dependency did not come up", s_records[i].name);
+                s_records[i].status = GEOGRAM_BOOT_SKIPPED;
+                s_remaining--;
+                changed = true;
+            } else if (ready) {
+                return (int)i;
+            }
+        }
+    }
+    return -1;
+}
+
+static void wake_workers(void)
+{
+    for (size_t i = 0; i < s_workers; i++) {
+        xSemaphoreGive(s_wake);
+    }
+}
+
+/**
+ * @brief Run ready stages until none are left
+ */
+static void boot_work(uint8_t worker)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (s_remaining > 0) {
+        int next = next_ready_stage();
+        if (next < 0) {
+            if (s_remaining == 0) {
+                break;
+            }
+            // Wait for a running stage to finish
+            xSemaphoreGive(s_lock);
+            xSemaphoreTake(s_wake, portMAX_DELAY);
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            continue;
+        }
+
+        geogram_boot_record_t *record = &s_records[next];
+        record->status = GEOGRAM_BOOT_RUNNING;
+        record->worker = worker;
+        record->start_us = esp_timer_get_time();
+        xSemaphoreGive(s_lock);
+
+        esp_err_t ret = s_stages[next].run();
+        int64_t end_us = esp_timer_get_time();
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        record->end_us = end_us;
+        record->result = ret;
+        record->status = (ret == ESP_OK) ? GEOGRAM_BOOT_DONE : GEOGRAM_BOOT_FAILED;
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Stage %s failed: %s", record->name, esp_err_to_name(ret));
+        }
+        s_remaining--;
+        wake_workers();
+    }
+    xSemaphoreGive(s_lock);
+    wake_workers();
+}
+
+static void boot_worker_task(void *arg)
+{
+    boot_work((uint8_t)(uintptr_t)arg);
+    xSemaphoreGive(s_finished);
+    vTaskDelete(NULL);
+}
+
+esp_err_t geogram_boot_run(const geogram_boot_stage_t *stages, size_t count, size_t workers)
+{
+    if (stages == NULL || count == 0 || count > GEOGRAM_BOOT_MAX_STAGES || workers == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = resolve_deps(stages, count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    memset(s_records, 0, sizeof(s_records));
+    for (size_t i = 0; i < count; i++) {
+        s_records[i].name = stages[i].name;
+    }
+    s_stages = stages;
+    s_count = count;
+    s_remaining = count;
+    s_workers = workers;
+
+    s_lock = xSemaphoreCreateMutex();
+    s_wake = xSemaphoreCreateCounting(GEOGRAM_BOOT_MAX_STAGES * workers + workers, 0);
+    s_finished = xSemaphoreCreateCounting(workers, 0);
+    if (s_lock == NULL || s_wake == NULL || s_finished == NULL) {
+        ESP_LOGE(TAG, "Failed to create boot semaphores");
+        if (s_lock) vSemaphoreDelete(s_lock);
+        if (s_wake) vSemaphoreDelete(s_wake);
+        if (s_finished) vSemaphoreDelete(s_finished);
+        s_lock = s_wake = s_finished = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // The calling task is worker 0; if a helper can't be created the rest still boots
+    size_t helpers = 0;
+    for (size_t i = 1; i < workers; i++) {
+        char name[12];
+        snprintf(name, sizeof(name), "boot%u", (unsigned)i);
+        if (xTaskCreate(boot_worker_task, name, GEOGRAM_BOOT_WORKER_STACK, (void *)(uintptr_t)i,
+                        BOOT_WORKER_PRIO, NULL) != pdPASS) {
+            ESP_LOGW(TAG, "Booting with %u of %u workers", (unsigned)i, (unsigned)workers);
+            break;
+        }
+        helpers++;
+    }
+
+    boot_work(0);
+    for (size_t i = 0; i < helpers; i++) {
+        xSemaphoreTake(s_finished, portMAX_DELAY);
+    }
+
+    vSemaphoreDelete(s_lock);
+    vSemaphoreDelete(s_wake);
+    vSemaphoreDelete(s_finished);
+    s_lock = s_wake = s_finished = NULL;
+
+    geogram_boot_print_profile();
+
+    for (size_t i = 0; i < count; i++) {
+        if (stages[i].critical && s_records[i].status != GEOGRAM_BOOT_DONE) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+void geogram_boot_mark(const char *name)
+{
+    if (name == NULL) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_mark_lock);
+    bool seen = false;
+    for (size_t i = 0; i < s_mark_count; i++) {
+        if (strcmp(s_marks[i].name, name) == 0) {
+            seen = true;
+            break;
+        }
+    }
+    if (!seen && s_mark_count < GEOGRAM_BOOT_MAX_MARKS) {
+        geogram_boot_record_t *mark = &s_marks[s_mark_count++];
+        mark->name = name;
+        mark->status = GEOGRAM_BOOT_DONE;
+        mark->start_us = now;
+        mark->end_us = now;
+        mark->milestone = true;
+    }
+    taskEXIT_CRITICAL(&s_mark_lock);
+}
+
+size_t geogram_boot_get_profile(geogram_boot_record_t *records, size_t max)
+{
+    if (records == NULL) {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < s_count && n < max; i++) {
+        records[n++] = s_records[i];
+    }
+    taskENTER_CRITICAL(&s_mark_lock);
+    for (size_t i = 0; i < s_mark_count && n < max; i++) {
+        records[n++] = s_marks[i];
+    }
+    taskEXIT_CRITICAL(&s_mark_lock);
+    return n;
+}
+
+static const char *status_name(geogram_boot_status_t status)
+{
+    switch (status) {
+        case GEOGRAM_BOOT_PENDING: return "pending";
+        case GEOGRAM_BOOT_RUNNING: return "running";
+        case GEOGRAM_BOOT_DONE:    return "ok";
+        case GEOGRAM_BOOT_FAILED:  return "failed";
+        case GEOGRAM_BOOT_SKIPPED: return "skipped";
+    }
+    return "?";
+}
+
+void geogram_boot_print_profile(void)
+{
+    geogram_boot_record_t records[GEOGRAM_BOOT_MAX_STAGES + GEOGRAM_BOOT_MAX_MARKS];
+    size_t n = geogram_boot_get_profile(records, sizeof(records) / sizeof(records[0]));
+    if (n == 0) {
+        printf("No boot profile recorded\n");
+        return;
+    }
+
+    printf("Boot profile (ms since app start)\n");
+    printf("  %-20s %7s %7s %7s  %-6s %s\n", "stage", "start", "end", "took", "worker", "status");
+    for (size_t i = 0; i < n; i++) {
+        const geogram_boot_record_t *r = &records[i];
+        if (r->milestone) {
+            printf("  %-20s %7lld %7s %7s  %-6s %s\n", r->name, (long long)(r->start_us / 1000), "", "", "",
+                   "milestone");
+        } else if (r->status == GEOGRAM_BOOT_DONE || r->status == GEOGRAM_BOOT_FAILED) {
+            printf("  %-20s %7lld %7lld %7lld  %-6u %s\n", r->name,
+                   (long long)(r->start_us / 1000), (long long)(r->end_us / 1000),
+                   (long long)((r->end_us - r->start_us) / 1000), r->worker,
+                   r->status == GEOGRAM_BOOT_DONE ? "ok" : esp_err_to_name(r->result));
+        } else {
+            printf("  %-20s %7s %7s %7s  %-6s %s\n", r->name, "", "", "", "",
+                   status_name(r->status));
+        }
+    }
+}
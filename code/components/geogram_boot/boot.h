@@ -0,0 +1,115 @@
+/**
+ * @file boot.h
+ * @brief Parallel boot: subsystem stages run as soon as their dependencies are up
+ *
+ * Each stage names the stages it needs. A small pool of workers runs every
+ * stage whose dependencies have completed, so independent subsystems (radio,
+ * SD card, display) come up concurrently. Start and end times of each stage
+ * are kept for the boot profile, along with one-off milestones such as the
+ * first HTTP request.
+ */
+
+#ifndef GEOGRAM_BOOT_H
+#define GEOGRAM_BOOT_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GEOGRAM_BOOT_MAX_STAGES     16
+#define GEOGRAM_BOOT_MAX_DEPS       4
+#define GEOGRAM_BOOT_MAX_MARKS      8
+#define GEOGRAM_BOOT_WORKER_STACK   8192
+
+/**
+ * @brief Stage body; an error skips every stage that depends on it
+ */
+typedef esp_err_t (*geogram_boot_fn_t)(void);
+
+/**
+ * @brief One subsystem to bring up
+ */
+typedef struct {
+    const char *name;
+    geogram_boot_fn_t run;
+    const char *deps[GEOGRAM_BOOT_MAX_DEPS];    ///< Stage names; unused slots NULL
+    bool critical;                              ///< Boot fails if this stage does not complete
+} geogram_boot_stage_t;
+
+typedef enum {
+    GEOGRAM_BOOT_PENDING = 0,
+    GEOGRAM_BOOT_RUNNING,
+    GEOGRAM_BOOT_DONE,
+    GEOGRAM_BOOT_FAILED,
+    GEOGRAM_BOOT_SKIPPED,       ///< A dependency failed or was skipped
+} geogram_boot_status_t;
+
+/**
+ * @brief Profile entry of a stage or milestone
+ *
+ * Times are microseconds since the application started (esp_timer), which
+ * is after the ROM and second-stage bootloaders.
+ */
+typedef struct {
+    const char *name;
+    geogram_boot_status_t status;
+    esp_err_t result;
+    int64_t start_us;
+    int64_t end_us;             ///< Equal to start_us for milestones
+    uint8_t worker;
+    bool milestone;
+} geogram_boot_record_t;
+
+/**
+ * @brief Run the stages and wait for all of them to finish
+ *
+ * The calling task is one of the workers; the others are temporary tasks
+ * with GEOGRAM_BOOT_WORKER_STACK bytes of stack. Stage order in the table
+ * breaks ties. Prints the profile when done.
+ *
+ * @param stages Stage table (must stay valid for the profile)
+ * @param count Number of stages
+ * @param workers Stages allowed to run at once (1 runs them serially)
+ * A failed or skipped stage that is not critical is logged and shown in the
+ * profile, but the boot still succeeds.
+ *
+ * @return ESP_OK when every critical stage completed, ESP_FAIL if a critical
+ *         stage failed or was skipped, ESP_ERR_INVALID_ARG for unknown dependencies or cycles,
+ *         ESP_ERR_NO_MEM if the worker semaphores can't be created
+ */
+esp_err_t geogram_boot_run(const geogram_boot_stage_t *stages, size_t count, size_t workers);
+
+/**
+ * @brief Record a milestone the first time it is reached
+ *
+ * Later calls with the same name are ignored, so it is cheap to call on
+ * every request. Safe from any task.
+ *
+ * @param name Static string
+ */
+void geogram_boot_mark(const char *name);
+
+/**
+ * @brief Copy the boot profile, stages first, then milestones
+ *
+ * @param records Output array
+ * @param max Capacity of records
+ * @return Number of entries written
+ */
+size_t geogram_boot_get_profile(geogram_boot_record_t *records, size_t max);
+
+/**
+ * @brief Print the boot profile to stdout
+ */
+void geogram_boot_print_profile(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_BOOT_H
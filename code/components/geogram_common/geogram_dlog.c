@@ -0,0 +1,643 @@
+#include "geogram_dlog.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "dlog";
+
+#define DLOG_TASK_STACK     4096
+#define DLOG_TASK_PRIO      1
+#define DLOG_POLL_MS        100     // Drain interval when the rings are quiet
+#define DLOG_LINE_MAX       256
+
+#define DLOG_FLAG_TRUNCATED 0x01
+
+#if (GEOGRAM_DLOG_RING_SIZE & (GEOGRAM_DLOG_RING_SIZE - 1)) != 0
+#error "GEOGRAM_DLOG_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * Record layout in the ring: this header, then one entry per argument in
+ * format order. Numbers (integers widened, doubles, pointers) take 8 bytes;
+ * strings take a length byte and the bytes without terminator.
+ */
+typedef struct {
+    uint16_t len;           // Whole record, header included
+    uint8_t level;
+    uint8_t flags;
+    uint32_t timestamp;     // esp_log_timestamp() at the call
+    const char *tag;
+    const char *fmt;
+} dlog_header_t;
+
+typedef struct {
+    uint8_t buf[GEOGRAM_DLOG_RING_SIZE];
+    size_t head;            // Free-running write offset
+    size_t tail;            // Free-running read offset
+    uint32_t written;
+    uint32_t dropped;
+    uint32_t dropped_reported;
+    uint32_t truncated;
+} dlog_ring_t;
+
+// One ring per core: writers on different cores never share a lock
+static dlog_ring_t s_rings[portNUM_PROCESSORS];
+static portMUX_TYPE s_ring_locks[portNUM_PROCESSORS] = {
+    [0 ... portNUM_PROCESSORS - 1] = portMUX_INITIALIZER_UNLOCKED
+};
+static TaskHandle_t s_task = NULL;
+
+// ============================================================================
+// Format specifiers
+// ============================================================================
+
+typedef struct {
+    const char *flags;
+    uint8_t flags_len;
+    const char *width;      // Literal digits
+    uint8_t width_len;
+    bool width_star;
+    bool has_prec;
+    bool prec_star;
+    const char *prec;       // Literal digits
+    uint8_t prec_len;
+    char length;            // 0, 'H' (hh), 'h', 'l', 'L' (ll), 'z', 'j', 't', 'D' (long double)
+    char conv;
+} dlog_spec_t;
+
+static const char *span(const char *p, const char *set, uint8_t *len)
+{
+    const char *start = p;
+    while (*p && strchr(set, *p)) {
+        p++;
+    }
+    *len = (uint8_t)((p - start) > 255 ? 255 : (p - start));
+    return p;
+}
+
+/**
+ * @brief Parse the conversion at p (which points at '%')
+ *
+ * @return Pointer past the conversion, or NULL if it isn't one we handle
+ */
+static const char *parse_spec(const char *p, dlog_spec_t *spec)
+{
+    memset(spec, 0, sizeof(*spec));
+    p++;
+
+    spec->flags = p;
+    p = span(p, "-+ #0", &spec->flags_len);
+
+    if (*p == '*') {
+        spec->width_star = true;
+        p++;
+    } else {
+        spec->width = p;
+        p = span(p, "0123456789", &spec->width_len);
+    }
+
+    if (*p == '.') {
+        spec->has_prec = true;
+        p++;
+        if (*p == '*') {
+            spec->prec_star = true;
+            p++;
+        } else {
+            spec->prec = p;
+            p = span(p, "0123456789", &spec->prec_len);
+        }
+    }
+
+    if (p[0] == 'h' && p[1] == 'h') {
+        spec->length = 'H';
+        p += 2;
+    } else if (p[0] == 'l' && p[1] == 'l') {
+        spec->length = 'L';
+        p += 2;
+    } else if (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't') {
+        spec->length = *p++;
+    } else if (*p == 'L') {
+        spec->length = 'D';
+        p++;
+    }
+
+    if (*p == '\0' || !strchr("diuoxXcspfFeEgGaAn", *p)) {
+        return NULL;
+    }
+    if (spec->flags_len > 5 || spec->width_len > 4 || spec->prec_len > 4) {
+        return NULL;
+    }
+    spec->conv = *p++;
+    return p;
+}
+
+// ============================================================================
+// Capture (caller side)
+// ============================================================================
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    bool full;
+} dlog_writer_t;
+
+static void put_u64(dlog_writer_t *w, uint64_t value)
+{
+    if (w->full || w->cap - w->len < sizeof(value)) {
+        w->full = true;
+        return;
+    }
+    memcpy(w->buf + w->len, &value, sizeof(value));
+    w->len += sizeof(value);
+}
+
+static void put_str(dlog_writer_t *w, const char *s, int max)
+{
+    if (s == NULL) {
+        s = "(null)";
+    }
+    size_t limit = GEOGRAM_DLOG_MAX_STR;
+    if (max >= 0 && (size_t)max < limit) {
+        limit = (size_t)max;
+    }
+    size_t n = strnlen(s, limit);
+    bool cut = (n == GEOGRAM_DLOG_MAX_STR && s[n] != '\0');
+
+    if (w->full || w->cap - w->len < 1) {
+        w->full = true;
+        return;
+    }
+    if (n > w->cap - w->len - 1) {
+        n = w->cap - w->len - 1;
+        w->full = true;     // Keep what fits of the string, nothing after it
+    }
+    w->buf[w->len++] = (uint8_t)n;
+    memcpy(w->buf + w->len, s, n);
+    if (cut && n >= 3) {
+        memcpy(w->buf + w->len + n - 3, "...", 3);
+    }
+    w->len += n;
+}
+
+static int64_t get_signed(const dlog_spec_t *spec, va_list *ap)
+{
+    switch (spec->length) {
+        case 'H': return (signed char)va_arg(*ap, int);
+        case 'h': return (short)va_arg(*ap, int);
+        case 'l': return va_arg(*ap, long);
+        case 'L': return va_arg(*ap, long long);
+        case 'z': return (int64_t)(ptrdiff_t)va_arg(*ap, size_t);
+        case 'j': return va_arg(*ap, intmax_t);
+        case 't': return va_arg(*ap, ptrdiff_t);
+        default:  return va_arg(*ap, int);
+    }
+}
+
+static uint64_t get_unsigned(const dlog_spec_t *spec, va_list *ap)
+{
+    switch (spec->length) {
+        case 'H': return (unsigned char)va_arg(*ap, unsigned int);
+        case 'h': return (unsigned short)va_arg(*ap, unsigned int);
+        case 'l': return va_arg(*ap, unsigned long);
+        case 'L': return va_arg(*ap, unsigned long long);
+        case 'z': return va_arg(*ap, size_t);
+        case 'j': return va_arg(*ap, uintmax_t);
+        case 't': return (uint64_t)va_arg(*ap, ptrdiff_t);
+        default:  return va_arg(*ap, unsigned int);
+    }
+}
+
+/**
+ * @brief Copy the arguments named by fmt into the record
+ */
+static void capture_args(dlog_writer_t *w, const char *fmt, va_list *ap)
+{
+    for (const char *p = fmt; *p && !w->full; ) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+
+        dlog_spec_t spec;
+        const char *next = parse_spec(p, &spec);
+        if (next == NULL) {
+            return;     // Formatting stops at the same place
+        }
+        p = next;
+
+        if (spec.width_star) {
+            put_u64(w, (uint64_t)(int64_t)va_arg(*ap, int));
+        }
+        int precision = -1;
+        if (spec.prec_star) {
+            precision = va_arg(*ap, int);
+            put_u64(w, (uint64_t)(int64_t)precision);
+        } else if (spec.has_prec) {
+            precision = 0;
+            for (uint8_t i = 0; i < spec.prec_len; i++) {
+                precision = precision * 10 + (spec.prec[i] - '0');
+            }
+        }
+
+        switch (spec.conv) {
+            case 'd': case 'i':
+                put_u64(w, (uint64_t)get_signed(&spec, ap));
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                put_u64(w, get_unsigned(&spec, ap));
+                break;
+            case 'c':
+                put_u64(w, (uint64_t)va_arg(*ap, int));
+                break;
+            case 'p':
+                put_u64(w, (uint64_t)(uintptr_t)va_arg(*ap, void *));
+                break;
+            case 's':
+                put_str(w, va_arg(*ap, const char *), precision);
+                break;
+            case 'n':
+                (void)va_arg(*ap, void *);
+                break;
+            default: {
+                double d = (spec.length == 'D') ? (double)va_arg(*ap, long double)
+                                                : va_arg(*ap, double);
+                uint64_t bits;
+                memcpy(&bits, &d, sizeof(bits));
+                put_u64(w, bits);
+                break;
+            }
+        }
+    }
+}
+
+static void ring_copy_in(dlog_ring_t *ring, const void *data, size_t len)
+{
+    size_t off = ring->head & (GEOGRAM_DLOG_RING_SIZE - 1);
+    size_t first = GEOGRAM_DLOG_RING_SIZE - off;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(ring->buf + off, data, first);
+    memcpy(ring->buf, (const uint8_t *)data + first, len - first);
+    ring->head += len;
+}
+
+void geogram_dlog_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    uint8_t record[GEOGRAM_DLOG_MAX_RECORD];
+    dlog_writer_t w = {
+        .buf = record,
+        .len = sizeof(dlog_header_t),
+        .cap = sizeof(record),
+        .full = false,
+    };
+
+    va_list ap;
+    va_start(ap, fmt);
+    capture_args(&w, fmt, &ap);
+    va_end(ap);
+
+    dlog_header_t hdr = {
+        .len = (uint16_t)w.len,
+        .level = (uint8_t)level,
+        .flags = w.full ? DLOG_FLAG_TRUNCATED : 0,
+        .timestamp = esp_log_timestamp(),
+        .tag = tag,
+        .fmt = fmt,
+    };
+    memcpy(record, &hdr, sizeof(hdr));
+
+    // A task may move to the other core after this; the lock keeps that correct
+    int core = xPortGetCoreID();
+    dlog_ring_t *ring = &s_rings[core];
+    size_t used;
+
+    taskENTER_CRITICAL(&s_ring_locks[core]);
+    used = ring->head - ring->tail;
+    if (GEOGRAM_DLOG_RING_SIZE - used < w.len) {
+        ring->dropped++;
+    } else {
+        ring_copy_in(ring, record, w.len);
+        ring->written++;
+        if (w.full) {
+            ring->truncated++;
+        }
+        used += w.len;
+    }
+    taskEXIT_CRITICAL(&s_ring_locks[core]);
+
+    // Wake the writer early only when the ring is filling up
+    if (used >= GEOGRAM_DLOG_RING_SIZE / 2 && s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+// ============================================================================
+// Formatting (log task side)
+// ============================================================================
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} dlog_reader_t;
+
+static bool get_u64(dlog_reader_t *r, uint64_t *value)
+{
+    if (r->len - r->pos < sizeof(*value)) {
+        return false;
+    }
+    memcpy(value, r->buf + r->pos, sizeof(*value));
+    r->pos += sizeof(*value);
+    return true;
+}
+
+static bool get_str(dlog_reader_t *r, char *out)
+{
+    if (r->pos >= r->len) {
+        return false;
+    }
+    size_t n = r->buf[r->pos++];
+    if (n > r->len - r->pos) {
+        return false;
+    }
+    memcpy(out, r->buf + r->pos, n);
+    out[n] = '\0';
+    r->pos += n;
+    return true;
+}
+
+/**
+ * @brief Rebuild one conversion with the captured width and precision
+ *
+ * Integer conversions are widened to "ll" since arguments were stored as
+ * 64-bit values.
+ */
+static bool build_spec(const dlog_spec_t *spec, dlog_reader_t *r, char *out, size_t cap)
+{
+    size_t o = 0;
+    uint64_t value;
+
+    out[o++] = '%';
+    memcpy(out + o, spec->flags, spec->flags_len);
+    o += spec->flags_len;
+
+    if (spec->width_star) {
+        if (!get_u64(r, &value)) {
+            return false;
+        }
+        o += snprintf(out + o, cap - o, "%d", (int)(int64_t)value);
+    } else {
+        memcpy(out + o, spec->width, spec->width_len);
+        o += spec->width_len;
+    }
+
+    if (spec->has_prec) {
+        out[o++] = '.';
+        if (spec->prec_star) {
+            if (!get_u64(r, &value)) {
+                return false;
+            }
+            int prec = (int)(int64_t)value;
+            o += snprintf(out + o, cap - o, "%d", prec < 0 ? 0 : prec);
+        } else {
+            memcpy(out + o, spec->prec, spec->prec_len);
+            o += spec->prec_len;
+        }
+    }
+
+    if (strchr("diuoxX", spec->conv)) {
+        out[o++] = 'l';
+        out[o++] = 'l';
+    }
+    out[o++] = spec->conv;
+    out[o] = '\0';
+    return true;
+}
+
+static size_t format_record(const dlog_header_t *hdr, const uint8_t *args, size_t args_len,
+                            char *out, size_t cap)
+{
+    dlog_reader_t r = { .buf = args, .len = args_len, .pos = 0 };
+    char str[GEOGRAM_DLOG_MAX_STR + 1];
+    char conv[32];
+    size_t o = 0;
+    bool complete = true;
+
+    for (const char *p = hdr->fmt; *p && o + 1 < cap; ) {
+        if (*p != '%') {
+            out[o++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[o++] = '%';
+            p += 2;
+            continue;
+        }
+
+        dlog_spec_t spec;
+        const char *next = parse_spec(p, &spec);
+        if (next == NULL) {
+            break;
+        }
+        p = next;
+        if (!build_spec(&spec, &r, conv, sizeof(conv))) {
+            complete = false;
+            break;
+        }
+
+        uint64_t value = 0;
+        int n = 0;
+        if (spec.conv == 'n') {
+            continue;
+        } else if (spec.conv == 's') {
+            if (!get_str(&r, str)) {
+                complete = false;
+                break;
+            }
+            n = snprintf(out + o, cap - o, conv, str);
+        } else if (!get_u64(&r, &value)) {
+            complete = false;
+            break;
+        } else if (spec.conv == 'd' || spec.conv == 'i') {
+            n = snprintf(out + o, cap - o, conv, (long long)value);
+        } else if (strchr("uoxX", spec.conv)) {
+            n = snprintf(out + o, cap - o, conv, (unsigned long long)value);
+        } else if (spec.conv == 'c') {
+            n = snprintf(out + o, cap - o, conv, (int)value);
+        } else if (spec.conv == 'p') {
+            n = snprintf(out + o, cap - o, conv, (void *)(uintptr_t)value);
+        } else {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            n = snprintf(out + o, cap - o, conv, d);
+        }
+        if (n > 0) {
+            o += ((size_t)n < cap - o) ? (size_t)n : cap - o - 1;
+        }
+    }
+
+    if ((!complete || (hdr->flags & DLOG_FLAG_TRUNCATED)) && o + 4 < cap) {
+        memcpy(out + o, "...", 3);
+        o += 3;
+    }
+    out[o] = '\0';
+    return o;
+}
+
+static char level_letter(esp_log_level_t level)
+{
+    switch (level) {
+        case ESP_LOG_ERROR:   return 'E';
+        case ESP_LOG_WARN:    return 'W';
+        case ESP_LOG_INFO:    return 'I';
+        case ESP_LOG_DEBUG:   return 'D';
+        default:              return 'V';
+    }
+}
+
+static const char *level_color(esp_log_level_t level)
+{
+    switch (level) {
+        case ESP_LOG_ERROR:   return LOG_COLOR_E;
+        case ESP_LOG_WARN:    return LOG_COLOR_W;
+        case ESP_LOG_INFO:    return LOG_COLOR_I;
+        case ESP_LOG_DEBUG:   return LOG_COLOR_D;
+        default:              return LOG_COLOR_V;
+    }
+}
+
+static void emit_record(const uint8_t *record)
+{
+    static char line[DLOG_LINE_MAX];
+    dlog_header_t hdr;
+    memcpy(&hdr, record, sizeof(hdr));
+
+    format_record(&hdr, record + sizeof(hdr), hdr.len - sizeof(hdr), line, sizeof(line));
+
+    esp_log_level_t level = (esp_log_level_t)hdr.level;
+    const char *color = level_color(level);
+    esp_log_write(level, hdr.tag, "%s%c (%lu) %s: %s%s\n", color, level_letter(level),
+                  (unsigned long)hdr.timestamp, hdr.tag, line, color[0] ? LOG_RESET_COLOR : "");
+}
+
+/**
+ * @brief Move the oldest record of a ring into record
+ */
+static bool ring_pop(int core, uint8_t *record)
+{
+    dlog_ring_t *ring = &s_rings[core];
+    bool found = false;
+
+    taskENTER_CRITICAL(&s_ring_locks[core]);
+    if (ring->head != ring->tail) {
+        size_t off = ring->tail & (GEOGRAM_DLOG_RING_SIZE - 1);
+        uint16_t len;
+        uint8_t *len_bytes = (uint8_t *)&len;
+        len_bytes[0] = ring->buf[off];
+        len_bytes[1] = ring->buf[(off + 1) & (GEOGRAM_DLOG_RING_SIZE - 1)];
+
+        size_t first = GEOGRAM_DLOG_RING_SIZE - off;
+        if (first > len) {
+            first = len;
+        }
+        memcpy(record, ring->buf + off, first);
+        memcpy(record + first, ring->buf, len - first);
+        ring->tail += len;
+        found = true;
+    }
+    taskEXIT_CRITICAL(&s_ring_locks[core]);
+    return found;
+}
+
+static uint32_t record_timestamp(const uint8_t *record)
+{
+    dlog_header_t hdr;
+    memcpy(&hdr, record, sizeof(hdr));
+    return hdr.timestamp;
+}
+
+/**
+ * @brief Emit everything queued, merging the per-core rings by time
+ */
+static void drain(void)
+{
+    static uint8_t pending[portNUM_PROCESSORS][GEOGRAM_DLOG_MAX_RECORD];
+    bool have[portNUM_PROCESSORS];
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        have[i] = ring_pop(i, pending[i]);
+    }
+
+    while (true) {
+        int oldest = -1;
+        for (int i = 0; i < portNUM_PROCESSORS; i++) {
+            if (have[i] && (oldest < 0 ||
+                            (int32_t)(record_timestamp(pending[i]) -
+                                      record_timestamp(pending[oldest])) < 0)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            break;
+        }
+        emit_record(pending[oldest]);
+        have[oldest] = ring_pop(oldest, pending[oldest]);
+    }
+
+    uint32_t dropped = 0;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        taskENTER_CRITICAL(&s_ring_locks[i]);
+        dropped += s_rings[i].dropped - s_rings[i].dropped_reported;
+        s_rings[i].dropped_reported = s_rings[i].dropped;
+        taskEXIT_CRITICAL(&s_ring_locks[i]);
+    }
+    if (dropped > 0) {
+        ESP_LOGW(TAG, "%lu log messages dropped (ring full)", (unsigned long)dropped);
+    }
+}
+
+static void dlog_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DLOG_POLL_MS));
+        drain();
+    }
+}
+
+esp_err_t geogram_dlog_start(void)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(dlog_task, "dlog", DLOG_TASK_STACK, NULL, DLOG_TASK_PRIO, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void geogram_dlog_get_stats(geogram_dlog_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        taskENTER_CRITICAL(&s_ring_locks[i]);
+        stats->written += s_rings[i].written;
+        stats->dropped += s_rings[i].dropped;
+        stats->truncated += s_rings[i].truncated;
+        taskEXIT_CRITICAL(&s_ring_locks[i]);
+    }
+}
@@ -3,37 +3,40 @@
 #include <stdio.h>
 #include <string.h>
 
-static void strip_ansi(const char *in, char *out, size_t out_len)
+// Remove ANSI color sequences in place (output is never longer than input)
+static void strip_ansi(char *s)
 {
     size_t o = 0;
-    for (size_t i = 0; in[i] != '\0' && o + 1 < out_len; i++) {
-        if (in[i] == '\x1b' && in[i + 1] == '[') {
+    for (size_t i = 0; s[i] != '\0'; i++) {
+        if (s[i] == '\x1b' && s[i + 1] == '[') {
             i += 2;
-            while (in[i] != '\0' && in[i] != 'm') {
+            while (s[i] != '\0' && s[i] != 'm') {
                 i++;
             }
+            if (s[i] == '\0') {
+                break;
+            }
             continue;
         }
-        out[o++] = in[i];
+        s[o++] = s[i];
     }
-    out[o] = '\0';
+    s[o] = '\0';
 }
 
 void geogram_log_plain(const char *tag, const char *fmt, ...)
 {
-    char buf[512];
-    char clean[512];
+    char buf[256];
 
     va_list args;
     va_start(args, fmt);
     vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
 
-    strip_ansi(buf, clean, sizeof(clean));
+    strip_ansi(buf);
 
     if (tag && tag[0] != '\0') {
-        printf("%s: %s\n", tag, clean);
+        printf("%s: %s\n", tag, buf);
     } else {
-        printf("%s\n", clean);
+        printf("%s\n", buf);
     }
 }
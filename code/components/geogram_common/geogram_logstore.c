@@ -0,0 +1,587 @@
+#include "geogram_logstore.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "logstore";
+
+#define LOGSTORE_TASK_STACK     4096
+#define LOGSTORE_TASK_PRIO      2
+#define LOGSTORE_LINE_MAX       256     // Longer lines are stored cut, printed whole
+#define LOGSTORE_SHUTDOWN_MS    500     // Longest wait for the card on restart
+
+#define FILE_SIZE   GEOGRAM_LOGSTORE_FILE_SIZE
+
+static char s_dir[48];
+static bool s_running = false;
+static vprintf_like_t s_prev_vprintf = NULL;
+static TaskHandle_t s_task = NULL;
+
+// Batches: lines go into s_batch[s_active]; the flusher swaps and writes the
+// other one. Guarded by s_batch_lock (taken from any task that logs). Each
+// line is a record_t and its text; s_writers counts records still being
+// formatted, which the flusher waits out before writing.
+static char *s_batch[2] = { NULL, NULL };
+static size_t s_fill[2] = { 0, 0 };     // Bytes used, headers included
+static size_t s_text[2] = { 0, 0 };     // Text bytes of finished lines
+static uint32_t s_writers[2] = { 0, 0 };
+static int s_active = 0;
+static uint32_t s_dropped = 0;
+static portMUX_TYPE s_batch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Files, guarded by s_file_lock
+static SemaphoreHandle_t s_file_lock = NULL;
+static FILE *s_file = NULL;             // Current file, opened for append
+static uint32_t s_seq_first = 0;        // Oldest file kept
+static uint32_t s_seq_cur = 0;          // File being written
+static size_t s_cur_size = 0;           // Bytes in the current file
+static FILE *s_reader = NULL;           // Kept open between reads of an older file
+static uint32_t s_reader_seq = 0;
+static uint32_t s_write_errors = 0;
+static bool s_failing = false;          // Last write failed; log once per streak
+
+// Batch record header, unaligned in the batch (copied with memcpy)
+typedef struct {
+    uint16_t len;               // Text bytes
+    uint16_t size;              // Bytes reserved after the header
+} record_t;
+
+// ============================================================================
+// Files
+// ============================================================================
+
+static void file_path(uint32_t seq, char *path, size_t len)
+{
+    snprintf(path, len, "%s/%08lu.LOG", s_dir, (unsigned long)seq);
+}
+
+/**
+ * @brief Parse a log file name ("00000042.LOG")
+ */
+static bool parse_name(const char *name, uint32_t *seq)
+{
+    if (strlen(name) != 12 || strcasecmp(name + 8, ".log") != 0) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (uint32_t)(name[i] - '0');
+    }
+    *seq = value;
+    return true;
+}
+
+static void close_reader(void)
+{
+    if (s_reader) {
+        fclose(s_reader);
+        s_reader = NULL;
+    }
+}
+
+/**
+ * @brief Delete files until at most GEOGRAM_LOGSTORE_FILES remain (lock held)
+ */
+static void prune_files(void)
+{
+    char path[64];
+    while (s_seq_cur - s_seq_first + 1 > GEOGRAM_LOGSTORE_FILES) {
+        if (s_reader && s_reader_seq == s_seq_first) {
+            close_reader();
+        }
+        file_path(s_seq_first, path, sizeof(path));
+        unlink(path);
+        s_seq_first++;
+    }
+}
+
+/**
+ * @brief Close the full current file and move to the next one (lock held)
+ */
+static void rotate(void)
+{
+    if (s_file) {
+        fclose(s_file);
+        s_file = NULL;
+    }
+    s_seq_cur++;
+    s_cur_size = 0;
+    prune_files();
+}
+
+/**
+ * @brief Append a batch to the current file, rotating at FILE_SIZE (lock held)
+ */
+static esp_err_t write_out(const char *data, size_t len)
+{
+    char path[64];
+
+    while (len > 0) {
+        if (s_file == NULL) {
+            file_path(s_seq_cur, path, sizeof(path));
+            s_file = fopen(path, "ab");
+            if (s_file == NULL) {
+                return ESP_FAIL;
+            }
+            // Trust the card over our count, e.g. after an earlier failed write
+            fseek(s_file, 0, SEEK_END);
+            long size = ftell(s_file);
+            s_cur_size = size > 0 ? (size_t)size : 0;
+            if (s_cur_size >= FILE_SIZE) {
+                rotate();
+                continue;
+            }
+        }
+
+        size_t n = FILE_SIZE - s_cur_size;
+        if (n > len) {
+            n = len;
+        }
+        if (fwrite(data, 1, n, s_file) != n) {
+            fclose(s_file);
+            s_file = NULL;
+            return ESP_FAIL;
+        }
+        s_cur_size += n;
+        data += n;
+        len -= n;
+        if (s_cur_size >= FILE_SIZE) {
+            rotate();
+        }
+    }
+
+    if (s_file) {
+        fflush(s_file);
+        fsync(fileno(s_file));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Drop the record headers and unused space, leaving only the text
+ */
+static size_t compact(char *batch, size_t len)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in + sizeof(record_t) <= len) {
+        record_t rec;
+        memcpy(&rec, batch + in, sizeof(rec));
+        memmove(batch + out, batch + in + sizeof(rec), rec.len);
+        out += rec.len;
+        in += sizeof(rec) + rec.size;
+    }
+    return out;
+}
+
+/**
+ * @brief Write the active batch to the card (file lock held)
+ *
+ * New lines go to the other batch meanwhile; it is empty because the
+ * previous flush finished before this one started.
+ */
+static esp_err_t flush_locked(void)
+{
+    taskENTER_CRITICAL(&s_batch_lock);
+    int b = s_active;
+    size_t len = s_fill[b];
+    if (len > 0) {
+        s_active ^= 1;
+    }
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    if (len == 0) {
+        return ESP_OK;
+    }
+
+    // Lines reserved before the swap may still be formatting
+    while (true) {
+        taskENTER_CRITICAL(&s_batch_lock);
+        uint32_t writers = s_writers[b];
+        len = s_fill[b];
+        taskEXIT_CRITICAL(&s_batch_lock);
+        if (writers == 0) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+
+    esp_err_t ret = write_out(s_batch[b], compact(s_batch[b], len));
+
+    taskENTER_CRITICAL(&s_batch_lock);
+    s_fill[b] = 0;
+    s_text[b] = 0;
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    if (ret != ESP_OK) {
+        s_write_errors++;
+        if (!s_failing) {
+            s_failing = true;
+            ESP_LOGW(TAG, "Failed to write log batch to %s (errno %d)", s_dir, errno);
+        }
+    } else if (s_failing) {
+        s_failing = false;
+        ESP_LOGI(TAG, "Writing logs to %s again", s_dir);
+    }
+    return ret;
+}
+
+static esp_err_t flush_with_timeout(TickType_t timeout)
+{
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xSemaphoreTake(s_file_lock, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = flush_locked();
+    xSemaphoreGive(s_file_lock);
+    return ret;
+}
+
+static void logstore_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GEOGRAM_LOGSTORE_FLUSH_MS));
+        flush_with_timeout(portMAX_DELAY);
+    }
+}
+
+static void logstore_shutdown(void)
+{
+    flush_with_timeout(pdMS_TO_TICKS(LOGSTORE_SHUTDOWN_MS));
+}
+
+// ============================================================================
+// Log hook
+// ============================================================================
+
+// Remove ANSI color sequences in place and return the new length
+static size_t strip_ansi(char *s, size_t len)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\x1b' && i + 1 < len && s[i + 1] == '[') {
+            i += 2;
+            while (i < len && s[i] != 'm') {
+                i++;
+            }
+            continue;
+        }
+        s[o++] = s[i];
+    }
+    return o;
+}
+
+/**
+ * @brief Format a log line straight into the active batch
+ *
+ * A full line is reserved under the lock and formatted outside it, so
+ * other tasks keep logging meanwhile. The record then shrinks to the text
+ * if nothing was reserved after it; otherwise compact() skips the rest.
+ */
+static void store_line(const char *fmt, va_list args)
+{
+    record_t rec = { .len = 0, .size = LOGSTORE_LINE_MAX };
+    char *slot = NULL;
+    size_t pos = 0;
+
+    taskENTER_CRITICAL(&s_batch_lock);
+    int b = s_active;
+    if (s_batch[b] && GEOGRAM_LOGSTORE_BATCH - s_fill[b] >= sizeof(rec) + LOGSTORE_LINE_MAX) {
+        pos = s_fill[b];
+        s_fill[b] += sizeof(rec) + LOGSTORE_LINE_MAX;
+        s_writers[b]++;
+        slot = s_batch[b] + pos + sizeof(rec);
+    } else {
+        s_dropped++;
+    }
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    int n = vsnprintf(slot, LOGSTORE_LINE_MAX, fmt, args);
+    size_t len = 0;
+    if (n > 0) {
+        len = n < LOGSTORE_LINE_MAX ? (size_t)n : LOGSTORE_LINE_MAX - 1;
+        if ((size_t)n > len) {
+            slot[len - 1] = '\n';
+        }
+        len = strip_ansi(slot, len);
+    }
+    rec.len = (uint16_t)len;
+
+    taskENTER_CRITICAL(&s_batch_lock);
+    if (s_fill[b] == pos + sizeof(rec) + LOGSTORE_LINE_MAX) {
+        s_fill[b] = pos + sizeof(rec) + len;
+        rec.size = rec.len;
+    }
+    memcpy(s_batch[b] + pos, &rec, sizeof(rec));
+    s_text[b] += len;
+    s_writers[b]--;
+    size_t fill = s_fill[b];
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    if (fill >= GEOGRAM_LOGSTORE_BATCH * 3 / 4 && s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+/**
+ * @brief esp_log output hook: keep a copy, print as before
+ */
+static int logstore_vprintf(const char *fmt, va_list args)
+{
+    if (s_running) {
+        va_list copy;
+        va_copy(copy, args);
+        store_line(fmt, copy);
+        va_end(copy);
+    }
+    return s_prev_vprintf(fmt, args);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Find existing log files and resume the newest one
+ */
+static esp_err_t scan_dir(void)
+{
+    DIR *dir = opendir(s_dir);
+    if (dir == NULL) {
+        return ESP_FAIL;
+    }
+
+    bool found = false;
+    uint32_t min = 0;
+    uint32_t max = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        uint32_t seq;
+        if (!parse_name(entry->d_name, &seq)) {
+            continue;
+        }
+        if (!found || seq < min) {
+            min = seq;
+        }
+        if (!found || seq > max) {
+            max = seq;
+        }
+        found = true;
+    }
+    closedir(dir);
+
+    s_seq_first = min;
+    s_seq_cur = max;
+    s_cur_size = 0;
+    if (found) {
+        char path[64];
+        struct stat st;
+        file_path(s_seq_cur, path, sizeof(path));
+        if (stat(path, &st) == 0) {
+            s_cur_size = (size_t)st.st_size;
+        }
+        prune_files();
+        if (s_cur_size >= FILE_SIZE) {
+            rotate();
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t geogram_logstore_start(const char *dir)
+{
+    if (dir == NULL || strlen(dir) >= sizeof(s_dir)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    struct stat st;
+    if (stat(dir, &st) != 0 && mkdir(dir, 0775) != 0) {
+        ESP_LOGE(TAG, "Failed to create %s", dir);
+        return ESP_FAIL;
+    }
+
+    // Batches, lock and task are kept across stop/start
+    for (int i = 0; i < 2; i++) {
+        if (s_batch[i] == NULL) {
+            s_batch[i] = malloc(GEOGRAM_LOGSTORE_BATCH);
+            if (s_batch[i] == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+    if (s_file_lock == NULL) {
+        s_file_lock = xSemaphoreCreateMutex();
+        if (s_file_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_file_lock, portMAX_DELAY);
+    strcpy(s_dir, dir);
+    esp_err_t ret = scan_dir();
+    xSemaphoreGive(s_file_lock);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read %s", dir);
+        return ret;
+    }
+
+    if (s_task == NULL) {
+        if (xTaskCreate(logstore_task, "logstore", LOGSTORE_TASK_STACK, NULL,
+                        LOGSTORE_TASK_PRIO, &s_task) != pdPASS) {
+            s_task = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        esp_register_shutdown_handler(logstore_shutdown);
+    }
+
+    s_running = true;
+    s_prev_vprintf = esp_log_set_vprintf(logstore_vprintf);
+
+    ESP_LOGI(TAG, "Storing logs in %s (files %lu..%lu)", s_dir,
+             (unsigned long)s_seq_first, (unsigned long)s_seq_cur);
+    return ESP_OK;
+}
+
+void geogram_logstore_stop(void)
+{
+    if (!s_running) {
+        return;
+    }
+    esp_log_set_vprintf(s_prev_vprintf);
+
+    xSemaphoreTake(s_file_lock, portMAX_DELAY);
+    // Twice: lines may have gone to the other batch during the first write
+    flush_locked();
+    flush_locked();
+    s_running = false;
+    if (s_file) {
+        fclose(s_file);
+        s_file = NULL;
+    }
+    close_reader();
+    xSemaphoreGive(s_file_lock);
+}
+
+bool geogram_logstore_is_running(void)
+{
+    return s_running;
+}
+
+esp_err_t geogram_logstore_flush(void)
+{
+    return flush_with_timeout(portMAX_DELAY);
+}
+
+esp_err_t geogram_logstore_read(uint64_t since, char *buf, size_t len,
+                                size_t *out_len, uint64_t *next)
+{
+    if (buf == NULL || out_len == NULL || next == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_len = 0;
+    *next = since;
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_file_lock, portMAX_DELAY);
+    uint64_t first = (uint64_t)s_seq_first * FILE_SIZE;
+    uint64_t stored = (uint64_t)s_seq_cur * FILE_SIZE + s_cur_size;
+    esp_err_t ret = ESP_OK;
+
+    if (since < first) {
+        since = first;
+    }
+    // Files shorter than FILE_SIZE (a write failed) end early; skip to the next
+    while (since < stored && len > 0) {
+        uint32_t seq = (uint32_t)(since / FILE_SIZE);
+        size_t pos = (size_t)(since % FILE_SIZE);
+        size_t want = FILE_SIZE - pos;
+        if (want > len) {
+            want = len;
+        }
+        if (want > stored - since) {
+            want = (size_t)(stored - since);
+        }
+
+        if (s_reader == NULL || s_reader_seq != seq) {
+            close_reader();
+            char path[64];
+            file_path(seq, path, sizeof(path));
+            s_reader = fopen(path, "rb");
+            s_reader_seq = seq;
+        }
+        size_t n = 0;
+        if (s_reader && fseek(s_reader, (long)pos, SEEK_SET) == 0) {
+            n = fread(buf, 1, want, s_reader);
+        }
+        if (seq == s_seq_cur) {
+            // The open handle would not see later appends to this file
+            close_reader();
+        }
+        if (n > 0) {
+            *out_len = n;
+            since += n;
+            break;
+        }
+        if (seq == s_seq_cur) {
+            ret = ESP_FAIL;
+            break;
+        }
+        since = (uint64_t)(seq + 1) * FILE_SIZE;
+    }
+
+    if (since > stored) {
+        since = stored;
+    }
+    *next = since;
+    xSemaphoreGive(s_file_lock);
+    return ret;
+}
+
+void geogram_logstore_get_stats(geogram_logstore_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (s_file_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_file_lock, portMAX_DELAY);
+    stats->first = (uint64_t)s_seq_first * FILE_SIZE;
+    stats->end = (uint64_t)s_seq_cur * FILE_SIZE + s_cur_size;
+    stats->write_errors = s_write_errors;
+    xSemaphoreGive(s_file_lock);
+
+    taskENTER_CRITICAL(&s_batch_lock);
+    stats->end += s_text[0] + s_text[1];
+    stats->dropped_lines = s_dropped;
+    taskEXIT_CRITICAL(&s_batch_lock);
+}
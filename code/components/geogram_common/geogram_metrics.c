@@ -0,0 +1,411 @@
+#include "geogram_metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "geogram_dlog.h"
+#include "geogram_logstore.h"
+
+#define METRICS_LABELS_MAX  112     // Label block of one series, braces included
+
+// Bucket upper bounds; the Prometheus le labels below must match
+static const uint32_t k_bounds_us[GEOGRAM_METRICS_BUCKETS] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+static const char *const k_bounds_le[GEOGRAM_METRICS_BUCKETS] = {
+    "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5"
+};
+
+// Registry list; only grows. Writers link under s_lock (a mutex, created on
+// first use), readers walk it without locking (links are published with
+// release stores).
+static geogram_metric_t *s_head = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static bool s_builtin_registered = false;
+
+// ============================================================================
+// Built-in metrics (system, deferred log, log store)
+// ============================================================================
+
+enum {
+    BUILTIN_UPTIME,
+    BUILTIN_HEAP_FREE,
+    BUILTIN_HEAP_MIN_FREE,
+    BUILTIN_DLOG_WRITTEN,
+    BUILTIN_DLOG_DROPPED,
+    BUILTIN_LOGSTORE_BYTES,
+    BUILTIN_LOGSTORE_DROPPED,
+    BUILTIN_LOGSTORE_ERRORS,
+};
+
+static int64_t read_builtin(const geogram_metric_t *metric)
+{
+    geogram_dlog_stats_t dlog;
+    geogram_logstore_stats_t store;
+
+    switch (metric->arg) {
+        case BUILTIN_UPTIME:
+            return esp_timer_get_time() / 1000000;
+        case BUILTIN_HEAP_FREE:
+            return esp_get_free_heap_size();
+        case BUILTIN_HEAP_MIN_FREE:
+            return esp_get_minimum_free_heap_size();
+        case BUILTIN_DLOG_WRITTEN:
+        case BUILTIN_DLOG_DROPPED:
+            geogram_dlog_get_stats(&dlog);
+            return metric->arg == BUILTIN_DLOG_WRITTEN ? dlog.written : dlog.dropped;
+        default:
+            geogram_logstore_get_stats(&store);
+            if (metric->arg == BUILTIN_LOGSTORE_BYTES) {
+                return (int64_t)store.end;
+            }
+            return metric->arg == BUILTIN_LOGSTORE_DROPPED ? store.dropped_lines : store.write_errors;
+    }
+}
+
+static geogram_metric_t s_builtin[] = {
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_GAUGE, "geogram_uptime_seconds",
+                             "Seconds since the application started", read_builtin, BUILTIN_UPTIME),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_GAUGE, "geogram_heap_free_bytes",
+                             "Free heap", read_builtin, BUILTIN_HEAP_FREE),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_GAUGE, "geogram_heap_min_free_bytes",
+                             "Lowest free heap since boot", read_builtin, BUILTIN_HEAP_MIN_FREE),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_dlog_records_total",
+                             "Deferred log records queued", read_builtin, BUILTIN_DLOG_WRITTEN),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_dlog_dropped_total",
+                             "Deferred log records lost to a full ring", read_builtin, BUILTIN_DLOG_DROPPED),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_logstore_bytes_total",
+                             "Log bytes stored on the SD card (end offset)", read_builtin, BUILTIN_LOGSTORE_BYTES),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_logstore_dropped_lines_total",
+                             "Log lines lost because the SD card fell behind", read_builtin, BUILTIN_LOGSTORE_DROPPED),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_logstore_write_errors_total",
+                             "Log batches the SD card did not take", read_builtin, BUILTIN_LOGSTORE_ERRORS),
+};
+
+static void register_builtin(void)
+{
+    bool expected = false;
+    if (__atomic_compare_exchange_n(&s_builtin_registered, &expected, true, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        geogram_metrics_register_all(s_builtin, sizeof(s_builtin) / sizeof(s_builtin[0]));
+    }
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+static SemaphoreHandle_t registry_lock(void)
+{
+    SemaphoreHandle_t lock = __atomic_load_n(&s_lock, __ATOMIC_ACQUIRE);
+    if (lock == NULL) {
+        SemaphoreHandle_t created = xSemaphoreCreateMutex();
+        if (created == NULL) {
+            return NULL;
+        }
+        if (__atomic_compare_exchange_n(&s_lock, &lock, created, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            lock = created;
+        } else {
+            // Another task created it first; lock now holds theirs
+            vSemaphoreDelete(created);
+        }
+    }
+    return lock;
+}
+
+esp_err_t geogram_metrics_register(geogram_metric_t *metric)
+{
+    if (metric == NULL || metric->name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    register_builtin();
+
+    SemaphoreHandle_t lock = registry_lock();
+    if (lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (!metric->registered) {
+        // After the last member of its family, or at the end
+        geogram_metric_t **link = &s_head;
+        geogram_metric_t *family_last = NULL;
+        while (*link != NULL) {
+            if (strcmp((*link)->name, metric->name) == 0) {
+                family_last = *link;
+            }
+            link = &(*link)->next;
+        }
+        if (family_last != NULL) {
+            link = &family_last->next;
+        }
+        metric->next = *link;
+        __atomic_store_n(link, metric, __ATOMIC_RELEASE);
+        metric->registered = true;
+    }
+    xSemaphoreGive(lock);
+    return ESP_OK;
+}
+
+void geogram_metrics_register_all(geogram_metric_t *metrics, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        geogram_metrics_register(&metrics[i]);
+    }
+}
+
+void geogram_histogram_observe(geogram_histogram_t *hist, int64_t us)
+{
+    if (us < 0) {
+        us = 0;
+    }
+    size_t i = 0;
+    while (i < GEOGRAM_METRICS_BUCKETS && (uint64_t)us > k_bounds_us[i]) {
+        i++;
+    }
+    __atomic_fetch_add(&hist->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->sum_us, (uint64_t)us, __ATOMIC_RELAXED);
+}
+
+static geogram_metric_t *first_metric(void)
+{
+    return __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+}
+
+static geogram_metric_t *next_metric(const geogram_metric_t *metric)
+{
+    return __atomic_load_n(&metric->next, __ATOMIC_ACQUIRE);
+}
+
+static int64_t metric_value(const geogram_metric_t *metric)
+{
+    if (metric->read != NULL) {
+        return metric->read(metric);
+    }
+    uint32_t value = __atomic_load_n(&metric->value, __ATOMIC_RELAXED);
+    return metric->type == GEOGRAM_METRIC_GAUGE ? (int64_t)(int32_t)value : (int64_t)value;
+}
+
+/**
+ * @brief Copy the buckets of a histogram
+ *
+ * @return Observations counted (sum of the copied buckets)
+ */
+static uint32_t snapshot_histogram(const geogram_metric_t *metric,
+                                   uint32_t buckets[GEOGRAM_METRICS_BUCKETS + 1], uint64_t *sum_us)
+{
+    const geogram_histogram_t *hist = (const geogram_histogram_t *)metric;
+    uint32_t count = 0;
+    for (size_t i = 0; i <= GEOGRAM_METRICS_BUCKETS; i++) {
+        buckets[i] = __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+        count += buckets[i];
+    }
+    *sum_us = __atomic_load_n(&hist->sum_us, __ATOMIC_RELAXED);
+    return count;
+}
+
+/**
+ * @brief Format "{labels,labels2,extra}" (empty when there are no labels)
+ */
+static void format_labels(char *dst, size_t len, const geogram_metric_t *metric, const char *extra)
+{
+    const char *parts[3] = { metric->labels, metric->labels2, extra };
+    size_t pos = 0;
+    dst[0] = '\0';
+    for (size_t i = 0; i < 3 && pos < len; i++) {
+        if (parts[i] == NULL || parts[i][0] == '\0') {
+            continue;
+        }
+        int n = snprintf(dst + pos, len - pos, "%c%s", pos == 0 ? '{' : ',', parts[i]);
+        if (n < 0) {
+            break;
+        }
+        pos += (size_t)n;
+    }
+    if (pos > 0 && pos + 1 < len) {
+        dst[pos] = '}';
+        dst[pos + 1] = '\0';
+    }
+}
+
+// ============================================================================
+// Prometheus export
+// ============================================================================
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t pos;
+    geogram_metrics_flush_cb_t flush;
+    void *ctx;
+    bool failed;
+} metrics_out_t;
+
+static void out_drain(metrics_out_t *out, bool final)
+{
+    if (!out->failed && !out->flush(out->buffer, out->pos, final, out->ctx)) {
+        out->failed = true;
+    }
+    out->pos = 0;
+}
+
+static void out_printf(metrics_out_t *out, const char *fmt, ...)
+{
+    while (!out->failed) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(out->buffer + out->pos, out->size - out->pos, fmt, args);
+        va_end(args);
+
+        if (n >= 0 && (size_t)n < out->size - out->pos) {
+            out->pos += (size_t)n;
+            return;
+        }
+        if (n < 0 || out->pos == 0) {
+            out->failed = true;     // Line longer than the whole buffer
+            return;
+        }
+        // Did not fit behind the staged output: send that, then retry
+        out_drain(out, false);
+    }
+}
+
+static const char *type_name(geogram_metric_type_t type)
+{
+    switch (type) {
+        case GEOGRAM_METRIC_COUNTER:   return "counter";
+        case GEOGRAM_METRIC_GAUGE:     return "gauge";
+        case GEOGRAM_METRIC_HISTOGRAM: return "histogram";
+    }
+    return "untyped";
+}
+
+static void export_histogram(metrics_out_t *out, const geogram_metric_t *metric)
+{
+    uint32_t buckets[GEOGRAM_METRICS_BUCKETS + 1];
+    uint64_t sum_us;
+    uint32_t count = snapshot_histogram(metric, buckets, &sum_us);
+
+    char labels[METRICS_LABELS_MAX];
+    char le[24];
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i <= GEOGRAM_METRICS_BUCKETS; i++) {
+        cumulative += buckets[i];
+        snprintf(le, sizeof(le), "le=\"%s\"", i < GEOGRAM_METRICS_BUCKETS ? k_bounds_le[i] : "+Inf");
+        format_labels(labels, sizeof(labels), metric, le);
+        out_printf(out, "%s_bucket%s %lu\n", metric->name, labels, (unsigned long)cumulative);
+    }
+
+    format_labels(labels, sizeof(labels), metric, NULL);
+    out_printf(out, "%s_sum%s %llu.%06llu\n", metric->name, labels,
+               (unsigned long long)(sum_us / 1000000), (unsigned long long)(sum_us % 1000000));
+    out_printf(out, "%s_count%s %lu\n", metric->name, labels, (unsigned long)count);
+}
+
+bool geogram_metrics_export(char *buffer, size_t size, geogram_metrics_flush_cb_t flush, void *ctx)
+{
+    if (buffer == NULL || size == 0 || flush == NULL) {
+        return false;
+    }
+    register_builtin();
+
+    metrics_out_t out = {
+        .buffer = buffer,
+        .size = size,
+        .pos = 0,
+        .flush = flush,
+        .ctx = ctx,
+        .failed = false,
+    };
+
+    const char *family = NULL;
+    for (const geogram_metric_t *m = first_metric(); m != NULL && !out.failed; m = next_metric(m)) {
+        if (family == NULL || strcmp(family, m->name) != 0) {
+            family = m->name;
+            if (m->help != NULL) {
+                out_printf(&out, "# HELP %s %s\n", m->name, m->help);
+            }
+            out_printf(&out, "# TYPE %s %s\n", m->name, type_name(m->type));
+        }
+
+        if (m->type == GEOGRAM_METRIC_HISTOGRAM) {
+            export_histogram(&out, m);
+        } else {
+            char labels[METRICS_LABELS_MAX];
+            format_labels(labels, sizeof(labels), m, NULL);
+            out_printf(&out, "%s%s %lld\n", m->name, labels, (long long)metric_value(m));
+        }
+    }
+
+    out_drain(&out, true);
+    return !out.failed;
+}
+
+// ============================================================================
+// Console summary
+// ============================================================================
+
+/**
+ * @brief Upper bound of the bucket holding the pct-th percentile, as "<=2.5ms" or ">5s"
+ */
+static void format_quantile(char *dst, size_t len, const uint32_t *buckets, uint32_t count,
+                            unsigned pct)
+{
+    uint32_t target = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i < GEOGRAM_METRICS_BUCKETS; i++) {
+        cumulative += buckets[i];
+        if (cumulative >= target) {
+            uint32_t us = k_bounds_us[i];
+            if (us % 1000 == 0) {
+                snprintf(dst, len, "<=%lums", (unsigned long)(us / 1000));
+            } else {
+                snprintf(dst, len, "<=%lu.%lums", (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 100));
+            }
+            return;
+        }
+    }
+    snprintf(dst, len, ">%lus", (unsigned long)(k_bounds_us[GEOGRAM_METRICS_BUCKETS - 1] / 1000000));
+}
+
+void geogram_metrics_print(const char *filter)
+{
+    register_builtin();
+
+    for (const geogram_metric_t *m = first_metric(); m != NULL; m = next_metric(m)) {
+        if (filter != NULL && strstr(m->name, filter) == NULL) {
+            continue;
+        }
+
+        char series[160];
+        char labels[METRICS_LABELS_MAX];
+        format_labels(labels, sizeof(labels), m, NULL);
+        snprintf(series, sizeof(series), "%s%s", m->name, labels);
+
+        if (m->type != GEOGRAM_METRIC_HISTOGRAM) {
+            printf("  %-52s %lld\n", series, (long long)metric_value(m));
+            continue;
+        }
+
+        uint32_t buckets[GEOGRAM_METRICS_BUCKETS + 1];
+        uint64_t sum_us;
+        uint32_t count = snapshot_histogram(m, buckets, &sum_us);
+        if (count == 0) {
+            printf("  %-52s count=0\n", series);
+            continue;
+        }
+
+        char p50[16], p95[16], p99[16];
+        format_quantile(p50, sizeof(p50), buckets, count, 50);
+        format_quantile(p95, sizeof(p95), buckets, count, 95);
+        format_quantile(p99, sizeof(p99), buckets, count, 99);
+        uint64_t mean_us = sum_us / count;
+        printf("  %-52s count=%lu mean=%llu.%llums p50%s p95%s p99%s\n", series,
+               (unsigned long)count, (unsigned long long)(mean_us / 1000),
+               (unsigned long long)(mean_us % 1000 / 100), p50, p95, p99);
+    }
+}
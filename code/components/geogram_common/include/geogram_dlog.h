@@ -0,0 +1,73 @@
+#ifndef GEOGRAM_DLOG_H
+#define GEOGRAM_DLOG_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Deferred logging for hot paths (packet and request handlers).
+ *
+ * A call records the format string pointer, the tag and the raw arguments
+ * into a ring buffer of the calling core; a low-priority task formats the
+ * records and writes them through esp_log_write(), so tag levels and log
+ * hooks still apply. Strings passed for %s are copied (up to
+ * GEOGRAM_DLOG_MAX_STR bytes, longer ones end in "..."), so buffers may be
+ * reused right after the call. Format and tag must be string literals or
+ * otherwise outlive the record. When a ring is full the record is dropped
+ * and counted.
+ *
+ * Records still queued when the device crashes are lost; keep errors on
+ * ESP_LOGE.
+ */
+
+#define GEOGRAM_DLOG_RING_SIZE      4096    ///< Bytes per core, power of two
+#define GEOGRAM_DLOG_MAX_RECORD     192     ///< Largest record (header + arguments)
+#define GEOGRAM_DLOG_MAX_STR        64      ///< Bytes kept of each %s argument
+
+typedef struct {
+    uint32_t written;       ///< Records queued
+    uint32_t dropped;       ///< Records lost to a full ring
+    uint32_t truncated;     ///< Records whose arguments did not all fit
+} geogram_dlog_stats_t;
+
+/**
+ * @brief Start the task that formats and emits queued records
+ *
+ * Records logged before this are kept (until the ring fills) and emitted
+ * once the task runs.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the task can't be created
+ */
+esp_err_t geogram_dlog_start(void);
+
+/**
+ * @brief Queue a log record; use the GEOGRAM_DLOGx macros instead
+ */
+void geogram_dlog_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Copy the record counters
+ */
+void geogram_dlog_get_stats(geogram_dlog_stats_t *stats);
+
+#define GEOGRAM_DLOG_LEVEL(level, tag, fmt, ...) do {                   \
+        if (LOG_LOCAL_LEVEL >= (level)) {                               \
+            geogram_dlog_write((level), (tag), fmt, ##__VA_ARGS__);     \
+        }                                                               \
+    } while (0)
+
+#define GEOGRAM_DLOGW(tag, fmt, ...) GEOGRAM_DLOG_LEVEL(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define GEOGRAM_DLOGI(tag, fmt, ...) GEOGRAM_DLOG_LEVEL(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define GEOGRAM_DLOGD(tag, fmt, ...) GEOGRAM_DLOG_LEVEL(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_DLOG_H
@@ -0,0 +1,96 @@
+#ifndef GEOGRAM_LOGSTORE_H
+#define GEOGRAM_LOGSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Persistent log on the SD card.
+ *
+ * Every line that goes through esp_log (ESP_LOGx and deferred log records
+ * alike) is also copied, without ANSI colors, into a RAM batch. A
+ * background task appends full batches, or whatever is pending every
+ * GEOGRAM_LOGSTORE_FLUSH_MS, to the current log file, so callers never
+ * wait on the card. If the card falls behind, lines are dropped and counted.
+ *
+ * The log is addressed by byte offset since the first line ever stored.
+ * Files are named by sequence number (00000042.LOG) and each holds exactly
+ * GEOGRAM_LOGSTORE_FILE_SIZE bytes before the next one starts, so offset
+ * N lives in file N / FILE_SIZE. The oldest file is deleted when more than
+ * GEOGRAM_LOGSTORE_FILES exist. Lines still in RAM when the device crashes
+ * are lost.
+ */
+
+#define GEOGRAM_LOGSTORE_FILE_SIZE  (256 * 1024)
+#define GEOGRAM_LOGSTORE_FILES      8           ///< Files kept, current one included
+#define GEOGRAM_LOGSTORE_BATCH      4096        ///< Bytes per RAM batch (two are used)
+#define GEOGRAM_LOGSTORE_FLUSH_MS   5000
+
+typedef struct {
+    uint64_t first;         ///< Oldest offset still on the card
+    uint64_t end;           ///< Offset after the last byte stored or pending
+    uint32_t dropped_lines; ///< Lines lost because both batches were full
+    uint32_t write_errors;  ///< Batches the card did not take
+} geogram_logstore_stats_t;
+
+/**
+ * @brief Start storing logs in dir (created if missing)
+ *
+ * Resumes the newest log file found there. Hooks esp_log output; lines
+ * logged before this call are not stored.
+ *
+ * @param dir Directory on a mounted filesystem, e.g. "/sdcard/logs"
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already running, ESP_FAIL if
+ *         the directory can't be used, ESP_ERR_NO_MEM
+ */
+esp_err_t geogram_logstore_start(const char *dir);
+
+/**
+ * @brief Write pending lines and stop storing (before unmounting the card)
+ */
+void geogram_logstore_stop(void);
+
+/**
+ * @brief Whether logs are being stored
+ */
+bool geogram_logstore_is_running(void);
+
+/**
+ * @brief Write pending lines to the card now
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not running, ESP_FAIL on write error
+ */
+esp_err_t geogram_logstore_flush(void);
+
+/**
+ * @brief Read stored log text starting at an offset
+ *
+ * Does not flush; call geogram_logstore_flush() first to include the
+ * lines still in RAM. Reads stop at a file boundary, so loop on *next.
+ *
+ * @param since Offset to read from; older offsets start at the oldest file
+ * @param buf Output buffer (not NUL-terminated)
+ * @param len Capacity of buf
+ * @param out_len Bytes read (0 at the end of the log)
+ * @param next Offset to pass as since for the following read
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not running, ESP_FAIL on read error
+ */
+esp_err_t geogram_logstore_read(uint64_t since, char *buf, size_t len,
+                                size_t *out_len, uint64_t *next);
+
+/**
+ * @brief Get offsets and counters
+ */
+void geogram_logstore_get_stats(geogram_logstore_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_LOGSTORE_H
@@ -0,0 +1,157 @@
+#ifndef GEOGRAM_METRICS_H
+#define GEOGRAM_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Metrics registry, exported in Prometheus text format.
+ *
+ * Components keep their metrics in static structs and register them once
+ * at init. Registering only links the struct into a list (no allocation),
+ * and updating a metric is an atomic add on its own fields, so hot paths
+ * never take a registry lock. Metrics are never unregistered.
+ *
+ * - Counters only go up (requests, bytes, errors).
+ * - Gauges hold a current value (clients, free heap).
+ * - Histograms count latencies in fixed buckets from 1 ms to 5 s.
+ *
+ * A counter or gauge can instead be read from a function at export time,
+ * for values a component already tracks in its own stats struct.
+ *
+ * Metrics sharing a name but not labels form one family; registration keeps
+ * a family together so it is exported under a single HELP/TYPE header.
+ */
+
+#define GEOGRAM_METRICS_BUCKETS     12      ///< Finite histogram buckets (+Inf is extra)
+
+typedef enum {
+    GEOGRAM_METRIC_COUNTER = 0,
+    GEOGRAM_METRIC_GAUGE,
+    GEOGRAM_METRIC_HISTOGRAM,
+} geogram_metric_type_t;
+
+struct geogram_metric;
+
+/**
+ * @brief Value source for counters and gauges kept elsewhere
+ *
+ * Called at export time from the exporting task.
+ */
+typedef int64_t (*geogram_metric_read_fn_t)(const struct geogram_metric *metric);
+
+typedef struct geogram_metric {
+    const char *name;               ///< Prometheus name, e.g. "geogram_tiles_cache_hits_total"
+    const char *help;
+    const char *labels;             ///< Constant labels without braces (route="/api/status"), or NULL
+    const char *labels2;            ///< More labels appended after labels, e.g. a code="2xx" shared by many series, or NULL
+    geogram_metric_type_t type;
+    geogram_metric_read_fn_t read;  ///< Counter/gauge source; NULL uses value
+    uintptr_t arg;                  ///< For read, e.g. a field offset in a stats struct
+    uint32_t value;                 ///< Counter, or gauge as int32_t
+    struct geogram_metric *next;    ///< Registry list
+    bool registered;
+} geogram_metric_t;
+
+typedef struct {
+    geogram_metric_t metric;        ///< Type GEOGRAM_METRIC_HISTOGRAM
+    uint32_t buckets[GEOGRAM_METRICS_BUCKETS + 1];  ///< Per bucket (not cumulative), last is +Inf
+    uint64_t sum_us;
+} geogram_histogram_t;
+
+/**
+ * @brief Callback receiving export output, same contract as geo_json_flush_cb_t
+ *
+ * Gets each filled chunk, then the remainder with final set. Return false
+ * to abort.
+ */
+typedef bool (*geogram_metrics_flush_cb_t)(const char *data, size_t len, bool final, void *ctx);
+
+#define GEOGRAM_METRIC_COUNTER_INIT(name_, help_) \
+    { .name = (name_), .help = (help_), .type = GEOGRAM_METRIC_COUNTER }
+#define GEOGRAM_METRIC_GAUGE_INIT(name_, help_) \
+    { .name = (name_), .help = (help_), .type = GEOGRAM_METRIC_GAUGE }
+#define GEOGRAM_METRIC_READ_INIT(type_, name_, help_, read_, arg_) \
+    { .name = (name_), .help = (help_), .type = (type_), .read = (read_), .arg = (uintptr_t)(arg_) }
+#define GEOGRAM_HISTOGRAM_INIT(name_, help_) \
+    { .metric = { .name = (name_), .help = (help_), .type = GEOGRAM_METRIC_HISTOGRAM } }
+#define GEOGRAM_HISTOGRAM_LABELED_INIT(name_, help_, labels_) \
+    { .metric = { .name = (name_), .help = (help_), .labels = (labels_), .type = GEOGRAM_METRIC_HISTOGRAM } }
+
+/**
+ * @brief Add a metric to the registry (no-op if already registered)
+ *
+ * The struct must stay valid forever; name, help and labels are not copied.
+ * Safe from any task, not from an ISR.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG without a name, or ESP_ERR_NO_MEM if
+ *         the registry lock could not be created
+ */
+esp_err_t geogram_metrics_register(geogram_metric_t *metric);
+
+/**
+ * @brief Register a histogram
+ */
+static inline esp_err_t geogram_metrics_register_histogram(geogram_histogram_t *hist)
+{
+    return geogram_metrics_register(&hist->metric);
+}
+
+/**
+ * @brief Register every metric of an array
+ */
+void geogram_metrics_register_all(geogram_metric_t *metrics, size_t count);
+
+static inline void geogram_metric_add(geogram_metric_t *metric, uint32_t n)
+{
+    __atomic_fetch_add(&metric->value, n, __ATOMIC_RELAXED);
+}
+
+static inline void geogram_metric_inc(geogram_metric_t *metric)
+{
+    __atomic_fetch_add(&metric->value, 1, __ATOMIC_RELAXED);
+}
+
+static inline void geogram_metric_set(geogram_metric_t *metric, int32_t value)
+{
+    __atomic_store_n(&metric->value, (uint32_t)value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Record one latency observation
+ *
+ * @param us Duration in microseconds (negative counts as 0)
+ */
+void geogram_histogram_observe(geogram_histogram_t *hist, int64_t us);
+
+/**
+ * @brief Write all metrics in Prometheus text format (version 0.0.4)
+ *
+ * @param buffer Staging buffer, at least 256 bytes
+ * @param size Size of buffer
+ * @param flush Receives the output chunk by chunk
+ * @param ctx Passed to flush
+ * @return false if flush failed (output incomplete)
+ */
+bool geogram_metrics_export(char *buffer, size_t size, geogram_metrics_flush_cb_t flush, void *ctx);
+
+/**
+ * @brief Print a one-line-per-metric summary to stdout
+ *
+ * Histograms show count, mean and bucket-bound p50/p95/p99.
+ *
+ * @param filter Only metrics whose name contains this, or NULL for all
+ */
+void geogram_metrics_print(const char *filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_METRICS_H
@@ -0,0 +1,220 @@
+/**
+ * @file cmd_json.c
+ * @brief JSON tokenizer CLI commands (on-device benchmark)
+ *
+ * The same comparison on the build machine, with a cross-check of the
+ * tokenizer on a random corpus, is the `json` target in tests/host.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "argtable3/argtable3.h"
+#include "json_tokenizer.h"
+
+#define BENCH_DEFAULT_COUNT     200
+#define BENCH_MAX_COUNT         100000
+#define BENCH_TOKENS            32
+#define BENCH_CHUNK             128     // Streaming feed size, like a short httpd_req_recv()
+#define BENCH_DATA_LEN          1024    // Base64 payload of the sample file chunk
+
+// Fields a WebSocket relay reads from a file_chunk frame
+static const char *const BENCH_FIELDS[] = { "type", "to", "sha1", "from", "seq" };
+#define BENCH_FIELD_COUNT   (sizeof(BENCH_FIELDS) / sizeof(BENCH_FIELDS[0]))
+
+static struct {
+    struct arg_str *action;
+    struct arg_int *count;
+    struct arg_end *end;
+} json_args;
+
+static void print_rate(const char *label, int count, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    printf("%-10s %6d msgs %8lld us/msg %8.1f msgs/s\n", label, count,
+           (long long)(elapsed_us / count), (double)count * 1000000.0 / (double)elapsed_us);
+}
+
+/**
+ * @brief Field lookup the way the WebSocket server used to do it (one strstr per field)
+ */
+static bool strstr_get_field(const char *json, const char *key, char *value, size_t value_len)
+{
+    char search[64];
+    snprintf(search, sizeof(search), "\"%s\":\"", key);
+    const char *pos = strstr(json, search);
+    if (!pos) {
+        snprintf(search, sizeof(search), "\"%s\":", key);
+        pos = strstr(json, search);
+        if (!pos) return false;
+        pos += strlen(search);
+        size_t i = 0;
+        while (*pos && *pos != ',' && *pos != '}' && *pos != ']' && i < value_len - 1) {
+            value[i++] = *pos++;
+        }
+        value[i] = '\0';
+        return i > 0;
+    }
+
+    pos += strlen(search);
+    size_t i = 0;
+    while (*pos && *pos != '"' && i < value_len - 1) {
+        if (*pos == '\\' && pos[1]) {
+            pos++;
+        }
+        value[i++] = *pos++;
+    }
+    value[i] = '\0';
+    return true;
+}
+
+/**
+ * @brief Read all bench fields from tokens; returns how many were found
+ */
+static int token_get_fields(const char *json, const geo_json_token_t *tokens, int count,
+                            char values[][48])
+{
+    int found = 0;
+    for (size_t f = 0; f < BENCH_FIELD_COUNT; f++) {
+        values[f][0] = '\0';
+        int i = geo_json_object_get(json, tokens, count, 0, BENCH_FIELDS[f]);
+        if (i < 0) {
+            continue;
+        }
+        if (tokens[i].type == GEO_JSON_STRING) {
+            geo_json_token_to_string(json, &tokens[i], values[f], sizeof(values[f]));
+        } else {
+            int n = tokens[i].end - tokens[i].start;
+            snprintf(values[f], sizeof(values[f]), "%.*s", n, json + tokens[i].start);
+        }
+        found++;
+    }
+    return found;
+}
+
+/**
+ * @brief Compare strstr extraction with the tokenizer on a file_chunk frame
+ */
+static int bench_json(int count)
+{
+    size_t size = BENCH_DATA_LEN + 256;
+    char *frame = malloc(size);
+    if (!frame) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    // Signaling fields around a base64 payload, as sent by the file-sharing page
+    int len = snprintf(frame, size, "{\"type\":\"file_chunk\","
+                       "\"sha1\":\"2fd4e1c67a2d28fced849ee1bb76e7391b93eb12\",\"data\":\"");
+    for (int i = 0; i < BENCH_DATA_LEN; i++) {
+        frame[len++] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i % 64];
+    }
+    len += snprintf(frame + len, size - len, "\",\"from\":\"X1ABCD\",\"to\":\"X1WXYZ\",\"seq\":42}");
+
+    geo_json_token_t tokens[BENCH_TOKENS];
+    geo_json_parser_t parser;
+    char expected[BENCH_FIELD_COUNT][48];
+    char values[BENCH_FIELD_COUNT][48];
+    int failures = 0;
+
+    // Both approaches must agree before timing them
+    geo_json_parser_init(&parser, 2);
+    int ntok = geo_json_parse(&parser, frame, len, tokens, BENCH_TOKENS);
+    if (ntok < 1 || token_get_fields(frame, tokens, ntok, values) != BENCH_FIELD_COUNT) {
+        failures++;
+    }
+    for (size_t f = 0; f < BENCH_FIELD_COUNT; f++) {
+        if (!strstr_get_field(frame, BENCH_FIELDS[f], expected[f], sizeof(expected[f])) ||
+            strcmp(expected[f], values[f]) != 0) {
+            failures++;
+        }
+    }
+    printf("frame      %d bytes, %d tokens, %u fields\n", len, ntok, (unsigned)BENCH_FIELD_COUNT);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        for (size_t f = 0; f < BENCH_FIELD_COUNT; f++) {
+            strstr_get_field(frame, BENCH_FIELDS[f], values[f], sizeof(values[f]));
+        }
+    }
+    print_rate("strstr", count, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        geo_json_parser_init(&parser, 2);
+        ntok = geo_json_parse(&parser, frame, len, tokens, BENCH_TOKENS);
+        token_get_fields(frame, tokens, ntok, values);
+    }
+    print_rate("tokens", count, esp_timer_get_time() - start);
+
+    // Same frame arriving BENCH_CHUNK bytes at a time
+    start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        geo_json_parser_init(&parser, 2);
+        ntok = GEO_JSON_ERROR_PART;
+        for (int got = 0; ntok == GEO_JSON_ERROR_PART && got < len; ) {
+            got = got + BENCH_CHUNK < len ? got + BENCH_CHUNK : len;
+            ntok = geo_json_parse(&parser, frame, got, tokens, BENCH_TOKENS);
+        }
+        if (token_get_fields(frame, tokens, ntok, values) != BENCH_FIELD_COUNT) {
+            failures++;
+        }
+    }
+    print_rate("streamed", count, esp_timer_get_time() - start);
+
+    free(frame);
+
+    if (failures) {
+        printf("ERROR: %d unexpected results\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_json(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&json_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, json_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *action = json_args.action->sval[0];
+    int count = json_args.count->count > 0 ? json_args.count->ival[0] : BENCH_DEFAULT_COUNT;
+    if (count < 1 || count > BENCH_MAX_COUNT) {
+        printf("Count must be 1..%d\n", BENCH_MAX_COUNT);
+        return 1;
+    }
+
+    if (strcmp(action, "bench") == 0) {
+        return bench_json(count);
+    }
+
+    printf("Unknown action: %s\n", action);
+    printf("Usage:\n");
+    printf("  json bench [count]      - Compare strstr field lookup with the tokenizer\n");
+    return 1;
+}
+
+void register_json_commands(void)
+{
+    json_args.action = arg_str1(NULL, NULL, "<action>", "bench");
+    json_args.count = arg_int0(NULL, NULL, "<count>", "iterations");
+    json_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "json",
+        .help = "JSON tokenizer benchmark",
+        .hint = NULL,
+        .func = &cmd_json,
+        .argtable = &json_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file cmd_logs.c
+ * @brief Stored log CLI commands
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_console.h"
+#include "argtable3/argtable3.h"
+#include "geogram_logstore.h"
+
+#define LOGS_TAIL_DEFAULT   2048
+#define LOGS_READ_CHUNK     512
+
+static struct {
+    struct arg_str *action;
+    struct arg_int *bytes;
+    struct arg_str *since;
+    struct arg_end *end;
+} logs_args;
+
+static void print_status(void)
+{
+    geogram_logstore_stats_t stats;
+    geogram_logstore_get_stats(&stats);
+
+    printf("Log store: %s\n", geogram_logstore_is_running() ? "Running" : "Not running");
+    printf("Offsets: %llu..%llu (%llu bytes kept)\n", (unsigned long long)stats.first,
+           (unsigned long long)stats.end, (unsigned long long)(stats.end - stats.first));
+    printf("Dropped lines: %lu\n", (unsigned long)stats.dropped_lines);
+    printf("Write errors: %lu\n", (unsigned long)stats.write_errors);
+}
+
+static int logs_tail(void)
+{
+    if (!geogram_logstore_is_running()) {
+        printf("Log store is not running (no SD card?)\n");
+        return 1;
+    }
+
+    geogram_logstore_flush();
+    geogram_logstore_stats_t stats;
+    geogram_logstore_get_stats(&stats);
+
+    uint64_t since;
+    bool whole_lines = false;
+    if (logs_args.since->count > 0) {
+        since = strtoull(logs_args.since->sval[0], NULL, 10);
+    } else {
+        int bytes = logs_args.bytes->count > 0 ? logs_args.bytes->ival[0] : LOGS_TAIL_DEFAULT;
+        if (bytes <= 0) {
+            bytes = LOGS_TAIL_DEFAULT;
+        }
+        since = stats.end > (uint64_t)bytes ? stats.end - (uint64_t)bytes : 0;
+        whole_lines = since > 0;
+    }
+
+    char buf[LOGS_READ_CHUNK];
+    while (since < stats.end) {
+        size_t n = 0;
+        uint64_t next = since;
+        if (geogram_logstore_read(since, buf, sizeof(buf), &n, &next) != ESP_OK || n == 0) {
+            break;
+        }
+        since = next;
+
+        const char *start = buf;
+        if (whole_lines) {
+            // Started mid-log: drop the partial first line
+            const char *nl = memchr(buf, '\n', n);
+            if (nl == NULL) {
+                continue;
+            }
+            start = nl + 1;
+            whole_lines = false;
+        }
+        fwrite(start, 1, n - (size_t)(start - buf), stdout);
+    }
+
+    printf("-- next offset: %llu\n", (unsigned long long)since);
+    return 0;
+}
+
+static int cmd_logs(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&logs_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, logs_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *action = logs_args.action->sval[0];
+
+    if (strcmp(action, "tail") == 0) {
+        return logs_tail();
+    }
+    else if (strcmp(action, "status") == 0) {
+        print_status();
+    }
+    else {
+        printf("Unknown action: %s\n", action);
+        printf("Usage:\n");
+        printf("  logs tail [-n bytes]   - Print the end of the stored log\n");
+        printf("  logs tail -s <offset>  - Print from an offset (as printed by the last tail)\n");
+        printf("  logs status            - Show offsets and counters\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void register_logs_commands(void)
+{
+    logs_args.action = arg_str1(NULL, NULL, "<action>", "tail | status");
+    logs_args.bytes = arg_int0("n", "bytes", "<n>", "Bytes from the end to print (default 2048)");
+    logs_args.since = arg_str0("s", "since", "<offset>", "Offset to print from");
+    logs_args.end = arg_end(3);
+
+    const esp_console_cmd_t cmd = {
+        .command = "logs",
+        .help = "Logs stored on the SD card",
+        .hint = NULL,
+        .func = &cmd_logs,
+        .argtable = &logs_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,307 @@
+/**
+ * @file cmd_nostr.c
+ * @brief NOSTR signature CLI commands (status and on-device benchmarks)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "argtable3/argtable3.h"
+#include "nostr_schnorr.h"
+#include "nostr_event.h"
+#include "bech32.h"
+
+// Known-good BIP-340 signature used by the benchmark
+static const uint8_t BENCH_PUBKEY[32] = {
+    0xd7, 0xda, 0x18, 0xe2, 0x8d, 0x64, 0x63, 0xea, 0x9b, 0x7e, 0x93, 0x40, 0x2a, 0xec, 0x0e, 0x12,
+    0x2b, 0x76, 0xa6, 0x69, 0xe0, 0x4a, 0xd1, 0x2f, 0x5f, 0x4b, 0x91, 0x3f, 0x77, 0x27, 0x51, 0xef
+};
+static const uint8_t BENCH_MSG[32] = {
+    0x50, 0xeb, 0x6b, 0x82, 0x06, 0x90, 0x50, 0x60, 0x39, 0xa0, 0xb7, 0x50, 0x49, 0x08, 0xc9, 0xc1,
+    0x29, 0x07, 0x85, 0xd6, 0xb3, 0xa0, 0x88, 0x4b, 0xa4, 0x21, 0x90, 0x79, 0x29, 0xd9, 0x82, 0x74
+};
+static const uint8_t BENCH_SIG[64] = {
+    0xe0, 0x67, 0xaf, 0x59, 0x9d, 0xbb, 0x59, 0xc8, 0x4c, 0x4b, 0xcf, 0xfa, 0xa3, 0x42, 0xc5, 0x13,
+    0x8f, 0x7f, 0x41, 0x32, 0x2c, 0x98, 0x34, 0xac, 0xf3, 0x26, 0xad, 0x5d, 0xb1, 0x06, 0x5d, 0x46,
+    0x64, 0x15, 0x96, 0x93, 0x69, 0x55, 0x3a, 0x5a, 0x4f, 0x96, 0x44, 0x32, 0xba, 0x71, 0x0b, 0xa5,
+    0xe4, 0x38, 0x44, 0x60, 0x4d, 0x23, 0x19, 0x89, 0x03, 0x4a, 0xe8, 0xc2, 0xaa, 0x6e, 0x0a, 0x2a
+};
+
+#define BENCH_DEFAULT_COUNT     50
+#define BENCH_MAX_COUNT         10000
+#define BECH32_BATCH            16
+#define NPUB_BUF_LEN            80
+
+static struct {
+    struct arg_str *action;
+    struct arg_int *count;
+    struct arg_end *end;
+} nostr_args;
+
+static void print_rate(const char *label, int count, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    printf("%-10s %6d ops  %8lld us/op  %8.1f ops/s\n", label, count,
+           (long long)(elapsed_us / count), (double)count * 1000000.0 / (double)elapsed_us);
+}
+
+static int bench_verify(int count)
+{
+    int failures = 0;
+
+    // Forged copy of the signature (flipped bit in s) for the reject path
+    uint8_t bad_sig[64];
+    memcpy(bad_sig, BENCH_SIG, sizeof(bad_sig));
+    bad_sig[40] ^= 0x01;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        if (nostr_schnorr_verify(BENCH_SIG, BENCH_MSG, BENCH_PUBKEY) != ESP_OK) {
+            failures++;
+        }
+    }
+    print_rate("verify", count, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        if (nostr_schnorr_verify(bad_sig, BENCH_MSG, BENCH_PUBKEY) == ESP_OK) {
+            failures++;
+        }
+    }
+    print_rate("reject", count, esp_timer_get_time() - start);
+
+    // Same signature, checked NOSTR_VERIFY_BATCH_MAX at a time
+    nostr_schnorr_item_t items[NOSTR_VERIFY_BATCH_MAX];
+    esp_err_t results[NOSTR_VERIFY_BATCH_MAX];
+    for (int i = 0; i < NOSTR_VERIFY_BATCH_MAX; i++) {
+        items[i].sig = BENCH_SIG;
+        items[i].msg = BENCH_MSG;
+        items[i].pubkey = BENCH_PUBKEY;
+    }
+    int batches = (count + NOSTR_VERIFY_BATCH_MAX - 1) / NOSTR_VERIFY_BATCH_MAX;
+    start = esp_timer_get_time();
+    for (int i = 0; i < batches; i++) {
+        if (nostr_schnorr_verify_batch(items, NOSTR_VERIFY_BATCH_MAX, results) != ESP_OK) {
+            failures++;
+        }
+    }
+    print_rate("batch", batches * NOSTR_VERIFY_BATCH_MAX, esp_timer_get_time() - start);
+
+    // Signing with the station key; each message differs so every nonce does too
+    uint8_t msg[32], sig[64], pubkey[32];
+    if (nostr_schnorr_get_signing_pubkey(pubkey) == ESP_OK) {
+        memcpy(msg, BENCH_MSG, sizeof(msg));
+        start = esp_timer_get_time();
+        for (int i = 0; i < count; i++) {
+            msg[0] = (uint8_t)i;
+            msg[1] = (uint8_t)(i >> 8);
+            if (nostr_schnorr_sign(msg, sig) != ESP_OK) {
+                failures++;
+            }
+        }
+        print_rate("sign", count, esp_timer_get_time() - start);
+        if (nostr_schnorr_verify(sig, msg, pubkey) != ESP_OK) {
+            failures++;
+        }
+    } else {
+        printf("sign       skipped (no station key)\n");
+    }
+
+    if (failures) {
+        printf("ERROR: %d unexpected results\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+static uint32_t reference_polymod_step(uint32_t chk, uint32_t value)
+{
+    static const uint32_t gen[5] = { 0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3 };
+    uint32_t top = chk >> 25;
+    chk = ((chk & 0x1ffffff) << 5) ^ value;
+    for (int i = 0; i < 5; i++) {
+        if ((top >> i) & 1) {
+            chk ^= gen[i];
+        }
+    }
+    return chk;
+}
+
+/**
+ * @brief Bit-by-bit BIP-173 checksum check, kept as an independent reference
+ */
+static bool bech32_reference_valid(const char *str)
+{
+    static const char charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+    const char *sep = strrchr(str, '1');
+    if (!sep) {
+        return false;
+    }
+
+    uint32_t chk = 1;
+    for (const char *p = str; p < sep; p++) {
+        chk = reference_polymod_step(chk, (uint32_t)*p >> 5);
+    }
+    chk = reference_polymod_step(chk, 0);
+    for (const char *p = str; p < sep; p++) {
+        chk = reference_polymod_step(chk, (uint32_t)*p & 31);
+    }
+    for (const char *p = sep + 1; *p; p++) {
+        const char *c = strchr(charset, *p);
+        if (!c) {
+            return false;
+        }
+        chk = reference_polymod_step(chk, (uint32_t)(c - charset));
+    }
+    return chk == 1;
+}
+
+/**
+ * @brief Round-trip fuzz of the npub codec plus throughput figures
+ */
+static int bench_bech32(int count)
+{
+    int failures = 0;
+    uint8_t keys[BECH32_BATCH][32];
+    char npubs[BECH32_BATCH][NPUB_BUF_LEN];
+    char hrp[BECH32_MAX_HRP_LEN + 1];
+    uint8_t decoded[32];
+
+    for (int i = 0; i < count; i++) {
+        esp_fill_random(keys[0], sizeof(keys[0]));
+        if (bech32_encode("npub", keys[0], 32, npubs[0], NPUB_BUF_LEN) != ESP_OK ||
+            !bech32_reference_valid(npubs[0])) {
+            failures++;
+            continue;
+        }
+
+        size_t len = sizeof(decoded);
+        if (bech32_decode(npubs[0], hrp, decoded, &len) != ESP_OK ||
+            len != 32 || memcmp(decoded, keys[0], 32) != 0 || strcmp(hrp, "npub") != 0) {
+            failures++;
+            continue;
+        }
+
+        // Any single-character change must be caught by the checksum
+        size_t pos = 5 + esp_random() % (strlen(npubs[0]) - 5);
+        char orig = npubs[0][pos];
+        npubs[0][pos] = orig == 'q' ? 'p' : 'q';
+        len = sizeof(decoded);
+        if (bech32_decode(npubs[0], hrp, decoded, &len) == ESP_OK) {
+            failures++;
+        }
+        npubs[0][pos] = orig;
+    }
+    printf("fuzz       %6d round trips, %d failures\n", count, failures);
+
+    esp_fill_random(keys, sizeof(keys));
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        bech32_encode("npub", keys[i % BECH32_BATCH], 32, npubs[0], NPUB_BUF_LEN);
+    }
+    print_rate("encode", count, esp_timer_get_time() - start);
+
+    int batches = (count + BECH32_BATCH - 1) / BECH32_BATCH;
+    start = esp_timer_get_time();
+    for (int i = 0; i < batches; i++) {
+        bech32_encode_batch("npub", keys[0], 32, BECH32_BATCH, npubs[0], NPUB_BUF_LEN);
+    }
+    print_rate("batch", batches * BECH32_BATCH, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        size_t len = sizeof(decoded);
+        bech32_decode(npubs[i % BECH32_BATCH], hrp, decoded, &len);
+    }
+    print_rate("decode", count, esp_timer_get_time() - start);
+
+    if (failures) {
+        printf("ERROR: %d unexpected results\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_nostr(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&nostr_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, nostr_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *action = nostr_args.action->sval[0];
+    int count = nostr_args.count->count > 0 ? nostr_args.count->ival[0] : BENCH_DEFAULT_COUNT;
+    if (count < 1 || count > BENCH_MAX_COUNT) {
+        printf("Count must be 1..%d\n", BENCH_MAX_COUNT);
+        return 1;
+    }
+
+    if (strcmp(action, "status") == 0) {
+        nostr_schnorr_stats_t stats;
+        nostr_schnorr_get_stats(&stats);
+        uint32_t total = stats.verified + stats.rejected;
+        printf("Signatures verified: %lu\n", (unsigned long)stats.verified);
+        printf("Signatures rejected: %lu\n", (unsigned long)stats.rejected);
+        printf("Pubkey cache: %lu hits, %lu misses\n",
+               (unsigned long)stats.cache_hits, (unsigned long)stats.cache_misses);
+        if (total > 0) {
+            printf("Average verify time: %llu us\n",
+                   (unsigned long long)(stats.total_time_us / total));
+        }
+        printf("Signatures created: %lu", (unsigned long)stats.sigs_created);
+        if (stats.sigs_created > 0) {
+            printf(" (avg %llu us)", (unsigned long long)(stats.sign_time_us / stats.sigs_created));
+        }
+        printf("\n");
+        printf("Batches: %lu ok, %lu re-checked singly\n",
+               (unsigned long)stats.batches, (unsigned long)stats.batch_fallbacks);
+
+        nostr_event_stats_t ev_stats;
+        nostr_event_get_stats(&ev_stats);
+        printf("Event cache: %lu hits, %lu ids cached\n",
+               (unsigned long)ev_stats.cache_hits, (unsigned long)ev_stats.cached_ids);
+        printf("Events batched: %lu, queue drops: %lu\n",
+               (unsigned long)ev_stats.batched, (unsigned long)ev_stats.queue_drops);
+    }
+    else if (strcmp(action, "bench") == 0) {
+        return bench_verify(count);
+    }
+    else if (strcmp(action, "bech32") == 0) {
+        return bench_bech32(count);
+    }
+    else {
+        printf("Unknown action: %s\n", action);
+        printf("Usage:\n");
+        printf("  nostr status            - Show signature verification stats\n");
+        printf("  nostr bench [count]     - Benchmark Schnorr verification and signing\n");
+        printf("  nostr bech32 [count]    - Fuzz and benchmark npub encoding\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void register_nostr_commands(void)
+{
+    nostr_args.action = arg_str1(NULL, NULL, "<action>", "status | bench | bech32");
+    nostr_args.count = arg_int0(NULL, NULL, "<count>", "iterations for bench / bech32");
+    nostr_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "nostr",
+        .help = "NOSTR signature status and benchmarks",
+        .hint = NULL,
+        .func = &cmd_nostr,
+        .argtable = &nostr_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file cmd_ota.c
+ * @brief Firmware update CLI command
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_console.h"
+#include "argtable3/argtable3.h"
+#include "ota.h"
+
+static struct {
+    struct arg_str *source;
+    struct arg_str *sha256;
+    struct arg_lit *delta;
+    struct arg_end *end;
+} ota_args;
+
+static int cmd_ota(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&ota_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, ota_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *source = ota_args.source->sval[0];
+    const char *sha256 = ota_args.sha256->sval[0];
+    geogram_ota_kind_t kind = ota_args.delta->count > 0 ? GEOGRAM_OTA_DELTA : GEOGRAM_OTA_FULL;
+
+    printf("Applying %s update from %s...\n", kind == GEOGRAM_OTA_DELTA ? "delta" : "full", source);
+
+    esp_err_t ret;
+    if (strncmp(source, "http://", 7) == 0 || strncmp(source, "https://", 8) == 0) {
+        ret = geogram_ota_from_url(source, kind, sha256);
+    } else {
+        ret = geogram_ota_from_file(source, kind, sha256);
+    }
+
+    if (ret != ESP_OK) {
+        printf("Update failed: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+
+    printf("Update installed. Run 'reboot' to start it.\n");
+    return 0;
+}
+
+void register_ota_commands(void)
+{
+    ota_args.source = arg_str1(NULL, NULL, "<source>", "URL or file path (e.g. /sdcard/fw.patch)");
+    ota_args.sha256 = arg_str1(NULL, NULL, "<sha256>", "SHA-256 of the new firmware.bin");
+    ota_args.delta = arg_lit0("d", "delta", "Source is a patch against the running firmware");
+    ota_args.end = arg_end(3);
+
+    const esp_console_cmd_t cmd = {
+        .command = "ota",
+        .help = "Install a firmware update (full image or delta)",
+        .hint = NULL,
+        .func = &cmd_ota,
+        .argtable = &ota_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
@@ -18,6 +18,8 @@
 #include "model_init.h"
 #include "app_config.h"
 #include "wifi_bsp.h"
+#include "boot.h"
+#include "geogram_metrics.h"
 
 #if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
 #include "sdcard.h"
@@ -36,8 +38,11 @@ static int cmd_status(int argc, char **argv)
 
     if (mode == CONSOLE_OUTPUT_JSON) {
         // Build JSON status using station API
-        char json_buf[512];
-        station_build_status_json(json_buf, sizeof(json_buf));
+        char json_buf[STATION_STATUS_JSON_LEN];
+        if (station_build_status_json(json_buf, sizeof(json_buf)) == 0) {
+            printf("{\"error\":\"status too large\"}\n");
+            return 1;
+        }
         printf("%s\n", json_buf);
     } else {
         // Human-readable status
@@ -177,6 +182,69 @@ static int cmd_uptime(int argc, char **argv)
     return 0;
 }
 
+// ============================================================================
+// boot command
+// ============================================================================
+
+static int cmd_boot(int argc, char **argv)
+{
+    if (console_get_output_mode() != CONSOLE_OUTPUT_JSON) {
+        geogram_boot_print_profile();
+        return 0;
+    }
+
+    geogram_boot_record_t records[GEOGRAM_BOOT_MAX_STAGES + GEOGRAM_BOOT_MAX_MARKS];
+    size_t n = geogram_boot_get_profile(records, sizeof(records) / sizeof(records[0]));
+
+    printf("{\"stages\":[");
+    bool first = true;
+    for (size_t i = 0; i < n; i++) {
+        if (records[i].milestone) {
+            continue;
+        }
+        printf("%s{\"name\":\"%s\",\"start_ms\":%lld,\"end_ms\":%lld,\"worker\":%u,\"result\":\"%s\"}",
+               first ? "" : ",", records[i].name,
+               (long long)(records[i].start_us / 1000), (long long)(records[i].end_us / 1000),
+               records[i].worker,
+               records[i].status == GEOGRAM_BOOT_SKIPPED ? "skipped" : esp_err_to_name(records[i].result));
+        first = false;
+    }
+    printf("],\"milestones\":{");
+    first = true;
+    for (size_t i = 0; i < n; i++) {
+        if (!records[i].milestone) {
+            continue;
+        }
+        printf("%s\"%s\":%lld", first ? "" : ",", records[i].name,
+               (long long)(records[i].start_us / 1000));
+        first = false;
+    }
+    printf("}}\n");
+    return 0;
+}
+
+// ============================================================================
+// metrics command
+// ============================================================================
+
+static struct {
+    struct arg_str *filter;
+    struct arg_end *end;
+} metrics_args;
+
+static int cmd_metrics(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&metrics_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, metrics_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *filter = metrics_args.filter->count > 0 ? metrics_args.filter->sval[0] : NULL;
+    geogram_metrics_print(filter);
+    return 0;
+}
+
 // ============================================================================
 // format command (set output format)
 // ============================================================================
@@ -315,6 +383,27 @@ void register_system_commands(void)
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&uptime_cmd));
 
+    // boot
+    const esp_console_cmd_t boot_cmd = {
+        .command = "boot",
+        .help = "Show boot-time profile (stage timings, first HTTP response)",
+        .hint = NULL,
+        .func = &cmd_boot,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&boot_cmd));
+
+    // metrics
+    metrics_args.filter = arg_str0(NULL, NULL, "<filter>", "Only metrics whose name contains this");
+    metrics_args.end = arg_end(1);
+    const esp_console_cmd_t metrics_cmd = {
+        .command = "metrics",
+        .help = "Show counters, gauges and latency histograms (also at /metrics)",
+        .hint = NULL,
+        .func = &cmd_metrics,
+        .argtable = &metrics_args,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&metrics_cmd));
+
     // format
     format_args.format = arg_str0(NULL, NULL, "<text|json>", "Output format");
     format_args.end = arg_end(1);
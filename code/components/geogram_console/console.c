@@ -22,7 +22,7 @@ static const char *TAG = "console";
 #define MAX_CMDLINE_LENGTH  256
 #define MAX_CMDLINE_ARGS    8
 #define HISTORY_SIZE        8
-#define CONSOLE_TASK_STACK  4096
+#define CONSOLE_TASK_STACK  6144    // Room for the crypto benchmarks
 #define CONSOLE_TASK_PRIO   2
 
 static TaskHandle_t s_console_task = NULL;
@@ -157,6 +157,10 @@ esp_err_t console_init(void)
     register_config_commands();
     register_ssh_commands();
     register_ftp_commands();
+    register_nostr_commands();
+    register_json_commands();
+    register_ota_commands();
+    register_logs_commands();
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
     register_mesh_commands();
 #endif
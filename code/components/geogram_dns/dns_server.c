@@ -1,18 +1,29 @@
 /**
  * @file dns_server.c
- * @brief Simple DNS server for captive portal
+ * @brief DNS server for the station's AP clients
  *
- * This DNS server responds to all A record queries with the AP's IP address.
- * This allows users to access the device via any hostname (including the callsign).
+ * Local names (the zone table) are answered directly. Anything else is
+ * forwarded to the upstream resolver while forwarding is enabled, and the
+ * answers are kept in a small LRU cache for as long as their TTL allows.
+ * Without an uplink every other name resolves to the AP's IP address, so
+ * the device can be reached via any hostname (captive portal).
  */
 
 #include "dns_server.h"
+#include "geogram_metrics.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
+#include "lwip/dns.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <ctype.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 static const char *TAG = "dns_server";
 
@@ -28,22 +39,90 @@ typedef struct __attribute__((packed)) {
 
 // DNS flags
 #define DNS_FLAG_QR     0x8000  // Query/Response flag
+#define DNS_FLAG_OPCODE 0x7800  // Opcode, 0 = standard query
 #define DNS_FLAG_AA     0x0400  // Authoritative Answer
+#define DNS_FLAG_TC     0x0200  // Truncated
 #define DNS_FLAG_RD     0x0100  // Recursion Desired
 #define DNS_FLAG_RA     0x0080  // Recursion Available
+#define DNS_RCODE_MASK  0x000F
+
+#define DNS_RCODE_NOERROR   0
+#define DNS_RCODE_FORMERR   1
+#define DNS_RCODE_SERVFAIL  2
+#define DNS_RCODE_NXDOMAIN  3
+#define DNS_RCODE_NOTIMP    4
+#define DNS_RCODE_REFUSED   5
+#define DNS_RCODE_BADVERS   16      // Extended, upper bits carried in OPT
 
 // DNS types
 #define DNS_TYPE_A      1       // IPv4 address
+#define DNS_TYPE_SOA    6
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_AAAA   28      // IPv6 address
+#define DNS_TYPE_OPT    41      // EDNS pseudo-record (TTL field holds flags)
+#define DNS_TYPE_HTTPS  65
+#define DNS_TYPE_ANY    255
 #define DNS_CLASS_IN    1       // Internet class
 
 #define DNS_MAX_PACKET  512
-#define DNS_TASK_STACK  4096
+#define DNS_MAX_QNAME   256     // Dotted name, including the NUL
+#define DNS_MAX_QUESTIONS   4
+#define DNS_OPT_SIZE    11      // Our OPT record, no options
+#define DNS_BATCH_MAX   16      // Datagrams handled per socket per wakeup
+#define DNS_TASK_STACK  6144
 #define DNS_TASK_PRIO   5
 
+#define DNS_LOCAL_TTL       60      // Seconds, zone and captive answers
+#define DNS_CACHE_ENTRIES   32
+#define DNS_CACHE_MAX_TTL   3600    // Cap on upstream TTLs
+#define DNS_NEGATIVE_TTL    60      // Cap for NXDOMAIN / empty answers
+#define DNS_PENDING_MAX     4       // Queries awaiting the upstream resolver, one socket each
+#define DNS_FORWARD_TIMEOUT_US  (3 * 1000000LL)
+#define DNS_PORT_MIN        49152   // Random source ports are drawn from here up
+#define DNS_BIND_TRIES      4
+
+typedef struct {
+    char *name;             // Lowercase question name; NULL if slot unused
+    uint16_t qtype;
+    uint8_t *packet;        // Upstream response as received
+    uint16_t len;
+    int64_t stored_us;
+    int64_t expires_us;
+    uint32_t last_used;     // LRU tick
+} dns_cache_entry_t;
+
+typedef struct {
+    bool used;
+    int sock;                   // Bound to a random source port for this query only
+    uint16_t client_id;
+    uint16_t upstream_id;
+    uint16_t qtype;
+    uint16_t qclass;
+    uint32_t server;            // Resolver the query went to
+    struct sockaddr_in client;
+    int64_t sent_us;
+    char qname[DNS_MAX_QNAME];  // Lowercase; the answer must carry this question
+} dns_pending_t;
+
 static int s_socket = -1;
 static TaskHandle_t s_task = NULL;
 static uint32_t s_ap_ip = 0;
 static bool s_running = false;
+static volatile bool s_forwarding = false;
+static dns_server_stats_t s_stats;
+
+// Names under these are only ever answered from the zone table
+static const char *const s_local_domains[] = { "geogram", "mesh" };
+
+// Zone table is written by callers, read by the server task
+static dns_server_record_t s_records[DNS_SERVER_MAX_RECORDS];    // Lowercase names
+static size_t s_record_count = 0;
+static portMUX_TYPE s_records_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Only touched by the server task
+static dns_cache_entry_t s_cache[DNS_CACHE_ENTRIES];
+static uint32_t s_cache_tick = 0;
+static dns_pending_t s_pending[DNS_PENDING_MAX];
 
 /**
  * @brief Skip over a DNS name in the packet
@@ -64,102 +143,994 @@ static int dns_skip_name(const uint8_t *data, int offset, int len)
 }
 
 /**
- * @brief Build DNS response packet
+ * @brief Read an uncompressed question name as lowercase dotted text
+ *
+ * @return Offset just past the name, or -1 if malformed or too long
  */
-static int dns_build_response(const uint8_t *query, int query_len, uint8_t *response, uint32_t ip)
+static int dns_read_qname(const uint8_t *data, int offset, int len, char *name, size_t name_size)
 {
-    if (query_len < sizeof(dns_header_t)) {
-        return -1;
+    size_t pos = 0;
+    while (offset < len) {
+        uint8_t label_len = data[offset++];
+        if (label_len == 0) {
+            name[pos] = '\0';
+            return offset;
+        }
+        if ((label_len & 0xC0) != 0 || offset + label_len > len ||
+            pos + label_len + 2 > name_size) {
+            return -1;
+        }
+        if (pos > 0) {
+            name[pos++] = '.';
+        }
+        for (int i = 0; i < label_len; i++) {
+            name[pos++] = (char)tolower(data[offset + i]);
+        }
+        offset += label_len;
+    }
+    return -1;
+}
+
+static uint32_t dns_read_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief Visit the TTL field of every record after the question
+ *
+ * @param fn Called with the TTL position and record type
+ * @return false if the packet is malformed
+ */
+static bool dns_for_each_ttl(uint8_t *packet, int len, int offset,
+                             void (*fn)(uint8_t *ttl, uint16_t type, void *ctx), void *ctx)
+{
+    const dns_header_t *header = (const dns_header_t *)packet;
+    int records = ntohs(header->an_count) + ntohs(header->ns_count) + ntohs(header->ar_count);
+
+    for (int i = 0; i < records; i++) {
+        offset = dns_skip_name(packet, offset, len);
+        if (offset < 0 || offset + 10 > len) {
+            return false;
+        }
+        uint16_t type = (packet[offset] << 8) | packet[offset + 1];
+        uint16_t rdlength = (packet[offset + 8] << 8) | packet[offset + 9];
+        fn(packet + offset + 4, type, ctx);
+        offset += 10 + rdlength;
+    }
+    return offset <= len;
+}
+
+// ============================================================================
+// Zone Table
+// ============================================================================
+
+/**
+ * @brief Look up a name: exact match first, then the longest wildcard
+ */
+static bool dns_zone_lookup(const char *name, uint32_t *ip)
+{
+    size_t name_len = strlen(name);
+    size_t best = 0;
+    bool found = false;
+
+    taskENTER_CRITICAL(&s_records_lock);
+    for (size_t i = 0; i < s_record_count; i++) {
+        const char *rname = s_records[i].name;
+        if (strcmp(rname, name) == 0) {
+            *ip = s_records[i].ip;
+            found = true;
+            break;
+        }
+        if (rname[0] == '*' && rname[1] == '.') {
+            // "*.mesh" matches "x.mesh": suffix ".mesh" with a label before it
+            size_t suffix_len = strlen(rname + 1);
+            if (name_len > suffix_len && suffix_len > best &&
+                strcmp(name + name_len - suffix_len, rname + 1) == 0) {
+                *ip = s_records[i].ip;
+                best = suffix_len;
+                found = true;
+            }
+        }
+    }
+    taskEXIT_CRITICAL(&s_records_lock);
+    return found;
+}
+
+esp_err_t dns_server_add_record(const char *name, uint32_t ip)
+{
+    if (name == NULL || name[0] == '\0' || strlen(name) >= DNS_SERVER_MAX_NAME) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char lower[DNS_SERVER_MAX_NAME];
+    size_t i;
+    for (i = 0; name[i] != '\0'; i++) {
+        lower[i] = (char)tolower((unsigned char)name[i]);
+    }
+    lower[i] = '\0';
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_records_lock);
+    for (i = 0; i < s_record_count; i++) {
+        if (strcmp(s_records[i].name, lower) == 0) {
+            break;
+        }
+    }
+    if (i < DNS_SERVER_MAX_RECORDS) {
+        strcpy(s_records[i].name, lower);
+        s_records[i].ip = ip;
+        if (i == s_record_count) {
+            s_record_count++;
+        }
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_records_lock);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "%s -> %d.%d.%d.%d", lower,
+                 (uint8_t)(ip), (uint8_t)(ip >> 8), (uint8_t)(ip >> 16), (uint8_t)(ip >> 24));
+    } else {
+        ESP_LOGW(TAG, "Zone table full, %s not added", lower);
+    }
+    return ret;
+}
+
+esp_err_t dns_server_remove_record(const char *name)
+{
+    if (name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&s_records_lock);
+    for (size_t i = 0; i < s_record_count; i++) {
+        if (strcasecmp(s_records[i].name, name) == 0) {
+            s_records[i] = s_records[--s_record_count];
+            ret = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_records_lock);
+    return ret;
+}
+
+void dns_server_clear_records(void)
+{
+    taskENTER_CRITICAL(&s_records_lock);
+    s_record_count = 0;
+    taskEXIT_CRITICAL(&s_records_lock);
+}
+
+esp_err_t dns_server_set_records(const dns_server_record_t *records, size_t count)
+{
+    if ((records == NULL && count > 0) || count > DNS_SERVER_MAX_RECORDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (strnlen(records[i].name, DNS_SERVER_MAX_NAME) == DNS_SERVER_MAX_NAME) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // Lowercased while copied, so the lookup never sees a half-built table
+    taskENTER_CRITICAL(&s_records_lock);
+    s_record_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].name[0] == '\0') {
+            continue;
+        }
+        dns_server_record_t *r = &s_records[s_record_count++];
+        size_t j;
+        for (j = 0; records[i].name[j] != '\0'; j++) {
+            r->name[j] = (char)tolower((unsigned char)records[i].name[j]);
+        }
+        r->name[j] = '\0';
+        r->ip = records[i].ip;
+    }
+    taskEXIT_CRITICAL(&s_records_lock);
+
+    ESP_LOGI(TAG, "Zone table set, %u names", (unsigned)s_record_count);
+    return ESP_OK;
+}
+
+void dns_server_set_forwarding(bool enable)
+{
+    if (s_forwarding != enable) {
+        ESP_LOGI(TAG, "Upstream forwarding %s", enable ? "enabled" : "disabled");
+    }
+    s_forwarding = enable;
+}
+
+// ============================================================================
+// Answer Cache
+// ============================================================================
+
+static void dns_cache_free(dns_cache_entry_t *entry)
+{
+    free(entry->name);
+    entry->name = NULL;
+    entry->packet = NULL;   // Same allocation as the name
+}
+
+static void dns_cache_flush(void)
+{
+    for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        dns_cache_free(&s_cache[i]);
+    }
+}
+
+static dns_cache_entry_t *dns_cache_find(const char *name, uint16_t qtype)
+{
+    for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        dns_cache_entry_t *entry = &s_cache[i];
+        if (entry->name != NULL && entry->qtype == qtype && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void dns_age_ttl(uint8_t *ttl, uint16_t type, void *ctx)
+{
+    if (type != DNS_TYPE_OPT) {
+        uint32_t elapsed = *(const uint32_t *)ctx;
+        uint32_t value = dns_read_u32(ttl);
+        value = value > elapsed ? value - elapsed : 0;
+        ttl[0] = value >> 24;
+        ttl[1] = value >> 16;
+        ttl[2] = value >> 8;
+        ttl[3] = value;
+    }
+}
+
+/**
+ * @brief Answer from the cache in place, TTLs reduced by the time spent there
+ *
+ * The query's ID and question (as the client cased it) are kept.
+ *
+ * @return Response length, or 0 on a miss
+ */
+static int dns_cache_answer(uint8_t *buf, int qend, const char *name, uint16_t qtype)
+{
+    dns_cache_entry_t *entry = dns_cache_find(name, qtype);
+    if (entry == NULL) {
+        return 0;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now >= entry->expires_us) {
+        dns_cache_free(entry);
+        return 0;
+    }
+
+    entry->last_used = ++s_cache_tick;
+    // Same name length and a single question, so the layouts line up
+    memcpy(buf + 2, entry->packet + 2, sizeof(dns_header_t) - 2);
+    memcpy(buf + qend, entry->packet + qend, entry->len - qend);
+
+    uint32_t elapsed = (uint32_t)((now - entry->stored_us) / 1000000);
+    dns_for_each_ttl(buf, entry->len, qend, dns_age_ttl, &elapsed);
+    return entry->len;
+}
+
+typedef struct {
+    uint32_t min;
+    bool any;
+} dns_min_ttl_t;
+
+static void dns_collect_ttl(uint8_t *ttl, uint16_t type, void *ctx)
+{
+    dns_min_ttl_t *acc = (dns_min_ttl_t *)ctx;
+    if (type != DNS_TYPE_OPT) {
+        uint32_t value = dns_read_u32(ttl);
+        if (!acc->any || value < acc->min) {
+            acc->min = value;
+        }
+        acc->any = true;
+    }
+}
+
+/**
+ * @brief Keep an upstream response for the smallest TTL it carries
+ *
+ * @param qend End of its question, already checked against the query
+ * @param name Question name of the query that was forwarded
+ * @param qtype Question type of that query
+ */
+static void dns_cache_store(const uint8_t *packet, int len, int qend, const char *name, uint16_t qtype)
+{
+    const dns_header_t *header = (const dns_header_t *)packet;
+    uint16_t flags = ntohs(header->flags);
+    uint16_t rcode = flags & DNS_RCODE_MASK;
+    if ((flags & DNS_FLAG_TC) || (rcode != DNS_RCODE_NOERROR && rcode != DNS_RCODE_NXDOMAIN)) {
+        return;
+    }
+
+    // Negative answers: the SOA in the authority section carries the TTL
+    dns_min_ttl_t ttl = { 0 };
+    if (!dns_for_each_ttl((uint8_t *)packet, len, qend, dns_collect_ttl, &ttl) || !ttl.any) {
+        return;
+    }
+    uint32_t cap = (header->an_count == 0) ? DNS_NEGATIVE_TTL : DNS_CACHE_MAX_TTL;
+    if (ttl.min > cap) {
+        ttl.min = cap;
+    }
+    if (ttl.min == 0) {
+        return;
+    }
+
+    dns_cache_entry_t *entry = dns_cache_find(name, qtype);
+    if (entry == NULL) {
+        entry = &s_cache[0];
+        for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+            if (s_cache[i].name == NULL) {
+                entry = &s_cache[i];
+                break;
+            }
+            if (s_cache[i].last_used < entry->last_used) {
+                entry = &s_cache[i];
+            }
+        }
+    }
+    dns_cache_free(entry);
+
+    size_t name_len = strlen(name) + 1;
+    char *block = malloc(name_len + len);
+    if (block == NULL) {
+        return;
     }
+    memcpy(block, name, name_len);
+    memcpy(block + name_len, packet, len);
+
+    int64_t now = esp_timer_get_time();
+    entry->name = block;
+    entry->packet = (uint8_t *)block + name_len;
+    entry->len = len;
+    entry->qtype = qtype;
+    entry->stored_us = now;
+    entry->expires_us = now + (int64_t)ttl.min * 1000000;
+    entry->last_used = ++s_cache_tick;
+}
 
-    const dns_header_t *q_header = (const dns_header_t *)query;
-    dns_header_t *r_header = (dns_header_t *)response;
+// ============================================================================
+// Responses
+// ============================================================================
+
+typedef struct {
+    int name_offset;        // For compression pointers in the answers
+    uint16_t qtype;
+    uint16_t qclass;
+} dns_question_t;
+
+typedef struct {
+    bool present;
+    uint8_t version;
+    bool dnssec_ok;         // DO bit, echoed back
+} dns_edns_t;
+
+typedef enum {
+    DNS_SOURCE_ZONE,        // Local record
+    DNS_SOURCE_NXDOMAIN,    // Under a local domain, no record
+    DNS_SOURCE_UPSTREAM,    // Ask the upstream resolver
+    DNS_SOURCE_CAPTIVE,     // No uplink: everything is the AP
+} dns_source_t;
+
+static void dns_count_qtype(uint16_t qtype)
+{
+    switch (qtype) {
+        case DNS_TYPE_A:     s_stats.qtype_a++; break;
+        case DNS_TYPE_AAAA:  s_stats.qtype_aaaa++; break;
+        case DNS_TYPE_HTTPS: s_stats.qtype_https++; break;
+        case DNS_TYPE_PTR:   s_stats.qtype_ptr++; break;
+        case DNS_TYPE_ANY:   s_stats.qtype_any++; break;
+        default:             s_stats.qtype_other++; break;
+    }
+}
 
-    // Copy query header and modify for response
-    memcpy(response, query, query_len);
+/**
+ * @brief Decide who answers a name
+ *
+ * @param server Upstream resolver, 0 while not forwarding
+ */
+static dns_source_t dns_classify(const char *name, uint32_t server, uint32_t *ip)
+{
+    if (dns_zone_lookup(name, ip)) {
+        return DNS_SOURCE_ZONE;
+    }
 
-    // Set response flags
-    r_header->flags = htons(DNS_FLAG_QR | DNS_FLAG_AA | DNS_FLAG_RD | DNS_FLAG_RA);
-    r_header->an_count = htons(1);  // One answer
+    // Names in our own domains never leave the station
+    size_t name_len = strlen(name);
+    for (size_t i = 0; i < sizeof(s_local_domains) / sizeof(s_local_domains[0]); i++) {
+        const char *domain = s_local_domains[i];
+        size_t domain_len = strlen(domain);
+        if (strcmp(name, domain) == 0 ||
+            (name_len > domain_len && name[name_len - domain_len - 1] == '.' &&
+             strcmp(name + name_len - domain_len, domain) == 0)) {
+            return DNS_SOURCE_NXDOMAIN;
+        }
+    }
 
-    // Skip past header and question to find where to add answer
+    if (server != 0) {
+        return DNS_SOURCE_UPSTREAM;
+    }
+    *ip = s_ap_ip;
+    return DNS_SOURCE_CAPTIVE;
+}
+
+/**
+ * @brief Walk the question section
+ *
+ * @return Offset just past the last question, or -1 if malformed
+ */
+static int dns_parse_questions(const uint8_t *packet, int len, dns_question_t *questions, int count)
+{
     int offset = sizeof(dns_header_t);
+    for (int i = 0; i < count; i++) {
+        questions[i].name_offset = offset;
+        offset = dns_skip_name(packet, offset, len);
+        if (offset < 0 || offset + 4 > len || offset - questions[i].name_offset > 255) {
+            return -1;
+        }
+        questions[i].qtype = (packet[offset] << 8) | packet[offset + 1];
+        questions[i].qclass = (packet[offset + 2] << 8) | packet[offset + 3];
+        offset += 4;
+    }
+    return offset;
+}
+
+/**
+ * @brief Find the OPT record of an EDNS query
+ *
+ * @return false if the records after the questions are malformed
+ */
+static bool dns_parse_edns(const uint8_t *packet, int len, int offset, dns_edns_t *edns)
+{
+    const dns_header_t *header = (const dns_header_t *)packet;
+    int records = ntohs(header->an_count) + ntohs(header->ns_count) + ntohs(header->ar_count);
+
+    memset(edns, 0, sizeof(*edns));
+    for (int i = 0; i < records; i++) {
+        offset = dns_skip_name(packet, offset, len);
+        if (offset < 0 || offset + 10 > len) {
+            return false;
+        }
+        uint16_t type = (packet[offset] << 8) | packet[offset + 1];
+        uint16_t rdlength = (packet[offset + 8] << 8) | packet[offset + 9];
+        if (type == DNS_TYPE_OPT) {
+            edns->present = true;
+            edns->version = packet[offset + 5];
+            edns->dnssec_ok = (packet[offset + 6] & 0x80) != 0;
+        }
+        offset += 10 + rdlength;
+    }
+    return offset <= len;
+}
+
+static void dns_put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value >> 8;
+    p[1] = value;
+}
 
-    // Skip question name
-    offset = dns_skip_name(query, offset, query_len);
-    if (offset < 0) return -1;
+static void dns_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+/**
+ * @brief Append a record whose owner is a name already in the packet
+ *
+ * @return New length, or -1 if it does not fit
+ */
+static int dns_put_record(uint8_t *packet, int pos, int name_offset, uint16_t type,
+                          uint32_t ttl, const uint8_t *rdata, uint16_t rdlength)
+{
+    if (pos + 12 + rdlength > DNS_MAX_PACKET) {
+        return -1;
+    }
+    dns_put_u16(packet + pos, 0xC000 | name_offset);
+    dns_put_u16(packet + pos + 2, type);
+    dns_put_u16(packet + pos + 4, DNS_CLASS_IN);
+    dns_put_u32(packet + pos + 6, ttl);
+    dns_put_u16(packet + pos + 10, rdlength);
+    memcpy(packet + pos + 12, rdata, rdlength);
+    return pos + 12 + rdlength;
+}
+
+/**
+ * @brief Append the SOA that lets clients cache a negative answer
+ *
+ * Root MNAME/RNAME keep it short; MINIMUM bounds the negative TTL.
+ */
+static int dns_put_soa(uint8_t *packet, int pos, int name_offset)
+{
+    uint8_t rdata[22] = { 0 };
+    dns_put_u32(rdata + 2, 1);                  // Serial
+    dns_put_u32(rdata + 6, 3600);               // Refresh
+    dns_put_u32(rdata + 10, 600);               // Retry
+    dns_put_u32(rdata + 14, 86400);             // Expire
+    dns_put_u32(rdata + 18, DNS_LOCAL_TTL);     // Minimum
+    return dns_put_record(packet, pos, name_offset, DNS_TYPE_SOA, DNS_LOCAL_TTL,
+                          rdata, sizeof(rdata));
+}
+
+/**
+ * @brief Append our OPT record (fits in the room reserved for it)
+ */
+static int dns_put_opt(uint8_t *packet, int pos, const dns_edns_t *edns, uint8_t ext_rcode)
+{
+    packet[pos++] = 0;                          // Root name
+    dns_put_u16(packet + pos, DNS_TYPE_OPT);
+    dns_put_u16(packet + pos + 2, DNS_MAX_PACKET);  // Our UDP payload size
+    packet[pos + 4] = ext_rcode;
+    packet[pos + 5] = 0;                        // Version
+    dns_put_u16(packet + pos + 6, edns->dnssec_ok ? 0x8000 : 0);
+    dns_put_u16(packet + pos + 8, 0);           // No options
+    return pos + 10;
+}
+
+/**
+ * @brief Turn the query in buf into its response, in place
+ *
+ * Everything after the questions is overwritten. Questions the station
+ * can't answer locally (upstream names in a multi-question query) fail
+ * the query with SERVFAIL.
+ *
+ * @return Response length
+ */
+static int dns_build_response(uint8_t *buf, int qend, const dns_question_t *questions, int count,
+                              const dns_edns_t *edns, uint32_t server)
+{
+    dns_header_t *header = (dns_header_t *)buf;
+    uint16_t rcode = DNS_RCODE_NOERROR;
+    uint16_t flags = DNS_FLAG_QR | DNS_FLAG_AA | DNS_FLAG_RA |
+                     (ntohs(header->flags) & DNS_FLAG_RD);
+    int limit = DNS_MAX_PACKET - (edns->present ? DNS_OPT_SIZE : 0);
+    int pos = qend;
+    int answers = 0;
+    bool nxdomain = false;
+    char name[DNS_MAX_QNAME];
+
+    for (int i = 0; i < count; i++) {
+        const dns_question_t *q = &questions[i];
+        uint32_t ip = 0;
+        dns_source_t source = DNS_SOURCE_NXDOMAIN;
+        if (dns_read_qname(buf, q->name_offset, qend, name, sizeof(name)) >= 0) {
+            source = dns_classify(name, server, &ip);
+        }
+
+        if (source == DNS_SOURCE_UPSTREAM || q->qclass != DNS_CLASS_IN) {
+            rcode = (q->qclass != DNS_CLASS_IN) ? DNS_RCODE_REFUSED : DNS_RCODE_SERVFAIL;
+            pos = qend;
+            answers = 0;
+            break;
+        }
+        if (source == DNS_SOURCE_NXDOMAIN) {
+            nxdomain = true;
+            continue;
+        }
+        if (q->qtype != DNS_TYPE_A && q->qtype != DNS_TYPE_ANY) {
+            continue;   // AAAA, HTTPS...: the name exists, IPv4 only
+        }
+
+        // IP address (already in network byte order from esp_netif)
+        uint8_t rdata[4] = { ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, (ip >> 24) & 0xFF };
+        int next = (pos + 16 <= limit) ?
+                   dns_put_record(buf, pos, q->name_offset, DNS_TYPE_A, DNS_LOCAL_TTL, rdata, 4) : -1;
+        if (next < 0) {
+            flags |= DNS_FLAG_TC;
+            break;
+        }
+        pos = next;
+        answers++;
+    }
+
+    // A lone NXDOMAIN question names a domain that does not exist; otherwise
+    // an empty answer is NODATA. Either way the SOA makes it cacheable.
+    int authority = 0;
+    if (rcode == DNS_RCODE_NOERROR && answers == 0) {
+        if (nxdomain && count == 1) {
+            rcode = DNS_RCODE_NXDOMAIN;
+            s_stats.nxdomain++;
+        } else {
+            s_stats.nodata++;
+        }
+        if (pos + 34 <= limit) {
+            pos = dns_put_soa(buf, pos, questions[0].name_offset);
+            authority = 1;
+        }
+    }
+
+    if (rcode != DNS_RCODE_NOERROR && rcode != DNS_RCODE_NXDOMAIN) {
+        s_stats.errors++;
+    } else {
+        s_stats.local++;
+    }
+
+    header->flags = htons(flags | rcode);
+    header->qd_count = htons(count);
+    header->an_count = htons(answers);
+    header->ns_count = htons(authority);
+    header->ar_count = 0;
+    if (edns->present) {
+        pos = dns_put_opt(buf, pos, edns, 0);
+        header->ar_count = htons(1);
+    }
+    return pos;
+}
+
+/**
+ * @brief Turn the query in buf into an error response, in place
+ *
+ * @param qend End of the questions kept in the response, or header size
+ */
+static int dns_build_error(uint8_t *buf, int qend, uint16_t rcode, const dns_edns_t *edns)
+{
+    dns_header_t *header = (dns_header_t *)buf;
+    uint16_t flags = ntohs(header->flags);
+
+    s_stats.errors++;
+    header->flags = htons(DNS_FLAG_QR | DNS_FLAG_RA | (flags & (DNS_FLAG_OPCODE | DNS_FLAG_RD)) |
+                          (rcode & DNS_RCODE_MASK));
+    if (qend == (int)sizeof(dns_header_t)) {
+        header->qd_count = 0;
+    }
+    header->an_count = 0;
+    header->ns_count = 0;
+    header->ar_count = 0;
+    if (edns != NULL && edns->present) {
+        header->ar_count = htons(1);
+        return dns_put_opt(buf, qend, edns, rcode >> 4);
+    }
+    return qend;
+}
+
+/**
+ * @brief Upstream resolver learned by lwIP, 0 if none
+ */
+static uint32_t dns_upstream_server(void)
+{
+    const ip_addr_t *server = dns_getserver(0);
+    if (server == NULL || !IP_IS_V4(server) || ip_addr_isany(server)) {
+        return 0;
+    }
+    return ip_2_ip4(server)->addr;
+}
+
+/**
+ * @brief Open a UDP socket on a random source port
+ *
+ * lwIP hands out ephemeral ports in sequence, so the port is drawn here
+ * to make a forged answer guess it as well as the ID.
+ *
+ * @return Socket, or -1
+ */
+static int dns_open_random_port(void)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -1;
+    }
+    for (int i = 0; i < DNS_BIND_TRIES; i++) {
+        struct sockaddr_in local = {
+            .sin_family = AF_INET,
+            .sin_port = htons(DNS_PORT_MIN + esp_random() % (65536 - DNS_PORT_MIN)),
+            .sin_addr.s_addr = htonl(INADDR_ANY),
+        };
+        if (bind(sock, (struct sockaddr *)&local, sizeof(local)) == 0) {
+            return sock;
+        }
+    }
+    close(sock);
+    return -1;
+}
+
+static void dns_pending_release(dns_pending_t *slot)
+{
+    if (slot->sock >= 0) {
+        close(slot->sock);
+    }
+    slot->sock = -1;
+    slot->used = false;
+}
+
+/**
+ * @brief Send a query upstream under a fresh random ID and source port
+ *
+ * Only the header and question are forwarded, so the upstream answer fits
+ * a plain 512-byte UDP response. The question is kept to check the answer.
+ *
+ * @param name Lowercase question name
+ * @return true if the query is now pending
+ */
+static bool dns_forward(uint8_t *query, int qend, const dns_question_t *question, const char *name,
+                        const struct sockaddr_in *client, uint32_t server)
+{
+    dns_pending_t *slot = NULL;
+    for (int i = 0; i < DNS_PENDING_MAX; i++) {
+        if (!s_pending[i].used) {
+            slot = &s_pending[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        ESP_LOGD(TAG, "Too many pending upstream queries, dropping");
+        return false;
+    }
+
+    slot->sock = dns_open_random_port();
+    if (slot->sock < 0) {
+        ESP_LOGD(TAG, "No socket to forward on: %d", errno);
+        return false;
+    }
+
+    uint16_t upstream_id;
+    bool unique;
+    do {
+        upstream_id = (uint16_t)esp_random();
+        unique = true;
+        for (int i = 0; i < DNS_PENDING_MAX; i++) {
+            if (s_pending[i].used && s_pending[i].upstream_id == upstream_id) {
+                unique = false;
+            }
+        }
+    } while (!unique);
 
-    // Skip QTYPE and QCLASS
-    offset += 4;
+    dns_header_t *header = (dns_header_t *)query;
+    slot->client_id = header->id;
+    slot->upstream_id = upstream_id;
+    slot->qtype = question->qtype;
+    slot->qclass = question->qclass;
+    slot->server = server;
+    strlcpy(slot->qname, name, sizeof(slot->qname));
+    slot->client = *client;
+    slot->sent_us = esp_timer_get_time();
 
-    int resp_len = offset;
+    header->id = upstream_id;
+    header->qd_count = htons(1);
+    header->an_count = 0;
+    header->ns_count = 0;
+    header->ar_count = 0;
+
+    struct sockaddr_in server_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DNS_SERVER_PORT),
+        .sin_addr.s_addr = server,
+    };
+    if (sendto(slot->sock, query, qend, 0, (struct sockaddr *)&server_addr,
+               sizeof(server_addr)) < 0) {
+        ESP_LOGD(TAG, "Forward failed: %d", errno);
+        dns_pending_release(slot);
+        return false;
+    }
+    slot->used = true;
+    return true;
+}
 
-    // Add answer section
-    // Name pointer to question name (0xC00C points to offset 12, right after header)
-    response[resp_len++] = 0xC0;
-    response[resp_len++] = 0x0C;
+/**
+ * @brief Check that an upstream packet answers the pending query
+ *
+ * @return End of its question, or -1 if it does not match
+ */
+static int dns_match_answer(const uint8_t *packet, int len, const struct sockaddr_in *from,
+                            const dns_pending_t *slot)
+{
+    const dns_header_t *header = (const dns_header_t *)packet;
+    if (len < (int)sizeof(dns_header_t) || from->sin_addr.s_addr != slot->server ||
+        from->sin_port != htons(DNS_SERVER_PORT) || header->id != slot->upstream_id ||
+        !(ntohs(header->flags) & DNS_FLAG_QR) || ntohs(header->qd_count) != 1) {
+        return -1;
+    }
 
-    // Type: A (1)
-    response[resp_len++] = 0x00;
-    response[resp_len++] = DNS_TYPE_A;
+    char name[DNS_MAX_QNAME];
+    int offset = dns_read_qname(packet, sizeof(dns_header_t), len, name, sizeof(name));
+    if (offset < 0 || offset + 4 > len || strcmp(name, slot->qname) != 0 ||
+        ((packet[offset] << 8) | packet[offset + 1]) != slot->qtype ||
+        ((packet[offset + 2] << 8) | packet[offset + 3]) != slot->qclass) {
+        return -1;
+    }
+    return offset + 4;
+}
 
-    // Class: IN (1)
-    response[resp_len++] = 0x00;
-    response[resp_len++] = DNS_CLASS_IN;
+/**
+ * @brief Relay an upstream answer to the client that asked and cache it
+ *
+ * Anything that is not the answer to the pending question is ignored, and
+ * the query stays pending for the real one.
+ */
+static void dns_handle_upstream(dns_pending_t *slot, uint8_t *packet, int len,
+                                const struct sockaddr_in *from)
+{
+    int qend = dns_match_answer(packet, len, from, slot);
+    if (qend < 0) {
+        ESP_LOGD(TAG, "Ignoring upstream packet that does not answer %s", slot->qname);
+        return;
+    }
+
+    dns_cache_store(packet, len, qend, slot->qname, slot->qtype);
+    dns_header_t *header = (dns_header_t *)packet;
+    header->id = slot->client_id;
+    sendto(s_socket, packet, len, 0, (struct sockaddr *)&slot->client, sizeof(slot->client));
+    dns_pending_release(slot);
+}
+
+/**
+ * @brief Answer a client query in place: zone, cache, upstream, captive portal
+ *
+ * @return Response length, or 0 if nothing is to be sent now
+ */
+static int dns_handle_query(uint8_t *buf, int len, const struct sockaddr_in *client)
+{
+    dns_header_t *header = (dns_header_t *)buf;
+
+    s_stats.queries++;
+    if (len < (int)sizeof(dns_header_t) || (ntohs(header->flags) & DNS_FLAG_QR)) {
+        s_stats.dropped++;
+        return 0;   // Never answer a response
+    }
+
+    int count = ntohs(header->qd_count);
+    if (count == 0 || count > DNS_MAX_QUESTIONS) {
+        return dns_build_error(buf, sizeof(dns_header_t), DNS_RCODE_FORMERR, NULL);
+    }
+
+    dns_question_t questions[DNS_MAX_QUESTIONS];
+    int qend = dns_parse_questions(buf, len, questions, count);
+    if (qend < 0) {
+        return dns_build_error(buf, sizeof(dns_header_t), DNS_RCODE_FORMERR, NULL);
+    }
+    for (int i = 0; i < count; i++) {
+        dns_count_qtype(questions[i].qtype);
+    }
+
+    dns_edns_t edns;
+    if (!dns_parse_edns(buf, len, qend, &edns)) {
+        return dns_build_error(buf, qend, DNS_RCODE_FORMERR, NULL);
+    }
+    if (edns.present && edns.version != 0) {
+        return dns_build_error(buf, qend, DNS_RCODE_BADVERS, &edns);
+    }
+    if ((ntohs(header->flags) & DNS_FLAG_OPCODE) != 0) {
+        return dns_build_error(buf, qend, DNS_RCODE_NOTIMP, &edns);
+    }
 
-    // TTL: 60 seconds
-    response[resp_len++] = 0x00;
-    response[resp_len++] = 0x00;
-    response[resp_len++] = 0x00;
-    response[resp_len++] = 60;
+    uint32_t server = s_forwarding ? dns_upstream_server() : 0;
 
-    // Data length: 4 (IPv4 address)
-    response[resp_len++] = 0x00;
-    response[resp_len++] = 0x04;
+    // Only single questions go upstream (resolvers reject more)
+    char name[DNS_MAX_QNAME];
+    uint32_t ip;
+    if (count == 1 && server != 0 && questions[0].qclass == DNS_CLASS_IN &&
+        dns_read_qname(buf, questions[0].name_offset, qend, name, sizeof(name)) >= 0 &&
+        dns_classify(name, server, &ip) == DNS_SOURCE_UPSTREAM) {
+        int cached = dns_cache_answer(buf, qend, name, questions[0].qtype);
+        if (cached > 0) {
+            s_stats.cached++;
+            return cached;
+        }
+        if (dns_forward(buf, qend, &questions[0], name, client, server)) {
+            s_stats.forwarded++;
+        } else {
+            s_stats.dropped++;
+        }
+        return 0;
+    }
 
-    // IP address (already in network byte order from esp_netif)
-    response[resp_len++] = (ip >> 0) & 0xFF;
-    response[resp_len++] = (ip >> 8) & 0xFF;
-    response[resp_len++] = (ip >> 16) & 0xFF;
-    response[resp_len++] = (ip >> 24) & 0xFF;
+    return dns_build_response(buf, qend, questions, count, &edns, server);
+}
 
-    return resp_len;
+/**
+ * @brief Forget upstream queries that were never answered
+ */
+static void dns_expire_pending(void)
+{
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < DNS_PENDING_MAX; i++) {
+        if (s_pending[i].used && now - s_pending[i].sent_us > DNS_FORWARD_TIMEOUT_US) {
+            dns_pending_release(&s_pending[i]);
+        }
+    }
 }
 
 /**
  * @brief DNS server task
+ *
+ * Each wakeup drains every datagram already queued on both sockets (up to
+ * DNS_BATCH_MAX each), so a burst of connectivity checks from a phone that
+ * just associated is answered in one pass instead of one per select().
  */
 static void dns_server_task(void *pvParameters)
 {
-    uint8_t rx_buffer[DNS_MAX_PACKET];
-    uint8_t tx_buffer[DNS_MAX_PACKET];
+    // Queries are answered in this buffer; upstream replies relayed from it
+    uint8_t buffer[DNS_MAX_PACKET];
 
     ESP_LOGI(TAG, "DNS server task started");
 
     while (s_running) {
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
-
-        int len = recvfrom(s_socket, rx_buffer, sizeof(rx_buffer), 0,
-                          (struct sockaddr *)&client_addr, &addr_len);
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(s_socket, &readfds);
+        int max_fd = s_socket;
+        for (int i = 0; i < DNS_PENDING_MAX; i++) {
+            if (s_pending[i].used) {
+                FD_SET(s_pending[i].sock, &readfds);
+                if (s_pending[i].sock > max_fd) {
+                    max_fd = s_pending[i].sock;
+                }
+            }
+        }
 
-        if (len < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                continue;  // Timeout, check if still running
+        struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+        int ready = select(max_fd + 1, &readfds, NULL, NULL, &timeout);
+        if (!s_running) {
+            break;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-            ESP_LOGE(TAG, "recvfrom failed: %d", errno);
+            ESP_LOGE(TAG, "select failed: %d", errno);
             break;
         }
 
-        if (len < (int)sizeof(dns_header_t)) {
-            continue;  // Packet too short
+        struct sockaddr_in addr;
+        socklen_t addr_len;
+
+        // Answers first, before an expired slot's socket is closed
+        for (int i = 0; ready > 0 && i < DNS_PENDING_MAX; i++) {
+            dns_pending_t *slot = &s_pending[i];
+            if (!slot->used || !FD_ISSET(slot->sock, &readfds)) {
+                continue;
+            }
+            for (int n = 0; n < DNS_BATCH_MAX && slot->used; n++) {
+                addr_len = sizeof(addr);
+                int len = recvfrom(slot->sock, buffer, sizeof(buffer), MSG_DONTWAIT,
+                                   (struct sockaddr *)&addr, &addr_len);
+                if (len <= 0) {
+                    break;
+                }
+                dns_handle_upstream(slot, buffer, len, &addr);
+            }
+        }
+
+        dns_expire_pending();
+        if (ready == 0) {
+            continue;  // Timeout, check if still running
         }
 
-        // Build and send response
-        int resp_len = dns_build_response(rx_buffer, len, tx_buffer, s_ap_ip);
-        if (resp_len > 0) {
-            sendto(s_socket, tx_buffer, resp_len, 0,
-                   (struct sockaddr *)&client_addr, addr_len);
+        if (!FD_ISSET(s_socket, &readfds)) {
+            continue;
+        }
+        bool failed = false;
+        for (int n = 0; n < DNS_BATCH_MAX; n++) {
+            addr_len = sizeof(addr);
+            int len = recvfrom(s_socket, buffer, sizeof(buffer), MSG_DONTWAIT,
+                               (struct sockaddr *)&addr, &addr_len);
+            if (len < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    ESP_LOGE(TAG, "recvfrom failed: %d", errno);
+                    failed = true;
+                }
+                break;
+            }
+
+            int resp_len = dns_handle_query(buffer, len, &addr);
+            if (resp_len > 0) {
+                sendto(s_socket, buffer, resp_len, 0, (struct sockaddr *)&addr, addr_len);
+            }
+        }
+        if (failed) {
+            break;
+        }
+    }
+
+    dns_cache_flush();
+    for (int i = 0; i < DNS_PENDING_MAX; i++) {
+        if (s_pending[i].used) {
+            dns_pending_release(&s_pending[i]);
         }
     }
 
@@ -167,6 +1138,25 @@ static void dns_server_task(void *pvParameters)
     vTaskDelete(NULL);
 }
 
+// Metrics: read from s_stats at export time
+static int64_t read_stat(const geogram_metric_t *metric)
+{
+    return *(const uint32_t *)((const uint8_t *)&s_stats + metric->arg);
+}
+
+#define DNS_STAT(name, help, field) \
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, name, help, read_stat, offsetof(dns_server_stats_t, field))
+
+static geogram_metric_t s_metrics[] = {
+    DNS_STAT("geogram_dns_queries_total", "DNS queries received", queries),
+    DNS_STAT("geogram_dns_local_total", "Queries answered from the zone table or captive portal", local),
+    DNS_STAT("geogram_dns_cached_total", "Queries answered from the upstream answer cache", cached),
+    DNS_STAT("geogram_dns_forwarded_total", "Queries sent to the upstream resolver", forwarded),
+    DNS_STAT("geogram_dns_nxdomain_total", "Local names that do not exist", nxdomain),
+    DNS_STAT("geogram_dns_errors_total", "Malformed, unsupported or unanswerable queries", errors),
+    DNS_STAT("geogram_dns_dropped_total", "Queries not answered (forward queue full)", dropped),
+};
+
 esp_err_t dns_server_start(uint32_t ap_ip)
 {
     if (s_running) {
@@ -183,10 +1173,6 @@ esp_err_t dns_server_start(uint32_t ap_ip)
         return ESP_FAIL;
     }
 
-    // Set socket timeout
-    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
-    setsockopt(s_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
     // Bind to DNS port
     struct sockaddr_in server_addr = {
         .sin_family = AF_INET,
@@ -214,7 +1200,9 @@ esp_err_t dns_server_start(uint32_t ap_ip)
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "DNS server started on port %d, responding with %d.%d.%d.%d",
+    geogram_metrics_register_all(s_metrics, sizeof(s_metrics) / sizeof(s_metrics[0]));
+
+    ESP_LOGI(TAG, "DNS server started on port %d, AP address %d.%d.%d.%d",
              DNS_SERVER_PORT,
              (uint8_t)(ap_ip), (uint8_t)(ap_ip >> 8),
              (uint8_t)(ap_ip >> 16), (uint8_t)(ap_ip >> 24));
@@ -230,12 +1218,11 @@ esp_err_t dns_server_stop(void)
 
     s_running = false;
 
-    // Close socket to unblock recvfrom
+    // Close sockets to unblock select
     if (s_socket >= 0) {
         close(s_socket);
         s_socket = -1;
     }
-
     // Wait for task to finish
     vTaskDelay(pdMS_TO_TICKS(100));
     s_task = NULL;
@@ -248,3 +1235,10 @@ bool dns_server_is_running(void)
 {
     return s_running;
 }
+
+void dns_server_get_stats(dns_server_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
@@ -1,9 +1,11 @@
 /**
  * @file dns_server.h
- * @brief Simple DNS server for captive portal
+ * @brief DNS server for the station's AP clients
  *
- * Responds to DNS queries with the AP's IP address.
- * This enables accessing the device via hostname when connected to its AP.
+ * Names in the local zone table (e.g. station.geogram, <callsign>.mesh)
+ * are answered directly. Other names are forwarded to the upstream resolver
+ * when forwarding is enabled, with answers cached for their TTL; otherwise
+ * they resolve to the AP's IP address (captive portal).
  */
 
 #ifndef GEOGRAM_DNS_SERVER_H
@@ -11,6 +13,8 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +22,31 @@ extern "C" {
 
 #define DNS_SERVER_PORT 53
 
+#define DNS_SERVER_MAX_RECORDS  16  ///< Local zone table size
+#define DNS_SERVER_MAX_NAME     64  ///< Longest local name, including the NUL
+
+/**
+ * @brief Query counters since boot
+ *
+ * Per-type counters count questions; a query may carry several.
+ */
+typedef struct {
+    uint32_t queries;       // Client datagrams received
+    uint32_t qtype_a;
+    uint32_t qtype_aaaa;
+    uint32_t qtype_https;   // Type 65, sent by phones next to A/AAAA
+    uint32_t qtype_ptr;
+    uint32_t qtype_any;
+    uint32_t qtype_other;
+    uint32_t local;         // Answered from the zone table or captive portal
+    uint32_t cached;        // Answered from the upstream answer cache
+    uint32_t forwarded;     // Sent to the upstream resolver
+    uint32_t nxdomain;      // Local names that do not exist
+    uint32_t nodata;        // Names that exist, no record of the asked type
+    uint32_t errors;        // Malformed, unsupported or unanswerable queries
+    uint32_t dropped;       // Not answered at all (forward queue full)
+} dns_server_stats_t;
+
 /**
  * @brief Start the DNS server
  *
@@ -40,6 +69,69 @@ esp_err_t dns_server_stop(void);
  */
 bool dns_server_is_running(void);
 
+/**
+ * @brief One local name, for dns_server_set_records()
+ */
+typedef struct {
+    char name[DNS_SERVER_MAX_NAME];     ///< Case-insensitive, "*." prefix for a wildcard
+    uint32_t ip;                        ///< IPv4 address in network byte order
+} dns_server_record_t;
+
+/**
+ * @brief Add or update a local name
+ *
+ * A leading "*." makes the record a wildcard matching any name below it
+ * ("*.mesh" matches "abc.mesh" but not "mesh"). Exact names take precedence
+ * over wildcards. The table may be filled before the server starts.
+ *
+ * @param name Name, case-insensitive, without trailing dot
+ * @param ip IPv4 address in network byte order
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t dns_server_add_record(const char *name, uint32_t ip);
+
+/**
+ * @brief Remove a local name
+ *
+ * @param name Name as passed to dns_server_add_record()
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND
+ */
+esp_err_t dns_server_remove_record(const char *name);
+
+/**
+ * @brief Remove every local name
+ */
+void dns_server_clear_records(void);
+
+/**
+ * @brief Replace the whole zone table at once
+ *
+ * Queries see either the old table or the new one, never a partial table.
+ *
+ * @param records New names; empty names are skipped
+ * @param count Number of records, at most DNS_SERVER_MAX_RECORDS
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG (table unchanged)
+ */
+esp_err_t dns_server_set_records(const dns_server_record_t *records, size_t count);
+
+/**
+ * @brief Forward names outside the local zone upstream
+ *
+ * Uses the resolver lwIP learned over DHCP. Enable only while the station
+ * has an uplink; with forwarding off (or no resolver known) unknown names
+ * resolve to the AP's IP address.
+ *
+ * @param enable true to forward
+ */
+void dns_server_set_forwarding(bool enable);
+
+/**
+ * @brief Get query counters
+ *
+ * @param stats Output structure
+ */
+void dns_server_get_stats(dns_server_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
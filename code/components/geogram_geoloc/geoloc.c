@@ -1,12 +1,21 @@
 /**
  * @file geoloc.c
  * @brief IP-based geolocation implementation
+ *
+ * The last successful lookup is kept in NVS and applied at boot, so local
+ * time is right before the network is up. A background task refreshes it,
+ * backing off while the lookup fails.
  */
 
 #include "geoloc.h"
+#include "geoloc_tz.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "cJSON.h"
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
@@ -20,8 +29,27 @@ static const char *TAG = "geoloc";
 // Response buffer
 #define RESPONSE_BUFFER_SIZE 512
 
+// Last lookup, persisted across reboots
+#define GEOLOC_NVS_NAMESPACE    "geoloc"
+#define GEOLOC_NVS_KEY          "last"
+#define GEOLOC_NVS_VERSION      1
+
+// Background refresh
+#define GEOLOC_TASK_STACK       4096
+#define GEOLOC_TASK_PRIO        3
+#define GEOLOC_RETRY_MIN_MS     (30 * 1000)             // First retry after a failure
+#define GEOLOC_RETRY_MAX_MS     (60 * 60 * 1000)        // Backoff ceiling
+#define GEOLOC_REFRESH_MS       (24 * 60 * 60 * 1000)   // After a success
+
+typedef struct {
+    uint8_t version;
+    geoloc_data_t data;
+} geoloc_nvs_record_t;
+
 // Cached geolocation data
 static geoloc_data_t s_geoloc = {0};
+static TaskHandle_t s_refresh_task = NULL;
+static geoloc_update_cb_t s_update_cb = NULL;
 static char s_response_buffer[RESPONSE_BUFFER_SIZE];
 static int s_response_len = 0;
 
@@ -44,6 +72,60 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
+/**
+ * @brief Persist a lookup unless NVS already holds the same one
+ */
+static void geoloc_save(const geoloc_data_t *data)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(GEOLOC_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+
+    geoloc_nvs_record_t record = { .version = GEOLOC_NVS_VERSION };
+    geoloc_nvs_record_t stored;
+    size_t len = sizeof(stored);
+    memcpy(&record.data, data, sizeof(record.data));
+
+    if (nvs_get_blob(nvs, GEOLOC_NVS_KEY, &stored, &len) != ESP_OK || len != sizeof(stored) ||
+        memcmp(&stored, &record, sizeof(record)) != 0) {
+        if (nvs_set_blob(nvs, GEOLOC_NVS_KEY, &record, sizeof(record)) == ESP_OK) {
+            nvs_commit(nvs);
+            ESP_LOGI(TAG, "Saved location for next boot");
+        }
+    }
+    nvs_close(nvs);
+}
+
+esp_err_t geoloc_load(void)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(GEOLOC_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    geoloc_nvs_record_t record;
+    size_t len = sizeof(record);
+    err = nvs_get_blob(nvs, GEOLOC_NVS_KEY, &record, &len);
+    nvs_close(nvs);
+
+    // Layout changes bump the version; older records are simply ignored
+    if (err != ESP_OK || len != sizeof(record) || record.version != GEOLOC_NVS_VERSION ||
+        !record.data.valid) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    record.data.timezone[GEOLOC_TIMEZONE_LEN - 1] = '\0';
+    record.data.country[GEOLOC_COUNTRY_LEN - 1] = '\0';
+    record.data.city[GEOLOC_CITY_LEN - 1] = '\0';
+    memcpy(&s_geoloc, &record.data, sizeof(s_geoloc));
+
+    ESP_LOGI(TAG, "Last known location: %s, %s TZ: %s",
+             s_geoloc.city, s_geoloc.country, s_geoloc.timezone);
+    return ESP_OK;
+}
+
 esp_err_t geoloc_fetch(geoloc_data_t *data)
 {
     if (data == NULL) {
@@ -134,6 +216,7 @@ esp_err_t geoloc_fetch(geoloc_data_t *data)
 
     // Cache the data
     memcpy(&s_geoloc, data, sizeof(geoloc_data_t));
+    geoloc_save(data);
 
     ESP_LOGI(TAG, "Geolocation: %s, %s (%.4f, %.4f) TZ: %s (UTC%+ld)",
              data->city, data->country,
@@ -159,10 +242,15 @@ esp_err_t geoloc_iana_to_posix_tz(const char *iana_tz, char *posix_tz, size_t si
         return ESP_ERR_INVALID_ARG;
     }
 
-    // For ESP-IDF, we can use the IANA timezone directly if timezone database is available
-    // Otherwise, we construct a simple POSIX string from the offset
+    // Compiled table first: it carries the DST rules
+    const char *rule = geoloc_tz_lookup(iana_tz);
+    if (rule != NULL) {
+        strncpy(posix_tz, rule, size - 1);
+        posix_tz[size - 1] = '\0';
+        return ESP_OK;
+    }
 
-    // If we have cached offset, use it to construct POSIX timezone
+    // Unknown zone: fixed offset from the lookup (DST state at fetch time)
     if (s_geoloc.valid && s_geoloc.utc_offset != 0) {
         // POSIX timezone format: STDoffset or STDoffsetDST
         // Note: POSIX offset is opposite sign from UTC offset
@@ -192,7 +280,7 @@ esp_err_t geoloc_apply_timezone(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    char posix_tz[32];
+    char posix_tz[48];
     esp_err_t err = geoloc_iana_to_posix_tz(s_geoloc.timezone, posix_tz, sizeof(posix_tz));
     if (err != ESP_OK) {
         return err;
@@ -219,3 +307,55 @@ const char *geoloc_get_timezone(void)
 {
     return s_geoloc.valid ? s_geoloc.timezone : "UTC";
 }
+
+/**
+ * @brief Refresh task: look up, then sleep a day or back off on failure
+ *
+ * A notification (geoloc_start_refresh() again) cuts any wait short.
+ */
+static void geoloc_refresh_task(void *pvParameters)
+{
+    uint32_t retry_ms = GEOLOC_RETRY_MIN_MS;
+
+    while (true) {
+        geoloc_data_t data;
+        uint32_t wait_ms;
+
+        if (geoloc_fetch(&data) == ESP_OK) {
+            geoloc_apply_timezone();
+            if (s_update_cb) {
+                s_update_cb(&data);
+            }
+            retry_ms = GEOLOC_RETRY_MIN_MS;
+            wait_ms = GEOLOC_REFRESH_MS;
+        } else {
+            ESP_LOGW(TAG, "Lookup failed, retrying in %lus%s", (unsigned long)(retry_ms / 1000),
+                     s_geoloc.valid ? " (keeping last known location)" : "");
+            wait_ms = retry_ms;
+            retry_ms = (retry_ms * 2 > GEOLOC_RETRY_MAX_MS) ? GEOLOC_RETRY_MAX_MS : retry_ms * 2;
+        }
+
+        // pdMS_TO_TICKS multiplies by the tick rate first and would wrap a
+        // day at 1000 Hz to about 8 minutes; divide instead
+        if (ulTaskNotifyTake(pdTRUE, (TickType_t)(wait_ms / portTICK_PERIOD_MS)) > 0) {
+            retry_ms = GEOLOC_RETRY_MIN_MS;
+        }
+    }
+}
+
+esp_err_t geoloc_start_refresh(geoloc_update_cb_t callback)
+{
+    s_update_cb = callback;
+
+    if (s_refresh_task != NULL) {
+        xTaskNotifyGive(s_refresh_task);
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(geoloc_refresh_task, "geoloc", GEOLOC_TASK_STACK, NULL,
+                    GEOLOC_TASK_PRIO, &s_refresh_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create refresh task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
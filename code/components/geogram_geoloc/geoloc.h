@@ -4,6 +4,7 @@
  *
  * Uses ip-api.com to determine location based on public IP address.
  * Provides timezone string for NTP and coordinates for station status.
+ * The last result is kept in NVS so it can be applied at boot, offline.
  */
 
 #ifndef GEOGRAM_GEOLOC_H
@@ -33,6 +34,11 @@ typedef struct {
     bool valid;                             // True if data was successfully fetched
 } geoloc_data_t;
 
+/**
+ * @brief Called from the refresh task after each successful lookup
+ */
+typedef void (*geoloc_update_cb_t)(const geoloc_data_t *data);
+
 /**
  * @brief Fetch geolocation data from IP-based service
  *
@@ -44,10 +50,34 @@ typedef struct {
  */
 esp_err_t geoloc_fetch(geoloc_data_t *data);
 
+/**
+ * @brief Load the last successful lookup saved in NVS
+ *
+ * Call at boot, then geoloc_apply_timezone(), to have local time before
+ * any network is up.
+ *
+ * @return ESP_OK if a saved location was loaded, ESP_ERR_NOT_FOUND otherwise
+ */
+esp_err_t geoloc_load(void);
+
+/**
+ * @brief Keep the location fresh in the background
+ *
+ * Looks up now, then daily. Failed lookups are retried with exponential
+ * backoff (30 s up to 1 h) while the last known location stays in effect.
+ * Each success is saved to NVS and applied as the timezone. Calling again
+ * (e.g. on reconnect) replaces the callback and retries immediately.
+ *
+ * @param callback Optional, called after each successful lookup
+ * @return ESP_OK on success
+ */
+esp_err_t geoloc_start_refresh(geoloc_update_cb_t callback);
+
 /**
  * @brief Get cached geolocation data
  *
- * Returns pointer to internally cached data from last successful fetch.
+ * Returns pointer to internally cached data from the last successful
+ * fetch, or the location loaded by geoloc_load().
  *
  * @return Pointer to cached data, or NULL if not yet fetched
  */
@@ -64,7 +94,9 @@ bool geoloc_is_valid(void);
  * @brief Get POSIX timezone string for setenv("TZ", ...)
  *
  * Converts the IANA timezone (e.g., "Europe/Lisbon") to a POSIX
- * timezone string that can be used with setenv("TZ", ...).
+ * timezone string that can be used with setenv("TZ", ...), using a
+ * compiled table of every tzdata zone with its DST rules. Unknown zones
+ * fall back to the fixed UTC offset of the last lookup, then to UTC.
  *
  * @param iana_tz IANA timezone name
  * @param posix_tz Buffer to store POSIX timezone string
@@ -77,7 +109,7 @@ esp_err_t geoloc_iana_to_posix_tz(const char *iana_tz, char *posix_tz, size_t si
  * @brief Apply timezone from geolocation
  *
  * Sets the system timezone based on cached geolocation data.
- * Should be called after geoloc_fetch() succeeds.
+ * Should be called after geoloc_fetch() or geoloc_load() succeeds.
  *
  * @return ESP_OK on success
  */
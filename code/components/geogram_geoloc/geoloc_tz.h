@@ -0,0 +1,17 @@
+/**
+ * @file geoloc_tz.h
+ * @brief Compiled IANA to POSIX timezone table (internal)
+ */
+
+#ifndef GEOGRAM_GEOLOC_TZ_H
+#define GEOGRAM_GEOLOC_TZ_H
+
+/**
+ * @brief Look up the POSIX TZ string of an IANA zone
+ *
+ * @param iana_tz Canonical IANA name, e.g. "Europe/Lisbon"
+ * @return POSIX string with DST rules, or NULL if the zone is unknown
+ */
+const char *geoloc_tz_lookup(const char *iana_tz);
+
+#endif // GEOGRAM_GEOLOC_TZ_H
@@ -0,0 +1,32 @@
+#!/usr/bin/env python3
+"""
+Compress a web asset for embedding in flash.
+
+Usage: gzip_asset.py <input> <output.gz>
+
+The gzip header carries no file name or timestamp, so the output (and the
+ETag derived from it on the device) only changes when the input does.
+"""
+
+import gzip
+import sys
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    with open(sys.argv[1], 'rb') as f:
+        data = f.read()
+
+    compressed = gzip.compress(data, compresslevel=9, mtime=0)
+
+    with open(sys.argv[2], 'wb') as f:
+        f.write(compressed)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,108 @@
+/**
+ * @file http_arena.c
+ * @brief Per-request scratch memory for HTTP handlers
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "http_arena.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "http_arena";
+
+#define ARENA_ALIGN 8
+
+struct http_arena {
+    httpd_handle_t server;      // Owner, NULL if the slot is free
+    uint8_t *base;              // HTTP_ARENA_SIZE bytes
+    size_t used;
+    size_t peak;                // Largest request so far, for sizing the budget
+};
+
+static http_arena_t s_pool[HTTP_ARENA_POOL_SIZE];
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static http_arena_t *arena_claim(httpd_handle_t server)
+{
+    http_arena_t *arena = NULL;
+
+    // Only the first request of a server takes a slot, but two servers
+    // can get there at the same time
+    taskENTER_CRITICAL(&s_pool_lock);
+    for (int i = 0; i < HTTP_ARENA_POOL_SIZE; i++) {
+        if (s_pool[i].server == server) {
+            arena = &s_pool[i];
+            break;
+        }
+        if (s_pool[i].server == NULL && arena == NULL) {
+            arena = &s_pool[i];
+        }
+    }
+    if (arena != NULL && arena->server == NULL) {
+        arena->server = server;
+    }
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    return arena;
+}
+
+http_arena_t *http_arena_begin(httpd_req_t *req)
+{
+    http_arena_t *arena = arena_claim(req->handle);
+    if (arena == NULL) {
+        ESP_LOGE(TAG, "No free arena (pool of %d)", HTTP_ARENA_POOL_SIZE);
+        return NULL;
+    }
+
+    if (arena->base == NULL) {
+        arena->base = malloc(HTTP_ARENA_SIZE);
+        if (arena->base == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate %d byte arena", HTTP_ARENA_SIZE);
+            return NULL;
+        }
+        ESP_LOGI(TAG, "Arena of %d bytes allocated", HTTP_ARENA_SIZE);
+    }
+
+    arena->used = 0;
+    return arena;
+}
+
+void *http_arena_alloc(http_arena_t *arena, size_t size)
+{
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (start > HTTP_ARENA_SIZE || size > HTTP_ARENA_SIZE - start) {
+        ESP_LOGW(TAG, "Arena exhausted: %zu bytes requested, %zu free",
+                 size, http_arena_available(arena));
+        return NULL;
+    }
+
+    arena->used = start + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+        ESP_LOGD(TAG, "Arena peak %zu of %d bytes", arena->peak, HTTP_ARENA_SIZE);
+    }
+    return arena->base + start;
+}
+
+size_t http_arena_available(const http_arena_t *arena)
+{
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    return start < HTTP_ARENA_SIZE ? HTTP_ARENA_SIZE - start : 0;
+}
+
+void http_arena_release(httpd_handle_t server)
+{
+    taskENTER_CRITICAL(&s_pool_lock);
+    for (int i = 0; i < HTTP_ARENA_POOL_SIZE; i++) {
+        if (s_pool[i].server == server) {
+            uint8_t *base = s_pool[i].base;
+            s_pool[i] = (http_arena_t){0};
+            taskEXIT_CRITICAL(&s_pool_lock);
+            free(base);
+            return;
+        }
+    }
+    taskEXIT_CRITICAL(&s_pool_lock);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file http_arena.h
+ * @brief Per-request scratch memory for HTTP handlers
+ *
+ * Each server (esp_http_server runs one worker task per server) owns one
+ * fixed block, allocated on its first request and kept until the server
+ * stops. Handlers take their buffers from it with a bump allocator and
+ * never free them: the arena is rewound when the worker starts its next
+ * request. Request handling thus does no heap allocation, and large
+ * buffers stay off the handler stack.
+ *
+ * Buffer budget per endpoint (bytes of arena, worst case):
+ *
+ *     POST /api/chat/send        HTTP_BUDGET_CHAT_FORM x 2  body + event copy
+ *     POST /api/chat/send-file   HTTP_BUDGET_CHAT_FORM      body
+ *     POST /api/chat/client      HTTP_BUDGET_CHAT_CLIENT    body
+ *     POST /api/file/upload      HTTP_BUDGET_FILE_UPLOAD    body, URL-decoded in place
+ *     GET  /api/file/download    HTTP_BUDGET_FILE_B64       base64 slice, streamed
+ *     GET  /api/status/signed    STATION_SIGNED_STATUS_LEN  signed event copy
+ *     GET  /api/logs             HTTP_BUDGET_LOG_READ       SD log read buffer, streamed
+ *     GET  static assets         HTTP_BUDGET_STATIC_READ    SD bundle read buffer
+ *
+ * Requests that do not fit are rejected with an error status, never
+ * served from the heap.
+ *
+ * The upload's base64 field is decoded into the static 16 KB transfer
+ * buffer in http_server.c, which holds the chunk until the receiver
+ * fetches it, so only the encoded body counts against the arena.
+ */
+
+#ifndef HTTP_ARENA_H
+#define HTTP_ARENA_H
+
+#include <stddef.h>
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_BUDGET_CHAT_FORM       2048
+#define HTTP_BUDGET_CHAT_CLIENT     1024
+#define HTTP_BUDGET_FILE_UPLOAD     32768       // 16 KB chunk, base64 + URL encoded
+#define HTTP_BUDGET_FILE_B64        2052        // 1536 raw bytes per slice
+#define HTTP_BUDGET_STATIC_READ     2048
+#define HTTP_BUDGET_LOG_READ        2048
+
+#define HTTP_ARENA_SIZE             (HTTP_BUDGET_FILE_UPLOAD + 256)
+#define HTTP_ARENA_POOL_SIZE        2           // Servers running at once
+
+typedef struct http_arena http_arena_t;
+
+/**
+ * @brief Get the arena of the worker running this request, rewound
+ *
+ * Call once at the top of a handler; everything allocated earlier on the
+ * same worker is released.
+ *
+ * @param req Current request, selects the worker by its server handle
+ * @return Arena, or NULL if the pool is full or the block can't be allocated
+ */
+http_arena_t *http_arena_begin(httpd_req_t *req);
+
+/**
+ * @brief Allocate from the arena (8-byte aligned, not zeroed)
+ *
+ * @return Pointer valid until the worker's next request, NULL if over budget
+ */
+void *http_arena_alloc(http_arena_t *arena, size_t size);
+
+/**
+ * @brief Bytes still available in the arena
+ */
+size_t http_arena_available(const http_arena_t *arena);
+
+/**
+ * @brief Free the arena of a server, call after httpd_stop()
+ */
+void http_arena_release(httpd_handle_t server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_ARENA_H
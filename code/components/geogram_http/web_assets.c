@@ -0,0 +1,450 @@
+/**
+ * @file web_assets.c
+ * @brief Static web UI assets served from a sorted route table
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "web_assets.h"
+#include "http_arena.h"
+#include "esp_log.h"
+#include "app_config.h"
+
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+#include "sdcard.h"
+#define WEB_BUNDLE_SUPPORTED 1
+#endif
+
+static const char *TAG = "web_assets";
+
+#define CAPTIVE_PORTAL_URL      "http://192.168.5.1/"
+#define WEB_CACHE_MAX_ASSET     (4 * 1024)      // Largest asset kept in RAM
+#define WEB_CACHE_BUDGET        (32 * 1024)     // RAM for all cached assets
+
+// Pages change with the firmware or bundle and are revalidated by ETag;
+// versioned paths never change
+#define CACHE_REVALIDATE        "no-cache"
+#define CACHE_IMMUTABLE         "public, max-age=31536000, immutable"
+
+static const char *const MIME_TYPES[WEB_MIME_COUNT] = {
+    [WEB_MIME_BINARY] = "application/octet-stream",
+    [WEB_MIME_HTML]   = "text/html",
+    [WEB_MIME_JS]     = "application/javascript",
+    [WEB_MIME_CSS]    = "text/css",
+    [WEB_MIME_JSON]   = "application/json",
+    [WEB_MIME_PNG]    = "image/png",
+    [WEB_MIME_JPEG]   = "image/jpeg",
+    [WEB_MIME_SVG]    = "image/svg+xml",
+    [WEB_MIME_ICO]    = "image/x-icon",
+    [WEB_MIME_WOFF2]  = "font/woff2",
+    [WEB_MIME_TEXT]   = "text/plain",
+};
+
+// Pages embedded by CMakeLists.txt from www/, as-is and gzip-compressed
+extern const uint8_t index_html_start[] asm("_binary_index_html_start");
+extern const uint8_t index_html_end[] asm("_binary_index_html_end");
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
+extern const uint8_t setup_html_start[] asm("_binary_setup_html_start");
+extern const uint8_t setup_html_end[] asm("_binary_setup_html_end");
+extern const uint8_t setup_html_gz_start[] asm("_binary_setup_html_gz_start");
+extern const uint8_t setup_html_gz_end[] asm("_binary_setup_html_gz_end");
+extern const uint8_t nostr_tools_js_start[] asm("_binary_nostr_tools_1_17_0_js_start");
+extern const uint8_t nostr_tools_js_end[] asm("_binary_nostr_tools_1_17_0_js_end");
+extern const uint8_t nostr_tools_js_gz_start[] asm("_binary_nostr_tools_1_17_0_js_gz_start");
+extern const uint8_t nostr_tools_js_gz_end[] asm("_binary_nostr_tools_1_17_0_js_gz_end");
+
+typedef struct {
+    const char *path;
+    uint8_t mime;
+    uint8_t flags;
+    const uint8_t *data;
+    const uint8_t *data_end;
+    const uint8_t *gz;
+    const uint8_t *gz_end;
+    uint32_t etag;              // FNV-1a of data, 0 until first request
+} builtin_asset_t;
+
+// Sorted by path
+static builtin_asset_t s_builtin[] = {
+    // Landing page with chat - Terminimal theme
+    { "/index.html", WEB_MIME_HTML, 0,
+      index_html_start, index_html_end, index_html_gz_start, index_html_gz_end, 0 },
+    // NostrTools bundle used by the landing page for client keys and signing
+    { "/nostr-tools-1.17.0.js", WEB_MIME_JS, WEB_FLAG_IMMUTABLE,
+      nostr_tools_js_start, nostr_tools_js_end, nostr_tools_js_gz_start, nostr_tools_js_gz_end, 0 },
+    // WiFi configuration page
+    { "/setup", WEB_MIME_HTML, 0,
+      setup_html_start, setup_html_end, setup_html_gz_start, setup_html_gz_end, 0 },
+};
+#define BUILTIN_COUNT   (sizeof(s_builtin) / sizeof(s_builtin[0]))
+
+#ifdef WEB_BUNDLE_SUPPORTED
+// RAM copies of small bundle assets, per entry: [0] as-is, [1] gzip
+typedef struct {
+    uint8_t *data[2];
+} web_cache_slot_t;
+
+static web_bundle_entry_t *s_entries = NULL;
+static web_cache_slot_t *s_cache = NULL;
+static uint16_t s_entry_count = 0;
+static uint32_t s_bundle_version = 0;
+static size_t s_cache_used = 0;
+#endif
+
+static uint32_t fnv1a(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Check whether the client accepts gzip content encoding
+ */
+static bool accepts_gzip(httpd_req_t *req)
+{
+    char accept[96];
+    esp_err_t ret = httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept, sizeof(accept));
+    if (ret != ESP_OK && ret != ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return false;
+    }
+
+    const char *gzip = strstr(accept, "gzip");
+    if (!gzip) {
+        return false;
+    }
+
+    // "gzip;q=0" explicitly refuses it
+    const char *q = gzip + 4;
+    while (*q == ' ') q++;
+    if (*q != ';') {
+        return true;
+    }
+    q++;
+    while (*q == ' ') q++;
+    if (strncmp(q, "q=", 2) != 0) {
+        return true;
+    }
+    return strtod(q + 2, NULL) > 0;
+}
+
+/**
+ * @brief Request URI to table path: query dropped, directories to index.html
+ */
+static bool request_path(const char *uri, char *path, size_t path_size)
+{
+    size_t len = strcspn(uri, "?#");
+    if (len == 0 || len >= path_size) {
+        return false;
+    }
+    memcpy(path, uri, len);
+    path[len] = '\0';
+
+    if (path[len - 1] == '/') {
+        static const char index[] = "index.html";
+        if (len + sizeof(index) > path_size) {
+            return false;
+        }
+        memcpy(path + len, index, sizeof(index));
+    }
+    return true;
+}
+
+static int compare_builtin(const void *key, const void *item)
+{
+    return strcmp((const char *)key, ((const builtin_asset_t *)item)->path);
+}
+
+/**
+ * @brief Set the common headers; sends 304 and returns true on an ETag match
+ */
+static bool begin_response(httpd_req_t *req, uint8_t mime, uint8_t flags,
+                           uint32_t etag_hash, bool gzip, char *etag, size_t etag_size)
+{
+    // Each encoding is a different representation and gets its own tag
+    snprintf(etag, etag_size, gzip ? "\"%08lx-gz\"" : "\"%08lx\"", (unsigned long)etag_hash);
+
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control",
+                       (flags & WEB_FLAG_IMMUTABLE) ? CACHE_IMMUTABLE : CACHE_REVALIDATE);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match,
+                                    sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return true;
+    }
+
+    httpd_resp_set_type(req, MIME_TYPES[mime < WEB_MIME_COUNT ? mime : WEB_MIME_BINARY]);
+    if (gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+    return false;
+}
+
+static esp_err_t serve_builtin(httpd_req_t *req, builtin_asset_t *asset, bool gzip)
+{
+    if (asset->etag == 0) {
+        asset->etag = fnv1a(asset->data, asset->data_end - asset->data);
+    }
+
+    char etag[16];
+    if (begin_response(req, asset->mime, asset->flags, asset->etag, gzip, etag, sizeof(etag))) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "HTTP GET %s (%s)", req->uri, gzip ? "gzip" : "identity");
+    if (gzip) {
+        return httpd_resp_send(req, (const char *)asset->gz, asset->gz_end - asset->gz);
+    }
+    return httpd_resp_send(req, (const char *)asset->data, asset->data_end - asset->data);
+}
+
+#ifdef WEB_BUNDLE_SUPPORTED
+
+static int compare_entry(const void *key, const void *item)
+{
+    return strcmp((const char *)key, ((const web_bundle_entry_t *)item)->path);
+}
+
+static void unload_bundle(void)
+{
+    if (s_cache) {
+        for (uint16_t i = 0; i < s_entry_count; i++) {
+            free(s_cache[i].data[0]);
+            free(s_cache[i].data[1]);
+        }
+        free(s_cache);
+        s_cache = NULL;
+    }
+    free(s_entries);
+    s_entries = NULL;
+    s_entry_count = 0;
+    s_bundle_version = 0;
+    s_cache_used = 0;
+}
+
+/**
+ * @brief Check a manifest before trusting it for lookups and reads
+ */
+static bool validate_entries(const web_bundle_entry_t *entries, uint16_t count, long file_size)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        const web_bundle_entry_t *e = &entries[i];
+        if (e->path[0] != '/' || memchr(e->path, '\0', WEB_PATH_LEN) == NULL) {
+            return false;
+        }
+        // Sorted and unique, or the binary search misses entries
+        if (i > 0 && strcmp(entries[i - 1].path, e->path) >= 0) {
+            return false;
+        }
+        if ((uint64_t)e->offset + e->length > (uint64_t)file_size ||
+            (uint64_t)e->gz_offset + e->gz_length > (uint64_t)file_size ||
+            e->mime >= WEB_MIME_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copy a small bundle asset to RAM while the cache budget lasts
+ */
+static const uint8_t *cache_asset(FILE *f, web_cache_slot_t *slot, int variant,
+                                  uint32_t offset, uint32_t length)
+{
+    if (slot->data[variant]) {
+        return slot->data[variant];
+    }
+    if (length > WEB_CACHE_MAX_ASSET || s_cache_used + length > WEB_CACHE_BUDGET) {
+        return NULL;
+    }
+
+    uint8_t *data = malloc(length);
+    if (!data) {
+        return NULL;
+    }
+    if (fseek(f, offset, SEEK_SET) != 0 || fread(data, 1, length, f) != length) {
+        free(data);
+        return NULL;
+    }
+
+    slot->data[variant] = data;
+    s_cache_used += length;
+    return data;
+}
+
+/**
+ * @brief Stream an asset from the bundle file in chunks
+ */
+static esp_err_t stream_asset(httpd_req_t *req, FILE *f, uint32_t offset, uint32_t length)
+{
+    if (fseek(f, offset, SEEK_SET) != 0) {
+        return ESP_FAIL;
+    }
+
+    http_arena_t *arena = http_arena_begin(req);
+    char *chunk = arena ? http_arena_alloc(arena, HTTP_BUDGET_STATIC_READ) : NULL;
+    if (chunk == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    while (length > 0) {
+        size_t n = length < HTTP_BUDGET_STATIC_READ ? length : HTTP_BUDGET_STATIC_READ;
+        if (fread(chunk, 1, n, f) != n) {
+            ESP_LOGE(TAG, "Short read from %s", WEB_BUNDLE_PATH);
+            return ESP_FAIL;
+        }
+        if (httpd_resp_send_chunk(req, chunk, n) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        length -= n;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t serve_bundle_entry(httpd_req_t *req, const web_bundle_entry_t *entry, bool gzip)
+{
+    gzip = gzip && entry->gz_length > 0;
+    int variant = gzip ? 1 : 0;
+    uint32_t offset = gzip ? entry->gz_offset : entry->offset;
+    uint32_t length = gzip ? entry->gz_length : entry->length;
+    web_cache_slot_t *slot = &s_cache[entry - s_entries];
+
+    char etag[16];
+    if (begin_response(req, entry->mime, entry->flags, entry->etag, gzip, etag, sizeof(etag))) {
+        return ESP_OK;
+    }
+
+    if (slot->data[variant]) {
+        return httpd_resp_send(req, (const char *)slot->data[variant], length);
+    }
+
+    FILE *f = fopen(WEB_BUNDLE_PATH, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "Web bundle disappeared: %s", WEB_BUNDLE_PATH);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Web bundle not available");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "HTTP GET %s (bundle, %s)", req->uri, gzip ? "gzip" : "identity");
+    esp_err_t ret;
+    const uint8_t *cached = cache_asset(f, slot, variant, offset, length);
+    if (cached) {
+        ret = httpd_resp_send(req, (const char *)cached, length);
+    } else {
+        ret = stream_asset(req, f, offset, length);
+    }
+    fclose(f);
+    return ret;
+}
+
+#endif // WEB_BUNDLE_SUPPORTED
+
+esp_err_t web_assets_load(void)
+{
+#ifdef WEB_BUNDLE_SUPPORTED
+    unload_bundle();
+
+    if (!sdcard_is_mounted()) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    FILE *f = fopen(WEB_BUNDLE_PATH, "rb");
+    if (!f) {
+        ESP_LOGI(TAG, "No web bundle at %s, serving embedded pages", WEB_BUNDLE_PATH);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_OK;
+    web_bundle_header_t header;
+    long file_size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        file_size = ftell(f);
+    }
+
+    if (file_size < (long)sizeof(header) || fseek(f, 0, SEEK_SET) != 0 ||
+        fread(&header, 1, sizeof(header), f) != sizeof(header)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (header.magic != WEB_BUNDLE_MAGIC || header.format != WEB_BUNDLE_FORMAT) {
+        ret = ESP_ERR_INVALID_VERSION;
+    } else if (header.count == 0 || header.count > WEB_BUNDLE_MAX_ENTRIES) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+
+    if (ret == ESP_OK) {
+        size_t manifest_size = header.count * sizeof(web_bundle_entry_t);
+        s_entries = malloc(manifest_size);
+        s_cache = calloc(header.count, sizeof(web_cache_slot_t));
+        if (!s_entries || !s_cache) {
+            ret = ESP_ERR_NO_MEM;
+        } else if (fread(s_entries, 1, manifest_size, f) != manifest_size ||
+                   !validate_entries(s_entries, header.count, file_size)) {
+            ret = ESP_ERR_INVALID_SIZE;
+        }
+    }
+    fclose(f);
+
+    if (ret != ESP_OK) {
+        free(s_entries);
+        free(s_cache);
+        s_entries = NULL;
+        s_cache = NULL;
+        ESP_LOGW(TAG, "Ignoring web bundle %s: %s", WEB_BUNDLE_PATH, esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_entry_count = header.count;
+    s_bundle_version = header.version;
+    ESP_LOGI(TAG, "Web bundle v%lu loaded: %u assets", (unsigned long)s_bundle_version, s_entry_count);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_FOUND;
+#endif
+}
+
+uint32_t web_assets_get_version(void)
+{
+#ifdef WEB_BUNDLE_SUPPORTED
+    return s_bundle_version;
+#else
+    return 0;
+#endif
+}
+
+esp_err_t web_assets_http_handler(httpd_req_t *req)
+{
+    char path[WEB_PATH_LEN];
+    if (request_path(req->uri, path, sizeof(path))) {
+        bool gzip = accepts_gzip(req);
+
+#ifdef WEB_BUNDLE_SUPPORTED
+        if (s_entry_count > 0) {
+            const web_bundle_entry_t *entry = bsearch(path, s_entries, s_entry_count,
+                                                      sizeof(web_bundle_entry_t), compare_entry);
+            if (entry) {
+                return serve_bundle_entry(req, entry, gzip);
+            }
+        }
+#endif
+
+        builtin_asset_t *asset = bsearch(path, s_builtin, BUILTIN_COUNT,
+                                         sizeof(builtin_asset_t), compare_builtin);
+        if (asset) {
+            return serve_builtin(req, asset, gzip);
+        }
+    }
+
+    // Unknown path: send to the landing page (captive portal)
+    httpd_resp_set_status(req, "302 Found");
+    httpd_resp_set_hdr(req, "Location", CAPTIVE_PORTAL_URL);
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
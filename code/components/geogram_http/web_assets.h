@@ -0,0 +1,108 @@
+/**
+ * @file web_assets.h
+ * @brief Static web UI assets served from a sorted route table
+ *
+ * Assets come from two tables, both sorted by path and searched with a
+ * binary search:
+ * - a web bundle on the SD card (/sdcard/www/bundle.bin), built on a PC with
+ *   scripts/pack_www.py, so the UI can be updated without reflashing
+ * - the pages embedded in the firmware (components/geogram_http/www/),
+ *   used for any path the bundle does not provide
+ *
+ * Bundle layout (little endian):
+ *
+ *     web_bundle_header_t
+ *     web_bundle_entry_t[count]    sorted by path (byte order)
+ *     asset data                   at the offsets given by the entries
+ *
+ * Small assets are kept in RAM after their first request.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEB_BUNDLE_PATH         "/sdcard/www/bundle.bin"
+#define WEB_BUNDLE_MAGIC        0x57575747      // "GWWW"
+#define WEB_BUNDLE_FORMAT       1
+#define WEB_BUNDLE_MAX_ENTRIES  128
+#define WEB_PATH_LEN            40              // Including NUL
+
+// Entry flags
+#define WEB_FLAG_IMMUTABLE      0x01            // Path is versioned, cache for a year
+
+// Content types (web_bundle_entry_t.mime)
+typedef enum {
+    WEB_MIME_BINARY = 0,
+    WEB_MIME_HTML,
+    WEB_MIME_JS,
+    WEB_MIME_CSS,
+    WEB_MIME_JSON,
+    WEB_MIME_PNG,
+    WEB_MIME_JPEG,
+    WEB_MIME_SVG,
+    WEB_MIME_ICO,
+    WEB_MIME_WOFF2,
+    WEB_MIME_TEXT,
+    WEB_MIME_COUNT
+} web_mime_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // WEB_BUNDLE_MAGIC
+    uint16_t format;            // WEB_BUNDLE_FORMAT
+    uint16_t count;             // Number of entries
+    uint32_t version;           // Bundle version, chosen when packing
+    uint32_t reserved;
+} web_bundle_header_t;
+
+typedef struct __attribute__((packed)) {
+    char path[WEB_PATH_LEN];    // URI path, NUL padded ("/index.html")
+    uint32_t offset;            // Uncompressed copy
+    uint32_t length;
+    uint32_t gz_offset;         // gzip copy, gz_length 0 if not compressed
+    uint32_t gz_length;
+    uint32_t etag;              // FNV-1a of the uncompressed copy
+    uint8_t mime;               // web_mime_t
+    uint8_t flags;              // WEB_FLAG_*
+    uint16_t reserved;
+} web_bundle_entry_t;
+
+/**
+ * @brief Load the SD card bundle manifest, if there is one
+ *
+ * Safe to call again after a new bundle was copied to the card; the
+ * previous manifest and cached assets are dropped.
+ *
+ * @return ESP_OK if a bundle was loaded, ESP_ERR_NOT_FOUND if there is none
+ *         (embedded pages are still served)
+ */
+esp_err_t web_assets_load(void);
+
+/**
+ * @brief Version of the loaded bundle, 0 if only embedded pages are served
+ */
+uint32_t web_assets_get_version(void);
+
+/**
+ * @brief HTTP handler serving any static path
+ *
+ * Called for GET requests no URI handler matched (from the 404 error
+ * handler), so other methods on unknown paths still get the redirect.
+ * Paths ending in '/' serve index.html. Unknown paths redirect to the
+ * landing page, as the captive portal expects.
+ */
+esp_err_t web_assets_http_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_ASSETS_H
@@ -3,7 +3,9 @@
  * @brief Async HTTP client implementation
  */
 
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include "http_client_async.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
@@ -22,6 +24,9 @@ static const char *TAG = "http_async";
 // Default user agent
 #define DEFAULT_USER_AGENT      "ESP32-HTTP/1.0"
 
+// Redirects followed per request (GitHub release assets answer with one)
+#define MAX_REDIRECTS           5
+
 /**
  * @brief Internal request context passed to task
  */
@@ -32,6 +37,58 @@ typedef struct {
     SemaphoreHandle_t done_sem;
 } http_task_ctx_t;
 
+/**
+ * @brief Keep the validators of the response for the next conditional request
+ */
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    if (evt->event_id != HTTP_EVENT_ON_HEADER || evt->user_data == NULL) {
+        return ESP_OK;
+    }
+
+    http_client_response_t *resp = (http_client_response_t *)evt->user_data;
+    if (strcasecmp(evt->header_key, "ETag") == 0) {
+        strlcpy(resp->etag, evt->header_value, sizeof(resp->etag));
+    } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+        strlcpy(resp->last_modified, evt->header_value, sizeof(resp->last_modified));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Read the body piece by piece into the response buffer
+ *
+ * @return ESP_ERR_NOT_FINISHED if the caller stopped the stream, or the
+ *         connection ended before the announced length or last chunk
+ */
+static esp_err_t stream_body(esp_http_client_handle_t client, const http_client_request_t *request,
+                             http_client_response_t *resp)
+{
+    while (true) {
+        int read_len = esp_http_client_read(client, (char *)resp->data, resp->buffer_size);
+        if (read_len < 0) {
+            ESP_LOGE(TAG, "Failed to read HTTP response");
+            return ESP_FAIL;
+        }
+        if (read_len == 0) {
+            // A body without length or chunking ends with the connection
+            bool framed = esp_http_client_is_chunked_response(client) ||
+                          esp_http_client_get_content_length(client) >= 0;
+            if (framed && !esp_http_client_is_complete_data_received(client)) {
+                ESP_LOGW(TAG, "Response ended early after %zu bytes", resp->data_len);
+                return ESP_ERR_NOT_FINISHED;
+            }
+            return ESP_OK;
+        }
+
+        resp->data_len += (size_t)read_len;
+        if (!request->on_data(resp->data, (size_t)read_len, request->on_data_ctx)) {
+            ESP_LOGD(TAG, "Stream stopped by caller after %zu bytes", resp->data_len);
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+}
+
 /**
  * @brief Perform the actual HTTP request (runs in dedicated task)
  */
@@ -43,6 +100,8 @@ static void http_request_task(void *arg)
     // Initialize response
     resp->status_code = 0;
     resp->data_len = 0;
+    resp->etag[0] = '\0';
+    resp->last_modified[0] = '\0';
 
     // Configure HTTP client - use insecure mode for tile downloads
     // Certificate verification is skipped as tiles are not sensitive data
@@ -53,6 +112,8 @@ static void http_request_task(void *arg)
         .cert_pem = NULL,
         .skip_cert_common_name_check = true,
         .use_global_ca_store = false,
+        .event_handler = http_event_handler,
+        .user_data = resp,
     };
 
     ESP_LOGI(TAG, "HTTP GET: %s", config.url);
@@ -64,22 +125,69 @@ static void http_request_task(void *arg)
         goto done;
     }
 
-    ESP_LOGI(TAG, "Opening HTTP connection...");
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
+    if (ctx->request.if_none_match && ctx->request.if_none_match[0]) {
+        esp_http_client_set_header(client, "If-None-Match", ctx->request.if_none_match);
+    }
+    if (ctx->request.if_modified_since && ctx->request.if_modified_since[0]) {
+        esp_http_client_set_header(client, "If-Modified-Since", ctx->request.if_modified_since);
+    }
+    if (ctx->request.range_start > 0) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%zu-", ctx->request.range_start);
+        esp_http_client_set_header(client, "Range", range);
+    }
+
+    int content_length = 0;
+    for (int redirects = 0; ; redirects++) {
+        ESP_LOGI(TAG, "Opening HTTP connection...");
+        esp_err_t err = esp_http_client_open(client, 0);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
+            esp_http_client_cleanup(client);
+            ctx->result = err;
+            goto done;
+        }
+        ESP_LOGI(TAG, "HTTP connection opened");
+
+        content_length = esp_http_client_fetch_headers(client);
+        resp->status_code = esp_http_client_get_status_code(client);
+
+        ESP_LOGD(TAG, "HTTP status: %d, content-length: %d", resp->status_code, content_length);
+
+        bool redirect = resp->status_code == 301 || resp->status_code == 302 ||
+                        resp->status_code == 303 || resp->status_code == 307 ||
+                        resp->status_code == 308;
+        if (!redirect || redirects >= MAX_REDIRECTS) {
+            break;
+        }
+
+        // Follow Location; the request headers above are kept
+        esp_http_client_set_redirection(client);
+        esp_http_client_close(client);
+        resp->etag[0] = '\0';
+        resp->last_modified[0] = '\0';
+        ESP_LOGD(TAG, "Redirected (%d)", resp->status_code);
+    }
+
+    if (resp->status_code == 304) {
+        ESP_LOGI(TAG, "Not modified: %s", config.url);
+        esp_http_client_close(client);
         esp_http_client_cleanup(client);
-        ctx->result = err;
+        ctx->result = ESP_OK;
         goto done;
     }
-    ESP_LOGI(TAG, "HTTP connection opened");
-
-    int content_length = esp_http_client_fetch_headers(client);
-    resp->status_code = esp_http_client_get_status_code(client);
 
-    ESP_LOGD(TAG, "HTTP status: %d, content-length: %d", resp->status_code, content_length);
+    // A server that ignores Range sends the whole body, which the caller
+    // would append to the part it already has
+    if (ctx->request.range_start > 0 && resp->status_code == 200) {
+        ESP_LOGW(TAG, "Range not supported by %s", config.url);
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        ctx->result = ESP_ERR_INVALID_RESPONSE;
+        goto done;
+    }
 
-    if (resp->status_code != 200) {
+    if (resp->status_code != 200 && !(resp->status_code == 206 && ctx->request.range_start > 0)) {
         ESP_LOGW(TAG, "HTTP error %d for %s", resp->status_code, config.url);
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
@@ -87,6 +195,13 @@ static void http_request_task(void *arg)
         goto done;
     }
 
+    if (ctx->request.on_data) {
+        ctx->result = stream_body(client, &ctx->request, resp);
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        goto done;
+    }
+
     // Check if response fits in buffer
     if (content_length > 0 && (size_t)content_length > resp->buffer_size) {
         ESP_LOGE(TAG, "Response too large: %d bytes (buffer: %zu)", content_length, resp->buffer_size);
@@ -160,12 +275,14 @@ esp_err_t http_client_get_async(const http_client_request_t *request, http_clien
         return ESP_ERR_NO_MEM;
     }
 
-    // Calculate wait timeout
+    // Calculate wait timeout; a streamed body may take any time, its reads
+    // are still bounded by timeout_ms
     int timeout_ms = request->timeout_ms > 0 ? request->timeout_ms : DEFAULT_TIMEOUT_MS;
     timeout_ms += 5000;  // Extra margin for task overhead
+    TickType_t wait = request->on_data ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
 
     // Wait for completion
-    if (xSemaphoreTake(ctx.done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    if (xSemaphoreTake(ctx.done_sem, wait) != pdTRUE) {
         ESP_LOGE(TAG, "HTTP request timed out");
         vSemaphoreDelete(ctx.done_sem);
         return ESP_ERR_TIMEOUT;
@@ -17,6 +17,19 @@
 extern "C" {
 #endif
 
+#define HTTP_CLIENT_ETAG_LEN            72  /**< Longest ETag kept, including NUL */
+#define HTTP_CLIENT_LAST_MODIFIED_LEN   32  /**< Fits an RFC 7231 date, including NUL */
+
+/**
+ * @brief Body callback for streamed responses
+ *
+ * @param data Next piece of the body
+ * @param len Length of the piece
+ * @param ctx Request on_data_ctx
+ * @return false to stop reading; the request then fails with ESP_ERR_NOT_FINISHED
+ */
+typedef bool (*http_client_data_cb_t)(const uint8_t *data, size_t len, void *ctx);
+
 /**
  * @brief HTTP request configuration
  */
@@ -25,16 +38,27 @@ typedef struct {
     const char *user_agent;     /**< User agent string (optional, defaults to "ESP32-HTTP/1.0") */
     int timeout_ms;             /**< Request timeout in ms (optional, defaults to 15000) */
     bool skip_cert_verify;      /**< Skip TLS certificate verification (default: true for simplicity) */
+    const char *if_none_match;  /**< ETag of the cached copy (optional); 304 if unchanged */
+    const char *if_modified_since; /**< Last-Modified of the cached copy (optional) */
+    size_t range_start;         /**< Resume offset (optional); the answer must be 206 */
+    http_client_data_cb_t on_data; /**< Stream the body through the response buffer (optional, no overall timeout) */
+    void *on_data_ctx;          /**< Context passed to on_data */
 } http_client_request_t;
 
 /**
  * @brief HTTP response structure
+ *
+ * A 304 Not Modified answer to a conditional request succeeds with no data.
+ * Redirects are followed. With range_start set, a 200 (Range ignored) fails
+ * with ESP_ERR_INVALID_RESPONSE.
  */
 typedef struct {
-    int status_code;            /**< HTTP status code (e.g., 200, 404, 500) */
+    int status_code;            /**< HTTP status code (e.g., 200, 206, 304, 404, 416, 500) */
     uint8_t *data;              /**< Response data (caller must provide buffer) */
-    size_t data_len;            /**< Actual length of response data */
-    size_t buffer_size;         /**< Size of provided buffer */
+    size_t data_len;            /**< Actual length of response data (total streamed with on_data) */
+    size_t buffer_size;         /**< Size of provided buffer (piece size with on_data) */
+    char etag[HTTP_CLIENT_ETAG_LEN];                    /**< ETag header, "" if none */
+    char last_modified[HTTP_CLIENT_LAST_MODIFIED_LEN];  /**< Last-Modified header, "" if none */
 } http_client_response_t;
 
 /**
@@ -46,7 +70,8 @@ typedef struct {
  *
  * @param request Request configuration
  * @param response Response buffer (caller provides data buffer)
- * @return ESP_OK on success, ESP_FAIL on HTTP error, ESP_ERR_TIMEOUT on timeout
+ * @return ESP_OK on success, ESP_FAIL on HTTP error, ESP_ERR_TIMEOUT on timeout,
+ *         ESP_ERR_NOT_FINISHED if a streamed body was stopped or cut short
  */
 esp_err_t http_client_get_async(const http_client_request_t *request, http_client_response_t *response);
 
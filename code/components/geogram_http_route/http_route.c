@@ -0,0 +1,288 @@
+/**
+ * @file http_route.c
+ * @brief Per-route request metrics for the HTTP server
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http_route.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "geogram_metrics.h"
+
+static const char *TAG = "http_route";
+
+#define HTTP_ROUTE_LABELS_LEN   (HTTP_ROUTE_URI_LEN + 32)   // route="...",method="OPTIONS"
+
+typedef enum {
+    ROUTE_CLASS_1XX = 0,
+    ROUTE_CLASS_2XX,
+    ROUTE_CLASS_3XX,
+    ROUTE_CLASS_4XX,
+    ROUTE_CLASS_5XX,
+    ROUTE_CLASS_NONE,
+    ROUTE_CLASS_COUNT,
+} route_class_t;
+
+static const char *const k_class_labels[ROUTE_CLASS_COUNT] = {
+    "code=\"1xx\"", "code=\"2xx\"", "code=\"3xx\"", "code=\"4xx\"", "code=\"5xx\"", "code=\"none\"",
+};
+
+typedef struct http_route {
+    char uri[HTTP_ROUTE_URI_LEN];
+    int method;
+    esp_err_t (*handler)(httpd_req_t *req);
+    void *user_ctx;
+    char labels[HTTP_ROUTE_LABELS_LEN];
+    geogram_metric_t requests[ROUTE_CLASS_COUNT];
+    geogram_metric_t errors;
+    geogram_metric_t bytes_in;
+    geogram_metric_t bytes_out;
+    geogram_histogram_t duration;
+    struct http_route *next;
+} http_route_t;
+
+/**
+ * @brief Request being handled, filled by the send hook
+ */
+typedef struct {
+    TaskHandle_t task;
+    int sockfd;
+    bool sent;                  // Something was sent; the first send carries the status line
+    route_class_t status;
+    uint32_t bytes_out;
+} route_request_t;
+
+static http_route_t *s_routes = NULL;
+static route_request_t *volatile s_active = NULL;   // Only the server task sets it
+static bool s_configured = false;                   // Hooks installed by the last configure
+
+static geogram_metric_t s_open_sockets = GEOGRAM_METRIC_GAUGE_INIT(
+    "geogram_http_open_sockets", "HTTP server sockets currently open");
+static geogram_metric_t s_max_sockets = GEOGRAM_METRIC_GAUGE_INIT(
+    "geogram_http_max_open_sockets", "HTTP server socket limit (max_open_sockets)");
+
+// ============================================================================
+// Session hooks
+// ============================================================================
+
+/**
+ * @brief Status class from the start of a response ("HTTP/1.1 404 ...")
+ */
+static route_class_t status_class(const char *buf, size_t len)
+{
+    if (len < 10 || memcmp(buf, "HTTP/1.", 7) != 0 || buf[8] != ' ') {
+        return ROUTE_CLASS_NONE;
+    }
+    if (buf[9] < '1' || buf[9] > '5') {
+        return ROUTE_CLASS_NONE;
+    }
+    return (route_class_t)(ROUTE_CLASS_1XX + (buf[9] - '1'));
+}
+
+/**
+ * @brief Session send function: httpd_default_send() plus accounting
+ */
+static int route_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    (void)hd;
+    if (buf == NULL) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0) {
+        // Same mapping as httpd_default_send, so httpd retries or closes as before
+        switch (errno) {
+            case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+            case EWOULDBLOCK:
+#endif
+            case ETIMEDOUT:
+            case EINTR:
+                return HTTPD_SOCK_ERR_TIMEOUT;
+            case EINVAL:
+            case EBADF:
+            case EFAULT:
+            case ENOTSOCK:
+                return HTTPD_SOCK_ERR_INVALID;
+            default:
+                return HTTPD_SOCK_ERR_FAIL;
+        }
+    }
+
+    // Only sends by the handler itself belong to the request; other tasks
+    // (WebSocket broadcasts) share the sessions
+    route_request_t *active = s_active;
+    if (active != NULL && active->task == xTaskGetCurrentTaskHandle() && active->sockfd == sockfd) {
+        if (!active->sent) {
+            active->sent = true;
+            active->status = status_class(buf, buf_len);
+        }
+        active->bytes_out += (uint32_t)ret;
+    }
+    return ret;
+}
+
+static esp_err_t route_open(httpd_handle_t hd, int sockfd)
+{
+    geogram_metric_add(&s_open_sockets, 1);
+    return httpd_sess_set_send_override(hd, sockfd, route_send);
+}
+
+/**
+ * @brief Session close; with a close_fn set the server leaves closing to it
+ */
+static void route_close(httpd_handle_t hd, int sockfd)
+{
+    (void)hd;
+    geogram_metric_add(&s_open_sockets, (uint32_t)-1);
+    close(sockfd);
+}
+
+esp_err_t http_route_configure(httpd_config_t *config)
+{
+    s_configured = false;
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->open_fn != NULL || config->close_fn != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    config->open_fn = route_open;
+    config->close_fn = route_close;
+
+    geogram_metric_set(&s_open_sockets, 0);
+    geogram_metric_set(&s_max_sockets, (int32_t)config->max_open_sockets);
+    geogram_metrics_register(&s_open_sockets);
+    geogram_metrics_register(&s_max_sockets);
+    s_configured = true;
+    return ESP_OK;
+}
+
+// ============================================================================
+// Route wrapper
+// ============================================================================
+
+static esp_err_t route_handler(httpd_req_t *req)
+{
+    http_route_t *route = (http_route_t *)req->user_ctx;
+
+    route_request_t request = {
+        .task = xTaskGetCurrentTaskHandle(),
+        .sockfd = httpd_req_to_sockfd(req),
+        .sent = false,
+        .status = ROUTE_CLASS_NONE,
+        .bytes_out = 0,
+    };
+
+    req->user_ctx = route->user_ctx;
+    s_active = &request;
+    int64_t start = esp_timer_get_time();
+
+    esp_err_t ret = route->handler(req);
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    s_active = NULL;
+    req->user_ctx = route;
+
+    geogram_metric_inc(&route->requests[request.status]);
+    if (ret != ESP_OK) {
+        geogram_metric_inc(&route->errors);
+    }
+    geogram_metric_add(&route->bytes_in, (uint32_t)req->content_len);
+    geogram_metric_add(&route->bytes_out, request.bytes_out);
+    geogram_histogram_observe(&route->duration, elapsed);
+    return ret;
+}
+
+static const char *method_name(int method)
+{
+    return method < 0 ? "ANY" : http_method_str((enum http_method)method);
+}
+
+static http_route_t *route_find(const char *uri, int method)
+{
+    for (http_route_t *route = s_routes; route != NULL; route = route->next) {
+        if (route->method == method && strncmp(route->uri, uri, sizeof(route->uri) - 1) == 0) {
+            return route;
+        }
+    }
+    return NULL;
+}
+
+static http_route_t *route_create(const char *uri, int method)
+{
+    http_route_t *route = calloc(1, sizeof(*route));
+    if (route == NULL) {
+        return NULL;
+    }
+
+    strlcpy(route->uri, uri, sizeof(route->uri));
+    route->method = method;
+    snprintf(route->labels, sizeof(route->labels), "route=\"%s\",method=\"%s\"",
+             route->uri, method_name(method));
+
+    for (size_t i = 0; i < ROUTE_CLASS_COUNT; i++) {
+        route->requests[i] = (geogram_metric_t)GEOGRAM_METRIC_COUNTER_INIT(
+            "geogram_http_requests_total", "HTTP requests handled, by route and status class");
+        route->requests[i].labels = route->labels;
+        route->requests[i].labels2 = k_class_labels[i];
+    }
+    route->errors = (geogram_metric_t)GEOGRAM_METRIC_COUNTER_INIT(
+        "geogram_http_handler_errors_total", "HTTP handlers that returned an error");
+    route->bytes_in = (geogram_metric_t)GEOGRAM_METRIC_COUNTER_INIT(
+        "geogram_http_request_bytes_total", "HTTP request body bytes (Content-Length)");
+    route->bytes_out = (geogram_metric_t)GEOGRAM_METRIC_COUNTER_INIT(
+        "geogram_http_response_bytes_total", "HTTP response bytes sent, headers included");
+    route->duration = (geogram_histogram_t)GEOGRAM_HISTOGRAM_LABELED_INIT(
+        "geogram_http_request_duration_seconds", "HTTP handler time", route->labels);
+    route->errors.labels = route->labels;
+    route->bytes_in.labels = route->labels;
+    route->bytes_out.labels = route->labels;
+
+    geogram_metrics_register_all(route->requests, ROUTE_CLASS_COUNT);
+    geogram_metrics_register(&route->errors);
+    geogram_metrics_register(&route->bytes_in);
+    geogram_metrics_register(&route->bytes_out);
+    geogram_metrics_register_histogram(&route->duration);
+
+    route->next = s_routes;
+    s_routes = route;
+    return route;
+}
+
+esp_err_t http_route_register(httpd_handle_t server, const httpd_uri_t *uri)
+{
+    if (server == NULL || uri == NULL || uri->uri == NULL || uri->handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_configured) {
+        return httpd_register_uri_handler(server, uri);
+    }
+
+    int method = (int)uri->method;
+    http_route_t *route = route_find(uri->uri, method);
+    if (route == NULL) {
+        route = route_create(uri->uri, method);
+        if (route == NULL) {
+            ESP_LOGE(TAG, "No memory for route %s", uri->uri);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    route->handler = uri->handler;
+    route->user_ctx = uri->user_ctx;
+
+    // The server copies the descriptor, so a stack copy pointing at the wrapper will do
+    httpd_uri_t wrapped = *uri;
+    wrapped.handler = route_handler;
+    wrapped.user_ctx = route;
+    return httpd_register_uri_handler(server, &wrapped);
+}
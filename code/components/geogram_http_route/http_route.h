@@ -0,0 +1,62 @@
+/**
+ * @file http_route.h
+ * @brief Per-route request metrics for the HTTP server
+ *
+ * URI handlers are registered through http_route_register() instead of
+ * httpd_register_uri_handler(). The handler is then called through a
+ * wrapper that records, per route (URI template and method):
+ *
+ *     geogram_http_requests_total{code="2xx"}      by status class
+ *     geogram_http_handler_errors_total            handler returned an error
+ *     geogram_http_request_bytes_total             request bodies (Content-Length)
+ *     geogram_http_response_bytes_total            headers and body sent
+ *     geogram_http_request_duration_seconds        handler time, histogram
+ *
+ * The status class and response bytes come from a send hook installed on
+ * every session by http_route_configure(), which also keeps the open
+ * socket count next to the configured max_open_sockets. Requests with no
+ * HTTP response (WebSocket frames, handlers failing before they answer)
+ * count as code="none". Requests that match no route are not counted.
+ *
+ * Metrics of a route survive server restarts: registering the same URI
+ * and method again reuses them.
+ */
+
+#ifndef GEOGRAM_HTTP_ROUTE_H
+#define GEOGRAM_HTTP_ROUTE_H
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_ROUTE_URI_LEN      40      ///< Longest URI kept for the route label
+
+/**
+ * @brief Install the session hooks into a server configuration
+ *
+ * Call before httpd_start(). Sets open_fn and close_fn, which must still
+ * be NULL. Only one server can be instrumented. Until a call succeeds,
+ * http_route_register() registers handlers as they are, without metrics.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if open_fn/close_fn are taken
+ */
+esp_err_t http_route_configure(httpd_config_t *config);
+
+/**
+ * @brief Register a URI handler with request metrics
+ *
+ * Same contract as httpd_register_uri_handler(); the handler sees its own
+ * user_ctx. Call from the task that starts the server.
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM, or the httpd_register_uri_handler() error
+ */
+esp_err_t http_route_register(httpd_handle_t server, const httpd_uri_t *uri);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_HTTP_ROUTE_H
@@ -0,0 +1,339 @@
+#include "json_scanner.h"
+#include <string.h>
+
+enum {
+    ST_VALUE,           // Expecting a value
+    ST_FIRST_ELEMENT,   // After '[': a value or ']'
+    ST_FIRST_KEY,       // After '{': a key or '}'
+    ST_KEY,             // After ',' in an object: a key
+    ST_COLON,
+    ST_NEXT,            // After a value: ',' or the closing bracket
+    ST_STRING,
+    ST_ESCAPE,
+    ST_UNICODE,
+    ST_PRIMITIVE,
+    ST_DONE,
+    ST_STOPPED,
+    ST_ERROR,
+};
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool in_object(const geo_json_scanner_t *s) {
+    return s->depth > 0 && (s->objects & (1u << (s->depth - 1)));
+}
+
+static void append(geo_json_scanner_t *s, char c) {
+    if (s->value_len < sizeof(s->value) - 1) {
+        s->value[s->value_len++] = c;
+    } else {
+        s->truncated = true;
+    }
+}
+
+static void append_utf8(geo_json_scanner_t *s, uint32_t cp) {
+    if (cp < 0x80) {
+        append(s, (char)cp);
+    } else if (cp < 0x800) {
+        append(s, (char)(0xC0 | (cp >> 6)));
+        append(s, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        append(s, (char)(0xE0 | (cp >> 12)));
+        append(s, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        append(s, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        append(s, (char)(0xF0 | (cp >> 18)));
+        append(s, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        append(s, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        append(s, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+// A high surrogate not followed by a low one is replaced by U+FFFD
+static void flush_surrogate(geo_json_scanner_t *s) {
+    if (s->high_surrogate) {
+        append_utf8(s, 0xFFFD);
+        s->high_surrogate = 0;
+    }
+}
+
+static void add_codepoint(geo_json_scanner_t *s, uint32_t cp) {
+    if (cp >= 0xDC00 && cp <= 0xDFFF && s->high_surrogate) {
+        cp = 0x10000 + ((s->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        s->high_surrogate = 0;
+    } else {
+        flush_surrogate(s);
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            s->high_surrogate = cp;
+            return;
+        }
+        if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+    }
+    append_utf8(s, cp);
+}
+
+static int emit(geo_json_scanner_t *s, geo_json_scan_event_t event, geo_json_type_t type) {
+    if (event != GEO_JSON_SCAN_VALUE) {
+        s->value_len = 0;
+        s->truncated = false;
+    }
+    s->value[s->value_len] = '\0';
+    if (!s->callback(s, event, type, s->value, s->value_len, s->ctx)) {
+        s->state = ST_STOPPED;
+        return GEO_JSON_SCAN_STOPPED;
+    }
+    return 0;
+}
+
+static void set_key(geo_json_scanner_t *s, const char *key, size_t len) {
+    if (s->depth > GEO_JSON_SCAN_KEY_DEPTH) {
+        return;
+    }
+    char *slot = s->keys[s->depth - 1];
+    if (len >= GEO_JSON_SCAN_KEY_LEN) {
+        len = GEO_JSON_SCAN_KEY_LEN - 1;
+    }
+    memcpy(slot, key, len);
+    slot[len] = '\0';
+}
+
+static int open_container(geo_json_scanner_t *s, bool object) {
+    if (s->depth >= GEO_JSON_SCAN_MAX_DEPTH) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+    int ret = emit(s, GEO_JSON_SCAN_BEGIN, object ? GEO_JSON_OBJECT : GEO_JSON_ARRAY);
+    if (ret != 0) {
+        return ret;
+    }
+    if (object) {
+        s->objects |= 1u << s->depth;
+    } else {
+        s->objects &= ~(1u << s->depth);
+    }
+    s->depth++;
+    set_key(s, "", 0);
+    s->state = object ? ST_FIRST_KEY : ST_FIRST_ELEMENT;
+    return 0;
+}
+
+static int close_container(geo_json_scanner_t *s, char c) {
+    bool object = in_object(s);
+    if (s->depth == 0 || (c == '}') != object) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+    s->depth--;
+    s->state = s->depth == 0 ? ST_DONE : ST_NEXT;
+    return emit(s, GEO_JSON_SCAN_END, object ? GEO_JSON_OBJECT : GEO_JSON_ARRAY);
+}
+
+static int end_value(geo_json_scanner_t *s, geo_json_type_t type) {
+    if (s->in_key) {
+        set_key(s, s->value, s->value_len);
+        s->state = ST_COLON;
+        return 0;
+    }
+    s->state = s->depth == 0 ? ST_DONE : ST_NEXT;
+    return emit(s, GEO_JSON_SCAN_VALUE, type);
+}
+
+static void begin_string(geo_json_scanner_t *s, bool key) {
+    s->in_key = key;
+    s->value_len = 0;
+    s->truncated = false;
+    s->high_surrogate = 0;
+    s->state = ST_STRING;
+}
+
+static int begin_value(geo_json_scanner_t *s, char c) {
+    if (c == '{' || c == '[') {
+        return open_container(s, c == '{');
+    }
+    if (c == '"') {
+        begin_string(s, false);
+        return 0;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        s->in_key = false;
+        s->value_len = 0;
+        s->truncated = false;
+        append(s, c);
+        s->state = ST_PRIMITIVE;
+        return 0;
+    }
+    return GEO_JSON_ERROR_INVAL;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Process one character; returns 0 or a feed() result
+static int step(geo_json_scanner_t *s, char c) {
+    switch (s->state) {
+    case ST_STRING:
+        if (c == '"') {
+            flush_surrogate(s);
+            return end_value(s, GEO_JSON_STRING);
+        }
+        if (c == '\\') {
+            s->state = ST_ESCAPE;
+            return 0;
+        }
+        if ((unsigned char)c < 0x20) {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        flush_surrogate(s);
+        append(s, c);
+        return 0;
+
+    case ST_ESCAPE: {
+        s->state = ST_STRING;
+        char out;
+        switch (c) {
+        case '"': case '\\': case '/': out = c; break;
+        case 'b': out = '\b'; break;
+        case 'f': out = '\f'; break;
+        case 'n': out = '\n'; break;
+        case 'r': out = '\r'; break;
+        case 't': out = '\t'; break;
+        case 'u':
+            s->codepoint = 0;
+            s->hex_left = 4;
+            s->state = ST_UNICODE;
+            return 0;
+        default:
+            return GEO_JSON_ERROR_INVAL;
+        }
+        flush_surrogate(s);
+        append(s, out);
+        return 0;
+    }
+
+    case ST_UNICODE: {
+        int v = hex_value(c);
+        if (v < 0) {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        s->codepoint = (s->codepoint << 4) | (uint32_t)v;
+        if (--s->hex_left == 0) {
+            add_codepoint(s, s->codepoint);
+            s->state = ST_STRING;
+        }
+        return 0;
+    }
+
+    case ST_PRIMITIVE:
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+            c == '.' || c == '-' || c == '+' || c == 'E') {
+            append(s, c);
+            return 0;
+        }
+        if (c != ',' && c != '}' && c != ']' && !is_space(c)) {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        {
+            int ret = end_value(s, GEO_JSON_PRIMITIVE);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        // The delimiter belongs to the enclosing container
+        return step(s, c);
+
+    default:
+        break;
+    }
+
+    if (is_space(c)) {
+        return 0;
+    }
+
+    switch (s->state) {
+    case ST_VALUE:
+        return begin_value(s, c);
+
+    case ST_FIRST_ELEMENT:
+        if (c == ']') {
+            return close_container(s, c);
+        }
+        return begin_value(s, c);
+
+    case ST_FIRST_KEY:
+        if (c == '}') {
+            return close_container(s, c);
+        }
+        // fall through
+    case ST_KEY:
+        if (c != '"') {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        begin_string(s, true);
+        return 0;
+
+    case ST_COLON:
+        if (c != ':') {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        s->state = ST_VALUE;
+        return 0;
+
+    case ST_NEXT:
+        if (c == ',') {
+            s->state = in_object(s) ? ST_KEY : ST_VALUE;
+            return 0;
+        }
+        if (c == '}' || c == ']') {
+            return close_container(s, c);
+        }
+        return GEO_JSON_ERROR_INVAL;
+
+    default:
+        // Only whitespace may follow the document
+        return GEO_JSON_ERROR_INVAL;
+    }
+}
+
+void geo_json_scanner_init(geo_json_scanner_t *scanner, geo_json_scan_cb_t callback, void *ctx) {
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->callback = callback;
+    scanner->ctx = ctx;
+    scanner->state = ST_VALUE;
+}
+
+int geo_json_scanner_feed(geo_json_scanner_t *scanner, const char *data, size_t len) {
+    if (scanner->state == ST_STOPPED) {
+        return GEO_JSON_SCAN_STOPPED;
+    }
+    if (scanner->state == ST_ERROR) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        int ret = step(scanner, data[i]);
+        if (ret != 0) {
+            if (ret == GEO_JSON_ERROR_INVAL) {
+                scanner->state = ST_ERROR;
+            }
+            return ret;
+        }
+    }
+    return 0;
+}
+
+bool geo_json_scanner_done(const geo_json_scanner_t *scanner) {
+    return scanner->state == ST_DONE;
+}
+
+const char *geo_json_scanner_key(const geo_json_scanner_t *scanner, int level) {
+    if (level < 1 || level > scanner->depth || level > GEO_JSON_SCAN_KEY_DEPTH) {
+        return "";
+    }
+    return scanner->keys[level - 1];
+}
@@ -0,0 +1,104 @@
+/**
+ * @file json_scanner.h
+ * @brief Streaming JSON scanner
+ *
+ * Push parser for documents too large to hold in memory, such as HTTP
+ * bodies read in small pieces. Input is fed in chunks of any size (a chunk
+ * may end in the middle of a string or escape); the scanner reports each
+ * scalar value and the start and end of each object or array through a
+ * callback, then forgets it. Memory use is fixed: the current value and the
+ * keys leading to it.
+ *
+ *     static bool on_event(geo_json_scanner_t *s, geo_json_scan_event_t event,
+ *                          geo_json_type_t type, const char *value, size_t len,
+ *                          void *ctx) {
+ *         if (event == GEO_JSON_SCAN_VALUE && s->depth == 1 &&
+ *             strcmp(geo_json_scanner_key(s, 1), "tag_name") == 0) {
+ *             ...
+ *         }
+ *         return true;    // false stops the scan
+ *     }
+ *
+ *     geo_json_scanner_init(&scanner, on_event, ctx);
+ *     while ((n = read(...)) > 0) {
+ *         if (geo_json_scanner_feed(&scanner, buf, n) != 0) break;
+ *     }
+ *
+ * During a callback, scanner->depth is the number of containers around the
+ * value (0 for the document itself), and geo_json_scanner_key(s, s->depth)
+ * is the key the value is stored under.
+ */
+
+#ifndef GEOGRAM_JSON_SCANNER_H
+#define GEOGRAM_JSON_SCANNER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "json_tokenizer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GEO_JSON_SCAN_MAX_DEPTH     32      // Nesting limit
+#define GEO_JSON_SCAN_KEY_DEPTH     8       // Levels whose keys are kept
+#define GEO_JSON_SCAN_KEY_LEN       32      // Including NUL, longer keys are cut
+#define GEO_JSON_SCAN_VALUE_LEN     256     // Including NUL, longer values are cut
+
+// geo_json_scanner_feed() result besides 0 and GEO_JSON_ERROR_INVAL
+#define GEO_JSON_SCAN_STOPPED       1       // The callback returned false
+
+typedef enum {
+    GEO_JSON_SCAN_VALUE,    // String or primitive, value holds its text
+    GEO_JSON_SCAN_BEGIN,    // Object or array opened
+    GEO_JSON_SCAN_END,      // Object or array closed
+} geo_json_scan_event_t;
+
+typedef struct geo_json_scanner geo_json_scanner_t;
+
+// Event callback. value is NUL-terminated and only valid during the call;
+// it is empty for BEGIN and END. Return false to stop scanning.
+typedef bool (*geo_json_scan_cb_t)(geo_json_scanner_t *scanner, geo_json_scan_event_t event,
+                                   geo_json_type_t type, const char *value, size_t len,
+                                   void *ctx);
+
+struct geo_json_scanner {
+    geo_json_scan_cb_t callback;
+    void *ctx;
+    int depth;                  // Open objects and arrays
+    bool truncated;             // Current value was longer than the buffer
+    // Internal state
+    uint8_t state;
+    bool in_key;
+    uint8_t hex_left;
+    uint32_t codepoint;
+    uint32_t high_surrogate;
+    uint32_t objects;           // Bit per level: object (1) or array (0)
+    size_t value_len;
+    char keys[GEO_JSON_SCAN_KEY_DEPTH][GEO_JSON_SCAN_KEY_LEN];
+    char value[GEO_JSON_SCAN_VALUE_LEN];
+};
+
+// Prepare a scanner for a new document
+void geo_json_scanner_init(geo_json_scanner_t *scanner, geo_json_scan_cb_t callback, void *ctx);
+
+// Scan the next chunk. Returns 0 when more input may follow,
+// GEO_JSON_SCAN_STOPPED if the callback asked to stop, or
+// GEO_JSON_ERROR_INVAL for malformed input. Once it returns non-zero,
+// further calls return the same result.
+int geo_json_scanner_feed(geo_json_scanner_t *scanner, const char *data, size_t len);
+
+// True once a complete top-level value has been scanned
+bool geo_json_scanner_done(const geo_json_scanner_t *scanner);
+
+// Key of the member at nesting level (1 = member of the top-level object).
+// Returns "" for array elements, an object before its first key, and levels
+// deeper than GEO_JSON_SCAN_KEY_DEPTH.
+const char *geo_json_scanner_key(const geo_json_scanner_t *scanner, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_JSON_SCANNER_H
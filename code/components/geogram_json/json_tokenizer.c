@@ -0,0 +1,489 @@
+#include "json_tokenizer.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+// Tokens are emitted only while the nesting depth is below the limit
+static bool skipping(const geo_json_parser_t *parser) {
+    return parser->max_depth > 0 && parser->depth >= parser->max_depth;
+}
+
+static geo_json_token_t *alloc_token(geo_json_parser_t *parser, geo_json_token_t *tokens,
+                                     unsigned int num_tokens) {
+    if (parser->toknext >= num_tokens || parser->toknext >= GEO_JSON_MAX_TOKENS) {
+        return NULL;
+    }
+    geo_json_token_t *tok = &tokens[parser->toknext++];
+    tok->start = tok->end = -1;
+    tok->size = 0;
+    tok->parent = -1;
+    tok->type = GEO_JSON_UNDEFINED;
+    return tok;
+}
+
+// Attach a new value to the token that owns it
+static int attach(geo_json_parser_t *parser, geo_json_token_t *tokens, geo_json_token_t *tok) {
+    if (parser->toksuper == -1) {
+        return 0;
+    }
+    geo_json_token_t *super = &tokens[parser->toksuper];
+    // Object members must be "key": value; a key holds exactly one value
+    if (tok->type != GEO_JSON_STRING && super->type == GEO_JSON_OBJECT) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+    if (super->type == GEO_JSON_STRING && super->size != 0) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+    super->size++;
+    tok->parent = (int16_t)parser->toksuper;
+    return 0;
+}
+
+// Non-zero if any byte of x is a quote, a backslash or a control character
+static inline uint32_t special_bytes(uint32_t x) {
+    uint32_t q = x ^ 0x22222222u;
+    uint32_t b = x ^ 0x5C5C5C5Cu;
+    return (((q - 0x01010101u) & ~q) | ((b - 0x01010101u) & ~b) |
+            ((x - 0x20202020u) & ~x)) & 0x80808080u;
+}
+
+static bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int parse_string(geo_json_parser_t *parser, const char *js, size_t len,
+                        geo_json_token_t *tokens, unsigned int num_tokens, bool emit) {
+    // Resume a string cut off by the previous chunk without rescanning it
+    unsigned int start = parser->string_start >= 0 ? (unsigned int)parser->string_start : parser->pos;
+    unsigned int pos = parser->string_start >= 0 ? parser->pos : parser->pos + 1;
+
+    while (pos < len) {
+        // Skip plain text a word at a time; strings dominate most payloads
+        while (pos + 4 <= len) {
+            uint32_t word;
+            memcpy(&word, js + pos, sizeof(word));
+            if (special_bytes(word)) {
+                break;
+            }
+            pos += 4;
+        }
+        if (pos >= len) {
+            break;
+        }
+
+        char c = js[pos];
+
+        if (c != '"' && c != '\\' && (unsigned char)c >= 0x20) {
+            pos++;
+            continue;
+        }
+
+        if (c == '"') {
+            parser->string_start = -1;
+            parser->pos = pos;
+            if (!emit) {
+                return 0;
+            }
+            geo_json_token_t *tok = alloc_token(parser, tokens, num_tokens);
+            if (!tok) {
+                parser->string_start = start;
+                return GEO_JSON_ERROR_NOMEM;
+            }
+            tok->type = GEO_JSON_STRING;
+            tok->start = start + 1;
+            tok->end = pos;
+            return attach(parser, tokens, tok);
+        }
+
+        if (c != '\\') {
+            if (c == '\0') {
+                break;
+            }
+            return GEO_JSON_ERROR_INVAL;
+        }
+
+        // Escapes are consumed whole, so a chunk never ends inside one
+        if (pos + 1 >= len || !js[pos + 1]) {
+            break;
+        }
+        switch (js[pos + 1]) {
+            case '"': case '/': case '\\': case 'b':
+            case 'f': case 'r': case 'n': case 't':
+                pos += 2;
+                break;
+            case 'u':
+                if (pos + 5 >= len) {
+                    goto partial;
+                }
+                for (int i = 2; i < 6; i++) {
+                    if (!is_hex(js[pos + i])) {
+                        return GEO_JSON_ERROR_INVAL;
+                    }
+                }
+                pos += 6;
+                break;
+            default:
+                return GEO_JSON_ERROR_INVAL;
+        }
+    }
+
+partial:
+    parser->string_start = (int)start;
+    parser->pos = pos;
+    return GEO_JSON_ERROR_PART;
+}
+
+static int parse_primitive(geo_json_parser_t *parser, const char *js, size_t len,
+                           geo_json_token_t *tokens, unsigned int num_tokens) {
+    unsigned int start = parser->pos;
+
+    for (; parser->pos < len && js[parser->pos]; parser->pos++) {
+        char c = js[parser->pos];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+            c == ',' || c == ']' || c == '}') {
+            geo_json_token_t *tok = alloc_token(parser, tokens, num_tokens);
+            if (!tok) {
+                parser->pos = start;
+                return GEO_JSON_ERROR_NOMEM;
+            }
+            tok->type = GEO_JSON_PRIMITIVE;
+            tok->start = start;
+            tok->end = parser->pos;
+            parser->pos--;
+            return attach(parser, tokens, tok);
+        }
+        if ((unsigned char)c < 0x20 || (unsigned char)c >= 0x7f) {
+            return GEO_JSON_ERROR_INVAL;
+        }
+    }
+
+    // A number may continue in the next chunk
+    parser->pos = start;
+    return GEO_JSON_ERROR_PART;
+}
+
+// Match a closing bracket with the innermost open container
+static int close_container(geo_json_parser_t *parser, geo_json_token_t *tokens, uint8_t type) {
+    if (parser->toknext < 1) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+    geo_json_token_t *tok = &tokens[parser->toknext - 1];
+    for (;;) {
+        if (tok->start != -1 && tok->end == -1) {
+            if (tok->type != type) {
+                return GEO_JSON_ERROR_INVAL;
+            }
+            tok->end = parser->pos + 1;
+            parser->toksuper = tok->parent;
+            return 0;
+        }
+        if (tok->parent == -1) {
+            return GEO_JSON_ERROR_INVAL;
+        }
+        tok = &tokens[tok->parent];
+    }
+}
+
+void geo_json_parser_init(geo_json_parser_t *parser, int max_depth) {
+    parser->pos = 0;
+    parser->toknext = 0;
+    parser->toksuper = -1;
+    parser->depth = 0;
+    parser->string_start = -1;
+    parser->max_depth = max_depth > 0 ? max_depth : 0;
+}
+
+int geo_json_parse(geo_json_parser_t *parser, const char *js, size_t len,
+                   geo_json_token_t *tokens, unsigned int num_tokens) {
+    if (!parser || !js || !tokens) {
+        return GEO_JSON_ERROR_INVAL;
+    }
+
+    if (parser->string_start >= 0) {
+        int ret = parse_string(parser, js, len, tokens, num_tokens, !skipping(parser));
+        if (ret < 0) {
+            return ret;
+        }
+        parser->pos++;
+    }
+
+    for (; parser->pos < len && js[parser->pos]; parser->pos++) {
+        char c = js[parser->pos];
+        bool skip = skipping(parser);
+        int ret;
+
+        switch (c) {
+            case '{':
+            case '[': {
+                if (!skip) {
+                    geo_json_token_t *tok = alloc_token(parser, tokens, num_tokens);
+                    if (!tok) {
+                        return GEO_JSON_ERROR_NOMEM;
+                    }
+                    tok->type = c == '{' ? GEO_JSON_OBJECT : GEO_JSON_ARRAY;
+                    tok->start = parser->pos;
+                    ret = attach(parser, tokens, tok);
+                    if (ret < 0) {
+                        return ret;
+                    }
+                    parser->toksuper = parser->toknext - 1;
+                }
+                parser->depth++;
+                break;
+            }
+
+            case '}':
+            case ']':
+                if (parser->depth == 0) {
+                    return GEO_JSON_ERROR_INVAL;
+                }
+                parser->depth--;
+                if (!skipping(parser)) {
+                    ret = close_container(parser, tokens,
+                                          c == '}' ? GEO_JSON_OBJECT : GEO_JSON_ARRAY);
+                    if (ret < 0) {
+                        return ret;
+                    }
+                }
+                break;
+
+            case '"':
+                ret = parse_string(parser, js, len, tokens, num_tokens, !skip);
+                if (ret < 0) {
+                    return ret;
+                }
+                break;
+
+            case ' ': case '\t': case '\r': case '\n':
+                break;
+
+            case ':':
+                if (!skip) {
+                    if (parser->toknext < 1 || tokens[parser->toknext - 1].type != GEO_JSON_STRING) {
+                        return GEO_JSON_ERROR_INVAL;
+                    }
+                    parser->toksuper = parser->toknext - 1;
+                }
+                break;
+
+            case ',':
+                if (!skip && parser->toksuper != -1 &&
+                    tokens[parser->toksuper].type != GEO_JSON_OBJECT &&
+                    tokens[parser->toksuper].type != GEO_JSON_ARRAY) {
+                    parser->toksuper = tokens[parser->toksuper].parent;
+                }
+                break;
+
+            default:
+                // Skipped containers are only checked for balance and strings
+                if (skip) {
+                    break;
+                }
+                if (c != '-' && !(c >= '0' && c <= '9') && c != 't' && c != 'f' && c != 'n') {
+                    return GEO_JSON_ERROR_INVAL;
+                }
+                ret = parse_primitive(parser, js, len, tokens, num_tokens);
+                if (ret < 0) {
+                    return ret;
+                }
+                break;
+        }
+    }
+
+    if (parser->depth > 0) {
+        return GEO_JSON_ERROR_PART;
+    }
+    return (int)parser->toknext;
+}
+
+int geo_json_next(const geo_json_token_t *tokens, int count, int index) {
+    if (index < 0 || index >= count) {
+        return count;
+    }
+    int end = tokens[index].end;
+    int next = index + 1;
+    // Keys own their value; containers own everything inside their brackets
+    if (tokens[index].type == GEO_JSON_STRING && tokens[index].size > 0) {
+        return geo_json_next(tokens, count, next);
+    }
+    if (tokens[index].type == GEO_JSON_OBJECT || tokens[index].type == GEO_JSON_ARRAY) {
+        while (next < count && tokens[next].start < end) {
+            next++;
+        }
+    }
+    return next;
+}
+
+int geo_json_object_get(const char *js, const geo_json_token_t *tokens, int count,
+                        int obj, const char *key) {
+    if (!js || !tokens || !key || obj < 0 || obj >= count ||
+        tokens[obj].type != GEO_JSON_OBJECT) {
+        return -1;
+    }
+
+    int i = obj + 1;
+    for (int n = 0; n < tokens[obj].size && i < count; n++) {
+        if (tokens[i].size > 0 && i + 1 < count && geo_json_token_equals(js, &tokens[i], key)) {
+            return i + 1;
+        }
+        i = geo_json_next(tokens, count, i);
+    }
+    return -1;
+}
+
+bool geo_json_token_equals(const char *js, const geo_json_token_t *token, const char *str) {
+    if (!js || !token || !str ||
+        (token->type != GEO_JSON_STRING && token->type != GEO_JSON_PRIMITIVE)) {
+        return false;
+    }
+    size_t len = (size_t)(token->end - token->start);
+    return strlen(str) == len && memcmp(js + token->start, str, len) == 0;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int read_hex4(const char *p) {
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        int v = hex_value(p[i]);
+        if (v < 0) {
+            return -1;
+        }
+        value = (value << 4) | v;
+    }
+    return value;
+}
+
+int geo_json_token_to_string(const char *js, const geo_json_token_t *token,
+                             char *output, size_t output_size) {
+    if (!js || !token || token->type != GEO_JSON_STRING) {
+        return -1;
+    }
+
+    const char *p = js + token->start;
+    const char *end = js + token->end;
+    size_t n = 0;
+
+    while (p < end) {
+        char buf[4];
+        size_t buf_len = 1;
+
+        if (*p != '\\') {
+            buf[0] = *p++;
+        } else {
+            if (p + 1 >= end) {
+                return -1;
+            }
+            char e = p[1];
+            p += 2;
+            switch (e) {
+                case 'b': buf[0] = '\b'; break;
+                case 'f': buf[0] = '\f'; break;
+                case 'n': buf[0] = '\n'; break;
+                case 'r': buf[0] = '\r'; break;
+                case 't': buf[0] = '\t'; break;
+                case 'u': {
+                    if (end - p < 4) {
+                        return -1;
+                    }
+                    long cp = read_hex4(p);
+                    if (cp < 0) {
+                        return -1;
+                    }
+                    p += 4;
+                    // Combine a surrogate pair into one code point
+                    if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        int low = read_hex4(p + 2);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+                    if (cp < 0x80) {
+                        buf[0] = (char)cp;
+                    } else if (cp < 0x800) {
+                        buf[0] = (char)(0xC0 | (cp >> 6));
+                        buf[1] = (char)(0x80 | (cp & 0x3F));
+                        buf_len = 2;
+                    } else if (cp < 0x10000) {
+                        buf[0] = (char)(0xE0 | (cp >> 12));
+                        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        buf[2] = (char)(0x80 | (cp & 0x3F));
+                        buf_len = 3;
+                    } else {
+                        buf[0] = (char)(0xF0 | (cp >> 18));
+                        buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                        buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        buf[3] = (char)(0x80 | (cp & 0x3F));
+                        buf_len = 4;
+                    }
+                    break;
+                }
+                default: buf[0] = e; break;
+            }
+        }
+
+        for (size_t i = 0; i < buf_len; i++, n++) {
+            if (output && n + 1 < output_size) {
+                output[n] = buf[i];
+            }
+        }
+    }
+
+    if (output && output_size > 0) {
+        output[n < output_size ? n : output_size - 1] = '\0';
+    }
+    return (int)n;
+}
+
+bool geo_json_token_to_int64(const char *js, const geo_json_token_t *token, int64_t *output) {
+    if (!js || !token || !output || token->type != GEO_JSON_PRIMITIVE) {
+        return false;
+    }
+    char buf[24];
+    size_t len = (size_t)(token->end - token->start);
+    if (len == 0 || len >= sizeof(buf)) {
+        return false;
+    }
+    memcpy(buf, js + token->start, len);
+    buf[len] = '\0';
+
+    char *endptr;
+    errno = 0;
+    long long value = strtoll(buf, &endptr, 10);
+    if (*endptr != '\0' || errno == ERANGE) {
+        return false;
+    }
+    *output = value;
+    return true;
+}
+
+bool geo_json_token_to_int(const char *js, const geo_json_token_t *token, int *output) {
+    int64_t value;
+    if (!output || !geo_json_token_to_int64(js, token, &value) ||
+        value < INT32_MIN || value > INT32_MAX) {
+        return false;
+    }
+    *output = (int)value;
+    return true;
+}
+
+bool geo_json_token_to_bool(const char *js, const geo_json_token_t *token, bool *output) {
+    if (!output) {
+        return false;
+    }
+    if (geo_json_token_equals(js, token, "true") && token->type == GEO_JSON_PRIMITIVE) {
+        *output = true;
+        return true;
+    }
+    if (geo_json_token_equals(js, token, "false") && token->type == GEO_JSON_PRIMITIVE) {
+        *output = false;
+        return true;
+    }
+    return false;
+}
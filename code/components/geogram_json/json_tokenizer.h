@@ -0,0 +1,111 @@
+/**
+ * @file json_tokenizer.h
+ * @brief Zero-allocation JSON tokenizer
+ *
+ * Parses a buffer once into a caller-provided array of tokens (jsmn style).
+ * Tokens only record offsets into the source, so nothing is copied until a
+ * value is read with one of the accessors below.
+ *
+ * Parsing can be resumed: when geo_json_parse() returns GEO_JSON_ERROR_PART,
+ * append the next chunk (e.g. from another httpd_req_recv() call) to the same
+ * buffer and call it again with the same parser and tokens:
+ *
+ *     geo_json_parser_init(&parser, 0);
+ *     int count = GEO_JSON_ERROR_PART;
+ *     while (count == GEO_JSON_ERROR_PART && received < total) {
+ *         int ret = httpd_req_recv(req, buf + received, total - received);
+ *         if (ret <= 0) break;
+ *         received += ret;
+ *         count = geo_json_parse(&parser, buf, received, tokens, MAX_TOKENS);
+ *     }
+ *
+ * Callers that only need the top-level fields can limit the nesting depth;
+ * containers at the limit get a single token spanning the whole value and
+ * their contents are skipped without using any tokens.
+ */
+
+#ifndef GEOGRAM_JSON_TOKENIZER_H
+#define GEOGRAM_JSON_TOKENIZER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// geo_json_parse() errors
+#define GEO_JSON_ERROR_NOMEM    -1      // Not enough tokens
+#define GEO_JSON_ERROR_INVAL    -2      // Malformed JSON
+#define GEO_JSON_ERROR_PART     -3      // Input ends mid-value, more data expected
+
+#define GEO_JSON_MAX_TOKENS     INT16_MAX
+
+// Token types
+typedef enum {
+    GEO_JSON_UNDEFINED = 0,
+    GEO_JSON_OBJECT,
+    GEO_JSON_ARRAY,
+    GEO_JSON_STRING,
+    GEO_JSON_PRIMITIVE,     // Number, true, false or null
+} geo_json_type_t;
+
+// Token: a value located in the source buffer
+// Strings exclude their quotes; objects and arrays include their brackets.
+// size counts children: keys of an object, elements of an array, and 1 for
+// a key (its value); it stays 0 for containers at the depth limit. parent is
+// the index of the enclosing token or -1.
+typedef struct {
+    int start;
+    int end;
+    int16_t size;
+    int16_t parent;
+    uint8_t type;
+} geo_json_token_t;
+
+// Parser state, kept between calls when input arrives in pieces
+typedef struct {
+    unsigned int pos;       // Offset of next character
+    unsigned int toknext;   // Next free token
+    int toksuper;           // Token that owns the next value, or -1
+    int depth;              // Open objects and arrays
+    int string_start;       // Opening quote of a string cut off by the end of input, or -1
+    int max_depth;          // Nesting levels tokenized (0 = no limit)
+} geo_json_parser_t;
+
+// Initialize parser. max_depth 1 yields only the top-level value, 2 adds its
+// fields or elements, and so on; 0 tokenizes everything.
+void geo_json_parser_init(geo_json_parser_t *parser, int max_depth);
+
+// Parse js[0..len) into tokens. Returns the number of tokens used or a
+// GEO_JSON_ERROR_* code. Stops early at a NUL byte.
+int geo_json_parse(geo_json_parser_t *parser, const char *js, size_t len,
+                   geo_json_token_t *tokens, unsigned int num_tokens);
+
+// Index of the token following the value at index (skipping its contents)
+int geo_json_next(const geo_json_token_t *tokens, int count, int index);
+
+// Index of the value stored under key in the object at index obj, or -1
+int geo_json_object_get(const char *js, const geo_json_token_t *tokens, int count,
+                        int obj, const char *key);
+
+// Compare a string or primitive token with a C string
+bool geo_json_token_equals(const char *js, const geo_json_token_t *token, const char *str);
+
+// Decode a string token (escapes resolved, \u encoded as UTF-8) into output.
+// Returns the decoded length; if that is >= output_size the output was
+// truncated. Returns -1 if the token is not a string or is malformed.
+int geo_json_token_to_string(const char *js, const geo_json_token_t *token,
+                             char *output, size_t output_size);
+
+// Read a primitive token as a number or boolean
+bool geo_json_token_to_int(const char *js, const geo_json_token_t *token, int *output);
+bool geo_json_token_to_int64(const char *js, const geo_json_token_t *token, int64_t *output);
+bool geo_json_token_to_bool(const char *js, const geo_json_token_t *token, bool *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_JSON_TOKENIZER_H
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "esp_log.h"
 
 #define TAG "JSON"
 
@@ -11,39 +12,108 @@ void geo_json_init(geo_json_builder_t *builder, char *buffer, size_t size) {
     builder->pos = 0;
     builder->first_field = true;
     builder->depth = 0;
+    builder->flush = NULL;
+    builder->flush_ctx = NULL;
+    builder->flushed = 0;
+    builder->failed = false;
     if (size > 0) {
         buffer[0] = '\0';
     }
 }
 
-static void geo_json_append(geo_json_builder_t *builder, const char *str) {
-    size_t len = strlen(str);
-    if (builder->pos + len < builder->size) {
-        strcpy(builder->buffer + builder->pos, str);
+void geo_json_init_stream(geo_json_builder_t *builder, char *buffer, size_t size,
+                          geo_json_flush_cb_t flush, void *ctx) {
+    geo_json_init(builder, buffer, size);
+    builder->flush = flush;
+    builder->flush_ctx = ctx;
+    builder->failed = (flush == NULL || size == 0);
+}
+
+// Hand the staged bytes to the flush callback
+static void geo_json_drain(geo_json_builder_t *builder, bool final) {
+    if (!builder->failed &&
+        !builder->flush(builder->buffer, builder->pos, final, builder->flush_ctx)) {
+        ESP_LOGW(TAG, "Flush failed after %u bytes", (unsigned)builder->flushed);
+        builder->failed = true;
+    }
+    builder->flushed += builder->pos;
+    builder->pos = 0;
+}
+
+static void geo_json_write(geo_json_builder_t *builder, const char *data, size_t len) {
+    if (builder->failed) {
+        return;
+    }
+
+    if (!builder->flush) {
+        // A document that does not fit is discarded, never left half written
+        if (builder->pos + len >= builder->size) {
+            builder->failed = true;
+            builder->pos = 0;
+            builder->buffer[0] = '\0';
+            return;
+        }
+        memcpy(builder->buffer + builder->pos, data, len);
         builder->pos += len;
+        builder->buffer[builder->pos] = '\0';
+        return;
+    }
+
+    while (len > 0) {
+        if (builder->pos == builder->size) {
+            geo_json_drain(builder, false);
+        }
+        size_t n = builder->size - builder->pos;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(builder->buffer + builder->pos, data, n);
+        builder->pos += n;
+        data += n;
+        len -= n;
     }
 }
 
+bool geo_json_flush(geo_json_builder_t *builder) {
+    if (builder->flush && !builder->failed) {
+        geo_json_drain(builder, true);
+    }
+    return !builder->failed;
+}
+
+static void geo_json_append(geo_json_builder_t *builder, const char *str) {
+    geo_json_write(builder, str, strlen(str));
+}
+
 static void geo_json_append_escaped(geo_json_builder_t *builder, const char *str) {
-    geo_json_append(builder, "\"");
-    while (*str && builder->pos < builder->size - 2) {
-        char c = *str++;
-        if (c == '"' || c == '\\') {
-            builder->buffer[builder->pos++] = '\\';
-        } else if (c == '\n') {
-            builder->buffer[builder->pos++] = '\\';
-            c = 'n';
-        } else if (c == '\r') {
-            builder->buffer[builder->pos++] = '\\';
-            c = 'r';
-        } else if (c == '\t') {
-            builder->buffer[builder->pos++] = '\\';
-            c = 't';
+    geo_json_write(builder, "\"", 1);
+
+    // Copy runs of plain characters in one go
+    const char *run = str;
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        geo_json_write(builder, run, str - run);
+        run = str + 1;
+
+        char esc[8];
+        switch (c) {
+            case '"':  geo_json_write(builder, "\\\"", 2); break;
+            case '\\': geo_json_write(builder, "\\\\", 2); break;
+            case '\n': geo_json_write(builder, "\\n", 2); break;
+            case '\r': geo_json_write(builder, "\\r", 2); break;
+            case '\t': geo_json_write(builder, "\\t", 2); break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                geo_json_write(builder, esc, 6);
+                break;
         }
-        builder->buffer[builder->pos++] = c;
     }
-    builder->buffer[builder->pos] = '\0';
-    geo_json_append(builder, "\"");
+    geo_json_write(builder, run, str - run);
+
+    geo_json_write(builder, "\"", 1);
 }
 
 static void geo_json_add_comma(geo_json_builder_t *builder) {
@@ -54,11 +124,24 @@ static void geo_json_add_comma(geo_json_builder_t *builder) {
 }
 
 void geo_json_object_start(geo_json_builder_t *builder) {
+    // Objects inside an array are separated like any other element
+    if (builder->depth > 0) {
+        geo_json_add_comma(builder);
+    }
     geo_json_append(builder, "{");
     builder->first_field = true;
     builder->depth++;
 }
 
+void geo_json_object_start_key(geo_json_builder_t *builder, const char *key) {
+    geo_json_add_comma(builder);
+    geo_json_append(builder, "\"");
+    geo_json_append(builder, key);
+    geo_json_append(builder, "\":{");
+    builder->first_field = true;
+    builder->depth++;
+}
+
 void geo_json_object_end(geo_json_builder_t *builder) {
     geo_json_append(builder, "}");
     builder->depth--;
@@ -126,124 +209,5 @@ const char *geo_json_get_string(geo_json_builder_t *builder) {
 }
 
 size_t geo_json_get_length(geo_json_builder_t *builder) {
-    return builder->pos;
-}
-
-// Simple JSON field extraction (no full parser, just string search)
-bool geo_json_get_field_string(const char *json, const char *field, char *output, size_t output_size) {
-    if (!json || !field || !output || output_size == 0) {
-        return false;
-    }
-
-    // Build search pattern: "field":"
-    char pattern[64];
-    snprintf(pattern, sizeof(pattern), "\"%s\":\"", field);
-
-    const char *start = strstr(json, pattern);
-    if (!start) {
-        return false;
-    }
-
-    start += strlen(pattern);
-
-    // Find end quote (handle escaped quotes)
-    const char *end = start;
-    while (*end && *end != '"') {
-        if (*end == '\\' && *(end + 1)) {
-            end += 2;  // Skip escaped char
-        } else {
-            end++;
-        }
-    }
-
-    size_t len = end - start;
-    if (len >= output_size) {
-        len = output_size - 1;
-    }
-
-    strncpy(output, start, len);
-    output[len] = '\0';
-
-    return true;
-}
-
-bool geo_json_get_field_int(const char *json, const char *field, int *output) {
-    if (!json || !field || !output) {
-        return false;
-    }
-
-    // Build search pattern: "field":
-    char pattern[64];
-    snprintf(pattern, sizeof(pattern), "\"%s\":", field);
-
-    const char *start = strstr(json, pattern);
-    if (!start) {
-        return false;
-    }
-
-    start += strlen(pattern);
-
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t') {
-        start++;
-    }
-
-    *output = atoi(start);
-    return true;
-}
-
-// Extract value from tags array: [["key", "value"], ["key2", "value2"]]
-bool geo_json_get_tag_value(const char *json, const char *tag_key, char *output, size_t output_size) {
-    if (!json || !tag_key || !output || output_size == 0) {
-        return false;
-    }
-
-    // Find "tags": array
-    const char *tags = strstr(json, "\"tags\":");
-    if (!tags) {
-        return false;
-    }
-
-    // Build search pattern: ["key","
-    char pattern[64];
-    snprintf(pattern, sizeof(pattern), "[\"%s\",\"", tag_key);
-
-    const char *start = strstr(tags, pattern);
-    if (!start) {
-        // Try alternate format: ["key", " (with space)
-        snprintf(pattern, sizeof(pattern), "[\"%s\", \"", tag_key);
-        start = strstr(tags, pattern);
-        if (!start) {
-            return false;
-        }
-    }
-
-    // Find the value after the key
-    start = strchr(start + 2, ',');  // Skip past key
-    if (!start) {
-        return false;
-    }
-
-    // Skip to opening quote of value
-    start = strchr(start, '"');
-    if (!start) {
-        return false;
-    }
-    start++;  // Skip the quote
-
-    // Find closing quote
-    const char *end = strchr(start, '"');
-    if (!end) {
-        return false;
-    }
-
-    size_t len = end - start;
-    if (len >= output_size) {
-        len = output_size - 1;
-    }
-
-    strncpy(output, start, len);
-    output[len] = '\0';
-
-    return true;
+    return builder->flushed + builder->pos;
 }
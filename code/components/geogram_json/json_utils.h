@@ -4,11 +4,19 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "json_tokenizer.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Flush callback for streaming builders: receives each filled chunk, and the
+// remainder with final set from geo_json_flush(). Return false to abort.
+typedef bool (*geo_json_flush_cb_t)(const char *data, size_t len, bool final, void *ctx);
+
+// Chunk size that suits httpd_resp_send_chunk() and WebSocket fragments
+#define GEO_JSON_STREAM_CHUNK 512
+
 // JSON builder context
 typedef struct {
     char *buffer;
@@ -16,13 +24,29 @@ typedef struct {
     size_t pos;
     bool first_field;
     int depth;
+    geo_json_flush_cb_t flush;  // NULL: output stays in buffer
+    void *flush_ctx;
+    size_t flushed;             // Bytes already passed to flush
+    bool failed;                // Output lost: buffer full or flush error
 } geo_json_builder_t;
 
 // Initialize JSON builder
+// If the document does not fit in buffer the builder is marked failed and the
+// buffer emptied (length 0); callers check geo_json_flush() before using it
 void geo_json_init(geo_json_builder_t *builder, char *buffer, size_t size);
 
-// Start/end object
+// Initialize a streaming builder: buffer is only a staging area and is passed
+// to flush each time it fills, so output size is not bounded by it
+void geo_json_init_stream(geo_json_builder_t *builder, char *buffer, size_t size,
+                          geo_json_flush_cb_t flush, void *ctx);
+
+// Pass buffered output to flush (final chunk). Returns false if any output
+// was lost; for fixed buffers this reports overflow.
+bool geo_json_flush(geo_json_builder_t *builder);
+
+// Start/end object (start_key opens an object as the value of key)
 void geo_json_object_start(geo_json_builder_t *builder);
+void geo_json_object_start_key(geo_json_builder_t *builder, const char *key);
 void geo_json_object_end(geo_json_builder_t *builder);
 
 // Start/end array
@@ -37,19 +61,10 @@ void geo_json_add_int64(geo_json_builder_t *builder, const char *key, int64_t va
 void geo_json_add_double(geo_json_builder_t *builder, const char *key, double value, int precision);
 void geo_json_add_bool(geo_json_builder_t *builder, const char *key, bool value);
 
-// Get result
+// Get result (the length of a streamed document includes flushed output)
 const char *geo_json_get_string(geo_json_builder_t *builder);
 size_t geo_json_get_length(geo_json_builder_t *builder);
 
-// Simple JSON parsing (extract specific fields)
-// Returns true if field found, copies value to output buffer
-bool geo_json_get_field_string(const char *json, const char *field, char *output, size_t output_size);
-bool geo_json_get_field_int(const char *json, const char *field, int *output);
-
-// Extract nested field from tags array: [["key", "value"], ...]
-// Looks for tag with matching key and returns the value
-bool geo_json_get_tag_value(const char *json, const char *tag_key, char *output, size_t output_size);
-
 #ifdef __cplusplus
 }
 #endif
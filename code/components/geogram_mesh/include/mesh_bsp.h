@@ -158,6 +158,18 @@ uint8_t geogram_mesh_get_subnet_id(void);
  */
 esp_err_t geogram_mesh_get_parent_mac(uint8_t *mac);
 
+/**
+ * @brief Get parent node IP address (the gateway of this node's uplink)
+ *
+ * Parents run the Station API on port 80, so children reach their services
+ * over the mesh at this address.
+ *
+ * @param ip_str Buffer for IP string (min 16 bytes)
+ * @param len Buffer length
+ * @return ESP_OK if parent exists and has an address
+ */
+esp_err_t geogram_mesh_get_parent_ip(char *ip_str, size_t len);
+
 /**
  * @brief Check if this node has a parent (connected to mesh)
  * @return true if connected to a parent mesh node
@@ -14,6 +14,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "esp_err.h"
+#include "json_utils.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +38,11 @@ extern "C" {
  */
 #define MESH_CHAT_HISTORY_SIZE      100
 
+/**
+ * @brief Most messages returned by one JSON history request
+ */
+#define MESH_CHAT_JSON_MAX_MESSAGES 20
+
 /**
  * @brief Maximum filename length for file messages
  */
@@ -75,6 +81,7 @@ typedef struct {
     char text[MESH_CHAT_MAX_MESSAGE_LEN + 1];      /**< Message text */
     uint8_t sender_mac[6];                          /**< Sender MAC address */
     bool is_local;                                  /**< True if sent from this node */
+    bool verified;                                  /**< Text signed by the key its callsign derives from */
     mesh_chat_msg_type_t msg_type;                 /**< Message type (text/file) */
     mesh_chat_file_info_t file;                    /**< File info (only if msg_type==FILE) */
 } mesh_chat_message_t;
@@ -115,10 +122,12 @@ esp_err_t mesh_chat_add_local_message(const char *callsign, const char *text);
  * @param callsign Sender callsign (optional)
  * @param text Message text
  * @param timestamp Unix timestamp (seconds). If 0, current device time is used.
+ * @param verified The caller checked a signature over the text by the callsign's key
  */
 esp_err_t mesh_chat_add_local_message_with_timestamp(const char *callsign,
                                                      const char *text,
-                                                     uint32_t timestamp);
+                                                     uint32_t timestamp,
+                                                     bool verified);
 
 /**
  * @brief Add a local-only file metadata message with a custom callsign
@@ -181,10 +190,21 @@ void mesh_chat_register_callback(mesh_chat_callback_t callback);
  * @param buffer Output buffer
  * @param size Buffer size
  * @param since_id Only include messages with ID > since_id
- * @return Number of bytes written
+ * @return Number of bytes written, 0 if the buffer is too small
  */
 size_t mesh_chat_build_json(char *buffer, size_t size, uint32_t since_id);
 
+/**
+ * @brief Write a "messages" array field into the open JSON object
+ *
+ * With a streaming builder the history is sent without a response-sized
+ * buffer. At most MESH_CHAT_JSON_MAX_MESSAGES messages are written.
+ *
+ * @param builder JSON builder positioned inside an object
+ * @param since_id Only include messages with ID > since_id
+ */
+void mesh_chat_write_messages_json(geo_json_builder_t *builder, uint32_t since_id);
+
 /**
  * @brief Internal: Handle incoming mesh chat packet
  * Called by mesh data receive callback
@@ -21,6 +21,7 @@
 #include "lwip/ip4_addr.h"
 #include "lwip/netif.h"
 #include "lwip/pbuf.h"
+#include "geogram_metrics.h"
 
 static const char *TAG = "mesh_bridge";
 
@@ -63,11 +64,23 @@ typedef struct __attribute__((packed)) {
 
 static bool s_bridge_enabled = false;
 
-// Statistics
-static uint32_t s_packets_tx = 0;
-static uint32_t s_packets_rx = 0;
-static uint32_t s_bytes_tx = 0;
-static uint32_t s_bytes_rx = 0;
+// Statistics, exported as metrics (reset when the bridge is enabled)
+static geogram_metric_t s_packets_tx = {
+    .name = "geogram_mesh_bridge_packets_total", .help = "Bridge packets since the bridge was enabled",
+    .labels = "direction=\"tx\"", .type = GEOGRAM_METRIC_COUNTER,
+};
+static geogram_metric_t s_packets_rx = {
+    .name = "geogram_mesh_bridge_packets_total", .help = "Bridge packets since the bridge was enabled",
+    .labels = "direction=\"rx\"", .type = GEOGRAM_METRIC_COUNTER,
+};
+static geogram_metric_t s_bytes_tx = {
+    .name = "geogram_mesh_bridge_bytes_total", .help = "Bridge payload bytes since the bridge was enabled",
+    .labels = "direction=\"tx\"", .type = GEOGRAM_METRIC_COUNTER,
+};
+static geogram_metric_t s_bytes_rx = {
+    .name = "geogram_mesh_bridge_bytes_total", .help = "Bridge payload bytes since the bridge was enabled",
+    .labels = "direction=\"rx\"", .type = GEOGRAM_METRIC_COUNTER,
+};
 
 // ============================================================================
 // Forward Declarations
@@ -102,10 +115,14 @@ esp_err_t geogram_mesh_enable_bridge(void)
     geogram_mesh_register_data_callback(mesh_data_handler);
 
     s_bridge_enabled = true;
-    s_packets_tx = 0;
-    s_packets_rx = 0;
-    s_bytes_tx = 0;
-    s_bytes_rx = 0;
+    geogram_metric_set(&s_packets_tx, 0);
+    geogram_metric_set(&s_packets_rx, 0);
+    geogram_metric_set(&s_bytes_tx, 0);
+    geogram_metric_set(&s_bytes_rx, 0);
+    geogram_metrics_register(&s_packets_tx);
+    geogram_metrics_register(&s_packets_rx);
+    geogram_metrics_register(&s_bytes_tx);
+    geogram_metrics_register(&s_bytes_rx);
 
     ESP_LOGI(TAG, "[BRIDGE] Data bridging enabled successfully");
     return ESP_OK;
@@ -136,10 +153,10 @@ bool geogram_mesh_bridge_is_enabled(void)
 void geogram_mesh_bridge_get_stats(uint32_t *packets_tx, uint32_t *packets_rx,
                                     uint32_t *bytes_tx, uint32_t *bytes_rx)
 {
-    if (packets_tx) *packets_tx = s_packets_tx;
-    if (packets_rx) *packets_rx = s_packets_rx;
-    if (bytes_tx) *bytes_tx = s_bytes_tx;
-    if (bytes_rx) *bytes_rx = s_bytes_rx;
+    if (packets_tx) *packets_tx = s_packets_tx.value;
+    if (packets_rx) *packets_rx = s_packets_rx.value;
+    if (bytes_tx) *bytes_tx = s_bytes_tx.value;
+    if (bytes_rx) *bytes_rx = s_bytes_rx.value;
 }
 
 // ============================================================================
@@ -168,8 +185,8 @@ esp_err_t mesh_bridge_forward_packet(uint32_t dest_ip, const uint8_t *data, size
 
     ESP_LOGD(TAG, "[BRIDGE TX] Forwarding %zu bytes", len);
 
-    s_packets_tx++;
-    s_bytes_tx += len;
+    geogram_metric_inc(&s_packets_tx);
+    geogram_metric_add(&s_bytes_tx, len);
 
     return ESP_OK;
 }
@@ -234,12 +251,12 @@ static void mesh_data_handler(const uint8_t *src_mac, const void *data, size_t l
         return;
     }
 
-    s_packets_rx++;
-    s_bytes_rx += header->payload_len;
+    geogram_metric_inc(&s_packets_rx);
+    geogram_metric_add(&s_bytes_rx, header->payload_len);
 
     ESP_LOGI(TAG, "[BRIDGE RX] Packet validated successfully");
     ESP_LOGI(TAG, "[BRIDGE RX] Total RX: %lu packets, %lu bytes",
-             (unsigned long)s_packets_rx, (unsigned long)s_bytes_rx);
+             (unsigned long)s_packets_rx.value, (unsigned long)s_bytes_rx.value);
     ESP_LOGI(TAG, "[BRIDGE RX] ========================================");
 
     // With ESP-Mesh-Lite, IP packets are handled by per-node LWIP with NAPT
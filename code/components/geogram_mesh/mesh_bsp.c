@@ -13,6 +13,7 @@
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "esp_log.h"
+#include "geogram_dlog.h"
 #include "esp_mac.h"
 #include "esp_wifi.h"
 #include "esp_bridge.h"
@@ -475,6 +476,21 @@ esp_err_t geogram_mesh_get_parent_mac(uint8_t *mac)
     return ESP_OK;
 }
 
+esp_err_t geogram_mesh_get_parent_ip(char *ip_str, size_t len)
+{
+    if (!ip_str || len < 16) return ESP_ERR_INVALID_ARG;
+    if (!s_has_parent) return ESP_ERR_NOT_FOUND;
+
+    esp_netif_t *sta_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info;
+    if (!sta_netif || esp_netif_get_ip_info(sta_netif, &ip_info) != ESP_OK || ip_info.gw.addr == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    snprintf(ip_str, len, IPSTR, IP2STR(&ip_info.gw));
+    return ESP_OK;
+}
+
 bool geogram_mesh_has_parent(void)
 {
     return s_has_parent;
@@ -655,9 +671,6 @@ esp_err_t geogram_mesh_send_to_node(const uint8_t *dest_mac, const void *data, s
         return ESP_ERR_INVALID_STATE;
     }
 
-    ESP_LOGI(TAG, "[TX] Sending %zu bytes to " MACSTR,
-             len, MAC2STR(dest_mac));
-
     // Use ESP-Mesh-Lite's ESP-NOW based messaging
     esp_err_t ret = esp_mesh_lite_espnow_send(
         ESPNOW_DATA_TYPE_RM_GROUP_CONTROL,
@@ -667,9 +680,10 @@ esp_err_t geogram_mesh_send_to_node(const uint8_t *dest_mac, const void *data, s
     );
 
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "[TX] FAILED: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "[TX] %zu bytes to " MACSTR " FAILED: %s",
+                 len, MAC2STR(dest_mac), esp_err_to_name(ret));
     } else {
-        ESP_LOGI(TAG, "[TX] SUCCESS");
+        GEOGRAM_DLOGI(TAG, "[TX] %zu bytes to " MACSTR, len, MAC2STR(dest_mac));
     }
 
     return ret;
@@ -8,13 +8,17 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
 #include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
+#include "geogram_dlog.h"
 #include "esp_mac.h"
 #include "esp_timer.h"
 #include "esp_wifi.h"
+#include "nostr_event.h"
+#include "nostr_keys.h"
 
 // LED notification for incoming chat messages (ESP32-C3)
 #if CONFIG_IDF_TARGET_ESP32C3
@@ -29,6 +33,7 @@ static const char *TAG = "mesh_chat";
 
 #define CHAT_MSG_MAGIC      0x43484154  // "CHAT"
 #define CHAT_MSG_VERSION    2           // v2 adds file message support
+#define CHAT_JSON_BATCH     4           // Messages copied from history at a time for JSON
 
 // ============================================================================
 // Wire Protocol
@@ -49,8 +54,17 @@ typedef struct __attribute__((packed)) {
     char mime_type[MESH_CHAT_MAX_MIME_LEN];        // MIME type
     // Variable length text follows
     char text[];                                    // Message text (variable)
+    // Optional: signed NOSTR event JSON after the text's NUL terminator.
+    // Older receivers ignore the trailing bytes.
 } chat_wire_msg_t;
 
+/**
+ * @brief Received message waiting for its signed event to be verified
+ */
+typedef struct {
+    mesh_chat_message_t msg;
+} pending_chat_t;
+
 // ============================================================================
 // State
 // ============================================================================
@@ -69,6 +83,7 @@ static uint8_t s_local_mac[6] = {0};
 // ============================================================================
 
 static void add_message_to_history(const mesh_chat_message_t *msg);
+static void deliver_received_message(const mesh_chat_message_t *msg);
 static uint32_t get_timestamp(void);
 
 // ============================================================================
@@ -151,10 +166,26 @@ esp_err_t mesh_chat_send(const char *text)
         callsign = "UNKNOWN";
     }
 
-    // Build wire message
-    size_t wire_len = sizeof(chat_wire_msg_t) + text_len + 1;
+    // Sign the text so receivers can tell it really comes from this station
+    char *event = malloc(NOSTR_EVENT_MAX_JSON_LEN);
+    size_t event_len = 0;
+    if (event) {
+        char signed_text[MESH_CHAT_MAX_MESSAGE_LEN + 1];
+        memcpy(signed_text, text, text_len);
+        signed_text[text_len] = '\0';
+        esp_err_t ret = nostr_sign_event(1, 0, NULL, signed_text, event, NOSTR_EVENT_MAX_JSON_LEN);
+        if (ret == ESP_OK) {
+            event_len = strlen(event);
+        } else {
+            ESP_LOGW(TAG, "[CHAT TX] Sending unsigned: %s", esp_err_to_name(ret));
+        }
+    }
+
+    // Build wire message (signed event after the text's NUL terminator)
+    size_t wire_len = sizeof(chat_wire_msg_t) + text_len + 1 + event_len;
     chat_wire_msg_t *wire_msg = malloc(wire_len);
     if (!wire_msg) {
+        free(event);
         return ESP_ERR_NO_MEM;
     }
 
@@ -172,6 +203,10 @@ esp_err_t mesh_chat_send(const char *text)
     strncpy(wire_msg->callsign, callsign, MESH_CHAT_MAX_CALLSIGN_LEN - 1);
     memcpy(wire_msg->text, text, text_len);
     wire_msg->text[text_len] = '\0';
+    if (event_len > 0) {
+        memcpy(wire_msg->text + text_len + 1, event, event_len);
+    }
+    free(event);
 
     ESP_LOGI(TAG, "[CHAT TX] Sending message #%lu: \"%.*s\"",
              (unsigned long)wire_msg->msg_id, (int)text_len, text);
@@ -181,6 +216,7 @@ esp_err_t mesh_chat_send(const char *text)
         .id = wire_msg->msg_id,
         .timestamp = wire_msg->timestamp,
         .is_local = true,
+        .verified = event_len > 0,
         .msg_type = MESH_CHAT_MSG_TEXT
     };
     memset(&local_msg.file, 0, sizeof(local_msg.file));
@@ -233,12 +269,13 @@ esp_err_t mesh_chat_send(const char *text)
 
 esp_err_t mesh_chat_add_local_message(const char *callsign, const char *text)
 {
-    return mesh_chat_add_local_message_with_timestamp(callsign, text, 0);
+    return mesh_chat_add_local_message_with_timestamp(callsign, text, 0, false);
 }
 
 esp_err_t mesh_chat_add_local_message_with_timestamp(const char *callsign,
                                                      const char *text,
-                                                     uint32_t timestamp)
+                                                     uint32_t timestamp,
+                                                     bool verified)
 {
     if (!s_initialized) {
         ESP_LOGE(TAG, "Chat not initialized");
@@ -260,6 +297,7 @@ esp_err_t mesh_chat_add_local_message_with_timestamp(const char *callsign,
     mesh_chat_message_t local_msg = {
         .timestamp = msg_timestamp,
         .is_local = true,
+        .verified = verified,
         .msg_type = MESH_CHAT_MSG_TEXT
     };
     memset(&local_msg.file, 0, sizeof(local_msg.file));
@@ -472,6 +510,43 @@ esp_err_t mesh_chat_send_file(const char *text, const uint8_t *sha1,
 // Receive Handler
 // ============================================================================
 
+/**
+ * @brief Verify task callback for signed mesh messages
+ */
+static void on_event_verified(esp_err_t result, const nostr_event_t *event, void *ctx)
+{
+    pending_chat_t *pending = (pending_chat_t *)ctx;
+
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "[CHAT RX] Rejected message from %s: bad signature (%s)",
+                 pending->msg.callsign, esp_err_to_name(result));
+        free(pending);
+        return;
+    }
+
+    // The signed content must be the text that was shown
+    char content[MESH_CHAT_MAX_MESSAGE_LEN + 1];
+    if (nostr_event_get_content(event, content, sizeof(content)) != ESP_OK ||
+        strcmp(content, pending->msg.text) != 0) {
+        ESP_LOGW(TAG, "[CHAT RX] Rejected message from %s: text does not match event",
+                 pending->msg.callsign);
+        free(pending);
+        return;
+    }
+
+    if (!nostr_keys_callsign_matches(pending->msg.callsign, event->pubkey)) {
+        ESP_LOGW(TAG, "[CHAT RX] Rejected message from %s: callsign does not match key",
+                 pending->msg.callsign);
+        free(pending);
+        return;
+    }
+
+    ESP_LOGI(TAG, "[CHAT RX] Signed message from %s verified", pending->msg.callsign);
+    pending->msg.verified = true;
+    deliver_received_message(&pending->msg);
+    free(pending);
+}
+
 void mesh_chat_handle_packet(const uint8_t *src_mac, const void *data, size_t len)
 {
     if (!s_initialized || !data || len < sizeof(chat_wire_msg_t)) {
@@ -504,22 +579,19 @@ void mesh_chat_handle_packet(const uint8_t *src_mac, const void *data, size_t le
         msg_type = (mesh_chat_msg_type_t)wire_msg->msg_type;
     }
 
-    ESP_LOGI(TAG, "[CHAT RX] ========================================");
-    ESP_LOGI(TAG, "[CHAT RX] %s from %s",
-             msg_type == MESH_CHAT_MSG_FILE ? "File" : "Message",
-             wire_msg->callsign);
-    ESP_LOGI(TAG, "[CHAT RX] MAC: " MACSTR, MAC2STR(src_mac));
-    ESP_LOGI(TAG, "[CHAT RX] ID: %lu, Time: %lu",
-             (unsigned long)wire_msg->msg_id, (unsigned long)wire_msg->timestamp);
+    // Deferred: formatting and UART output happen off the receive path
+    GEOGRAM_DLOGI(TAG, "[CHAT RX] %s from %s (" MACSTR ") id=%lu time=%lu",
+                  msg_type == MESH_CHAT_MSG_FILE ? "File" : "Message",
+                  wire_msg->callsign, MAC2STR(src_mac),
+                  (unsigned long)wire_msg->msg_id, (unsigned long)wire_msg->timestamp);
     if (msg_type == MESH_CHAT_MSG_FILE) {
-        ESP_LOGI(TAG, "[CHAT RX] File: %s (%lu bytes)",
-                 wire_msg->filename, (unsigned long)wire_msg->file_size);
+        GEOGRAM_DLOGI(TAG, "[CHAT RX] File: %s (%lu bytes)",
+                      wire_msg->filename, (unsigned long)wire_msg->file_size);
     }
     if (wire_msg->text_len > 0) {
-        ESP_LOGI(TAG, "[CHAT RX] Text: \"%.*s\"",
-                 (int)wire_msg->text_len, wire_msg->text);
+        GEOGRAM_DLOGI(TAG, "[CHAT RX] Text: \"%.*s\"",
+                      (int)wire_msg->text_len, wire_msg->text);
     }
-    ESP_LOGI(TAG, "[CHAT RX] ========================================");
 
     // Build message structure
     mesh_chat_message_t msg = {
@@ -551,18 +623,32 @@ void mesh_chat_handle_packet(const uint8_t *src_mac, const void *data, size_t le
         memset(&msg.file, 0, sizeof(msg.file));
     }
 
-    // Add to history
-    add_message_to_history(&msg);
+    // Signed messages carry the event after the text's NUL terminator. Relays
+    // of the same event are verified once thanks to the shared id cache.
+    size_t text_end = sizeof(chat_wire_msg_t) + wire_msg->text_len + 1;
+    if (len > text_end && ((const char *)data)[text_end] == '{') {
+        pending_chat_t *pending = malloc(sizeof(pending_chat_t));
+        if (!pending) {
+            ESP_LOGW(TAG, "[CHAT RX] No memory to verify signed message");
+            return;
+        }
+        memcpy(&pending->msg, &msg, sizeof(msg));
 
-    // Notify callback
-    if (s_callback) {
-        s_callback(&msg);
+        esp_err_t ret = nostr_event_verify_async((const char *)data + text_end, len - text_end,
+                                                 on_event_verified, pending);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "[CHAT RX] Dropping signed message: %s", esp_err_to_name(ret));
+            free(pending);
+        }
+        return;
     }
 
-#if CONFIG_IDF_TARGET_ESP32C3
-    // Blink blue LED 3 times to indicate incoming chat message
-    led_notify_chat();
-#endif
+    // Unsigned: older firmware or file messages, or a relay stripped the event.
+    // Kept for the history, but never shown as coming from the callsign's key.
+    if (nostr_keys_callsign_has_key(msg.callsign)) {
+        GEOGRAM_DLOGW(TAG, "[CHAT RX] Unsigned message claims %s, marked unverified", msg.callsign);
+    }
+    deliver_received_message(&msg);
 }
 
 // ============================================================================
@@ -634,107 +720,90 @@ void mesh_chat_register_callback(mesh_chat_callback_t callback)
 // JSON Builder
 // ============================================================================
 
-size_t mesh_chat_build_json(char *buffer, size_t size, uint32_t since_id)
+static void write_message_json(geo_json_builder_t *builder, const mesh_chat_message_t *msg)
 {
-    if (!buffer || size < 64) {
-        return 0;
+    geo_json_object_start(builder);
+    geo_json_add_uint(builder, "id", msg->id);
+    geo_json_add_uint(builder, "ts", msg->timestamp);
+    geo_json_add_string(builder, "from", msg->callsign);
+    geo_json_add_string(builder, "type", msg->msg_type == MESH_CHAT_MSG_FILE ? "file" : "text");
+    geo_json_add_string(builder, "text", msg->text);
+    geo_json_add_bool(builder, "local", msg->is_local);
+    geo_json_add_bool(builder, "verified", msg->verified);
+
+    if (msg->msg_type == MESH_CHAT_MSG_FILE) {
+        char sha1_hex[41];
+        for (int j = 0; j < 20; j++) {
+            sprintf(sha1_hex + j * 2, "%02x", msg->file.sha1[j]);
+        }
+        sha1_hex[40] = '\0';
+
+        geo_json_object_start_key(builder, "file");
+        geo_json_add_string(builder, "sha1", sha1_hex);
+        geo_json_add_string(builder, "name", msg->file.filename);
+        geo_json_add_uint(builder, "size", msg->file.size);
+        geo_json_add_string(builder, "mime", msg->file.mime_type);
+        geo_json_object_end(builder);
     }
 
-    // Limit batch size to reduce memory usage (especially on ESP32-C3)
-    const size_t max_batch = 20;
-    mesh_chat_message_t *messages = malloc(sizeof(mesh_chat_message_t) * max_batch);
+    geo_json_object_end(builder);
+}
+
+void mesh_chat_write_messages_json(geo_json_builder_t *builder, uint32_t since_id)
+{
+    geo_json_array_start(builder, "messages");
+
+    // Copy a few messages at a time; a streaming builder then needs no more
+    // memory for 20 messages than for one
+    mesh_chat_message_t *messages = malloc(sizeof(mesh_chat_message_t) * CHAT_JSON_BATCH);
     if (!messages) {
-        ESP_LOGE("mesh_chat", "Failed to alloc messages, free heap: %lu",
+        ESP_LOGE(TAG, "Failed to alloc messages, free heap: %lu",
                  (unsigned long)esp_get_free_heap_size());
+        geo_json_array_end(builder);
+        return;
+    }
+
+    size_t total = 0;
+    while (total < MESH_CHAT_JSON_MAX_MESSAGES) {
+        size_t want = MESH_CHAT_JSON_MAX_MESSAGES - total;
+        size_t count = mesh_chat_get_history(messages, want < CHAT_JSON_BATCH ? want : CHAT_JSON_BATCH,
+                                             since_id);
+        for (size_t i = 0; i < count; i++) {
+            write_message_json(builder, &messages[i]);
+        }
+        total += count;
+        if (count < CHAT_JSON_BATCH) {
+            break;
+        }
+        since_id = messages[count - 1].id;
+    }
+
+    free(messages);
+    geo_json_array_end(builder);
+}
+
+size_t mesh_chat_build_json(char *buffer, size_t size, uint32_t since_id)
+{
+    if (!buffer || size < 64) {
         return 0;
     }
-    size_t count = mesh_chat_get_history(messages, max_batch, since_id);
 
     // Get local callsign for identification
     extern const char *nostr_keys_get_callsign(void);
     const char *my_callsign = nostr_keys_get_callsign();
     if (!my_callsign) my_callsign = "";
 
-    size_t pos = 0;
-    pos += snprintf(buffer + pos, size - pos,
-                    "{\"messages\":[");
-
-    for (size_t i = 0; i < count; i++) {
-        if (i > 0) {
-            pos += snprintf(buffer + pos, size - pos, ",");
-        }
-
-        // Escape the text for JSON
-        char escaped_text[MESH_CHAT_MAX_MESSAGE_LEN * 2 + 1];
-        size_t esc_pos = 0;
-        for (size_t j = 0; messages[i].text[j] && esc_pos < sizeof(escaped_text) - 2; j++) {
-            char c = messages[i].text[j];
-            if (c == '"' || c == '\\') {
-                escaped_text[esc_pos++] = '\\';
-            } else if (c == '\n') {
-                escaped_text[esc_pos++] = '\\';
-                c = 'n';
-            } else if (c == '\r') {
-                continue;
-            }
-            escaped_text[esc_pos++] = c;
-        }
-        escaped_text[esc_pos] = '\0';
-
-        // Build message JSON with type
-        if (messages[i].msg_type == MESH_CHAT_MSG_FILE) {
-            // Convert SHA1 to hex string
-            char sha1_hex[41];
-            for (int j = 0; j < 20; j++) {
-                sprintf(sha1_hex + j * 2, "%02x", messages[i].file.sha1[j]);
-            }
-            sha1_hex[40] = '\0';
-
-            // Escape filename for JSON
-            char escaped_filename[MESH_CHAT_MAX_FILENAME_LEN * 2 + 1];
-            size_t fn_pos = 0;
-            for (size_t j = 0; messages[i].file.filename[j] && fn_pos < sizeof(escaped_filename) - 2; j++) {
-                char c = messages[i].file.filename[j];
-                if (c == '"' || c == '\\') {
-                    escaped_filename[fn_pos++] = '\\';
-                }
-                escaped_filename[fn_pos++] = c;
-            }
-            escaped_filename[fn_pos] = '\0';
-
-            pos += snprintf(buffer + pos, size - pos,
-                "{\"id\":%lu,\"ts\":%lu,\"from\":\"%s\",\"type\":\"file\",\"text\":\"%s\",\"local\":%s,"
-                "\"file\":{\"sha1\":\"%s\",\"name\":\"%s\",\"size\":%lu,\"mime\":\"%s\"}}",
-                (unsigned long)messages[i].id,
-                (unsigned long)messages[i].timestamp,
-                messages[i].callsign,
-                escaped_text,
-                messages[i].is_local ? "true" : "false",
-                sha1_hex,
-                escaped_filename,
-                (unsigned long)messages[i].file.size,
-                messages[i].file.mime_type);
-        } else {
-            pos += snprintf(buffer + pos, size - pos,
-                "{\"id\":%lu,\"ts\":%lu,\"from\":\"%s\",\"type\":\"text\",\"text\":\"%s\",\"local\":%s}",
-                (unsigned long)messages[i].id,
-                (unsigned long)messages[i].timestamp,
-                messages[i].callsign,
-                escaped_text,
-                messages[i].is_local ? "true" : "false");
-        }
-
-        if (pos >= size - 1) break;
-    }
+    geo_json_builder_t builder;
+    geo_json_init(&builder, buffer, size);
 
-    pos += snprintf(buffer + pos, size - pos,
-                    "],\"latest_id\":%lu,\"my_callsign\":\"%s\",\"max_len\":%d}",
-                    (unsigned long)mesh_chat_get_latest_id(),
-                    my_callsign,
-                    MESH_CHAT_MAX_MESSAGE_LEN);
+    geo_json_object_start(&builder);
+    mesh_chat_write_messages_json(&builder, since_id);
+    geo_json_add_uint(&builder, "latest_id", mesh_chat_get_latest_id());
+    geo_json_add_string(&builder, "my_callsign", my_callsign);
+    geo_json_add_int(&builder, "max_len", MESH_CHAT_MAX_MESSAGE_LEN);
+    geo_json_object_end(&builder);
 
-    free(messages);
-    return pos;
+    return geo_json_flush(&builder) ? geo_json_get_length(&builder) : 0;
 }
 
 // ============================================================================
@@ -763,6 +832,22 @@ static void add_message_to_history(const mesh_chat_message_t *msg)
     ESP_LOGD(TAG, "Message added to history (count: %zu)", s_history_count);
 }
 
+static void deliver_received_message(const mesh_chat_message_t *msg)
+{
+    // Add to history
+    add_message_to_history(msg);
+
+    // Notify callback
+    if (s_callback) {
+        s_callback(msg);
+    }
+
+#if CONFIG_IDF_TARGET_ESP32C3
+    // Blink blue LED 3 times to indicate incoming chat message
+    led_notify_chat();
+#endif
+}
+
 static uint32_t get_timestamp(void)
 {
     time_t now;
@@ -119,28 +119,6 @@ esp_err_t model_init(void) {
         ESP_LOGW(TAG, "Failed to add SHTC3 I2C device");
     }
 
-    // Initialize e-paper display
-#if HAS_EPAPER_DISPLAY
-    epaper_spi_config_t epd_config = {
-        .cs = EPD_PIN_CS,
-        .dc = EPD_PIN_DC,
-        .rst = EPD_PIN_RST,
-        .busy = EPD_PIN_BUSY,
-        .mosi = EPD_PIN_MOSI,
-        .sclk = EPD_PIN_SCK,
-        .spi_host = EPD_SPI_HOST,
-    };
-    ret = epaper_1in54_create(&epd_config, &s_display);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create e-paper display");
-    } else {
-        ret = epaper_1in54_init(s_display);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to initialize e-paper display");
-        }
-    }
-#endif
-
     // Initialize RTC
 #if HAS_RTC
     if (s_rtc_i2c != NULL) {
@@ -184,9 +162,38 @@ esp_err_t model_init(void) {
         ESP_LOGW(TAG, "Failed to create power button");
     }
 
-    // Initialize SD card
+    ESP_LOGI(TAG, "Board initialization complete");
+    return ESP_OK;
+}
+
+esp_err_t model_init_display(void) {
+#if HAS_EPAPER_DISPLAY
+    epaper_spi_config_t epd_config = {
+        .cs = EPD_PIN_CS,
+        .dc = EPD_PIN_DC,
+        .rst = EPD_PIN_RST,
+        .busy = EPD_PIN_BUSY,
+        .mosi = EPD_PIN_MOSI,
+        .sclk = EPD_PIN_SCK,
+        .spi_host = EPD_SPI_HOST,
+    };
+    esp_err_t ret = epaper_1in54_create(&epd_config, &s_display);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create e-paper display");
+        return ret;
+    }
+    ret = epaper_1in54_init(s_display);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize e-paper display");
+        return ret;
+    }
+#endif
+    return ESP_OK;
+}
+
+esp_err_t model_init_storage(void) {
 #if HAS_SDCARD
-    ret = sdcard_init();
+    esp_err_t ret = sdcard_init();
     if (ret == ESP_OK) {
         s_sdcard_mounted = true;
         ESP_LOGI(TAG, "SD card mounted (%.2f GB)", sdcard_get_capacity_gb());
@@ -195,8 +202,6 @@ esp_err_t model_init(void) {
         s_sdcard_mounted = false;
     }
 #endif
-
-    ESP_LOGI(TAG, "Board initialization complete");
     return ESP_OK;
 }
 
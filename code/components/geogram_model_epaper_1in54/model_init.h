@@ -13,12 +13,29 @@ extern "C" {
 #endif
 
 /**
- * @brief Initialize all board hardware
+ * @brief Initialize board hardware (power, I2C sensors, RTC, buttons)
+ *
+ * The e-paper panel and the SD card sit on their own buses and are brought
+ * up separately, so boot can run them alongside each other.
  *
  * @return esp_err_t ESP_OK on success
  */
 esp_err_t model_init(void);
 
+/**
+ * @brief Create and initialize the e-paper panel (after model_init)
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t model_init_display(void);
+
+/**
+ * @brief Mount the SD card if one is inserted (after model_init)
+ *
+ * @return esp_err_t ESP_OK; a missing card is not an error
+ */
+esp_err_t model_init_storage(void);
+
 /**
  * @brief Deinitialize board hardware
  *
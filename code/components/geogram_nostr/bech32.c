@@ -2,7 +2,10 @@
  * @file bech32.c
  * @brief Bech32 encoding implementation for NOSTR
  *
- * Based on the reference implementation from BIP-173.
+ * Based on the reference implementation from BIP-173. The checksum is
+ * computed with a 32-entry generator table (one lookup per symbol) and the
+ * 8-to-5 bit regrouping happens while the string is written or read, so no
+ * intermediate arrays are needed.
  */
 
 #include "bech32.h"
@@ -25,90 +28,87 @@ static const int8_t CHARSET_REV[128] = {
      1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
 };
 
+// XOR of the BCH generator terms selected by the 5 bits shifted out of the
+// checksum, so each symbol costs one lookup instead of five tests
+static const uint32_t POLYMOD_GEN[32] = {
+    0x00000000, 0x3b6a57b2, 0x26508e6d, 0x1d3ad9df,
+    0x1ea119fa, 0x25cb4e48, 0x38f19797, 0x039bc025,
+    0x3d4233dd, 0x0628646f, 0x1b12bdb0, 0x2078ea02,
+    0x23e32a27, 0x18897d95, 0x05b3a44a, 0x3ed9f3f8,
+    0x2a1462b3, 0x117e3501, 0x0c44ecde, 0x372ebb6c,
+    0x34b57b49, 0x0fdf2cfb, 0x12e5f524, 0x298fa296,
+    0x1756516e, 0x2c3c06dc, 0x3106df03, 0x0a6c88b1,
+    0x09f74894, 0x329d1f26, 0x2fa7c6f9, 0x14cd914b,
+};
+
 /**
- * @brief Compute bech32 polymod
+ * @brief Feed one 5-bit value into the checksum
  */
-static uint32_t bech32_polymod(const uint8_t *values, size_t len) {
-    uint32_t chk = 1;
-    for (size_t i = 0; i < len; i++) {
-        uint8_t top = chk >> 25;
-        chk = (chk & 0x1ffffff) << 5 ^ values[i];
-        if (top & 1) chk ^= 0x3b6a57b2;
-        if (top & 2) chk ^= 0x26508e6d;
-        if (top & 4) chk ^= 0x1ea119fa;
-        if (top & 8) chk ^= 0x3d4233dd;
-        if (top & 16) chk ^= 0x2a1462b3;
-    }
-    return chk;
+static inline uint32_t polymod_step(uint32_t chk, uint8_t value) {
+    return ((chk & 0x1ffffff) << 5) ^ value ^ POLYMOD_GEN[chk >> 25];
 }
 
 /**
- * @brief Expand HRP for checksum computation
+ * @brief Checksum state after the expanded HRP (high bits, 0, low bits)
  */
-static size_t bech32_hrp_expand(const char *hrp, uint8_t *out) {
-    size_t hrp_len = strlen(hrp);
-    size_t i;
-
-    for (i = 0; i < hrp_len; i++) {
-        out[i] = hrp[i] >> 5;
+static uint32_t hrp_polymod(const char *hrp, size_t hrp_len) {
+    uint32_t chk = 1;
+    for (size_t i = 0; i < hrp_len; i++) {
+        chk = polymod_step(chk, (uint8_t)tolower((unsigned char)hrp[i]) >> 5);
     }
-    out[hrp_len] = 0;
-    for (i = 0; i < hrp_len; i++) {
-        out[hrp_len + 1 + i] = hrp[i] & 31;
+    chk = polymod_step(chk, 0);
+    for (size_t i = 0; i < hrp_len; i++) {
+        chk = polymod_step(chk, (uint8_t)tolower((unsigned char)hrp[i]) & 31);
     }
-
-    return hrp_len * 2 + 1;
+    return chk;
 }
 
 /**
- * @brief Create bech32 checksum
+ * @brief Encode with the HRP part of the checksum already computed
  */
-static void bech32_create_checksum(const char *hrp, const uint8_t *data,
-                                   size_t data_len, uint8_t *checksum) {
-    uint8_t values[128];
-    size_t hrp_len = bech32_hrp_expand(hrp, values);
-
-    memcpy(values + hrp_len, data, data_len);
-    memset(values + hrp_len + data_len, 0, 6);
-
-    uint32_t polymod = bech32_polymod(values, hrp_len + data_len + 6) ^ 1;
+static esp_err_t encode_from_state(uint32_t chk, const char *hrp, size_t hrp_len,
+                                   const uint8_t *data, size_t data_len,
+                                   char *output, size_t output_len) {
+    size_t data5_len = (data_len * 8 + 4) / 5;
+    size_t total_len = hrp_len + 1 + data5_len + 6 + 1; // hrp + "1" + data + checksum + null
+    if (output_len < total_len) {
+        return ESP_ERR_NO_MEM;
+    }
 
-    for (int i = 0; i < 6; i++) {
-        checksum[i] = (polymod >> (5 * (5 - i))) & 31;
+    size_t pos = 0;
+    for (size_t i = 0; i < hrp_len; i++) {
+        output[pos++] = tolower((unsigned char)hrp[i]);
     }
-}
+    output[pos++] = '1';
 
-/**
- * @brief Convert 8-bit data to 5-bit groups
- */
-static esp_err_t convert_bits(const uint8_t *in, size_t in_len,
-                              uint8_t *out, size_t *out_len,
-                              int frombits, int tobits, bool pad) {
+    // Regroup 8-bit bytes into 5-bit symbols as they are written
     uint32_t acc = 0;
     int bits = 0;
-    size_t out_idx = 0;
-    size_t max_out = *out_len;
-
-    for (size_t i = 0; i < in_len; i++) {
-        acc = (acc << frombits) | in[i];
-        bits += frombits;
-        while (bits >= tobits) {
-            bits -= tobits;
-            if (out_idx >= max_out) return ESP_ERR_NO_MEM;
-            out[out_idx++] = (acc >> bits) & ((1 << tobits) - 1);
+    for (size_t i = 0; i < data_len; i++) {
+        acc = (acc << 8) | data[i];
+        bits += 8;
+        while (bits >= 5) {
+            bits -= 5;
+            uint8_t v = (acc >> bits) & 31;
+            chk = polymod_step(chk, v);
+            output[pos++] = CHARSET[v];
         }
     }
+    if (bits > 0) {
+        uint8_t v = (acc << (5 - bits)) & 31;
+        chk = polymod_step(chk, v);
+        output[pos++] = CHARSET[v];
+    }
 
-    if (pad) {
-        if (bits > 0) {
-            if (out_idx >= max_out) return ESP_ERR_NO_MEM;
-            out[out_idx++] = (acc << (tobits - bits)) & ((1 << tobits) - 1);
-        }
-    } else if (bits >= frombits || ((acc << (tobits - bits)) & ((1 << tobits) - 1))) {
-        return ESP_ERR_INVALID_ARG;
+    for (int i = 0; i < 6; i++) {
+        chk = polymod_step(chk, 0);
+    }
+    chk ^= 1;
+    for (int i = 0; i < 6; i++) {
+        output[pos++] = CHARSET[(chk >> (5 * (5 - i))) & 31];
     }
 
-    *out_len = out_idx;
+    output[pos] = '\0';
     return ESP_OK;
 }
 
@@ -119,47 +119,26 @@ esp_err_t bech32_encode(const char *hrp, const uint8_t *data, size_t data_len,
     }
 
     size_t hrp_len = strlen(hrp);
+    return encode_from_state(hrp_polymod(hrp, hrp_len), hrp, hrp_len,
+                             data, data_len, output, output_len);
+}
 
-    // Convert 8-bit data to 5-bit groups
-    uint8_t data5[64];
-    size_t data5_len = sizeof(data5);
-    esp_err_t ret = convert_bits(data, data_len, data5, &data5_len, 8, 5, true);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-
-    // Check output buffer size
-    size_t total_len = hrp_len + 1 + data5_len + 6 + 1; // hrp + "1" + data + checksum + null
-    if (output_len < total_len) {
-        return ESP_ERR_NO_MEM;
-    }
-
-    // Create checksum
-    uint8_t checksum[6];
-    bech32_create_checksum(hrp, data5, data5_len, checksum);
-
-    // Build output string
-    size_t pos = 0;
-
-    // Copy HRP (lowercase)
-    for (size_t i = 0; i < hrp_len; i++) {
-        output[pos++] = tolower((unsigned char)hrp[i]);
+esp_err_t bech32_encode_batch(const char *hrp, const uint8_t *data, size_t data_len,
+                              size_t count, char *output, size_t output_stride) {
+    if (!hrp || !data || !output) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // Add separator
-    output[pos++] = '1';
-
-    // Add data
-    for (size_t i = 0; i < data5_len; i++) {
-        output[pos++] = CHARSET[data5[i]];
-    }
+    size_t hrp_len = strlen(hrp);
+    uint32_t chk = hrp_polymod(hrp, hrp_len);
 
-    // Add checksum
-    for (int i = 0; i < 6; i++) {
-        output[pos++] = CHARSET[checksum[i]];
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = encode_from_state(chk, hrp, hrp_len, data + i * data_len, data_len,
+                                          output + i * output_stride, output_stride);
+        if (ret != ESP_OK) {
+            return ret;
+        }
     }
-
-    output[pos] = '\0';
     return ESP_OK;
 }
 
@@ -182,7 +161,7 @@ esp_err_t bech32_decode(const char *input, char *hrp, uint8_t *data, size_t *dat
         }
     }
 
-    if (sep_pos == 0 || sep_pos + 7 > input_len) {
+    if (sep_pos == 0 || sep_pos > BECH32_MAX_HRP_LEN || sep_pos + 7 > input_len) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -192,30 +171,46 @@ esp_err_t bech32_decode(const char *input, char *hrp, uint8_t *data, size_t *dat
     }
     hrp[sep_pos] = '\0';
 
-    // Decode data portion
+    // Check the checksum and regroup 5-bit symbols into bytes in one pass;
+    // the last 6 symbols are checksum only
+    uint32_t chk = hrp_polymod(hrp, sep_pos);
     size_t data5_len = input_len - sep_pos - 1;
-    uint8_t data5[64];
+    size_t payload_len = data5_len - 6;
+    size_t max_out = *data_len;
+    size_t out_idx = 0;
+    uint32_t acc = 0;
+    int bits = 0;
 
     for (size_t i = 0; i < data5_len; i++) {
-        char c = input[sep_pos + 1 + i];
-        if (c < 0 || CHARSET_REV[(unsigned char)c] == -1) {
+        unsigned char c = (unsigned char)input[sep_pos + 1 + i];
+        if (c >= 128 || CHARSET_REV[c] == -1) {
             return ESP_ERR_INVALID_ARG;
         }
-        data5[i] = CHARSET_REV[(unsigned char)c];
+        uint8_t v = (uint8_t)CHARSET_REV[c];
+        chk = polymod_step(chk, v);
+
+        if (i < payload_len) {
+            acc = (acc << 5) | v;
+            bits += 5;
+            if (bits >= 8) {
+                bits -= 8;
+                if (out_idx >= max_out) {
+                    return ESP_ERR_NO_MEM;
+                }
+                data[out_idx++] = (acc >> bits) & 0xff;
+            }
+        }
     }
 
-    // Verify checksum
-    uint8_t values[128];
-    size_t hrp_exp_len = bech32_hrp_expand(hrp, values);
-    memcpy(values + hrp_exp_len, data5, data5_len);
-
-    if (bech32_polymod(values, hrp_exp_len + data5_len) != 1) {
+    if (chk != 1) {
         return ESP_ERR_INVALID_CRC;
     }
 
-    // Remove checksum from data
-    data5_len -= 6;
+    // Leftover padding must be shorter than a symbol and all zero
+    if (bits >= 5 || (acc & ((1u << bits) - 1))) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    // Convert 5-bit to 8-bit
-    return convert_bits(data5, data5_len, data, data_len, 5, 8, false);
+    *data_len = out_idx;
+    return ESP_OK;
 }
@@ -16,6 +16,8 @@
 extern "C" {
 #endif
 
+#define BECH32_MAX_HRP_LEN      16      // Longest human-readable part accepted by decode
+
 /**
  * @brief Encode data as bech32
  *
@@ -29,11 +31,27 @@ extern "C" {
 esp_err_t bech32_encode(const char *hrp, const uint8_t *data, size_t data_len,
                         char *output, size_t output_len);
 
+/**
+ * @brief Encode many equal-length items with the same HRP
+ *
+ * The HRP part of the checksum is computed once for the whole batch.
+ *
+ * @param hrp Human-readable part (e.g., "npub")
+ * @param data `count` items of `data_len` bytes, back to back
+ * @param data_len Length of each item
+ * @param count Number of items
+ * @param output `count` strings, `output_stride` bytes apart
+ * @param output_stride Size of each output slot
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if a slot is too small
+ */
+esp_err_t bech32_encode_batch(const char *hrp, const uint8_t *data, size_t data_len,
+                              size_t count, char *output, size_t output_stride);
+
 /**
  * @brief Decode bech32 string
  *
  * @param input Bech32-encoded string
- * @param hrp Output buffer for human-readable part (at least 8 bytes)
+ * @param hrp Output buffer for human-readable part (BECH32_MAX_HRP_LEN + 1 bytes)
  * @param data Output buffer for decoded data
  * @param data_len Input: size of data buffer, Output: actual data length
  * @return ESP_OK on success
@@ -0,0 +1,897 @@
+/**
+ * @file nostr_event.c
+ * @brief NOSTR event (NIP-01) parsing, verification and signing
+ */
+
+#include "nostr_event.h"
+#include "nostr_schnorr.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "nostr_event";
+
+// Verify queue worker
+#define VERIFY_QUEUE_LEN            16
+#define VERIFY_TASK_STACK           6144
+#define VERIFY_TASK_PRIO            3
+#define VERIFY_BATCH_WINDOW_MS      20      // How long to wait for more events
+
+/**
+ * @brief Pending asynchronous verification
+ */
+typedef struct {
+    char *json;                             // Owned copy of the event JSON
+    nostr_event_verify_cb_t callback;
+    void *ctx;
+} verify_job_t;
+
+// Verified event ids (ring buffer). Only successes are cached: the id commits
+// to pubkey, kind, tags and content, so any later copy whose recomputed id
+// matches is authentic. Caching failures would let a forged copy that
+// arrives first shadow the genuine event.
+static uint8_t s_verified_ids[NOSTR_EVENT_CACHE_SIZE][NOSTR_EVENT_ID_LEN];
+static size_t s_verified_next = 0;
+static size_t s_verified_count = 0;
+static SemaphoreHandle_t s_cache_mutex = NULL;
+static QueueHandle_t s_verify_queue = NULL;
+static nostr_event_stats_t s_stats = {0};
+
+/**
+ * @brief Raw span of a JSON value inside the source text
+ */
+typedef struct {
+    const char *start;
+    size_t len;
+} json_span_t;
+
+// ============================================================================
+// Minimal JSON scanner (top-level object members only)
+// ============================================================================
+
+static const char *skip_ws(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+        p++;
+    }
+    return p;
+}
+
+// p points at the opening quote; returns pointer past the closing quote
+static const char *scan_string(const char *p) {
+    p++;
+    while (*p && *p != '"') {
+        if (*p == '\\') {
+            p++;
+            if (!*p) {
+                return NULL;
+            }
+        }
+        p++;
+    }
+    return *p == '"' ? p + 1 : NULL;
+}
+
+// Returns pointer past the value, or NULL on malformed input
+static const char *scan_value(const char *p) {
+    if (*p == '"') {
+        return scan_string(p);
+    }
+    if (*p == '[' || *p == '{') {
+        int depth = 0;
+        while (*p) {
+            if (*p == '"') {
+                p = scan_string(p);
+                if (!p) {
+                    return NULL;
+                }
+                continue;
+            }
+            if (*p == '[' || *p == '{') {
+                depth++;
+            } else if (*p == ']' || *p == '}') {
+                if (--depth == 0) {
+                    return p + 1;
+                }
+            }
+            p++;
+        }
+        return NULL;
+    }
+    // Number or literal
+    const char *start = p;
+    while (*p && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+        p++;
+    }
+    return p > start ? p : NULL;
+}
+
+static bool key_equals(const char *key_start, const char *key_end, const char *name) {
+    size_t len = (size_t)(key_end - key_start);
+    return strlen(name) == len && memcmp(key_start, name, len) == 0;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// span includes the quotes
+static bool span_to_hex(const json_span_t *span, uint8_t *out, size_t out_len) {
+    if (!span->start || span->len != out_len * 2 + 2 || span->start[0] != '"') {
+        return false;
+    }
+    const char *hex = span->start + 1;
+    for (size_t i = 0; i < out_len; i++) {
+        int hi = hex_nibble(hex[i * 2]);
+        int lo = hex_nibble(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+// JSON integer as it is hashed: optional '-', then digits without a leading zero
+static bool span_is_integer(const json_span_t *span) {
+    if (!span->start || span->len == 0 || span->len > 20) {
+        return false;
+    }
+    size_t i = span->start[0] == '-' ? 1 : 0;
+    if (i == span->len || (span->start[i] == '0' && span->len - i > 1)) {
+        return false;
+    }
+    for (; i < span->len; i++) {
+        char c = span->start[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decode one character of a JSON string body to UTF-8
+ *
+ * @param p Current position (inside the quotes)
+ * @param end End of the string body
+ * @param buf Output, 1-4 bytes
+ * @param n Number of bytes written to buf
+ * @return Position after the character, or NULL on a malformed escape
+ */
+static const char *decode_char(const char *p, const char *end, uint8_t buf[4], size_t *n) {
+    if (*p != '\\') {
+        buf[0] = (uint8_t)*p;
+        *n = 1;
+        return p + 1;
+    }
+
+    uint32_t cp;
+    p++;
+    if (p >= end) {
+        return NULL;
+    }
+    char c = *p++;
+    switch (c) {
+        case 'n': cp = '\n'; break;
+        case 'r': cp = '\r'; break;
+        case 't': cp = '\t'; break;
+        case 'b': cp = '\b'; break;
+        case 'f': cp = '\f'; break;
+        case 'u': {
+            if (end - p < 4) {
+                return NULL;
+            }
+            cp = 0;
+            for (int i = 0; i < 4; i++) {
+                int v = hex_nibble(p[i]);
+                if (v < 0) {
+                    return NULL;
+                }
+                cp = (cp << 4) | (uint32_t)v;
+            }
+            p += 4;
+            // Surrogate pair
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                uint32_t lo = 0;
+                for (int i = 0; i < 4; i++) {
+                    int v = hex_nibble(p[2 + i]);
+                    if (v < 0) {
+                        return NULL;
+                    }
+                    lo = (lo << 4) | (uint32_t)v;
+                }
+                if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                }
+            }
+            break;
+        }
+        default: cp = (uint8_t)c; break;     // \" \\ \/
+    }
+
+    if (cp < 0x80) {
+        buf[0] = (uint8_t)cp; *n = 1;
+    } else if (cp < 0x800) {
+        buf[0] = 0xC0 | (cp >> 6); buf[1] = 0x80 | (cp & 0x3F); *n = 2;
+    } else if (cp < 0x10000) {
+        buf[0] = 0xE0 | (cp >> 12); buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[2] = 0x80 | (cp & 0x3F); *n = 3;
+    } else {
+        buf[0] = 0xF0 | (cp >> 18); buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3F); buf[3] = 0x80 | (cp & 0x3F); *n = 4;
+    }
+    return p;
+}
+
+/**
+ * @brief NIP-01 escape of one byte, as produced by JSON.stringify
+ *
+ * @param c Byte of UTF-8 text
+ * @param out Output, up to 6 characters
+ * @return Number of characters written
+ */
+static size_t escape_byte(uint8_t c, char out[6]) {
+    switch (c) {
+        case '"':  memcpy(out, "\\\"", 2); return 2;
+        case '\\': memcpy(out, "\\\\", 2); return 2;
+        case '\n': memcpy(out, "\\n", 2); return 2;
+        case '\r': memcpy(out, "\\r", 2); return 2;
+        case '\t': memcpy(out, "\\t", 2); return 2;
+        case '\b': memcpy(out, "\\b", 2); return 2;
+        case '\f': memcpy(out, "\\f", 2); return 2;
+        default:
+            if (c < 0x20) {
+                static const char digits[] = "0123456789abcdef";
+                memcpy(out, "\\u00", 4);
+                out[4] = digits[c >> 4];
+                out[5] = digits[c & 0x0F];
+                return 6;
+            }
+            out[0] = (char)c;
+            return 1;
+    }
+}
+
+// ============================================================================
+// Canonical serialization hash
+// ============================================================================
+
+/**
+ * @brief SHA-256 fed through a small buffer, so byte-wise output stays cheap
+ */
+typedef struct {
+    mbedtls_sha256_context sha;
+    uint8_t buf[64];
+    size_t len;
+} id_hasher_t;
+
+static void hasher_put(id_hasher_t *h, const void *data, size_t len) {
+    if (h->len + len > sizeof(h->buf)) {
+        mbedtls_sha256_update(&h->sha, h->buf, h->len);
+        h->len = 0;
+        if (len > sizeof(h->buf)) {
+            mbedtls_sha256_update(&h->sha, (const uint8_t *)data, len);
+            return;
+        }
+    }
+    memcpy(h->buf + h->len, data, len);
+    h->len += len;
+}
+
+static void hasher_puts(id_hasher_t *h, const char *s) {
+    hasher_put(h, s, strlen(s));
+}
+
+/**
+ * @brief Hash a JSON string (span with quotes) in NIP-01 form
+ *
+ * The escapes in the source are decoded and the text is escaped again the
+ * way JSON.stringify does, so "\u00e9" and "\/" hash as "\xc3\xa9" and "/".
+ */
+static bool hasher_string(id_hasher_t *h, const char *start, size_t len) {
+    const char *p = start + 1;
+    const char *end = start + len - 1;
+    hasher_put(h, "\"", 1);
+    while (p < end) {
+        uint8_t buf[4];
+        size_t n;
+        p = decode_char(p, end, buf, &n);
+        if (!p) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            char esc[6];
+            hasher_put(h, esc, escape_byte(buf[i], esc));
+        }
+    }
+    hasher_put(h, "\"", 1);
+    return true;
+}
+
+/**
+ * @brief Hash a JSON value span in NIP-01 form: no whitespace, strings re-escaped
+ */
+static bool hasher_value(id_hasher_t *h, const char *p, size_t len) {
+    const char *end = p + len;
+    while (p < end) {
+        if (*p == '"') {
+            const char *after = scan_string(p);
+            if (!after || after > end || !hasher_string(h, p, (size_t)(after - p))) {
+                return false;
+            }
+            p = after;
+        } else if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+            p++;
+        } else {
+            hasher_put(h, p, 1);
+            p++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief NIP-01 event id: sha256 of [0,"<pubkey>",<created_at>,<kind>,<tags>,"<content>"]
+ *
+ * The serialization is rebuilt from the decoded fields (no whitespace,
+ * JSON.stringify escaping), so an event that uses other legal formatting
+ * hashes to the same id as its canonical form.
+ *
+ * @param pubkey x-only public key
+ * @param created_at Integer span
+ * @param kind Integer span
+ * @param tags Array span, NULL for []
+ * @param content String span including the quotes
+ * @param id Output
+ * @return false if a string holds a malformed escape
+ */
+static bool event_id_hash(const uint8_t pubkey[32], const json_span_t *created_at,
+                          const json_span_t *kind, const json_span_t *tags,
+                          const json_span_t *content, uint8_t id[NOSTR_EVENT_ID_LEN]) {
+    static const char digits[] = "0123456789abcdef";
+    char pubkey_hex[64];
+    for (size_t i = 0; i < 32; i++) {
+        pubkey_hex[i * 2] = digits[pubkey[i] >> 4];
+        pubkey_hex[i * 2 + 1] = digits[pubkey[i] & 0x0F];
+    }
+
+    id_hasher_t h = { .len = 0 };
+    mbedtls_sha256_init(&h.sha);
+    mbedtls_sha256_starts(&h.sha, 0);
+    hasher_puts(&h, "[0,\"");
+    hasher_put(&h, pubkey_hex, sizeof(pubkey_hex));
+    hasher_puts(&h, "\",");
+    hasher_put(&h, created_at->start, created_at->len);
+    hasher_puts(&h, ",");
+    hasher_put(&h, kind->start, kind->len);
+    hasher_puts(&h, ",");
+    bool ok = true;
+    if (tags) {
+        ok = hasher_value(&h, tags->start, tags->len);
+    } else {
+        hasher_puts(&h, "[]");
+    }
+    hasher_puts(&h, ",");
+    ok = ok && hasher_string(&h, content->start, content->len);
+    hasher_puts(&h, "]");
+    mbedtls_sha256_update(&h.sha, h.buf, h.len);
+    mbedtls_sha256_finish(&h.sha, id);
+    mbedtls_sha256_free(&h.sha);
+    return ok;
+}
+
+// ============================================================================
+// Verified event cache
+// ============================================================================
+
+static bool cache_contains(const uint8_t *id) {
+    if (!s_cache_mutex) {
+        return false;
+    }
+    bool found = false;
+    xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_verified_count; i++) {
+        if (memcmp(s_verified_ids[i], id, NOSTR_EVENT_ID_LEN) == 0) {
+            found = true;
+            s_stats.cache_hits++;
+            break;
+        }
+    }
+    xSemaphoreGive(s_cache_mutex);
+    return found;
+}
+
+static void cache_add(const uint8_t *id) {
+    if (!s_cache_mutex) {
+        return;
+    }
+    xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+    memcpy(s_verified_ids[s_verified_next], id, NOSTR_EVENT_ID_LEN);
+    s_verified_next = (s_verified_next + 1) % NOSTR_EVENT_CACHE_SIZE;
+    if (s_verified_count < NOSTR_EVENT_CACHE_SIZE) {
+        s_verified_count++;
+    }
+    xSemaphoreGive(s_cache_mutex);
+}
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+/**
+ * @brief Parse an event and check that its id matches the contents
+ */
+static esp_err_t parse_event(const char *json, nostr_event_t *event) {
+    if (!json) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_span_t id = {0}, pubkey = {0}, sig = {0}, created_at = {0};
+    json_span_t kind = {0}, tags = {0}, content = {0};
+
+    const char *p = skip_ws(json);
+    if (*p != '{') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p = skip_ws(p + 1);
+
+    while (*p && *p != '}') {
+        if (*p != '"') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        const char *key_start = p + 1;
+        const char *key_after = scan_string(p);
+        if (!key_after) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        const char *key_end = key_after - 1;
+
+        p = skip_ws(key_after);
+        if (*p != ':') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        p = skip_ws(p + 1);
+
+        const char *value_end = scan_value(p);
+        if (!value_end) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        json_span_t span = { p, (size_t)(value_end - p) };
+
+        if (key_equals(key_start, key_end, "id")) id = span;
+        else if (key_equals(key_start, key_end, "pubkey")) pubkey = span;
+        else if (key_equals(key_start, key_end, "sig")) sig = span;
+        else if (key_equals(key_start, key_end, "created_at")) created_at = span;
+        else if (key_equals(key_start, key_end, "kind")) kind = span;
+        else if (key_equals(key_start, key_end, "tags")) tags = span;
+        else if (key_equals(key_start, key_end, "content")) content = span;
+
+        p = skip_ws(value_end);
+        if (*p == ',') {
+            p = skip_ws(p + 1);
+        }
+    }
+
+    nostr_event_t ev = {0};
+    if (!span_to_hex(&id, ev.id, sizeof(ev.id)) ||
+        !span_to_hex(&pubkey, ev.pubkey, sizeof(ev.pubkey)) ||
+        !span_to_hex(&sig, ev.sig, sizeof(ev.sig)) ||
+        !span_is_integer(&created_at) || !span_is_integer(&kind) ||
+        !content.start || content.start[0] != '"') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tags.start && tags.start[0] != '[') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ev.created_at = strtoll(created_at.start, NULL, 10);
+    ev.kind = (int)strtol(kind.start, NULL, 10);
+    ev.content = content.start + 1;
+    ev.content_len = content.len - 2;
+
+    uint8_t hash[32];
+    if (!event_id_hash(ev.pubkey, &created_at, &kind, tags.start ? &tags : NULL, &content, hash)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *event = ev;
+
+    if (memcmp(hash, ev.id, sizeof(hash)) != 0) {
+        ESP_LOGW(TAG, "Event id does not match contents");
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// Verify queue
+// ============================================================================
+
+static void verify_task(void *arg) {
+    (void)arg;
+    verify_job_t jobs[NOSTR_VERIFY_BATCH_MAX];
+    const char *jsons[NOSTR_VERIFY_BATCH_MAX];
+    nostr_event_t events[NOSTR_VERIFY_BATCH_MAX];
+    esp_err_t results[NOSTR_VERIFY_BATCH_MAX];
+
+    while (1) {
+        size_t count = 0;
+        if (xQueueReceive(s_verify_queue, &jobs[0], portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        count = 1;
+
+        // Collect whatever else arrives within the window into the same batch
+        while (count < NOSTR_VERIFY_BATCH_MAX &&
+               xQueueReceive(s_verify_queue, &jobs[count],
+                             pdMS_TO_TICKS(VERIFY_BATCH_WINDOW_MS)) == pdTRUE) {
+            count++;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            jsons[i] = jobs[i].json;
+        }
+        nostr_event_verify_batch_json(jsons, count, events, results);
+
+        for (size_t i = 0; i < count; i++) {
+            if (jobs[i].callback) {
+                jobs[i].callback(results[i], results[i] == ESP_OK ? &events[i] : NULL,
+                                 jobs[i].ctx);
+            }
+            free(jobs[i].json);
+        }
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t nostr_event_init(void) {
+    if (s_cache_mutex) {
+        return ESP_OK;
+    }
+
+    // s_cache_mutex marks success, so every failure below undoes everything
+    s_cache_mutex = xSemaphoreCreateMutex();
+    s_verify_queue = xQueueCreate(VERIFY_QUEUE_LEN, sizeof(verify_job_t));
+    if (!s_cache_mutex || !s_verify_queue) {
+        goto fail;
+    }
+
+    if (xTaskCreate(verify_task, "nostr_verify", VERIFY_TASK_STACK, NULL,
+                    VERIFY_TASK_PRIO, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create verify task");
+        goto fail;
+    }
+
+    return ESP_OK;
+
+fail:
+    if (s_verify_queue) {
+        vQueueDelete(s_verify_queue);
+        s_verify_queue = NULL;
+    }
+    if (s_cache_mutex) {
+        vSemaphoreDelete(s_cache_mutex);
+        s_cache_mutex = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nostr_event_verify_json(const char *json, nostr_event_t *event) {
+    nostr_event_t ev = {0};
+    esp_err_t ret = parse_event(json, &ev);
+    if (event) {
+        *event = ev;
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (cache_contains(ev.id)) {
+        return ESP_OK;
+    }
+
+    ret = nostr_schnorr_verify(ev.sig, ev.id, ev.pubkey);
+    if (ret == ESP_OK) {
+        cache_add(ev.id);
+        return ESP_OK;
+    }
+    ESP_LOGW(TAG, "Event signature rejected: %s", esp_err_to_name(ret));
+    return ret == ESP_ERR_INVALID_ARG ? ESP_FAIL : ret;
+}
+
+esp_err_t nostr_event_verify_batch_json(const char *const *jsons, size_t count,
+                                        nostr_event_t *events, esp_err_t *results) {
+    if (!jsons || !events || !results || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool all_ok = true;
+
+    for (size_t base = 0; base < count; base += NOSTR_VERIFY_BATCH_MAX) {
+        size_t chunk = count - base;
+        if (chunk > NOSTR_VERIFY_BATCH_MAX) {
+            chunk = NOSTR_VERIFY_BATCH_MAX;
+        }
+
+        nostr_schnorr_item_t items[NOSTR_VERIFY_BATCH_MAX];
+        esp_err_t item_results[NOSTR_VERIFY_BATCH_MAX];
+        size_t item_index[NOSTR_VERIFY_BATCH_MAX];
+        int dup_of[NOSTR_VERIFY_BATCH_MAX];
+        size_t n = 0;
+
+        for (size_t i = base; i < base + chunk; i++) {
+            dup_of[i - base] = -1;
+            results[i] = parse_event(jsons[i], &events[i]);
+            if (results[i] != ESP_OK || cache_contains(events[i].id)) {
+                continue;
+            }
+
+            // The same event relayed twice in one burst is verified once
+            for (size_t k = 0; k < n; k++) {
+                if (memcmp(events[item_index[k]].id, events[i].id, NOSTR_EVENT_ID_LEN) == 0) {
+                    dup_of[i - base] = (int)item_index[k];
+                    break;
+                }
+            }
+            if (dup_of[i - base] >= 0) {
+                continue;
+            }
+
+            items[n].sig = events[i].sig;
+            items[n].msg = events[i].id;
+            items[n].pubkey = events[i].pubkey;
+            item_index[n] = i;
+            n++;
+        }
+
+        if (n > 0) {
+            nostr_schnorr_verify_batch(items, n, item_results);
+            for (size_t k = 0; k < n; k++) {
+                size_t i = item_index[k];
+                if (item_results[k] == ESP_OK) {
+                    results[i] = ESP_OK;
+                    cache_add(events[i].id);
+                } else {
+                    results[i] = item_results[k] == ESP_ERR_INVALID_STATE ?
+                                 ESP_ERR_INVALID_STATE : ESP_FAIL;
+                }
+            }
+        }
+
+        for (size_t i = base; i < base + chunk; i++) {
+            if (dup_of[i - base] >= 0) {
+                results[i] = results[dup_of[i - base]];
+            }
+            if (results[i] != ESP_OK) {
+                all_ok = false;
+            }
+        }
+    }
+
+    if (s_cache_mutex) {
+        xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+        s_stats.batched += count;
+        xSemaphoreGive(s_cache_mutex);
+    }
+
+    return all_ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nostr_event_verify_async(const char *json, size_t len,
+                                   nostr_event_verify_cb_t callback, void *ctx) {
+    if (!json || len == 0 || len > NOSTR_EVENT_MAX_JSON_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_verify_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    verify_job_t job = {
+        .json = malloc(len + 1),
+        .callback = callback,
+        .ctx = ctx,
+    };
+    if (!job.json) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(job.json, json, len);
+    job.json[len] = '\0';
+
+    if (xQueueSend(s_verify_queue, &job, 0) != pdTRUE) {
+        free(job.json);
+        xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+        s_stats.queue_drops++;
+        xSemaphoreGive(s_cache_mutex);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+void nostr_event_get_stats(nostr_event_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+    if (!s_cache_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    stats->cached_ids = (uint32_t)s_verified_count;
+    xSemaphoreGive(s_cache_mutex);
+}
+
+// ============================================================================
+// Signing
+// ============================================================================
+
+/**
+ * @brief Bounded output buffer for building a signed event
+ */
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t pos;
+    bool overflow;
+} event_writer_t;
+
+static void writer_put(event_writer_t *w, const char *s, size_t len) {
+    if (w->overflow || w->pos + len >= w->cap) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->pos, s, len);
+    w->pos += len;
+}
+
+static void writer_puts(event_writer_t *w, const char *s) {
+    writer_put(w, s, strlen(s));
+}
+
+static void writer_hex(event_writer_t *w, const uint8_t *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len && !w->overflow; i++) {
+        char pair[2] = { digits[data[i] >> 4], digits[data[i] & 0x0F] };
+        writer_put(w, pair, 2);
+    }
+}
+
+// NIP-01 string escaping, as produced by JSON.stringify
+static void writer_escaped(event_writer_t *w, const char *s) {
+    for (; *s && !w->overflow; s++) {
+        char esc[6];
+        writer_put(w, esc, escape_byte((uint8_t)*s, esc));
+    }
+}
+
+esp_err_t nostr_sign_event(int kind, int64_t created_at, const char *tags_json,
+                           const char *content, char *out, size_t out_len) {
+    if (!content || !out || out_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t pubkey[32];
+    esp_err_t ret = nostr_schnorr_get_signing_pubkey(pubkey);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (created_at == 0) {
+        created_at = (int64_t)time(NULL);
+    }
+    if (!tags_json) {
+        tags_json = "[]";
+    }
+
+    char number[24];
+    event_writer_t w = { out, out_len, 0, false };
+
+    // Write the event with a blank id and sig, remembering where the fields
+    // that make up the canonical serialization start
+    writer_puts(&w, "{\"id\":\"");
+    size_t id_pos = w.pos;
+    for (int i = 0; i < NOSTR_EVENT_ID_LEN * 2; i++) {
+        writer_put(&w, "0", 1);
+    }
+    writer_puts(&w, "\",\"pubkey\":\"");
+    writer_hex(&w, pubkey, sizeof(pubkey));
+    writer_put(&w, "\"", 1);
+    writer_puts(&w, ",\"created_at\":");
+    size_t created_start = w.pos;
+    snprintf(number, sizeof(number), "%lld", (long long)created_at);
+    writer_puts(&w, number);
+    size_t created_end = w.pos;
+    writer_puts(&w, ",\"kind\":");
+    size_t kind_start = w.pos;
+    snprintf(number, sizeof(number), "%d", kind);
+    writer_puts(&w, number);
+    size_t kind_end = w.pos;
+    writer_puts(&w, ",\"tags\":");
+    size_t tags_start = w.pos;
+    writer_puts(&w, tags_json);
+    size_t tags_end = w.pos;
+    writer_puts(&w, ",\"content\":");
+    size_t content_start = w.pos;
+    writer_put(&w, "\"", 1);
+    writer_escaped(&w, content);
+    writer_put(&w, "\"", 1);
+    size_t content_end = w.pos;
+    writer_puts(&w, ",\"sig\":\"");
+    size_t sig_pos = w.pos;
+    for (int i = 0; i < NOSTR_SCHNORR_SIG_LEN * 2; i++) {
+        writer_put(&w, "0", 1);
+    }
+    writer_puts(&w, "\"}");
+    if (w.overflow) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    out[w.pos] = '\0';
+
+    // The caller's tags are hashed in canonical form, whatever their spacing
+    json_span_t created_span = { out + created_start, created_end - created_start };
+    json_span_t kind_span = { out + kind_start, kind_end - kind_start };
+    json_span_t tags_span = { out + tags_start, tags_end - tags_start };
+    json_span_t content_span = { out + content_start, content_end - content_start };
+    uint8_t id[NOSTR_EVENT_ID_LEN];
+    if (!event_id_hash(pubkey, &created_span, &kind_span, &tags_span, &content_span, id)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t sig[NOSTR_SCHNORR_SIG_LEN];
+    ret = nostr_schnorr_sign(id, sig);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Fill in the placeholders (same length, so nothing moves)
+    event_writer_t fill = { out + id_pos, NOSTR_EVENT_ID_LEN * 2 + 1, 0, false };
+    writer_hex(&fill, id, sizeof(id));
+    fill = (event_writer_t){ out + sig_pos, NOSTR_SCHNORR_SIG_LEN * 2 + 1, 0, false };
+    writer_hex(&fill, sig, sizeof(sig));
+
+    // Our own events never need verifying when they come back over the mesh
+    cache_add(id);
+    return ESP_OK;
+}
+
+esp_err_t nostr_event_get_content(const nostr_event_t *event, char *out, size_t out_len) {
+    if (!event || !event->content || !out || out_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *p = event->content;
+    const char *end = p + event->content_len;
+    size_t pos = 0;
+
+    while (p < end) {
+        uint8_t buf[4];
+        size_t n;
+        p = decode_char(p, end, buf, &n);
+        if (!p) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (pos + n >= out_len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out + pos, buf, n);
+        pos += n;
+    }
+
+    out[pos] = '\0';
+    return ESP_OK;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file nostr_event.h
+ * @brief NOSTR event (NIP-01) parsing, verification and signing
+ *
+ * Events arrive as the JSON produced by the chat page (JSON.stringify of a
+ * signed event) or by other clients. The id is recomputed by hashing the
+ * canonical serialization [0,pubkey,created_at,kind,tags,content], rebuilt
+ * from the decoded fields so whitespace and escape choices in the source do
+ * not matter, then the BIP-340 signature over the id is checked.
+ *
+ * Verified ids are remembered, so an event that reaches the station over
+ * several paths (HTTP, WebSocket, mesh relay) is only verified once. Events
+ * that do not need an immediate answer can be queued with
+ * nostr_event_verify_async(); a worker task verifies them in batches.
+ *
+ * nostr_sign_event() produces events signed with the station key.
+ */
+
+#ifndef GEOGRAM_NOSTR_EVENT_H
+#define GEOGRAM_NOSTR_EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NOSTR_EVENT_ID_LEN          32
+#define NOSTR_EVENT_CACHE_SIZE      64      // Verified event ids remembered
+#define NOSTR_EVENT_MAX_JSON_LEN    1024    // Largest event accepted for queueing
+
+/**
+ * @brief Parsed NOSTR event
+ *
+ * `content` points into the source JSON and is still JSON-escaped; use
+ * nostr_event_get_content() to obtain the decoded text.
+ */
+typedef struct {
+    uint8_t id[NOSTR_EVENT_ID_LEN];
+    uint8_t pubkey[32];
+    uint8_t sig[64];
+    int64_t created_at;
+    int kind;
+    const char *content;
+    size_t content_len;
+} nostr_event_t;
+
+/**
+ * @brief Event verification statistics
+ */
+typedef struct {
+    uint32_t cache_hits;        // Events accepted from the verified-id cache
+    uint32_t cached_ids;        // Ids currently cached
+    uint32_t batched;           // Events that went through batch verification
+    uint32_t queue_drops;       // Async submissions rejected (queue full)
+} nostr_event_stats_t;
+
+/**
+ * @brief Completion callback for nostr_event_verify_async()
+ *
+ * Runs on the verify task. `event` is only valid during the call and is
+ * NULL unless `result` is ESP_OK.
+ */
+typedef void (*nostr_event_verify_cb_t)(esp_err_t result, const nostr_event_t *event, void *ctx);
+
+/**
+ * @brief Initialize the verified-id cache and start the verify task
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t nostr_event_init(void);
+
+/**
+ * @brief Parse an event and verify its id and signature
+ *
+ * @param json Null-terminated event JSON
+ * @param event Output (may be NULL)
+ * @return ESP_OK if the event is authentic,
+ *         ESP_ERR_INVALID_ARG if required fields are missing or malformed,
+ *         ESP_ERR_INVALID_CRC if the id does not match the event contents,
+ *         ESP_FAIL if the signature is invalid
+ */
+esp_err_t nostr_event_verify_json(const char *json, nostr_event_t *event);
+
+/**
+ * @brief Verify several events, batching the signature checks
+ *
+ * Events already in the verified-id cache and duplicates within the batch
+ * skip the signature check.
+ *
+ * @param jsons Null-terminated event JSON strings
+ * @param count Number of events
+ * @param events Output, one per input
+ * @param results Per-event result (same codes as nostr_event_verify_json)
+ * @return ESP_OK if all events are authentic, ESP_FAIL otherwise
+ */
+esp_err_t nostr_event_verify_batch_json(const char *const *jsons, size_t count,
+                                        nostr_event_t *events, esp_err_t *results);
+
+/**
+ * @brief Queue an event for batched verification
+ *
+ * The JSON is copied; the callback fires on the verify task.
+ *
+ * @param json Event JSON (need not be null-terminated)
+ * @param len Length of json
+ * @param callback Completion callback (may be NULL)
+ * @param ctx Passed to the callback
+ * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the queue is full,
+ *         ESP_ERR_INVALID_STATE before nostr_event_init()
+ */
+esp_err_t nostr_event_verify_async(const char *json, size_t len,
+                                   nostr_event_verify_cb_t callback, void *ctx);
+
+/**
+ * @brief Get event verification statistics
+ *
+ * @param stats Output structure
+ */
+void nostr_event_get_stats(nostr_event_stats_t *stats);
+
+/**
+ * @brief Build and sign an event with the station key
+ *
+ * The output is a complete event object ready to be sent as-is. Its id is
+ * added to the verified-id cache, so copies relayed back to the station are
+ * not verified again.
+ *
+ * @param kind Event kind (1 for text notes)
+ * @param created_at Unix time in seconds (0 for now)
+ * @param tags_json Tags as a JSON array (NULL for [])
+ * @param content Content as UTF-8 text (escaped here)
+ * @param out Output buffer for the event JSON
+ * @param out_len Size of output buffer
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer is too small,
+ *         ESP_ERR_INVALID_STATE if no signing key is loaded
+ */
+esp_err_t nostr_sign_event(int kind, int64_t created_at, const char *tags_json,
+                           const char *content, char *out, size_t out_len);
+
+/**
+ * @brief Decode the event content into a buffer
+ *
+ * @param event Parsed event
+ * @param out Output buffer
+ * @param out_len Size of output buffer
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t nostr_event_get_content(const nostr_event_t *event, char *out, size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_NOSTR_EVENT_H
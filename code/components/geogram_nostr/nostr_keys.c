@@ -7,6 +7,8 @@
 
 #include "nostr_keys.h"
 #include "bech32.h"
+#include "nostr_schnorr.h"
+#include "nostr_event.h"
 
 #include <string.h>
 #include <ctype.h>
@@ -155,6 +157,37 @@ esp_err_t nostr_keys_derive_callsign(const char *npub, char *callsign) {
     return ESP_OK;
 }
 
+bool nostr_keys_callsign_has_key(const char *callsign) {
+    if (!callsign || strlen(callsign) != 6 || callsign[0] != 'X' || !isdigit((unsigned char)callsign[1])) {
+        return false;
+    }
+    // npub characters are bech32 (no 1, b, i or o), shown in upper case
+    for (int i = 2; i < 6; i++) {
+        char c = (char)tolower((unsigned char)callsign[i]);
+        if (!isupper((unsigned char)callsign[i]) && !isdigit((unsigned char)callsign[i])) {
+            return false;
+        }
+        if (strchr("qpzry9x8gf2tvdw0s3jn54khce6mua7l", c) == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool nostr_keys_callsign_matches(const char *callsign, const uint8_t *pubkey) {
+    char npub[NOSTR_NPUB_LEN + 16];
+    if (!nostr_keys_callsign_has_key(callsign) || !pubkey ||
+        bech32_encode("npub", pubkey, NOSTR_PUBLIC_KEY_LEN, npub, sizeof(npub)) != ESP_OK) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (callsign[2 + i] != toupper((unsigned char)npub[5 + i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @brief Save keys to NVS
  */
@@ -220,6 +253,21 @@ static esp_err_t load_keys_from_nvs(nostr_keys_t *keys) {
     return ESP_OK;
 }
 
+/**
+ * @brief Hand the private key to the signer
+ */
+static void load_signing_key(const nostr_keys_t *keys) {
+    uint8_t pubkey[NOSTR_PUBLIC_KEY_LEN];
+    esp_err_t ret = nostr_schnorr_set_signing_key(keys->private_key, pubkey);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Signing unavailable: %s", esp_err_to_name(ret));
+        return;
+    }
+    if (memcmp(pubkey, keys->public_key, NOSTR_PUBLIC_KEY_LEN) != 0) {
+        ESP_LOGE(TAG, "Stored public key does not match the private key");
+    }
+}
+
 esp_err_t nostr_keys_init(void) {
     if (s_initialized) {
         return ESP_OK;
@@ -249,6 +297,13 @@ esp_err_t nostr_keys_init(void) {
         }
     }
 
+    // Signature verification does not depend on our own keys; keep going without it
+    if (nostr_schnorr_init() != ESP_OK || nostr_event_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Schnorr verifier unavailable, signed events will be rejected");
+    } else {
+        load_signing_key(&s_keys);
+    }
+
     s_initialized = true;
     ESP_LOGI(TAG, "NOSTR keys initialized - callsign: %s", s_keys.callsign);
 
@@ -282,6 +337,11 @@ esp_err_t nostr_keys_generate(void) {
         ESP_LOGW(TAG, "Failed to save keys to NVS (keys still usable in RAM)");
     }
 
+    // Keys replaced at runtime: switch the signer over too
+    if (s_initialized) {
+        load_signing_key(&s_keys);
+    }
+
     ESP_LOGI(TAG, "Generated new keys - callsign: %s", s_keys.callsign);
 
     return ESP_OK;
@@ -93,6 +93,27 @@ bool nostr_keys_available(void);
  */
 esp_err_t nostr_keys_derive_callsign(const char *npub, char *callsign);
 
+/**
+ * @brief Check whether a callsign is derived from a key
+ *
+ * Key-bearing callsigns are 'X', a digit and 4 npub characters (X1 for
+ * chat users, X3 for stations). Messages under them can be checked against
+ * a signature; other callsigns are free-form names.
+ *
+ * @param callsign Null-terminated callsign
+ * @return true for the XnXXXX form
+ */
+bool nostr_keys_callsign_has_key(const char *callsign);
+
+/**
+ * @brief Check that a key-bearing callsign belongs to a public key
+ *
+ * @param callsign Null-terminated callsign (XnXXXX)
+ * @param pubkey x-only public key (NOSTR_PUBLIC_KEY_LEN bytes)
+ * @return true if the 4 characters after the prefix are the key's npub ones
+ */
+bool nostr_keys_callsign_matches(const char *callsign, const uint8_t *pubkey);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,555 @@
+/**
+ * @file nostr_schnorr.c
+ * @brief BIP-340 Schnorr signing and verification
+ */
+
+#include "nostr_schnorr.h"
+#include "secp256k1.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "nostr_schnorr";
+
+#define CHALLENGE_TAG       "BIP0340/challenge"
+#define AUX_TAG             "BIP0340/aux"
+#define NONCE_TAG           "BIP0340/nonce"
+
+/**
+ * @brief Cached public key with its odd-multiples table
+ */
+typedef struct {
+    uint8_t xonly[32];
+    secp_ge_storage table[SECP_TABLE_SIZE_P];
+    uint32_t last_used;
+    bool valid;
+} pubkey_cache_entry_t;
+
+// Odd multiples of G, built once at init
+static secp_ge_storage s_table_g[SECP_TABLE_SIZE_G];
+
+// SHA256 state after absorbing SHA256(tag) || SHA256(tag) (one full block)
+static mbedtls_sha256_context s_challenge_midstate;
+
+/**
+ * @brief Station signing key and its precomputed nonce state
+ */
+typedef struct {
+    secp_scalar seckey;                 // Negated if needed so that P has even y
+    uint8_t pubkey[32];
+    mbedtls_sha256_context nonce_midstate;  // After tag || tag || t || P (two blocks)
+    bool valid;
+} signing_ctx_t;
+
+// Comb table for k*G, built once at init, and its blinding (redrawn per key)
+static secp_ge_storage s_comb_g[SECP_COMB_TABLE_SIZE - 1];
+static secp_gen_blind s_gen_blind;
+static signing_ctx_t s_signer;
+
+static pubkey_cache_entry_t s_pubkey_cache[NOSTR_VERIFY_PUBKEY_CACHE_SIZE];
+static uint32_t s_cache_clock = 0;
+
+static nostr_schnorr_stats_t s_stats = {0};
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_initialized = false;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/**
+ * @brief Look up a public key, building its table on a miss
+ *
+ * Copies the table into `table` so the caller can run the multiplication
+ * without holding the lock.
+ */
+static esp_err_t get_pubkey_table(const uint8_t *pubkey, secp_ge_storage *table) {
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    pubkey_cache_entry_t *victim = &s_pubkey_cache[0];
+    for (int i = 0; i < NOSTR_VERIFY_PUBKEY_CACHE_SIZE; i++) {
+        pubkey_cache_entry_t *entry = &s_pubkey_cache[i];
+        if (entry->valid && memcmp(entry->xonly, pubkey, 32) == 0) {
+            entry->last_used = ++s_cache_clock;
+            memcpy(table, entry->table, sizeof(entry->table));
+            s_stats.cache_hits++;
+            xSemaphoreGive(s_mutex);
+            return ESP_OK;
+        }
+        if (!entry->valid) {
+            victim = entry;
+        } else if (victim->valid && entry->last_used < victim->last_used) {
+            victim = entry;
+        }
+    }
+    s_stats.cache_misses++;
+    xSemaphoreGive(s_mutex);
+
+    // Miss: lift_x and build the table outside the lock
+    secp_fe px;
+    secp_ge p;
+    if (!secp_fe_set_b32(&px, pubkey) || !secp_ge_set_xonly(&p, &px)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    secp_ecmult_odd_table(table, &p, SECP_TABLE_SIZE_P);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(victim->xonly, pubkey, 32);
+    memcpy(victim->table, table, sizeof(victim->table));
+    victim->last_used = ++s_cache_clock;
+    victim->valid = true;
+    xSemaphoreGive(s_mutex);
+
+    return ESP_OK;
+}
+
+static void compute_challenge(const uint8_t *r, const uint8_t *pubkey, const uint8_t *msg,
+                              secp_scalar *e) {
+    mbedtls_sha256_context ctx;
+    uint8_t hash[32];
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_clone(&ctx, &s_challenge_midstate);
+    mbedtls_sha256_update(&ctx, r, 32);
+    mbedtls_sha256_update(&ctx, pubkey, 32);
+    mbedtls_sha256_update(&ctx, msg, 32);
+    mbedtls_sha256_finish(&ctx, hash);
+    mbedtls_sha256_free(&ctx);
+
+    secp_scalar_set_b32(e, hash);
+}
+
+static void tagged_midstate(mbedtls_sha256_context *ctx, const char *tag) {
+    uint8_t tag_hash[32];
+    mbedtls_sha256((const uint8_t *)tag, strlen(tag), tag_hash, 0);
+    mbedtls_sha256_init(ctx);
+    mbedtls_sha256_starts(ctx, 0);
+    mbedtls_sha256_update(ctx, tag_hash, sizeof(tag_hash));
+    mbedtls_sha256_update(ctx, tag_hash, sizeof(tag_hash));
+}
+
+static esp_err_t verify_internal(const uint8_t *sig, const uint8_t *msg, const uint8_t *pubkey) {
+    secp_fe rx;
+    secp_scalar s, e;
+    secp_ge_storage table_p[SECP_TABLE_SIZE_P];
+
+    if (!secp_fe_set_b32(&rx, sig)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (secp_scalar_set_b32(&s, sig + 32)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = get_pubkey_table(pubkey, table_p);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // R = s*G - e*P
+    compute_challenge(sig, pubkey, msg, &e);
+    secp_scalar_negate(&e, &e);
+
+    secp_gej rj;
+    secp_ecmult(&rj, s_table_g, &s, table_p, &e);
+    if (rj.infinity) {
+        return ESP_FAIL;
+    }
+
+    // Cheap x check in Jacobian form (X == r * Z^2) before the inversion
+    secp_fe z2, rz2;
+    secp_fe_sqr(&z2, &rj.z);
+    secp_fe_mul(&rz2, &rx, &z2);
+    if (!secp_fe_equal(&rz2, &rj.x)) {
+        return ESP_FAIL;
+    }
+
+    secp_ge r;
+    secp_ge_set_gej(&r, &rj);
+    if (secp_fe_is_odd(&r.y)) {
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Batch equation over up to NOSTR_VERIFY_BATCH_MAX signatures
+ *
+ * Returns ESP_OK only if the combined equation holds; any other result
+ * means the caller must fall back to individual verification.
+ */
+static esp_err_t verify_batch_internal(const nostr_schnorr_item_t *items, size_t count) {
+    // Tables [0, count) are the public keys, [count, 2*count) the negated R points
+    secp_ge_storage *tables = malloc(2 * count * SECP_TABLE_SIZE_P * sizeof(secp_ge_storage));
+    secp_scalar *scalars = malloc(2 * count * sizeof(secp_scalar));
+    secp_ge *r_points = malloc(count * sizeof(secp_ge));
+    esp_err_t ret = ESP_OK;
+
+    if (!tables || !scalars || !r_points) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    secp_scalar sum_s;
+    secp_scalar_set_int(&sum_s, 0);
+
+    for (size_t i = 0; i < count; i++) {
+        const nostr_schnorr_item_t *item = &items[i];
+        secp_fe rx;
+        secp_scalar s, e, a;
+
+        if (!secp_fe_set_b32(&rx, item->sig) || secp_scalar_set_b32(&s, item->sig + 32)) {
+            ret = ESP_ERR_INVALID_ARG;
+            goto cleanup;
+        }
+        ret = get_pubkey_table(item->pubkey, tables + i * SECP_TABLE_SIZE_P);
+        if (ret != ESP_OK) {
+            goto cleanup;
+        }
+        if (!secp_ge_set_xonly(&r_points[i], &rx)) {
+            ret = ESP_FAIL;
+            goto cleanup;
+        }
+        secp_ge_neg(&r_points[i], &r_points[i]);
+
+        // a_0 = 1, the rest random 128-bit
+        secp_scalar_set_int(&a, 1);
+        if (i > 0) {
+            esp_fill_random(a.d, 16);
+        }
+
+        compute_challenge(item->sig, item->pubkey, item->msg, &e);
+
+        // P_i scalar: -(a_i * e_i); R_i is negated, so its scalar is just a_i
+        secp_scalar_mul(&e, &e, &a);
+        secp_scalar_negate(&scalars[i], &e);
+        scalars[count + i] = a;
+
+        secp_scalar_mul(&s, &s, &a);
+        secp_scalar_add(&sum_s, &sum_s, &s);
+    }
+
+    if (!secp_ecmult_odd_tables(tables + count * SECP_TABLE_SIZE_P, r_points, count)) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    secp_gej result;
+    if (!secp_ecmult_multi(&result, s_table_g, &sum_s, tables, scalars, 2 * count)) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    ret = result.infinity ? ESP_OK : ESP_FAIL;
+
+cleanup:
+    free(tables);
+    free(scalars);
+    free(r_points);
+    return ret;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Draw a fresh blinding for the signing comb
+ */
+static void draw_gen_blind(secp_gen_blind *blind) {
+    uint8_t seed[64];
+    do {
+        esp_fill_random(seed, sizeof(seed));
+    } while (!secp_ecmult_gen_blind(blind, s_comb_g, seed));
+    mbedtls_platform_zeroize(seed, sizeof(seed));
+}
+
+esp_err_t nostr_schnorr_init(void) {
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (!secp_ecmult_odd_table(s_table_g, &secp_ge_generator, SECP_TABLE_SIZE_G) ||
+        !secp_ecmult_gen_table(s_comb_g)) {
+        ESP_LOGE(TAG, "Failed to build G tables");
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    tagged_midstate(&s_challenge_midstate, CHALLENGE_TAG);
+    draw_gen_blind(&s_gen_blind);
+
+    memset(s_pubkey_cache, 0, sizeof(s_pubkey_cache));
+    mbedtls_sha256_init(&s_signer.nonce_midstate);
+    s_initialized = true;
+
+    ESP_LOGI(TAG, "Schnorr ready (G tables %u bytes, %lld us)",
+             (unsigned)(sizeof(s_table_g) + sizeof(s_comb_g)),
+             (long long)(esp_timer_get_time() - start));
+    return ESP_OK;
+}
+
+esp_err_t nostr_schnorr_verify(const uint8_t *sig, const uint8_t *msg, const uint8_t *pubkey) {
+    if (!sig || !msg || !pubkey) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = verify_internal(sig, msg, pubkey);
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        s_stats.verified++;
+    } else {
+        s_stats.rejected++;
+    }
+    s_stats.total_time_us += (uint64_t)elapsed;
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+esp_err_t nostr_schnorr_verify_batch(const nostr_schnorr_item_t *items, size_t count,
+                                     esp_err_t *results) {
+    if (!items || !results || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (count > NOSTR_VERIFY_BATCH_MAX) {
+        esp_err_t first = nostr_schnorr_verify_batch(items, NOSTR_VERIFY_BATCH_MAX, results);
+        esp_err_t rest = nostr_schnorr_verify_batch(items + NOSTR_VERIFY_BATCH_MAX,
+                                                    count - NOSTR_VERIFY_BATCH_MAX,
+                                                    results + NOSTR_VERIFY_BATCH_MAX);
+        return (first == ESP_OK && rest == ESP_OK) ? ESP_OK : ESP_FAIL;
+    }
+
+    if (count > 1) {
+        int64_t start = esp_timer_get_time();
+        esp_err_t ret = verify_batch_internal(items, count);
+        int64_t elapsed = esp_timer_get_time() - start;
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_stats.total_time_us += (uint64_t)elapsed;
+        if (ret == ESP_OK) {
+            s_stats.batches++;
+            s_stats.verified += count;
+        } else {
+            s_stats.batch_fallbacks++;
+        }
+        xSemaphoreGive(s_mutex);
+
+        if (ret == ESP_OK) {
+            for (size_t i = 0; i < count; i++) {
+                results[i] = ESP_OK;
+            }
+            return ESP_OK;
+        }
+    }
+
+    // Single item, or the batch equation failed: find the bad signatures
+    bool all_ok = true;
+    for (size_t i = 0; i < count; i++) {
+        results[i] = nostr_schnorr_verify(items[i].sig, items[i].msg, items[i].pubkey);
+        if (results[i] != ESP_OK) {
+            all_ok = false;
+        }
+    }
+    return all_ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nostr_schnorr_set_signing_key(const uint8_t *seckey, uint8_t *pubkey) {
+    if (!seckey) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    signing_ctx_t ctx;
+    if (secp_scalar_set_b32(&ctx.seckey, seckey) || secp_scalar_is_zero(&ctx.seckey)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // New key, new blinding
+    secp_gen_blind blind;
+    draw_gen_blind(&blind);
+
+    // P = d*G; BIP-340 keys are x-only, so flip d if P has odd y
+    secp_gej pj;
+    secp_ge p;
+    secp_ecmult_gen(&pj, s_comb_g, &blind, &ctx.seckey);
+    secp_ge_set_gej(&p, &pj);
+    if (secp_fe_is_odd(&p.y)) {
+        secp_scalar_negate(&ctx.seckey, &ctx.seckey);
+    }
+    secp_fe_get_b32(ctx.pubkey, &p.x);
+
+    // t = d xor H_aux(a). The auxiliary randomness is drawn once per key, so
+    // the nonce hash can be absorbed up to the message: each signature then
+    // hashes a single block, and the nonce stays unique per message.
+    uint8_t aux[32], t[32], d_bytes[32];
+    mbedtls_sha256_context aux_ctx;
+    esp_fill_random(aux, sizeof(aux));
+    tagged_midstate(&aux_ctx, AUX_TAG);
+    mbedtls_sha256_update(&aux_ctx, aux, sizeof(aux));
+    mbedtls_sha256_finish(&aux_ctx, t);
+    mbedtls_sha256_free(&aux_ctx);
+
+    secp_scalar_get_b32(d_bytes, &ctx.seckey);
+    for (int i = 0; i < 32; i++) {
+        t[i] ^= d_bytes[i];
+    }
+    tagged_midstate(&ctx.nonce_midstate, NONCE_TAG);
+    mbedtls_sha256_update(&ctx.nonce_midstate, t, sizeof(t));
+    mbedtls_sha256_update(&ctx.nonce_midstate, ctx.pubkey, sizeof(ctx.pubkey));
+    mbedtls_platform_zeroize(d_bytes, sizeof(d_bytes));
+    mbedtls_platform_zeroize(t, sizeof(t));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_signer.seckey = ctx.seckey;
+    s_gen_blind = blind;
+    memcpy(s_signer.pubkey, ctx.pubkey, sizeof(s_signer.pubkey));
+    mbedtls_sha256_clone(&s_signer.nonce_midstate, &ctx.nonce_midstate);
+    s_signer.valid = true;
+    xSemaphoreGive(s_mutex);
+
+    mbedtls_sha256_free(&ctx.nonce_midstate);
+    mbedtls_platform_zeroize(&ctx.seckey, sizeof(ctx.seckey));
+
+    if (pubkey) {
+        memcpy(pubkey, ctx.pubkey, 32);
+    }
+    return ESP_OK;
+}
+
+esp_err_t nostr_schnorr_get_signing_pubkey(uint8_t *pubkey) {
+    if (!pubkey) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool valid = s_signer.valid;
+    if (valid) {
+        memcpy(pubkey, s_signer.pubkey, 32);
+    }
+    xSemaphoreGive(s_mutex);
+
+    return valid ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t nostr_schnorr_sign(const uint8_t *msg, uint8_t *sig) {
+    if (!msg || !sig) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    secp_scalar d;
+    secp_gen_blind blind;
+    uint8_t pubkey[32];
+    mbedtls_sha256_context nonce;
+    mbedtls_sha256_init(&nonce);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool valid = s_signer.valid;
+    if (valid) {
+        d = s_signer.seckey;
+        blind = s_gen_blind;
+        memcpy(pubkey, s_signer.pubkey, sizeof(pubkey));
+        mbedtls_sha256_clone(&nonce, &s_signer.nonce_midstate);
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (!valid) {
+        mbedtls_sha256_free(&nonce);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // k = H_nonce(t || P || m) mod n
+    esp_err_t ret = ESP_OK;
+    uint8_t rand[32];
+    secp_scalar k;
+    mbedtls_sha256_update(&nonce, msg, 32);
+    mbedtls_sha256_finish(&nonce, rand);
+    mbedtls_sha256_free(&nonce);
+    secp_scalar_set_b32(&k, rand);
+    if (secp_scalar_is_zero(&k)) {
+        ret = ESP_FAIL;
+        goto cleanup;
+    }
+
+    // R = k*G, with k negated if R has odd y
+    secp_gej rj;
+    secp_ge r;
+    secp_ecmult_gen(&rj, s_comb_g, &blind, &k);
+    secp_ge_set_gej(&r, &rj);
+    if (secp_fe_is_odd(&r.y)) {
+        secp_scalar_negate(&k, &k);
+    }
+    secp_fe_get_b32(sig, &r.x);
+
+    // s = k + e*d
+    secp_scalar e;
+    compute_challenge(sig, pubkey, msg, &e);
+    secp_scalar_mul(&e, &e, &d);
+    secp_scalar_add(&k, &k, &e);
+    secp_scalar_get_b32(sig + 32, &k);
+    mbedtls_platform_zeroize(&e, sizeof(e));
+
+cleanup:
+    // The secret key and nonce are wiped on every exit, including k == 0
+    mbedtls_platform_zeroize(rand, sizeof(rand));
+    mbedtls_platform_zeroize(&d, sizeof(d));
+    mbedtls_platform_zeroize(&k, sizeof(k));
+    mbedtls_platform_zeroize(&blind, sizeof(blind));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.sigs_created++;
+    s_stats.sign_time_us += (uint64_t)elapsed;
+    xSemaphoreGive(s_mutex);
+
+    return ESP_OK;
+}
+
+void nostr_schnorr_get_stats(nostr_schnorr_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+    if (!s_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file nostr_schnorr.h
+ * @brief BIP-340 Schnorr signatures for NOSTR events
+ *
+ * Verification computes R = s*G - e*P with a single Strauss/Shamir pass.
+ * Bursts of signatures can be checked together with a randomised linear
+ * combination (BIP-340 batch verification), sharing one doubling chain.
+ * The odd multiples of G are precomputed once at init; the odd multiples of
+ * recently seen public keys are kept in a small LRU cache, so repeated
+ * messages from the same chat participant skip the lift_x square root and
+ * the table build.
+ *
+ * Signing uses a constant-time, blinded fixed-base comb for k*G (43
+ * doublings, see secp_ecmult_gen()) and a nonce hash state precomputed when
+ * the key is loaded.
+ */
+
+#ifndef GEOGRAM_NOSTR_SCHNORR_H
+#define GEOGRAM_NOSTR_SCHNORR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NOSTR_SCHNORR_SIG_LEN               64
+#define NOSTR_VERIFY_PUBKEY_CACHE_SIZE      8
+#define NOSTR_VERIFY_BATCH_MAX              8       // Signatures per batch equation
+
+/**
+ * @brief One signature in a batch
+ */
+typedef struct {
+    const uint8_t *sig;         // 64-byte signature
+    const uint8_t *msg;         // 32-byte message
+    const uint8_t *pubkey;      // 32-byte x-only public key
+} nostr_schnorr_item_t;
+
+/**
+ * @brief Verification statistics
+ */
+typedef struct {
+    uint32_t verified;          // Signatures that checked out
+    uint32_t rejected;          // Bad signatures or malformed input
+    uint32_t cache_hits;        // Public key found in the cache
+    uint32_t cache_misses;      // Public key lifted and tabled
+    uint32_t batches;           // Batch equations that held
+    uint32_t batch_fallbacks;   // Batches re-checked one signature at a time
+    uint64_t total_time_us;     // Time spent verifying (single and batch)
+    uint32_t sigs_created;      // Signatures made with the station key
+    uint64_t sign_time_us;      // Time spent signing
+} nostr_schnorr_stats_t;
+
+/**
+ * @brief Initialize the verifier (builds the fixed-base G table, ~4 KB)
+ *
+ * Safe to call more than once.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table could not be built
+ */
+esp_err_t nostr_schnorr_init(void);
+
+/**
+ * @brief Verify a BIP-340 signature
+ *
+ * @param sig 64-byte signature (r || s)
+ * @param msg 32-byte message (the NOSTR event id)
+ * @param pubkey 32-byte x-only public key
+ * @return ESP_OK if valid,
+ *         ESP_ERR_INVALID_ARG if the signature or key is malformed,
+ *         ESP_ERR_INVALID_STATE if nostr_schnorr_init() has not run,
+ *         ESP_FAIL if the signature does not match
+ */
+esp_err_t nostr_schnorr_verify(const uint8_t *sig, const uint8_t *msg, const uint8_t *pubkey);
+
+/**
+ * @brief Verify several signatures at once
+ *
+ * Checks sum(a_i*s_i)*G == sum(a_i*R_i) + sum(a_i*e_i*P_i) with random
+ * 128-bit a_i. If the combined equation fails, each signature is verified
+ * on its own so `results` always identifies the bad ones. Larger inputs are
+ * split into chunks of NOSTR_VERIFY_BATCH_MAX.
+ *
+ * @param items Signatures to verify
+ * @param count Number of items
+ * @param results Per-item result (same codes as nostr_schnorr_verify)
+ * @return ESP_OK if every signature is valid, ESP_FAIL if any is not,
+ *         ESP_ERR_INVALID_ARG / ESP_ERR_INVALID_STATE on bad calls
+ */
+esp_err_t nostr_schnorr_verify_batch(const nostr_schnorr_item_t *items, size_t count,
+                                     esp_err_t *results);
+
+/**
+ * @brief Load the key used by nostr_schnorr_sign()
+ *
+ * Precomputes the public key and the nonce-derivation hash state. The
+ * BIP-340 auxiliary randomness is drawn once here rather than per signature.
+ *
+ * @param seckey 32-byte secret key
+ * @param pubkey Output, 32-byte x-only public key (may be NULL)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the key is out of range,
+ *         ESP_ERR_INVALID_STATE if nostr_schnorr_init() has not run
+ */
+esp_err_t nostr_schnorr_set_signing_key(const uint8_t *seckey, uint8_t *pubkey);
+
+/**
+ * @brief Get the x-only public key of the loaded signing key
+ *
+ * @param pubkey Output, 32 bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no key is loaded
+ */
+esp_err_t nostr_schnorr_get_signing_pubkey(uint8_t *pubkey);
+
+/**
+ * @brief Sign a 32-byte message with the loaded key
+ *
+ * @param msg 32-byte message (the NOSTR event id)
+ * @param sig Output, 64-byte signature
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no key is loaded
+ */
+esp_err_t nostr_schnorr_sign(const uint8_t *msg, uint8_t *sig);
+
+/**
+ * @brief Get signing and verification statistics
+ *
+ * @param stats Output structure
+ */
+void nostr_schnorr_get_stats(nostr_schnorr_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_NOSTR_SCHNORR_H
@@ -0,0 +1,1045 @@
+/**
+ * @file secp256k1.c
+ * @brief Minimal secp256k1 arithmetic for BIP-340 Schnorr signatures
+ *
+ * Field: p = 2^256 - 2^32 - 977. Products are reduced with the identity
+ * 2^256 = 0x1000003D1 (mod p), folded twice.
+ * Scalar: n = group order, reduced by repeated folding with 2^256 - n.
+ * Group: Jacobian coordinates, a = 0 formulas.
+ */
+
+#include "secp256k1.h"
+#include <string.h>
+#include <stdlib.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+// p, little-endian limbs
+static const uint32_t FE_P[8] = {
+    0xFFFFFC2F, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF,
+    0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
+};
+
+// 2^256 mod p = 0x1000003D1 = (1 << 32) + 0x3D1
+#define FE_C_LO     0x3D1u
+
+// n, little-endian limbs
+static const uint32_t SC_N[8] = {
+    0xD0364141, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6,
+    0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
+};
+
+// 2^256 - n (129 bits)
+static const uint32_t SC_C[5] = {
+    0x2FC9BEBF, 0x402DA173, 0x50B75FC4, 0x45512319, 0x00000001
+};
+
+const secp_ge secp_ge_generator = {
+    .x = {{ 0x16F81798, 0x59F2815B, 0x2DCE28D9, 0x029BFCDB,
+            0xCE870B07, 0x55A06295, 0xF9DCBBAC, 0x79BE667E }},
+    .y = {{ 0xFB10D4B8, 0x9C47D08F, 0xA6855419, 0xFD17B448,
+            0x0E1108A8, 0x5DA4FBFC, 0x26A3C465, 0x483ADA77 }},
+    .infinity = false,
+};
+
+// ============================================================================
+// 256-bit helpers
+// ============================================================================
+
+static inline void load_be32(uint32_t *w, const uint8_t *b32) {
+    for (int i = 0; i < 8; i++) {
+        const uint8_t *p = b32 + (7 - i) * 4;
+        w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+               ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+}
+
+static inline void store_be32(uint8_t *b32, const uint32_t *w) {
+    for (int i = 0; i < 8; i++) {
+        uint8_t *p = b32 + (7 - i) * 4;
+        p[0] = (uint8_t)(w[i] >> 24);
+        p[1] = (uint8_t)(w[i] >> 16);
+        p[2] = (uint8_t)(w[i] >> 8);
+        p[3] = (uint8_t)w[i];
+    }
+}
+
+// r = a - m, returns borrow
+static inline uint32_t sub256(uint32_t *r, const uint32_t *a, const uint32_t *m) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t d = (uint64_t)a[i] - m[i] - borrow;
+        r[i] = (uint32_t)d;
+        borrow = (d >> 63) & 1;
+    }
+    return (uint32_t)borrow;
+}
+
+// Returns true if a >= m (no early exit)
+static inline bool geq256(const uint32_t *a, const uint32_t *m) {
+    uint32_t t[8];
+    return sub256(t, a, m) == 0;
+}
+
+// r = a - m if carry is set or a >= m, else a; branch-free
+static inline void reduce_once(uint32_t *r, const uint32_t *a, uint32_t carry, const uint32_t *m) {
+    uint32_t t[8];
+    uint32_t borrow = sub256(t, a, m);
+    uint32_t mask = 0u - ((carry | (borrow ^ 1)) & 1);
+    for (int i = 0; i < 8; i++) {
+        r[i] = (t[i] & mask) | (a[i] & ~mask);
+    }
+}
+
+// r = a + m, returns carry
+static inline uint32_t add256(uint32_t *r, const uint32_t *a, const uint32_t *m) {
+    uint64_t carry = 0;
+    for (int i = 0; i < 8; i++) {
+        carry += (uint64_t)a[i] + m[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// 512-bit product, row-wise so each step fits in 64 bits
+static void mul256(uint32_t *t, const uint32_t *a, const uint32_t *b) {
+    memset(t, 0, 16 * sizeof(uint32_t));
+    for (int i = 0; i < 8; i++) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (int j = 0; j < 8; j++) {
+            carry += (uint64_t)t[i + j] + ai * b[j];
+            t[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        t[i + 8] = (uint32_t)carry;
+    }
+}
+
+// 512-bit square: off-diagonal products once, doubled, plus the diagonal
+static void sqr256(uint32_t *t, const uint32_t *a) {
+    memset(t, 0, 16 * sizeof(uint32_t));
+    for (int i = 0; i < 7; i++) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (int j = i + 1; j < 8; j++) {
+            carry += (uint64_t)t[i + j] + ai * a[j];
+            t[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        t[i + 8] = (uint32_t)carry;
+    }
+
+    uint32_t top = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t next = t[i] >> 31;
+        t[i] = (t[i] << 1) | top;
+        top = next;
+    }
+
+    uint64_t carry = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t sq = (uint64_t)a[i] * a[i];
+        carry += (uint64_t)t[2 * i] + (uint32_t)sq;
+        t[2 * i] = (uint32_t)carry;
+        carry >>= 32;
+        carry += (uint64_t)t[2 * i + 1] + (sq >> 32);
+        t[2 * i + 1] = (uint32_t)carry;
+        carry >>= 32;
+    }
+}
+
+// ============================================================================
+// Field
+// ============================================================================
+
+static void fe_reduce512(secp_fe *r, const uint32_t *t) {
+    uint32_t u[8];
+    uint64_t acc = 0;
+
+    // First fold: u = t_lo + t_hi * 0x3D1 + (t_hi << 32)
+    for (int i = 0; i < 8; i++) {
+        acc += (uint64_t)t[i] + (uint64_t)t[8 + i] * FE_C_LO;
+        if (i > 0) {
+            acc += t[8 + i - 1];
+        }
+        u[i] = (uint32_t)acc;
+        acc >>= 32;
+    }
+    acc += t[15];   // < 2^34
+
+    // Second fold of the small overflow word
+    uint64_t hi = acc;
+    acc = (uint64_t)u[0] + hi * FE_C_LO;
+    u[0] = (uint32_t)acc;
+    acc >>= 32;
+    acc += (uint64_t)u[1] + hi;
+    u[1] = (uint32_t)acc;
+    acc >>= 32;
+    for (int i = 2; i < 8; i++) {
+        acc += u[i];
+        u[i] = (uint32_t)acc;
+        acc >>= 32;
+    }
+
+    // A final carry leaves a tiny value, adding 2^256 mod p cannot overflow.
+    // Added under a mask so the timing does not depend on the carry.
+    uint32_t mask = 0u - (uint32_t)acc;
+    uint64_t c = (uint64_t)u[0] + (FE_C_LO & mask);
+    u[0] = (uint32_t)c;
+    c = (c >> 32) + (uint64_t)u[1] + (1u & mask);
+    u[1] = (uint32_t)c;
+    c >>= 32;
+    for (int i = 2; i < 8; i++) {
+        c += u[i];
+        u[i] = (uint32_t)c;
+        c >>= 32;
+    }
+
+    reduce_once(r->n, u, 0, FE_P);
+}
+
+bool secp_fe_set_b32(secp_fe *r, const uint8_t *b32) {
+    load_be32(r->n, b32);
+    return !geq256(r->n, FE_P);
+}
+
+void secp_fe_get_b32(uint8_t *b32, const secp_fe *a) {
+    store_be32(b32, a->n);
+}
+
+void secp_fe_set_int(secp_fe *r, uint32_t v) {
+    memset(r->n, 0, sizeof(r->n));
+    r->n[0] = v;
+}
+
+bool secp_fe_is_zero(const secp_fe *a) {
+    uint32_t z = 0;
+    for (int i = 0; i < 8; i++) {
+        z |= a->n[i];
+    }
+    return z == 0;
+}
+
+bool secp_fe_is_odd(const secp_fe *a) {
+    return a->n[0] & 1;
+}
+
+bool secp_fe_equal(const secp_fe *a, const secp_fe *b) {
+    return memcmp(a->n, b->n, sizeof(a->n)) == 0;
+}
+
+// Field and scalar add/sub/negate are branch-free: the signing path runs
+// them on secret values
+
+void secp_fe_add(secp_fe *r, const secp_fe *a, const secp_fe *b) {
+    uint32_t carry = add256(r->n, a->n, b->n);
+    reduce_once(r->n, r->n, carry, FE_P);
+}
+
+void secp_fe_sub(secp_fe *r, const secp_fe *a, const secp_fe *b) {
+    uint32_t mask = 0u - sub256(r->n, a->n, b->n);
+    uint32_t p[8];
+    for (int i = 0; i < 8; i++) {
+        p[i] = FE_P[i] & mask;
+    }
+    add256(r->n, r->n, p);
+}
+
+void secp_fe_negate(secp_fe *r, const secp_fe *a) {
+    // p - 0 = p reduces to 0
+    sub256(r->n, FE_P, a->n);
+    reduce_once(r->n, r->n, 0, FE_P);
+}
+
+void secp_fe_mul(secp_fe *r, const secp_fe *a, const secp_fe *b) {
+    uint32_t t[16];
+    mul256(t, a->n, b->n);
+    fe_reduce512(r, t);
+}
+
+void secp_fe_sqr(secp_fe *r, const secp_fe *a) {
+    uint32_t t[16];
+    sqr256(t, a->n);
+    fe_reduce512(r, t);
+}
+
+static inline void fe_sqr_n(secp_fe *r, const secp_fe *a, int n) {
+    secp_fe_sqr(r, a);
+    for (int i = 1; i < n; i++) {
+        secp_fe_sqr(r, r);
+    }
+}
+
+// Shared prefix of the inversion and square root addition chains:
+// x_k = a^(2^k - 1)
+static void fe_chain_x223(secp_fe *x2, secp_fe *x22, secp_fe *x223, const secp_fe *a) {
+    secp_fe x3, x6, x9, x11, x44, x88, x176, x220, t;
+
+    secp_fe_sqr(x2, a);
+    secp_fe_mul(x2, x2, a);
+
+    secp_fe_sqr(&x3, x2);
+    secp_fe_mul(&x3, &x3, a);
+
+    fe_sqr_n(&x6, &x3, 3);
+    secp_fe_mul(&x6, &x6, &x3);
+
+    fe_sqr_n(&x9, &x6, 3);
+    secp_fe_mul(&x9, &x9, &x3);
+
+    fe_sqr_n(&x11, &x9, 2);
+    secp_fe_mul(&x11, &x11, x2);
+
+    fe_sqr_n(x22, &x11, 11);
+    secp_fe_mul(x22, x22, &x11);
+
+    fe_sqr_n(&x44, x22, 22);
+    secp_fe_mul(&x44, &x44, x22);
+
+    fe_sqr_n(&x88, &x44, 44);
+    secp_fe_mul(&x88, &x88, &x44);
+
+    fe_sqr_n(&x176, &x88, 88);
+    secp_fe_mul(&x176, &x176, &x88);
+
+    fe_sqr_n(&x220, &x176, 44);
+    secp_fe_mul(&x220, &x220, &x44);
+
+    fe_sqr_n(&t, &x220, 3);
+    secp_fe_mul(x223, &t, &x3);
+}
+
+void secp_fe_inv(secp_fe *r, const secp_fe *a) {
+    // a^(p-2)
+    secp_fe x2, x22, x223, t;
+    fe_chain_x223(&x2, &x22, &x223, a);
+
+    fe_sqr_n(&t, &x223, 23);
+    secp_fe_mul(&t, &t, &x22);
+    fe_sqr_n(&t, &t, 5);
+    secp_fe_mul(&t, &t, a);
+    fe_sqr_n(&t, &t, 3);
+    secp_fe_mul(&t, &t, &x2);
+    fe_sqr_n(&t, &t, 2);
+    secp_fe_mul(r, &t, a);
+}
+
+bool secp_fe_sqrt(secp_fe *r, const secp_fe *a) {
+    // a^((p+1)/4), valid because p = 3 mod 4
+    secp_fe x2, x22, x223, t, check;
+    fe_chain_x223(&x2, &x22, &x223, a);
+
+    fe_sqr_n(&t, &x223, 23);
+    secp_fe_mul(&t, &t, &x22);
+    fe_sqr_n(&t, &t, 6);
+    secp_fe_mul(&t, &t, &x2);
+    fe_sqr_n(r, &t, 2);
+
+    secp_fe_sqr(&check, r);
+    return secp_fe_equal(&check, a);
+}
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+// Reduce a 512-bit value mod n by folding the high half with 2^256 - n.
+// Four folds always suffice (< 2^386, < 2^260, < 2^256 + 2^133, < 2^256),
+// so the work is the same for every input.
+static void scalar_reduce512(secp_scalar *r, const uint32_t *l) {
+    uint32_t t[16];
+    memcpy(t, l, sizeof(t));
+
+    for (int fold = 0; fold < 4; fold++) {
+        uint32_t out[16];
+        memcpy(out, t, 8 * sizeof(uint32_t));
+        memset(out + 8, 0, 8 * sizeof(uint32_t));
+
+        for (int i = 0; i < 8; i++) {
+            uint64_t hi = t[8 + i];
+            uint64_t carry = 0;
+            int k = i;
+            for (int j = 0; j < 5; j++, k++) {
+                carry += (uint64_t)out[k] + hi * SC_C[j];
+                out[k] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            for (; k < 16; k++) {
+                carry += out[k];
+                out[k] = (uint32_t)carry;
+                carry >>= 32;
+            }
+        }
+        memcpy(t, out, sizeof(t));
+    }
+
+    // Value is now < 2^256 < 2n
+    reduce_once(r->d, t, 0, SC_N);
+}
+
+bool secp_scalar_set_b32(secp_scalar *r, const uint8_t *b32) {
+    load_be32(r->d, b32);
+    bool overflow = geq256(r->d, SC_N);
+    reduce_once(r->d, r->d, 0, SC_N);
+    return overflow;
+}
+
+void secp_scalar_get_b32(uint8_t *b32, const secp_scalar *a) {
+    store_be32(b32, a->d);
+}
+
+void secp_scalar_set_int(secp_scalar *r, uint32_t v) {
+    memset(r->d, 0, sizeof(r->d));
+    r->d[0] = v;
+}
+
+bool secp_scalar_is_zero(const secp_scalar *a) {
+    uint32_t z = 0;
+    for (int i = 0; i < 8; i++) {
+        z |= a->d[i];
+    }
+    return z == 0;
+}
+
+void secp_scalar_add(secp_scalar *r, const secp_scalar *a, const secp_scalar *b) {
+    uint32_t carry = add256(r->d, a->d, b->d);
+    reduce_once(r->d, r->d, carry, SC_N);
+}
+
+void secp_scalar_mul(secp_scalar *r, const secp_scalar *a, const secp_scalar *b) {
+    uint32_t t[16];
+    mul256(t, a->d, b->d);
+    scalar_reduce512(r, t);
+}
+
+void secp_scalar_negate(secp_scalar *r, const secp_scalar *a) {
+    sub256(r->d, SC_N, a->d);
+    reduce_once(r->d, r->d, 0, SC_N);
+}
+
+// ============================================================================
+// Group
+// ============================================================================
+
+bool secp_ge_set_xonly(secp_ge *r, const secp_fe *x) {
+    secp_fe c;
+    secp_fe seven;
+
+    secp_fe_set_int(&seven, 7);
+    secp_fe_sqr(&c, x);
+    secp_fe_mul(&c, &c, x);
+    secp_fe_add(&c, &c, &seven);
+
+    if (!secp_fe_sqrt(&r->y, &c)) {
+        return false;
+    }
+    if (secp_fe_is_odd(&r->y)) {
+        secp_fe_negate(&r->y, &r->y);
+    }
+    r->x = *x;
+    r->infinity = false;
+    return true;
+}
+
+void secp_ge_set_gej(secp_ge *r, const secp_gej *a) {
+    if (a->infinity) {
+        memset(r, 0, sizeof(*r));
+        r->infinity = true;
+        return;
+    }
+    secp_fe zi, zi2, zi3;
+    secp_fe_inv(&zi, &a->z);
+    secp_fe_sqr(&zi2, &zi);
+    secp_fe_mul(&zi3, &zi2, &zi);
+    secp_fe_mul(&r->x, &a->x, &zi2);
+    secp_fe_mul(&r->y, &a->y, &zi3);
+    r->infinity = false;
+}
+
+void secp_ge_neg(secp_ge *r, const secp_ge *a) {
+    *r = *a;
+    secp_fe_negate(&r->y, &a->y);
+}
+
+void secp_gej_set_ge(secp_gej *r, const secp_ge *a) {
+    r->x = a->x;
+    r->y = a->y;
+    secp_fe_set_int(&r->z, 1);
+    r->infinity = a->infinity;
+}
+
+void secp_gej_set_infinity(secp_gej *r) {
+    memset(r, 0, sizeof(*r));
+    r->infinity = true;
+}
+
+void secp_gej_double(secp_gej *r, const secp_gej *a) {
+    // dbl-2009-l
+    if (a->infinity || secp_fe_is_zero(&a->y)) {
+        secp_gej_set_infinity(r);
+        return;
+    }
+
+    secp_fe A, B, C, D, E, F, t;
+
+    secp_fe_sqr(&A, &a->x);
+    secp_fe_sqr(&B, &a->y);
+    secp_fe_sqr(&C, &B);
+
+    secp_fe_add(&t, &a->x, &B);
+    secp_fe_sqr(&t, &t);
+    secp_fe_sub(&t, &t, &A);
+    secp_fe_sub(&t, &t, &C);
+    secp_fe_add(&D, &t, &t);
+
+    secp_fe_add(&E, &A, &A);
+    secp_fe_add(&E, &E, &A);
+    secp_fe_sqr(&F, &E);
+
+    // Z3 first: r may alias a
+    secp_fe_mul(&r->z, &a->y, &a->z);
+    secp_fe_add(&r->z, &r->z, &r->z);
+
+    secp_fe_add(&t, &D, &D);
+    secp_fe_sub(&r->x, &F, &t);
+
+    secp_fe_sub(&t, &D, &r->x);
+    secp_fe_mul(&t, &E, &t);
+    secp_fe_add(&C, &C, &C);
+    secp_fe_add(&C, &C, &C);
+    secp_fe_add(&C, &C, &C);
+    secp_fe_sub(&r->y, &t, &C);
+    r->infinity = false;
+}
+
+void secp_gej_add_ge(secp_gej *r, const secp_gej *a, const secp_ge *b) {
+    // madd-2004-hmv
+    if (b->infinity) {
+        *r = *a;
+        return;
+    }
+    if (a->infinity) {
+        secp_gej_set_ge(r, b);
+        return;
+    }
+
+    secp_fe z1z1, u2, s2, h, rr, hh, hhh, v, t;
+
+    secp_fe_sqr(&z1z1, &a->z);
+    secp_fe_mul(&u2, &b->x, &z1z1);
+    secp_fe_mul(&s2, &b->y, &a->z);
+    secp_fe_mul(&s2, &s2, &z1z1);
+    secp_fe_sub(&h, &u2, &a->x);
+    secp_fe_sub(&rr, &s2, &a->y);
+
+    if (secp_fe_is_zero(&h)) {
+        if (secp_fe_is_zero(&rr)) {
+            secp_gej_double(r, a);
+        } else {
+            secp_gej_set_infinity(r);
+        }
+        return;
+    }
+
+    secp_fe_sqr(&hh, &h);
+    secp_fe_mul(&hhh, &h, &hh);
+    secp_fe_mul(&v, &a->x, &hh);
+
+    secp_fe_mul(&r->z, &a->z, &h);
+
+    secp_fe_mul(&t, &a->y, &hhh);    // Y1*HHH, before r->y is written
+
+    secp_fe_sqr(&r->x, &rr);
+    secp_fe_sub(&r->x, &r->x, &hhh);
+    secp_fe_sub(&r->x, &r->x, &v);
+    secp_fe_sub(&r->x, &r->x, &v);
+
+    secp_fe_sub(&v, &v, &r->x);
+    secp_fe_mul(&v, &rr, &v);
+    secp_fe_sub(&r->y, &v, &t);
+    r->infinity = false;
+}
+
+void secp_gej_add(secp_gej *r, const secp_gej *a, const secp_gej *b) {
+    // add-1998-cmo-2
+    if (a->infinity) {
+        *r = *b;
+        return;
+    }
+    if (b->infinity) {
+        *r = *a;
+        return;
+    }
+
+    secp_fe z1z1, z2z2, u1, u2, s1, s2, h, rr, hh, hhh, v, t;
+
+    secp_fe_sqr(&z1z1, &a->z);
+    secp_fe_sqr(&z2z2, &b->z);
+    secp_fe_mul(&u1, &a->x, &z2z2);
+    secp_fe_mul(&u2, &b->x, &z1z1);
+    secp_fe_mul(&s1, &a->y, &b->z);
+    secp_fe_mul(&s1, &s1, &z2z2);
+    secp_fe_mul(&s2, &b->y, &a->z);
+    secp_fe_mul(&s2, &s2, &z1z1);
+    secp_fe_sub(&h, &u2, &u1);
+    secp_fe_sub(&rr, &s2, &s1);
+
+    if (secp_fe_is_zero(&h)) {
+        if (secp_fe_is_zero(&rr)) {
+            secp_gej_double(r, a);
+        } else {
+            secp_gej_set_infinity(r);
+        }
+        return;
+    }
+
+    secp_fe_sqr(&hh, &h);
+    secp_fe_mul(&hhh, &h, &hh);
+    secp_fe_mul(&v, &u1, &hh);
+
+    secp_fe_mul(&t, &a->z, &b->z);
+    secp_fe_mul(&r->z, &t, &h);
+
+    secp_fe_sqr(&r->x, &rr);
+    secp_fe_sub(&r->x, &r->x, &hhh);
+    secp_fe_sub(&r->x, &r->x, &v);
+    secp_fe_sub(&r->x, &r->x, &v);
+
+    secp_fe_mul(&t, &s1, &hhh);
+    secp_fe_sub(&v, &v, &r->x);
+    secp_fe_mul(&v, &rr, &v);
+    secp_fe_sub(&r->y, &v, &t);
+    r->infinity = false;
+}
+
+void secp_ge_set_all_gej(secp_ge_storage *r, const secp_gej *a, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    // Montgomery's trick: prefix products of Z stored in r[i].x
+    r[0].x = a[0].z;
+    for (size_t i = 1; i < n; i++) {
+        secp_fe_mul(&r[i].x, &r[i - 1].x, &a[i].z);
+    }
+
+    secp_fe u;
+    secp_fe_inv(&u, &r[n - 1].x);
+
+    for (size_t i = n; i-- > 0;) {
+        secp_fe zi, zi2, zi3;
+        if (i > 0) {
+            secp_fe_mul(&zi, &u, &r[i - 1].x);
+            secp_fe_mul(&u, &u, &a[i].z);
+        } else {
+            zi = u;
+        }
+        secp_fe_sqr(&zi2, &zi);
+        secp_fe_mul(&zi3, &zi2, &zi);
+        secp_fe_mul(&r[i].x, &a[i].x, &zi2);
+        secp_fe_mul(&r[i].y, &a[i].y, &zi3);
+    }
+}
+
+// ============================================================================
+// Multiplication
+// ============================================================================
+
+#define WNAF_BITS   256
+
+static inline uint32_t scalar_get_bits(const secp_scalar *s, int offset, int count) {
+    int limb = offset >> 5;
+    int shift = offset & 31;
+    uint64_t v = s->d[limb] >> shift;
+    if (shift + count > 32 && limb < 7) {
+        v |= (uint64_t)s->d[limb + 1] << (32 - shift);
+    }
+    return (uint32_t)v & ((1u << count) - 1);
+}
+
+// Width-w non-adjacent form; returns the number of significant digits
+static int scalar_wnaf(int8_t *wnaf, const secp_scalar *a, int w) {
+    secp_scalar s = *a;
+    int last_set_bit = -1;
+    int bit = 0;
+    int sign = 1;
+    int carry = 0;
+
+    memset(wnaf, 0, WNAF_BITS);
+
+    if (scalar_get_bits(&s, 255, 1)) {
+        secp_scalar_negate(&s, &s);
+        sign = -1;
+    }
+
+    while (bit < WNAF_BITS) {
+        if ((int)scalar_get_bits(&s, bit, 1) == carry) {
+            bit++;
+            continue;
+        }
+
+        int now = w;
+        if (now > WNAF_BITS - bit) {
+            now = WNAF_BITS - bit;
+        }
+
+        int word = (int)scalar_get_bits(&s, bit, now) + carry;
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+
+        wnaf[bit] = (int8_t)(sign * word);
+        last_set_bit = bit;
+        bit += now;
+    }
+    return last_set_bit + 1;
+}
+
+bool secp_ecmult_odd_table(secp_ge_storage *table, const secp_ge *p, size_t count) {
+    // Small (public key) tables use the stack, the G table borrows the heap
+    secp_gej stack_acc[SECP_TABLE_SIZE_P];
+    secp_gej *acc = stack_acc;
+    secp_gej d;
+    secp_ge d_aff;
+
+    if (count == 0) {
+        return true;
+    }
+    if (count > SECP_TABLE_SIZE_P) {
+        acc = malloc(count * sizeof(secp_gej));
+        if (!acc) {
+            return false;
+        }
+    }
+
+    secp_gej_set_ge(&acc[0], p);
+    secp_gej_double(&d, &acc[0]);
+    secp_ge_set_gej(&d_aff, &d);
+
+    for (size_t i = 1; i < count; i++) {
+        secp_gej_add_ge(&acc[i], &acc[i - 1], &d_aff);
+    }
+    secp_ge_set_all_gej(table, acc, count);
+
+    if (acc != stack_acc) {
+        free(acc);
+    }
+    return true;
+}
+
+bool secp_ecmult_odd_tables(secp_ge_storage *tables, const secp_ge *points, size_t n) {
+    if (n == 0) {
+        return true;
+    }
+
+    secp_gej *acc = malloc(n * SECP_TABLE_SIZE_P * sizeof(secp_gej));
+    if (!acc) {
+        return false;
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        secp_gej *t = acc + k * SECP_TABLE_SIZE_P;
+        secp_gej d;
+        secp_gej_set_ge(&t[0], &points[k]);
+        secp_gej_double(&d, &t[0]);
+        for (size_t i = 1; i < SECP_TABLE_SIZE_P; i++) {
+            secp_gej_add(&t[i], &t[i - 1], &d);
+        }
+    }
+    secp_ge_set_all_gej(tables, acc, n * SECP_TABLE_SIZE_P);
+
+    free(acc);
+    return true;
+}
+
+static inline void table_get(secp_ge *r, const secp_ge_storage *table, int n) {
+    if (n > 0) {
+        r->x = table[(n - 1) / 2].x;
+        r->y = table[(n - 1) / 2].y;
+    } else {
+        r->x = table[(-n - 1) / 2].x;
+        secp_fe_negate(&r->y, &table[(-n - 1) / 2].y);
+    }
+    r->infinity = false;
+}
+
+void secp_ecmult(secp_gej *r, const secp_ge_storage *table_g, const secp_scalar *na,
+                 const secp_ge_storage *table_p, const secp_scalar *np) {
+    int8_t wnaf_g[WNAF_BITS];
+    int8_t wnaf_p[WNAF_BITS];
+    int bits_g = scalar_wnaf(wnaf_g, na, SECP_WINDOW_G);
+    int bits_p = 0;
+
+    if (table_p) {
+        bits_p = scalar_wnaf(wnaf_p, np, SECP_WINDOW_P);
+    }
+
+    int bits = bits_g > bits_p ? bits_g : bits_p;
+    secp_ge tmp;
+
+    secp_gej_set_infinity(r);
+    for (int i = bits - 1; i >= 0; i--) {
+        secp_gej_double(r, r);
+
+        if (i < bits_p && wnaf_p[i]) {
+            table_get(&tmp, table_p, wnaf_p[i]);
+            secp_gej_add_ge(r, r, &tmp);
+        }
+        if (i < bits_g && wnaf_g[i]) {
+            table_get(&tmp, table_g, wnaf_g[i]);
+            secp_gej_add_ge(r, r, &tmp);
+        }
+    }
+}
+
+bool secp_ecmult_multi(secp_gej *r, const secp_ge_storage *table_g, const secp_scalar *ng,
+                       const secp_ge_storage *tables, const secp_scalar *scalars, size_t n) {
+    int8_t wnaf_g[WNAF_BITS];
+    int8_t *wnaf = NULL;
+    int *bits = NULL;
+
+    if (n > 0) {
+        wnaf = malloc(n * WNAF_BITS);
+        bits = malloc(n * sizeof(int));
+        if (!wnaf || !bits) {
+            free(wnaf);
+            free(bits);
+            return false;
+        }
+    }
+
+    int max_bits = scalar_wnaf(wnaf_g, ng, SECP_WINDOW_G);
+    int bits_g = max_bits;
+    for (size_t k = 0; k < n; k++) {
+        bits[k] = scalar_wnaf(wnaf + k * WNAF_BITS, &scalars[k], SECP_WINDOW_P);
+        if (bits[k] > max_bits) {
+            max_bits = bits[k];
+        }
+    }
+
+    secp_ge tmp;
+    secp_gej_set_infinity(r);
+    for (int i = max_bits - 1; i >= 0; i--) {
+        secp_gej_double(r, r);
+
+        for (size_t k = 0; k < n; k++) {
+            int8_t digit = wnaf[k * WNAF_BITS + i];
+            if (i < bits[k] && digit) {
+                table_get(&tmp, tables + k * SECP_TABLE_SIZE_P, digit);
+                secp_gej_add_ge(r, r, &tmp);
+            }
+        }
+        if (i < bits_g && wnaf_g[i]) {
+            table_get(&tmp, table_g, wnaf_g[i]);
+            secp_gej_add_ge(r, r, &tmp);
+        }
+    }
+
+    free(wnaf);
+    free(bits);
+    return true;
+}
+
+// ============================================================================
+// Fixed-base comb (signing)
+// ============================================================================
+
+static inline uint32_t scalar_get_bit(const secp_scalar *s, int pos) {
+    if (pos >= 256) {
+        return 0;
+    }
+    return (s->d[pos >> 5] >> (pos & 31)) & 1;
+}
+
+bool secp_ecmult_gen_table(secp_ge_storage *table) {
+    secp_gej *acc = malloc((SECP_COMB_TABLE_SIZE - 1) * sizeof(secp_gej));
+    if (!acc) {
+        return false;
+    }
+
+    // Teeth B_t = 2^(t * spacing) * G
+    secp_gej teeth[SECP_COMB_TEETH];
+    secp_gej_set_ge(&teeth[0], &secp_ge_generator);
+    for (int t = 1; t < SECP_COMB_TEETH; t++) {
+        teeth[t] = teeth[t - 1];
+        for (int i = 0; i < SECP_COMB_SPACING; i++) {
+            secp_gej_double(&teeth[t], &teeth[t]);
+        }
+    }
+
+    // Entry j (stored at j - 1) is the sum of the teeth selected by the bits of j
+    for (int j = 1; j < SECP_COMB_TABLE_SIZE; j++) {
+        int low = __builtin_ctz(j);
+        int rest = j & (j - 1);
+        if (rest == 0) {
+            acc[j - 1] = teeth[low];
+        } else {
+            secp_gej_add(&acc[j - 1], &acc[rest - 1], &teeth[low]);
+        }
+    }
+    secp_ge_set_all_gej(table, acc, SECP_COMB_TABLE_SIZE - 1);
+
+    free(acc);
+    return true;
+}
+
+// Homogeneous projective point (x = X/Z, y = Y/Z; infinity is (0:1:0)). The
+// comb uses the complete a = 0 formulas of Renes, Costello and Batina
+// (eprint 2015/1060, algorithms 8 and 9): no special cases, so the same
+// operations run whatever the operands are.
+typedef struct {
+    secp_fe x;
+    secp_fe y;
+    secp_fe z;
+} secp_gep;
+
+static const secp_fe FE_B3 = {{ 21 }};   // 3 * b
+
+static void gep_double(secp_gep *r, const secp_gep *a) {
+    secp_fe t0, t1, t2, x3, y3, z3;
+
+    secp_fe_sqr(&t0, &a->y);
+    secp_fe_add(&z3, &t0, &t0);
+    secp_fe_add(&z3, &z3, &z3);
+    secp_fe_add(&z3, &z3, &z3);
+    secp_fe_mul(&t1, &a->y, &a->z);
+    secp_fe_sqr(&t2, &a->z);
+    secp_fe_mul(&t2, &t2, &FE_B3);
+    secp_fe_mul(&x3, &t2, &z3);
+    secp_fe_add(&y3, &t0, &t2);
+    secp_fe_mul(&z3, &t1, &z3);
+    secp_fe_add(&t1, &t2, &t2);
+    secp_fe_add(&t2, &t1, &t2);
+    secp_fe_sub(&t0, &t0, &t2);
+    secp_fe_mul(&y3, &t0, &y3);
+    secp_fe_add(&y3, &x3, &y3);
+    secp_fe_mul(&t1, &a->x, &a->y);
+    secp_fe_mul(&x3, &t0, &t1);
+    secp_fe_add(&x3, &x3, &x3);
+
+    r->x = x3;
+    r->y = y3;
+    r->z = z3;
+}
+
+// r = a + b for an affine b (never infinity)
+static void gep_add_ge(secp_gep *r, const secp_gep *a, const secp_ge_storage *b) {
+    secp_fe t0, t1, t2, t3, t4, x3, y3, z3;
+
+    secp_fe_mul(&t0, &a->x, &b->x);
+    secp_fe_mul(&t1, &a->y, &b->y);
+    secp_fe_add(&t3, &b->x, &b->y);
+    secp_fe_add(&t4, &a->x, &a->y);
+    secp_fe_mul(&t3, &t3, &t4);
+    secp_fe_add(&t4, &t0, &t1);
+    secp_fe_sub(&t3, &t3, &t4);
+    secp_fe_mul(&t4, &b->y, &a->z);
+    secp_fe_add(&t4, &t4, &a->y);
+    secp_fe_mul(&y3, &b->x, &a->z);
+    secp_fe_add(&y3, &y3, &a->x);
+    secp_fe_add(&x3, &t0, &t0);
+    secp_fe_add(&t0, &x3, &t0);
+    secp_fe_mul(&t2, &a->z, &FE_B3);
+    secp_fe_add(&z3, &t1, &t2);
+    secp_fe_sub(&t1, &t1, &t2);
+    secp_fe_mul(&y3, &y3, &FE_B3);
+    secp_fe_mul(&x3, &t4, &y3);
+    secp_fe_mul(&t2, &t3, &t1);
+    secp_fe_sub(&x3, &t2, &x3);
+    secp_fe_mul(&y3, &y3, &t0);
+    secp_fe_mul(&t1, &t1, &z3);
+    secp_fe_add(&y3, &t1, &y3);
+    secp_fe_mul(&t0, &t0, &t3);
+    secp_fe_mul(&z3, &z3, &t4);
+    secp_fe_add(&z3, &z3, &t0);
+
+    r->x = x3;
+    r->y = y3;
+    r->z = z3;
+}
+
+// r = a if mask is all ones, unchanged if zero
+static inline void fe_cmov(secp_fe *r, const secp_fe *a, uint32_t mask) {
+    for (int w = 0; w < 8; w++) {
+        r->n[w] = (r->n[w] & ~mask) | (a->n[w] & mask);
+    }
+}
+
+bool secp_ecmult_gen_blind(secp_gen_blind *blind, const secp_ge_storage *table, const uint8_t *seed) {
+    // c from the first half of the seed, the projective Z from the second
+    secp_scalar c;
+    secp_fe z;
+    secp_scalar_set_b32(&c, seed);
+    bool z_ok = secp_fe_set_b32(&z, seed + 32);
+    if (secp_scalar_is_zero(&c) || !z_ok || secp_fe_is_zero(&z)) {
+        return false;
+    }
+
+    // Start point C = c*G. The comb doubles it SECP_COMB_SPACING times, so
+    // the scalar is offset by -(2^SPACING * c).
+    secp_gej cj;
+    secp_ge ca;
+    secp_gen_blind none;
+    memset(&none, 0, sizeof(none));
+    secp_fe_set_int(&none.y, 1);    // (0:1:0), no blinding
+    secp_ecmult_gen(&cj, table, &none, &c);
+    secp_ge_set_gej(&ca, &cj);
+
+    secp_fe_mul(&blind->x, &ca.x, &z);
+    secp_fe_mul(&blind->y, &ca.y, &z);
+    blind->z = z;
+
+    secp_scalar shift;
+    secp_scalar_set_int(&shift, 0);
+    shift.d[SECP_COMB_SPACING / 32] = 1u << (SECP_COMB_SPACING % 32);
+    secp_scalar_mul(&blind->offset, &c, &shift);
+    secp_scalar_negate(&blind->offset, &blind->offset);
+
+    memset(&c, 0, sizeof(c));
+    return true;
+}
+
+void secp_ecmult_gen(secp_gej *r, const secp_ge_storage *table, const secp_gen_blind *blind,
+                     const secp_scalar *k) {
+    secp_scalar kb;
+    secp_scalar_add(&kb, k, &blind->offset);
+
+    secp_gep acc = { blind->x, blind->y, blind->z };
+
+    for (int col = SECP_COMB_SPACING - 1; col >= 0; col--) {
+        gep_double(&acc, &acc);
+
+        uint32_t idx = 0;
+        for (int t = 0; t < SECP_COMB_TEETH; t++) {
+            idx |= scalar_get_bit(&kb, t * SECP_COMB_SPACING + col) << t;
+        }
+
+        // Scan the whole table; entry 1 stands in for idx 0 and the sum is
+        // then discarded, so every column costs one full addition
+        secp_ge_storage p = table[0];
+        for (uint32_t j = 2; j < SECP_COMB_TABLE_SIZE; j++) {
+            uint32_t mask = 0u - (((j ^ idx) - 1) >> 31);    // j == idx, without a compare
+            fe_cmov(&p.x, &table[j - 1].x, mask);
+            fe_cmov(&p.y, &table[j - 1].y, mask);
+        }
+
+        secp_gep sum;
+        gep_add_ge(&sum, &acc, &p);
+        uint32_t keep = 0u - ((0u - idx) >> 31);            // idx != 0
+        fe_cmov(&acc.x, &sum.x, keep);
+        fe_cmov(&acc.y, &sum.y, keep);
+        fe_cmov(&acc.z, &sum.z, keep);
+    }
+    memset(&kb, 0, sizeof(kb));
+
+    // Jacobian from projective: (X*Z, Y*Z^2, Z)
+    secp_fe z2;
+    secp_fe_sqr(&z2, &acc.z);
+    secp_fe_mul(&r->x, &acc.x, &acc.z);
+    secp_fe_mul(&r->y, &acc.y, &z2);
+    r->z = acc.z;
+    r->infinity = secp_fe_is_zero(&acc.z);
+}
@@ -0,0 +1,234 @@
+/**
+ * @file secp256k1.h
+ * @brief Minimal secp256k1 arithmetic for BIP-340 Schnorr signatures
+ *
+ * Field and scalar arithmetic use 8x32-bit limbs, which maps well onto the
+ * 32-bit Xtensa/RISC-V cores. Only what NOSTR needs is implemented:
+ * x-only public keys, fixed-base multiplication by G through a precomputed
+ * odd-multiples table, and Strauss/Shamir double-scalar multiplication
+ * (a*G + b*P) with interleaved wNAF.
+ *
+ * This module is pure C (no ESP-IDF dependencies). Verification paths are
+ * variable time; they only ever see public data. Field and scalar
+ * add/sub/negate/reduce and secp_ecmult_gen() are branch-free, as signing
+ * runs them on the secret key and nonce.
+ */
+
+#ifndef GEOGRAM_SECP256K1_H
+#define GEOGRAM_SECP256K1_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// wNAF window used for the fixed-base G table (table holds 2^(w-2) points)
+#define SECP_WINDOW_G           8
+#define SECP_TABLE_SIZE_G       (1 << (SECP_WINDOW_G - 2))
+
+// wNAF window used for variable points (public keys)
+#define SECP_WINDOW_P           5
+#define SECP_TABLE_SIZE_P       (1 << (SECP_WINDOW_P - 2))
+
+// Fixed-base comb used for signing: 6 teeth spaced 43 bits apart cover
+// 258 bits, so k*G costs 43 doublings and 43 additions
+#define SECP_COMB_TEETH         6
+#define SECP_COMB_SPACING       43
+#define SECP_COMB_TABLE_SIZE    (1 << SECP_COMB_TEETH)
+
+/** Field element mod p, little-endian 32-bit limbs, always fully reduced */
+typedef struct {
+    uint32_t n[8];
+} secp_fe;
+
+/** Scalar mod n, little-endian 32-bit limbs, always fully reduced */
+typedef struct {
+    uint32_t d[8];
+} secp_scalar;
+
+/** Affine point */
+typedef struct {
+    secp_fe x;
+    secp_fe y;
+    bool infinity;
+} secp_ge;
+
+/** Jacobian point (x = X/Z^2, y = Y/Z^3) */
+typedef struct {
+    secp_fe x;
+    secp_fe y;
+    secp_fe z;
+    bool infinity;
+} secp_gej;
+
+/** Compact affine point for tables (never infinity) */
+typedef struct {
+    secp_fe x;
+    secp_fe y;
+} secp_ge_storage;
+
+// ---------------------------------------------------------------------------
+// Field
+// ---------------------------------------------------------------------------
+
+/** Load 32 big-endian bytes; returns false if the value is >= p */
+bool secp_fe_set_b32(secp_fe *r, const uint8_t *b32);
+void secp_fe_get_b32(uint8_t *b32, const secp_fe *a);
+void secp_fe_set_int(secp_fe *r, uint32_t v);
+bool secp_fe_is_zero(const secp_fe *a);
+bool secp_fe_is_odd(const secp_fe *a);
+bool secp_fe_equal(const secp_fe *a, const secp_fe *b);
+void secp_fe_add(secp_fe *r, const secp_fe *a, const secp_fe *b);
+void secp_fe_sub(secp_fe *r, const secp_fe *a, const secp_fe *b);
+void secp_fe_negate(secp_fe *r, const secp_fe *a);
+void secp_fe_mul(secp_fe *r, const secp_fe *a, const secp_fe *b);
+void secp_fe_sqr(secp_fe *r, const secp_fe *a);
+void secp_fe_inv(secp_fe *r, const secp_fe *a);
+/** Square root; returns false (and leaves garbage in r) if a is not a square */
+bool secp_fe_sqrt(secp_fe *r, const secp_fe *a);
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+/** Load 32 big-endian bytes reduced mod n; returns true if reduction happened */
+bool secp_scalar_set_b32(secp_scalar *r, const uint8_t *b32);
+void secp_scalar_get_b32(uint8_t *b32, const secp_scalar *a);
+void secp_scalar_set_int(secp_scalar *r, uint32_t v);
+bool secp_scalar_is_zero(const secp_scalar *a);
+void secp_scalar_add(secp_scalar *r, const secp_scalar *a, const secp_scalar *b);
+void secp_scalar_mul(secp_scalar *r, const secp_scalar *a, const secp_scalar *b);
+void secp_scalar_negate(secp_scalar *r, const secp_scalar *a);
+
+// ---------------------------------------------------------------------------
+// Group
+// ---------------------------------------------------------------------------
+
+/** The generator G */
+extern const secp_ge secp_ge_generator;
+
+/** Lift an x-only coordinate to the point with even y (BIP-340 lift_x) */
+bool secp_ge_set_xonly(secp_ge *r, const secp_fe *x);
+void secp_ge_set_gej(secp_ge *r, const secp_gej *a);
+void secp_ge_neg(secp_ge *r, const secp_ge *a);
+void secp_gej_set_ge(secp_gej *r, const secp_ge *a);
+void secp_gej_set_infinity(secp_gej *r);
+void secp_gej_double(secp_gej *r, const secp_gej *a);
+void secp_gej_add(secp_gej *r, const secp_gej *a, const secp_gej *b);
+void secp_gej_add_ge(secp_gej *r, const secp_gej *a, const secp_ge *b);
+
+/**
+ * @brief Convert n Jacobian points to affine with a single inversion
+ *
+ * None of the inputs may be infinity.
+ */
+void secp_ge_set_all_gej(secp_ge_storage *r, const secp_gej *a, size_t n);
+
+// ---------------------------------------------------------------------------
+// Multiplication
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Build the odd-multiples table [1,3,5,...]*P in affine form
+ *
+ * @param table Output, `count` entries
+ * @param p Base point (not infinity)
+ * @param count Table size (SECP_TABLE_SIZE_G for G, SECP_TABLE_SIZE_P for keys)
+ * @return false if scratch memory for a large table could not be allocated
+ */
+bool secp_ecmult_odd_table(secp_ge_storage *table, const secp_ge *p, size_t count);
+
+/**
+ * @brief Build odd-multiples tables for several points with one inversion
+ *
+ * @param tables Output, n * SECP_TABLE_SIZE_P entries (table i at i * SECP_TABLE_SIZE_P)
+ * @param points Base points (none may be infinity)
+ * @param n Number of points
+ * @return false if scratch memory could not be allocated
+ */
+bool secp_ecmult_odd_tables(secp_ge_storage *tables, const secp_ge *points, size_t n);
+
+/**
+ * @brief Strauss/Shamir double multiplication r = na*G + np*P
+ *
+ * @param r Result
+ * @param table_g Odd multiples of G (SECP_TABLE_SIZE_G entries)
+ * @param na Scalar for G
+ * @param table_p Odd multiples of P (SECP_TABLE_SIZE_P entries), or NULL
+ * @param np Scalar for P (ignored if table_p is NULL)
+ */
+void secp_ecmult(secp_gej *r, const secp_ge_storage *table_g, const secp_scalar *na,
+                 const secp_ge_storage *table_p, const secp_scalar *np);
+
+/**
+ * @brief Interleaved multi-scalar multiplication r = ng*G + sum(scalars[i]*P_i)
+ *
+ * All points share one doubling chain, which is what makes batch
+ * verification cheaper than verifying signatures one by one.
+ *
+ * @param r Result
+ * @param table_g Odd multiples of G
+ * @param ng Scalar for G
+ * @param tables n odd-multiples tables (SECP_TABLE_SIZE_P entries each)
+ * @param scalars n scalars
+ * @param n Number of variable points
+ * @return false if scratch memory could not be allocated
+ */
+bool secp_ecmult_multi(secp_gej *r, const secp_ge_storage *table_g, const secp_scalar *ng,
+                       const secp_ge_storage *tables, const secp_scalar *scalars, size_t n);
+
+/**
+ * @brief Build the comb table for secp_ecmult_gen()
+ *
+ * @param table Output, SECP_COMB_TABLE_SIZE - 1 entries
+ * @return false if scratch memory could not be allocated
+ */
+bool secp_ecmult_gen_table(secp_ge_storage *table);
+
+/**
+ * @brief Blinding for secp_ecmult_gen()
+ *
+ * The comb starts from a random point C (with a random projective Z) and
+ * multiplies k + offset, where offset cancels C after the doublings.
+ */
+typedef struct {
+    secp_fe x;
+    secp_fe y;
+    secp_fe z;                  // Start point C, projective (X:Y:Z)
+    secp_scalar offset;         // -(2^SECP_COMB_SPACING * c) mod n
+} secp_gen_blind;
+
+/**
+ * @brief Derive a blinding from 64 random bytes
+ *
+ * @param blind Output
+ * @param table Comb table from secp_ecmult_gen_table()
+ * @param seed 64 bytes: the blinding scalar c, then the projective Z
+ * @return false if the seed gives c = 0 or an unusable Z (draw a new one)
+ */
+bool secp_ecmult_gen_blind(secp_gen_blind *blind, const secp_ge_storage *table, const uint8_t *seed);
+
+/**
+ * @brief Fixed-base multiplication r = k*G for secret scalars, constant time
+ *
+ * Each column doubles and adds with complete projective formulas (no
+ * special cases), selects its table entry by scanning every entry with
+ * masks, and adds even for a zero column, discarding the sum by mask. The
+ * accumulator starts from the blinded point, so it is never a known value.
+ *
+ * @param r Result
+ * @param table Comb table from secp_ecmult_gen_table()
+ * @param blind Blinding from secp_ecmult_gen_blind()
+ * @param k Scalar
+ */
+void secp_ecmult_gen(secp_gej *r, const secp_ge_storage *table, const secp_gen_blind *blind,
+                     const secp_scalar *k);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_SECP256K1_H
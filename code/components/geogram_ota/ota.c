@@ -0,0 +1,327 @@
+/**
+ * @file ota.c
+ * @brief Station firmware updates, full image or detools delta
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "ota.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_delta_ota.h"
+#include "mbedtls/sha256.h"
+#include "http_client_async.h"
+
+static const char *TAG = "ota";
+
+// Payload read/download piece
+#define OTA_CHUNK_SIZE      4096
+
+// Per network read
+#define OTA_TIMEOUT_MS      30000
+
+struct geogram_ota {
+    geogram_ota_kind_t kind;
+    const esp_partition_t *target;
+    esp_ota_handle_t handle;
+    esp_delta_ota_handle_t delta;
+    mbedtls_sha256_context sha;     // Of the image as written
+    size_t written;
+    bool failed;
+    char sha256[65];
+};
+
+// One update at a time; the delta source read callback has no context
+static geogram_ota_t *s_active = NULL;
+static const esp_partition_t *s_running = NULL;
+
+/**
+ * @brief Delta source: the running image
+ */
+static esp_err_t read_running(uint8_t *buf, size_t size, int offset)
+{
+    return esp_partition_read(s_running, offset, buf, size);
+}
+
+/**
+ * @brief Write the next piece of the new image to the inactive slot
+ */
+static esp_err_t write_image(const uint8_t *data, size_t size, void *ctx)
+{
+    geogram_ota_t *ota = (geogram_ota_t *)ctx;
+    esp_err_t ret = esp_ota_write(ota->handle, data, size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Flash write failed at %zu: %s", ota->written, esp_err_to_name(ret));
+        return ret;
+    }
+    mbedtls_sha256_update(&ota->sha, data, size);
+    ota->written += size;
+    return ESP_OK;
+}
+
+static bool is_sha256_hex(const char *s)
+{
+    if (s == NULL || strlen(s) != 64) {
+        return false;
+    }
+    for (int i = 0; i < 64; i++) {
+        if (!isxdigit((unsigned char)s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void release(geogram_ota_t *ota)
+{
+    if (ota->delta) {
+        esp_delta_ota_deinit(ota->delta);
+    }
+    mbedtls_sha256_free(&ota->sha);
+    free(ota);
+    s_active = NULL;
+}
+
+esp_err_t geogram_ota_begin(geogram_ota_kind_t kind, const char *sha256, geogram_ota_t **ota)
+{
+    if (ota == NULL || !is_sha256_hex(sha256)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_active != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+    if (target == NULL) {
+        ESP_LOGE(TAG, "No OTA slot in the partition table");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    geogram_ota_t *o = calloc(1, sizeof(geogram_ota_t));
+    if (o == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    o->kind = kind;
+    o->target = target;
+    strlcpy(o->sha256, sha256, sizeof(o->sha256));
+    mbedtls_sha256_init(&o->sha);
+    mbedtls_sha256_starts(&o->sha, 0);
+
+    // Sequential writes erase the slot as they go instead of all up front
+    esp_err_t ret = esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &o->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(ret));
+        mbedtls_sha256_free(&o->sha);
+        free(o);
+        return ret;
+    }
+
+    if (kind == GEOGRAM_OTA_DELTA) {
+        s_running = esp_ota_get_running_partition();
+        esp_delta_ota_cfg_t cfg = {
+            .read_cb = read_running,
+            .write_cb_with_user_data = write_image,
+            .user_data = o,
+        };
+        o->delta = esp_delta_ota_init(&cfg);
+        if (o->delta == NULL) {
+            ESP_LOGE(TAG, "esp_delta_ota_init failed");
+            esp_ota_abort(o->handle);
+            mbedtls_sha256_free(&o->sha);
+            free(o);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "Writing %s update to %s (0x%lx)", kind == GEOGRAM_OTA_DELTA ? "delta" : "full",
+             target->label, (unsigned long)target->address);
+    s_active = o;
+    *ota = o;
+    return ESP_OK;
+}
+
+esp_err_t geogram_ota_write(geogram_ota_t *ota, const uint8_t *data, size_t len)
+{
+    if (ota == NULL || ota->failed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret;
+    if (ota->kind == GEOGRAM_OTA_DELTA) {
+        ret = esp_delta_ota_feed_patch(ota->delta, data, (int)len);
+    } else {
+        ret = write_image(data, len, ota);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Update failed: %s", esp_err_to_name(ret));
+        ota->failed = true;
+    }
+    return ret;
+}
+
+esp_err_t geogram_ota_finish(geogram_ota_t *ota)
+{
+    if (ota == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ota->failed ? ESP_FAIL : ESP_OK;
+    if (ret == ESP_OK && ota->kind == GEOGRAM_OTA_DELTA) {
+        ret = esp_delta_ota_finalize(ota->delta);
+    }
+
+    if (ret == ESP_OK) {
+        uint8_t digest[32];
+        char hex[65];
+        mbedtls_sha256_finish(&ota->sha, digest);
+        for (int i = 0; i < 32; i++) {
+            snprintf(hex + i * 2, 3, "%02x", digest[i]);
+        }
+        if (strcasecmp(hex, ota->sha256) != 0) {
+            ESP_LOGE(TAG, "Image SHA-256 mismatch: %s", hex);
+            ret = ESP_ERR_INVALID_CRC;
+        }
+    }
+
+    if (ret != ESP_OK) {
+        esp_ota_abort(ota->handle);
+    } else {
+        // Checks the app image format and its own checksum
+        ret = esp_ota_end(ota->handle);
+        if (ret == ESP_OK) {
+            ret = esp_ota_set_boot_partition(ota->target);
+        }
+    }
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Update written (%zu bytes), boots from %s after restart",
+                 ota->written, ota->target->label);
+    } else {
+        ESP_LOGE(TAG, "Update rejected: %s", esp_err_to_name(ret));
+    }
+    release(ota);
+    return ret;
+}
+
+void geogram_ota_abort(geogram_ota_t *ota)
+{
+    if (ota == NULL) {
+        return;
+    }
+    esp_ota_abort(ota->handle);
+    release(ota);
+}
+
+/**
+ * @brief Body callback: feed the download to the update
+ */
+static bool ota_receive(const uint8_t *data, size_t len, void *ctx)
+{
+    return geogram_ota_write((geogram_ota_t *)ctx, data, len) == ESP_OK;
+}
+
+esp_err_t geogram_ota_from_url(const char *url, geogram_ota_kind_t kind, const char *sha256)
+{
+    if (url == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t *buffer = malloc(OTA_CHUNK_SIZE);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    geogram_ota_t *ota;
+    esp_err_t ret = geogram_ota_begin(kind, sha256, &ota);
+    if (ret != ESP_OK) {
+        free(buffer);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Downloading %s", url);
+    http_client_request_t request = http_client_default_config();
+    request.url = url;
+    request.timeout_ms = OTA_TIMEOUT_MS;
+    request.user_agent = "Geogram-ESP32/1.0";
+    request.on_data = ota_receive;
+    request.on_data_ctx = ota;
+
+    http_client_response_t response = {
+        .data = buffer,
+        .buffer_size = OTA_CHUNK_SIZE,
+        .data_len = 0,
+        .status_code = 0,
+    };
+
+    ret = http_client_get_async(&request, &response);
+    free(buffer);
+    if (ret == ESP_OK && response.status_code != 200) {
+        ESP_LOGE(TAG, "Download failed: HTTP %d", response.status_code);
+        ret = ESP_FAIL;
+    }
+    if (ret != ESP_OK) {
+        geogram_ota_abort(ota);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Received %zu bytes", response.data_len);
+    return geogram_ota_finish(ota);
+}
+
+esp_err_t geogram_ota_from_file(const char *path, geogram_ota_kind_t kind, const char *sha256)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t *buffer = malloc(OTA_CHUNK_SIZE);
+    if (buffer == NULL) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+
+    geogram_ota_t *ota;
+    esp_err_t ret = geogram_ota_begin(kind, sha256, &ota);
+    if (ret == ESP_OK) {
+        size_t n;
+        while (ret == ESP_OK && (n = fread(buffer, 1, OTA_CHUNK_SIZE, f)) > 0) {
+            ret = geogram_ota_write(ota, buffer, n);
+        }
+        if (ret == ESP_OK && ferror(f)) {
+            ESP_LOGE(TAG, "Read error in %s", path);
+            ret = ESP_FAIL;
+        }
+        if (ret == ESP_OK) {
+            ret = geogram_ota_finish(ota);
+        } else {
+            geogram_ota_abort(ota);
+        }
+    }
+
+    free(buffer);
+    fclose(f);
+    return ret;
+}
+
+esp_err_t geogram_ota_confirm(void)
+{
+    esp_ota_img_states_t state;
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (esp_ota_get_state_partition(running, &state) != ESP_OK ||
+        state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "New firmware in %s started, cancelling rollback", running->label);
+    return esp_ota_mark_app_valid_cancel_rollback();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file ota.h
+ * @brief Station firmware updates, as a full image or a binary delta
+ *
+ * The new firmware is written to the inactive OTA slot while it streams in
+ * from HTTP or the SD card; nothing is buffered beyond one chunk. A delta
+ * is a detools patch (heatshrink, from esp_delta_ota's patch generator)
+ * made against the running firmware.bin: it is applied on the fly, reading
+ * unchanged parts from the running slot, so only the patch crosses the link.
+ *
+ * Either way the written image must match the expected SHA-256 (sha256sum
+ * of the new firmware.bin) before it is made bootable. The bootloader runs
+ * it on probation: geogram_ota_confirm() keeps it, a reset before that
+ * rolls back to the previous image.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Update payload format
+ */
+typedef enum {
+    GEOGRAM_OTA_FULL,           /**< Complete firmware.bin */
+    GEOGRAM_OTA_DELTA,          /**< detools patch against the running image */
+} geogram_ota_kind_t;
+
+typedef struct geogram_ota geogram_ota_t;
+
+/**
+ * @brief Start an update into the inactive slot
+ *
+ * Only one update runs at a time.
+ *
+ * @param kind Payload format
+ * @param sha256 Expected SHA-256 of the resulting image (64 hex digits)
+ * @param ota Receives the update session
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED without an OTA slot,
+ *         ESP_ERR_INVALID_STATE if an update is already running
+ */
+esp_err_t geogram_ota_begin(geogram_ota_kind_t kind, const char *sha256, geogram_ota_t **ota);
+
+/**
+ * @brief Feed the next piece of the payload
+ */
+esp_err_t geogram_ota_write(geogram_ota_t *ota, const uint8_t *data, size_t len);
+
+/**
+ * @brief Verify the image and make it the next boot partition
+ *
+ * Frees the session whatever the result.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_CRC on a SHA-256 mismatch,
+ *         ESP_ERR_OTA_VALIDATE_FAILED if the image is not a valid app
+ */
+esp_err_t geogram_ota_finish(geogram_ota_t *ota);
+
+/**
+ * @brief Drop an update, leaving the boot partition unchanged
+ */
+void geogram_ota_abort(geogram_ota_t *ota);
+
+/**
+ * @brief Download and apply an update
+ *
+ * @param url Payload URL (redirects are followed)
+ * @param kind Payload format
+ * @param sha256 Expected SHA-256 of the resulting image
+ * @return ESP_OK when the new image will boot on the next restart
+ */
+esp_err_t geogram_ota_from_url(const char *url, geogram_ota_kind_t kind, const char *sha256);
+
+/**
+ * @brief Apply an update stored in a file (e.g. on the SD card)
+ *
+ * @param path Payload path
+ * @param kind Payload format
+ * @param sha256 Expected SHA-256 of the resulting image
+ * @return ESP_OK when the new image will boot on the next restart
+ */
+esp_err_t geogram_ota_from_file(const char *path, geogram_ota_kind_t kind, const char *sha256);
+
+/**
+ * @brief Keep the running image after an update
+ *
+ * Call once the station has started; no-op if the image is not on probation.
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t geogram_ota_confirm(void);
+
+#ifdef __cplusplus
+}
+#endif
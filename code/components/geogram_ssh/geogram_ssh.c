@@ -5,13 +5,16 @@
 
 #include "geogram_ssh.h"
 #include "ssh_server.h"  // From ssh_cli_server component
+#include "sdcard.h"
 
 #include <stdio.h>
 #include <string.h>
+#include "sdkconfig.h"
 #include "esp_log.h"
 #include "esp_console.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_vfs_eventfd.h"
 #include "mbedtls/pk.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
@@ -38,6 +41,20 @@ static const char *TAG = "geogram_ssh";
 #define HOST_KEY_PEM_SIZE   2048
 #define PASSWORD_MAX_LEN    64
 
+// Served as "/" over SFTP, as FTP does
+#define SFTP_ROOT_DIR       "/sdcard"
+
+#if CONFIG_SPIRAM
+// Admin sessions: a shell plus an SFTP transfer each fit the budget
+#define SSH_MAX_SESSIONS        3
+#define SSH_SESSION_BUDGET      (160 * 1024)
+#else
+// Internal RAM only: a shell channel (30 KB) fits, SFTP (74 KB) is refused
+#define SSH_MAX_SESSIONS        2
+#define SSH_SESSION_BUDGET      (40 * 1024)
+#endif
+#define SSH_IDLE_TIMEOUT_S      (30 * 60)
+
 static bool s_running = false;
 static uint16_t s_port = 0;
 static char s_host_key[HOST_KEY_PEM_SIZE] = {0};
@@ -294,7 +311,18 @@ esp_err_t geogram_ssh_start(uint16_t port) {
     static char port_str[8];  // Static to persist after function returns
     snprintf(port_str, sizeof(port_str), "%d", port);
 
-    ssh_server_config_t config = {
+    // Each session wakes its event loop through an eventfd
+    esp_vfs_eventfd_config_t eventfd_config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    eventfd_config.max_fds = SSH_MAX_SESSIONS + 2;
+    esp_err_t err = esp_vfs_eventfd_register(&eventfd_config);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to register eventfd: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // The server keeps using the config, so it must outlive this call
+    static ssh_server_config_t config;
+    config = (ssh_server_config_t){
         .bindaddr = "0.0.0.0",
         .port = port_str,
         .debug_level = "0",
@@ -309,6 +337,12 @@ esp_err_t geogram_ssh_start(uint16_t port) {
         .shell_func = ssh_shell_callback,
         .shell_func_ctx = NULL,
         .shell_task_size = 8192,
+        .write_buffer_size = 16 * 1024,  // Long command output, SFTP downloads
+        .read_buffer_size = 4 * 1024,    // Room for pipelined SFTP requests
+        .sftp_root = sdcard_is_mounted() ? SFTP_ROOT_DIR : NULL,
+        .max_sessions = SSH_MAX_SESSIONS,
+        .session_memory_budget = SSH_SESSION_BUDGET,
+        .idle_timeout_s = SSH_IDLE_TIMEOUT_S,
         .shell_task_kill_on_disconnect = true,
     };
 
@@ -1,7 +1,9 @@
 #include "station.h"
 #include "json_utils.h"
 #include "nostr_keys.h"
+#include "nostr_event.h"
 #include "app_config.h"
+#include "geogram_metrics.h"
 
 #if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
 #include "tiles.h"
@@ -22,6 +24,31 @@ static const char *TAG = "Station";
 // Singleton station state
 static station_state_t s_station = {0};
 
+// Last signed status: re-signed only when the document changes.
+// Only used from the HTTP server task.
+static char s_signed_content[STATION_STATUS_JSON_LEN];
+static char s_signed_status[STATION_SIGNED_STATUS_LEN];
+static size_t s_signed_status_len = 0;
+
+// Cached /api/status document, re-rendered when marked dirty or when the
+// uptime second rolls over. Read and rendered only from the HTTP server task;
+// s_status_changes may be bumped from any task.
+static char s_status_cache[STATION_STATUS_JSON_LEN];
+static size_t s_status_len = 0;
+static bool s_status_too_large = false;
+static uint32_t s_status_hash = 0;
+static uint32_t s_status_uptime = 0;
+static uint32_t s_status_seen = 0;
+static volatile uint32_t s_status_changes = 1;
+
+static int64_t read_client_count(const geogram_metric_t *metric) {
+    (void)metric;
+    return s_station.client_count;
+}
+
+static geogram_metric_t s_clients_metric = GEOGRAM_METRIC_READ_INIT(
+    GEOGRAM_METRIC_GAUGE, "geogram_station_clients", "Station clients connected", read_client_count, 0);
+
 void station_init(void) {
     if (s_station.initialized) {
         return;
@@ -55,6 +82,7 @@ void station_init(void) {
     }
 
     s_station.initialized = true;
+    geogram_metrics_register(&s_clients_metric);
 
     ESP_LOGI(TAG, "Station initialized: %s (%s)", s_station.name, s_station.callsign);
 }
@@ -96,6 +124,7 @@ void station_set_location(double latitude, double longitude,
     }
 
     s_station.has_location = true;
+    station_mark_status_dirty();
 
     ESP_LOGI(TAG, "Station location updated: %s (%.4f, %.4f) TZ: %s",
              s_station.location, latitude, longitude, s_station.timezone);
@@ -112,6 +141,7 @@ int station_add_client(int fd) {
             client->last_activity = client->connected_at;
             client->authenticated = false;
             s_station.client_count++;
+            station_mark_status_dirty();
 
             ESP_LOGI(TAG, "Client added: fd=%d (total: %d)", fd, s_station.client_count);
             return i;
@@ -129,6 +159,7 @@ void station_remove_client(int fd) {
                      fd, s_station.clients[i].callsign[0] ? s_station.clients[i].callsign : "(none)");
             s_station.clients[i].fd = -1;
             s_station.client_count--;
+            station_mark_status_dirty();
             return;
         }
     }
@@ -183,71 +214,160 @@ void station_client_activity(station_client_t *client) {
     }
 }
 
-size_t station_build_status_json(char *buffer, size_t size) {
-    geo_json_builder_t builder;
-    geo_json_init(&builder, buffer, size);
-
-    geo_json_object_start(&builder);
+static void write_status(geo_json_builder_t *builder, bool include_uptime) {
+    geo_json_object_start(builder);
 
     // Core identification (matching p2p.radio format)
-    geo_json_add_string(&builder, "service", "Geogram Station Server");
-    geo_json_add_string(&builder, "name", s_station.name);
-    geo_json_add_string(&builder, "version", STATION_VERSION);
-    geo_json_add_string(&builder, "callsign", s_station.callsign);
-    geo_json_add_string(&builder, "description", "Geogram ESP32 Station");
-    geo_json_add_string(&builder, "platform", "esp32");
+    geo_json_add_string(builder, "service", "Geogram Station Server");
+    geo_json_add_string(builder, "name", s_station.name);
+    geo_json_add_string(builder, "version", STATION_VERSION);
+    geo_json_add_string(builder, "callsign", s_station.callsign);
+    geo_json_add_string(builder, "description", "Geogram ESP32 Station");
+    geo_json_add_string(builder, "platform", "esp32");
 
     // Station status
-    geo_json_add_bool(&builder, "station_mode", true);
-    geo_json_add_uint(&builder, "uptime", station_get_uptime());
-    geo_json_add_int(&builder, "connected_devices", s_station.client_count);
+    geo_json_add_bool(builder, "station_mode", true);
+    if (include_uptime) {
+        geo_json_add_uint(builder, "uptime", station_get_uptime());
+    }
+    geo_json_add_int(builder, "connected_devices", s_station.client_count);
 
     // Location data
     if (s_station.has_location) {
-        geo_json_add_string(&builder, "location", s_station.location);
-        geo_json_add_double(&builder, "latitude", s_station.latitude, 6);
-        geo_json_add_double(&builder, "longitude", s_station.longitude, 6);
-        geo_json_add_string(&builder, "timezone", s_station.timezone);
+        geo_json_add_string(builder, "location", s_station.location);
+        geo_json_add_double(builder, "latitude", s_station.latitude, 6);
+        geo_json_add_double(builder, "longitude", s_station.longitude, 6);
+        geo_json_add_string(builder, "timezone", s_station.timezone);
     }
 
     // Tile server (available when SD card is present)
 #if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
     bool tile_available = tiles_is_available();
-    geo_json_add_bool(&builder, "tile_server", tile_available);
-    geo_json_add_bool(&builder, "osm_fallback", !tile_available);
-    geo_json_add_uint(&builder, "cache_size", tile_available ? tiles_get_cache_count() : 0);
-    geo_json_add_uint(&builder, "cache_size_bytes", tile_available ? tiles_get_cache_size() : 0);
+    geo_json_add_bool(builder, "tile_server", tile_available);
+    geo_json_add_bool(builder, "osm_fallback", !tile_available);
+    geo_json_add_uint(builder, "cache_size", tile_available ? tiles_get_cache_count() : 0);
+    geo_json_add_uint(builder, "cache_size_bytes", tile_available ? tiles_get_cache_size() : 0);
 #else
-    geo_json_add_bool(&builder, "tile_server", false);
-    geo_json_add_bool(&builder, "osm_fallback", true);
-    geo_json_add_uint(&builder, "cache_size", 0);
-    geo_json_add_uint(&builder, "cache_size_bytes", 0);
+    geo_json_add_bool(builder, "tile_server", false);
+    geo_json_add_bool(builder, "osm_fallback", true);
+    geo_json_add_uint(builder, "cache_size", 0);
+    geo_json_add_uint(builder, "cache_size_bytes", 0);
 #endif
 
     // Features
-    geo_json_add_bool(&builder, "enable_aprs", false);
-    geo_json_add_int(&builder, "chat_rooms", 0);
+    geo_json_add_bool(builder, "enable_aprs", false);
+    geo_json_add_int(builder, "chat_rooms", 0);
 
     // Network ports
-    geo_json_add_int(&builder, "http_port", 80);
-    geo_json_add_bool(&builder, "https_enabled", false);
-    geo_json_add_int(&builder, "https_port", 0);
-    geo_json_add_bool(&builder, "https_running", false);
+    geo_json_add_int(builder, "http_port", 80);
+    geo_json_add_bool(builder, "https_enabled", false);
+    geo_json_add_int(builder, "https_port", 0);
+    geo_json_add_bool(builder, "https_running", false);
 
     // Mesh networking status
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
-    geo_json_add_bool(&builder, "mesh_enabled", true);
-    geo_json_add_bool(&builder, "mesh_connected", geogram_mesh_is_connected());
-    geo_json_add_bool(&builder, "mesh_is_root", geogram_mesh_is_root());
-    geo_json_add_int(&builder, "mesh_layer", geogram_mesh_get_layer());
-    geo_json_add_int(&builder, "mesh_nodes", geogram_mesh_get_node_count());
+    geo_json_add_bool(builder, "mesh_enabled", true);
+    geo_json_add_bool(builder, "mesh_connected", geogram_mesh_is_connected());
+    geo_json_add_bool(builder, "mesh_is_root", geogram_mesh_is_root());
+    geo_json_add_int(builder, "mesh_layer", geogram_mesh_get_layer());
+    geo_json_add_int(builder, "mesh_nodes", geogram_mesh_get_node_count());
 #else
-    geo_json_add_bool(&builder, "mesh_enabled", false);
+    geo_json_add_bool(builder, "mesh_enabled", false);
 #endif
 
-    geo_json_object_end(&builder);
+    geo_json_object_end(builder);
+}
+
+static size_t build_status(char *buffer, size_t size, bool include_uptime) {
+    geo_json_builder_t builder;
+    geo_json_init(&builder, buffer, size);
+    write_status(&builder, include_uptime);
+    return geo_json_flush(&builder) ? geo_json_get_length(&builder) : 0;
+}
+
+size_t station_build_status_json(char *buffer, size_t size) {
+    return build_status(buffer, size, true);
+}
+
+void station_write_status_json(geo_json_builder_t *builder) {
+    write_status(builder, true);
+}
+
+void station_mark_status_dirty(void) {
+    s_status_changes++;
+}
 
-    return geo_json_get_length(&builder);
+// FNV-1a, used as the document's ETag
+static uint32_t status_hash(const char *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+const char *station_get_status_json(size_t *len, uint32_t *etag) {
+    uint32_t uptime = station_get_uptime();
+    uint32_t changes = s_status_changes;
+
+    if (changes != s_status_seen || uptime != s_status_uptime) {
+        // Read the counter before rendering so an event during the render
+        // still triggers the next one
+        s_status_seen = changes;
+        s_status_uptime = uptime;
+
+        char content[STATION_STATUS_JSON_LEN];
+        size_t content_len = build_status(content, sizeof(content), true);
+        if (content_len == 0) {
+            // Never serve a stale copy; callers stream the document instead
+            if (!s_status_too_large) {
+                ESP_LOGW(TAG, "Status document exceeds %u bytes, not cached", (unsigned)sizeof(content));
+                s_status_too_large = true;
+            }
+            s_status_len = 0;
+        } else {
+            s_status_too_large = false;
+            uint32_t hash = status_hash(content, content_len);
+            if (content_len != s_status_len || hash != s_status_hash ||
+                memcmp(content, s_status_cache, content_len) != 0) {
+                memcpy(s_status_cache, content, content_len + 1);
+                s_status_len = content_len;
+                s_status_hash = hash;
+            }
+        }
+    }
+
+    if (len) *len = s_status_len;
+    if (etag) *etag = s_status_hash;
+    return s_status_len > 0 ? s_status_cache : NULL;
+}
+
+size_t station_build_signed_status_json(char *buffer, size_t size) {
+    char content[STATION_STATUS_JSON_LEN];
+    if (build_status(content, sizeof(content), false) == 0) {
+        ESP_LOGW(TAG, "Status document exceeds %u bytes", (unsigned)sizeof(content));
+        return 0;
+    }
+
+    if (s_signed_status_len == 0 || strcmp(content, s_signed_content) != 0) {
+        esp_err_t ret = nostr_sign_event(STATION_STATUS_EVENT_KIND, 0,
+                                         "[[\"d\",\"geogram-status\"]]", content,
+                                         s_signed_status, sizeof(s_signed_status));
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to sign status: %s", esp_err_to_name(ret));
+            s_signed_status_len = 0;
+            return 0;
+        }
+        strcpy(s_signed_content, content);
+        s_signed_status_len = strlen(s_signed_status);
+        ESP_LOGI(TAG, "Status re-signed (%u bytes)", (unsigned)s_signed_status_len);
+    }
+
+    if (s_signed_status_len >= size) {
+        return 0;
+    }
+    memcpy(buffer, s_signed_status, s_signed_status_len + 1);
+    return s_signed_status_len;
 }
 
 size_t station_build_hello_ack_json(char *buffer, size_t size, bool success, const char *message) {
@@ -262,7 +382,7 @@ size_t station_build_hello_ack_json(char *buffer, size_t size, bool success, con
     geo_json_add_string(&builder, "version", STATION_VERSION);
     geo_json_object_end(&builder);
 
-    return geo_json_get_length(&builder);
+    return geo_json_flush(&builder) ? geo_json_get_length(&builder) : 0;
 }
 
 size_t station_build_pong_json(char *buffer, size_t size) {
@@ -277,7 +397,7 @@ size_t station_build_pong_json(char *buffer, size_t size) {
     geo_json_add_int64(&builder, "timestamp", timestamp);
     geo_json_object_end(&builder);
 
-    return geo_json_get_length(&builder);
+    return geo_json_flush(&builder) ? geo_json_get_length(&builder) : 0;
 }
 
 void station_foreach_client(station_client_callback_t callback, void *ctx) {
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "json_utils.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +18,11 @@ extern "C" {
 #define STATION_NAME_LEN 32
 #define STATION_LOCATION_LEN 64
 #define STATION_TIMEZONE_LEN 48
+#define STATION_STATUS_JSON_LEN 1024            // Status document (about 750 bytes with every field at full length)
+// Status document wrapped in a signed event: the content escaped (at most
+// doubled) plus about 380 bytes of id, pubkey, sig, kind and tags
+#define STATION_SIGNED_STATUS_LEN (2 * STATION_STATUS_JSON_LEN + 512)
+#define STATION_STATUS_EVENT_KIND 30078         // NIP-78 application data
 
 // Connected WebSocket client
 typedef struct {
@@ -83,13 +89,32 @@ void station_client_set_info(station_client_t *client, const char *callsign,
 // Update client activity timestamp
 void station_client_activity(station_client_t *client);
 
-// Build status JSON into buffer
+// Build status JSON into buffer. Returns 0 if it does not fit
 size_t station_build_status_json(char *buffer, size_t size);
 
-// Build hello_ack JSON into buffer
+// Write status JSON to a builder (e.g. one streaming to an HTTP response)
+void station_write_status_json(geo_json_builder_t *builder);
+
+// Cached status document. It is re-rendered only after
+// station_mark_status_dirty() or once per second for the uptime field;
+// etag (a hash of the bytes) changes whenever the document does. Returns NULL if the document outgrew STATION_STATUS_JSON_LEN;
+// stream it with station_write_status_json() instead. Call from the HTTP
+// server task only.
+const char *station_get_status_json(size_t *len, uint32_t *etag);
+
+// Flag the cached status as stale (client, mesh or location change).
+// Safe to call from any task.
+void station_mark_status_dirty(void);
+
+// Build the status document as a NOSTR event signed with the station key.
+// Uptime is left out so the signature is reused until something else changes.
+// Returns 0 if no signing key is available or the event does not fit.
+size_t station_build_signed_status_json(char *buffer, size_t size);
+
+// Build hello_ack JSON into buffer. Returns 0 if it does not fit
 size_t station_build_hello_ack_json(char *buffer, size_t size, bool success, const char *message);
 
-// Build PONG JSON into buffer
+// Build PONG JSON into buffer. Returns 0 if it does not fit
 size_t station_build_pong_json(char *buffer, size_t size);
 
 // Iterate over authenticated clients (for broadcasting)
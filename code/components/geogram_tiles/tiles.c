@@ -3,6 +3,7 @@
  * @brief Tile cache manager implementation
  */
 
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -10,7 +11,11 @@
 #include "tiles.h"
 #include "sdcard.h"
 #include "esp_log.h"
+#include "geogram_dlog.h"
+#include "geogram_metrics.h"
+#include "esp_timer.h"
 #include "http_client_async.h"
+#include "http_route.h"
 
 static const char *TAG = "tiles";
 
@@ -33,6 +38,39 @@ static const char *TAG = "tiles";
 static tile_cache_stats_t s_stats = {0};
 static bool s_initialized = false;
 
+// Metrics: the cache counters are read from s_stats at export time
+static int64_t read_stat(const geogram_metric_t *metric)
+{
+    return *(const uint32_t *)((const uint8_t *)&s_stats + metric->arg);
+}
+
+static geogram_metric_t s_metrics[] = {
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_tiles_cache_hits_total",
+                             "Tiles served from the SD cache", read_stat,
+                             offsetof(tile_cache_stats_t, cache_hits)),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_tiles_cache_misses_total",
+                             "Tiles downloaded from the tile server", read_stat,
+                             offsetof(tile_cache_stats_t, cache_misses)),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_COUNTER, "geogram_tiles_download_errors_total",
+                             "Tile downloads that failed", read_stat,
+                             offsetof(tile_cache_stats_t, download_errors)),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_GAUGE, "geogram_tiles_cached",
+                             "Tiles cached since boot", read_stat,
+                             offsetof(tile_cache_stats_t, total_tiles)),
+    GEOGRAM_METRIC_READ_INIT(GEOGRAM_METRIC_GAUGE, "geogram_tiles_cached_bytes",
+                             "Bytes of tiles cached since boot", read_stat,
+                             offsetof(tile_cache_stats_t, cache_size_bytes)),
+};
+static geogram_histogram_t s_read_latency =
+    GEOGRAM_HISTOGRAM_INIT("geogram_tiles_cache_read_seconds", "Time to read a tile from the SD cache");
+static geogram_histogram_t s_download_latency =
+    GEOGRAM_HISTOGRAM_INIT("geogram_tiles_download_seconds", "Time to download a tile, failures included");
+
+// Tile buffer of the HTTP handler: allocated on the first request and kept,
+// so serving tiles doesn't churn the heap (the httpd task runs one handler
+// at a time)
+static uint8_t *s_tile_buffer = NULL;
+
 /**
  * @brief Create directory recursively
  */
@@ -124,7 +162,9 @@ static esp_err_t tile_read_cache(int z, int x, int y, tile_layer_t layer,
     char path[256];
     build_tile_path(path, sizeof(path), z, x, y, layer);
 
+    int64_t start_us = esp_timer_get_time();
     esp_err_t ret = sdcard_read_file(path, buffer, buffer_size, tile_size);
+    geogram_histogram_observe(&s_read_latency, esp_timer_get_time() - start_us);
     if (ret == ESP_OK) {
         s_stats.cache_hits++;
         ESP_LOGD(TAG, "Cache hit: %s (%zu bytes)", path, *tile_size);
@@ -155,7 +195,9 @@ static esp_err_t tile_download(int z, int x, int y, tile_layer_t layer,
         .status_code = 0,
     };
 
+    int64_t start_us = esp_timer_get_time();
     esp_err_t ret = http_client_get_async(&request, &response);
+    geogram_histogram_observe(&s_download_latency, esp_timer_get_time() - start_us);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to download tile: %s", esp_err_to_name(ret));
         s_stats.download_errors++;
@@ -171,7 +213,7 @@ static esp_err_t tile_download(int z, int x, int y, tile_layer_t layer,
     *tile_size = response.data_len;
     s_stats.cache_misses++;
 
-    ESP_LOGI(TAG, "Downloaded tile: z=%d x=%d y=%d (%zu bytes)", z, x, y, *tile_size);
+    GEOGRAM_DLOGI(TAG, "Downloaded tile: z=%d x=%d y=%d (%zu bytes)", z, x, y, *tile_size);
     return ESP_OK;
 }
 
@@ -230,6 +272,10 @@ esp_err_t tiles_init(void)
         return ret;
     }
 
+    geogram_metrics_register_all(s_metrics, sizeof(s_metrics) / sizeof(s_metrics[0]));
+    geogram_metrics_register_histogram(&s_read_latency);
+    geogram_metrics_register_histogram(&s_download_latency);
+
     s_initialized = true;
     ESP_LOGI(TAG, "Tile cache initialized at %s", TILES_BASE_PATH);
     return ESP_OK;
@@ -338,22 +384,22 @@ static esp_err_t tiles_http_handler(httpd_req_t *req)
         }
     }
 
-    ESP_LOGI(TAG, "Tile request: z=%d x=%d y=%d layer=%s",
-             z, x, y, layer == TILE_LAYER_SATELLITE ? "satellite" : "standard");
+    GEOGRAM_DLOGI(TAG, "Tile request: z=%d x=%d y=%d layer=%s",
+                  z, x, y, layer == TILE_LAYER_SATELLITE ? "satellite" : "standard");
 
-    // Allocate buffer for tile data
-    uint8_t *tile_buffer = malloc(MAX_TILE_SIZE);
-    if (tile_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate tile buffer");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    if (s_tile_buffer == NULL) {
+        s_tile_buffer = malloc(MAX_TILE_SIZE);
+        if (s_tile_buffer == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate tile buffer");
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+            return ESP_FAIL;
+        }
     }
 
     size_t tile_size = 0;
-    esp_err_t ret = tiles_get(z, x, y, layer, tile_buffer, MAX_TILE_SIZE, &tile_size);
+    esp_err_t ret = tiles_get(z, x, y, layer, s_tile_buffer, MAX_TILE_SIZE, &tile_size);
 
     if (ret != ESP_OK) {
-        free(tile_buffer);
         if (ret == ESP_ERR_INVALID_ARG) {
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid tile coordinates");
         } else {
@@ -366,9 +412,7 @@ static esp_err_t tiles_http_handler(httpd_req_t *req)
     httpd_resp_set_type(req, "image/png");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=86400");
-    httpd_resp_send(req, (char *)tile_buffer, tile_size);
-
-    free(tile_buffer);
+    httpd_resp_send(req, (char *)s_tile_buffer, tile_size);
     return ESP_OK;
 }
 
@@ -391,7 +435,7 @@ esp_err_t tiles_register_http_handler(httpd_handle_t server)
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t ret = httpd_register_uri_handler(server, &tiles_uri);
+    esp_err_t ret = http_route_register(server, &tiles_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register tile handler: %s", esp_err_to_name(ret));
         return ret;
@@ -3,18 +3,29 @@
  * @brief Update mirror service implementation
  */
 
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include "updates.h"
 #include "sdcard.h"
 #include "http_client_async.h"
+#include "http_route.h"
 #include "json_utils.h"
+#include "json_scanner.h"
 #include "esp_log.h"
+#include "geogram_dlog.h"
+#include "geogram_metrics.h"
+#include "esp_timer.h"
 #include "cJSON.h"
+#include "mbedtls/sha256.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "updates";
 
@@ -25,11 +36,27 @@ static const char *TAG = "updates";
 #define UPDATES_BASE_PATH   "/sdcard/updates"
 #define RELEASE_JSON_PATH   "/sdcard/updates/release.json"
 
-// Download buffer size
-#define DOWNLOAD_BUFFER_SIZE    (64 * 1024)
+// Mirrored files are served from SD this much at a time
+#define SERVE_CHUNK_SIZE        4096
 
-// Max response size for GitHub API
-#define API_RESPONSE_SIZE       (24 * 1024)
+// Mirror jobs: each worker streams its download to SD through this buffer
+#define MIRROR_CHUNK_SIZE       4096
+#define MIRROR_TIMEOUT_MS       30000   // Per network read
+#define MIRROR_RETRY_DELAY_MS   15000   // Times the number of failed attempts
+#define MIRROR_STACK_SIZE       4096
+#define PART_SUFFIX             ".part"
+
+// Checksum file published next to the assets (SHA256SUMS style)
+#define CHECKSUMS_MAX_SIZE      8192
+
+// Path of the release document on an upstream station
+#define UPSTREAM_LATEST_PATH    "/api/updates/latest"
+
+// Max size of the cached release.json
+#define RELEASE_JSON_MAX_SIZE   (24 * 1024)
+
+// The GitHub API response is parsed as it arrives, this much at a time
+#define API_CHUNK_SIZE          1024
 
 // Polling task
 static TaskHandle_t s_poll_task = NULL;
@@ -40,9 +67,87 @@ static bool s_polling_active = false;
 static update_release_t s_release = {0};
 static bool s_initialized = false;
 
+// Validators of the GitHub response the cached release came from, sent back
+// so an unchanged release costs a 304 instead of the whole document
+static char s_etag[HTTP_CLIENT_ETAG_LEN] = {0};
+static char s_last_modified[HTTP_CLIENT_LAST_MODIFIED_LEN] = {0};
+
+// Station to mirror instead of GitHub ("" = GitHub), see updates_set_upstream
+static char s_upstream[64] = {0};
+
+// Mirror jobs: s_release.assets and the fields below are shared by the poll
+// task, the download workers and the HTTP handlers
+static SemaphoreHandle_t s_mirror_lock = NULL;
+static int s_mirror_workers = 0;                    // Running download tasks
+static uint32_t s_mirror_generation = 0;            // Bumped when s_release is replaced
+static int64_t s_retry_at[UPDATE_ASSET_COUNT];      // Earliest retry per asset (us)
+static int64_t s_rate_start = 0;                    // Download rate window
+static uint64_t s_rate_bytes = 0;
+static uint32_t s_rate = 0;
+
+// Release being read from the GitHub API or an upstream station
+typedef struct {
+    geo_json_scanner_t scanner;
+    update_release_t release;
+    const char *base;           // Upstream station URL, asset URLs are relative to it
+    char asset_name[64];        // As update_asset_t.filename
+    char asset_url[GEO_JSON_SCAN_VALUE_LEN];
+    char asset_digest[65];
+    char checksums_url[GEO_JSON_SCAN_VALUE_LEN];
+    size_t asset_size;
+    bool have_tag;
+    bool unchanged;             // Tag matches the cached release, rest skipped
+    bool failed;                // Body was not valid JSON
+    uint8_t chunk[API_CHUNK_SIZE];
+} release_scan_t;
+
 // Statistics
 static update_stats_t s_stats = {0};
 
+// Metrics: read from updates_get_stats() at export time
+static int64_t read_stat32(const geogram_metric_t *metric)
+{
+    update_stats_t stats;
+    updates_get_stats(&stats);
+    return *(const uint32_t *)((const uint8_t *)&stats + metric->arg);
+}
+
+static int64_t read_stat64(const geogram_metric_t *metric)
+{
+    update_stats_t stats;
+    updates_get_stats(&stats);
+    return (int64_t)*(const uint64_t *)((const uint8_t *)&stats + metric->arg);
+}
+
+#define UPDATES_STAT(type, name, help, read, field) \
+    GEOGRAM_METRIC_READ_INIT(type, name, help, read, offsetof(update_stats_t, field))
+
+static geogram_metric_t s_metrics[] = {
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_checks_total",
+                 "Release checks against GitHub or an upstream station", read_stat32, checks_performed),
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_downloads_completed_total",
+                 "Release assets mirrored", read_stat32, downloads_completed),
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_downloads_failed_total",
+                 "Release asset downloads that failed", read_stat32, downloads_failed),
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_verify_failures_total",
+                 "Downloads discarded on SHA-256 mismatch", read_stat32, verify_failures),
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_files_served_total",
+                 "Mirrored files served to clients", read_stat32, files_served),
+    UPDATES_STAT(GEOGRAM_METRIC_COUNTER, "geogram_updates_served_bytes_total",
+                 "Bytes of mirrored files served to clients", read_stat64, bytes_served),
+    UPDATES_STAT(GEOGRAM_METRIC_GAUGE, "geogram_updates_mirror_bytes_done",
+                 "Bytes of the current release on the SD card", read_stat64, mirror_bytes_done),
+    UPDATES_STAT(GEOGRAM_METRIC_GAUGE, "geogram_updates_download_rate_bytes",
+                 "Bytes per second over all downloads", read_stat32, download_rate),
+};
+
+static geogram_histogram_t s_check_github_latency =
+    GEOGRAM_HISTOGRAM_LABELED_INIT("geogram_updates_check_seconds", "Time to fetch the latest release description",
+                                   "source=\"github\"");
+static geogram_histogram_t s_check_upstream_latency =
+    GEOGRAM_HISTOGRAM_LABELED_INIT("geogram_updates_check_seconds", "Time to fetch the latest release description",
+                                   "source=\"upstream\"");
+
 /**
  * @brief Get asset type from filename
  */
@@ -121,14 +226,19 @@ static esp_err_t save_release_json(const update_release_t *release)
     cJSON_AddStringToObject(root, "name", release->name);
     cJSON_AddStringToObject(root, "publishedAt", release->published_at);
     cJSON_AddStringToObject(root, "htmlUrl", release->html_url);
+    cJSON_AddStringToObject(root, "etag", s_etag);
+    cJSON_AddStringToObject(root, "lastModified", s_last_modified);
 
     cJSON *assets = cJSON_CreateArray();
     for (int i = 0; i < release->asset_count; i++) {
         cJSON *asset = cJSON_CreateObject();
         cJSON_AddStringToObject(asset, "filename", release->assets[i].filename);
         cJSON_AddStringToObject(asset, "localPath", release->assets[i].local_path);
+        cJSON_AddStringToObject(asset, "url", release->assets[i].url);
+        cJSON_AddStringToObject(asset, "sha256", release->assets[i].sha256);
         cJSON_AddNumberToObject(asset, "sizeBytes", release->assets[i].size_bytes);
-        cJSON_AddBoolToObject(asset, "downloaded", release->assets[i].downloaded);
+        cJSON_AddNumberToObject(asset, "state", release->assets[i].state);
+        cJSON_AddBoolToObject(asset, "verified", release->assets[i].verified);
         cJSON_AddNumberToObject(asset, "type", release->assets[i].type);
         cJSON_AddItemToArray(assets, asset);
     }
@@ -150,11 +260,11 @@ static esp_err_t save_release_json(const update_release_t *release)
  */
 static esp_err_t load_release_json(update_release_t *release)
 {
-    uint8_t *buffer = malloc(API_RESPONSE_SIZE);
+    uint8_t *buffer = malloc(RELEASE_JSON_MAX_SIZE);
     if (buffer == NULL) return ESP_ERR_NO_MEM;
 
     size_t len = 0;
-    esp_err_t ret = sdcard_read_file(RELEASE_JSON_PATH, buffer, API_RESPONSE_SIZE - 1, &len);
+    esp_err_t ret = sdcard_read_file(RELEASE_JSON_PATH, buffer, RELEASE_JSON_MAX_SIZE - 1, &len);
     if (ret != ESP_OK) {
         free(buffer);
         return ret;
@@ -187,6 +297,12 @@ static esp_err_t load_release_json(update_release_t *release)
     if ((item = cJSON_GetObjectItem(root, "htmlUrl")) && cJSON_IsString(item)) {
         strlcpy(release->html_url, item->valuestring, sizeof(release->html_url));
     }
+    if ((item = cJSON_GetObjectItem(root, "etag")) && cJSON_IsString(item)) {
+        strlcpy(s_etag, item->valuestring, sizeof(s_etag));
+    }
+    if ((item = cJSON_GetObjectItem(root, "lastModified")) && cJSON_IsString(item)) {
+        strlcpy(s_last_modified, item->valuestring, sizeof(s_last_modified));
+    }
 
     cJSON *assets = cJSON_GetObjectItem(root, "assets");
     if (assets && cJSON_IsArray(assets)) {
@@ -196,23 +312,43 @@ static esp_err_t load_release_json(update_release_t *release)
 
         for (int i = 0; i < count; i++) {
             cJSON *asset = cJSON_GetArrayItem(assets, i);
+            update_asset_t *a = &release->assets[i];
             if (asset) {
                 if ((item = cJSON_GetObjectItem(asset, "filename")) && cJSON_IsString(item)) {
-                    strlcpy(release->assets[i].filename, item->valuestring, sizeof(release->assets[i].filename));
+                    strlcpy(a->filename, item->valuestring, sizeof(a->filename));
                 }
                 if ((item = cJSON_GetObjectItem(asset, "localPath")) && cJSON_IsString(item)) {
-                    strlcpy(release->assets[i].local_path, item->valuestring, sizeof(release->assets[i].local_path));
+                    strlcpy(a->local_path, item->valuestring, sizeof(a->local_path));
+                }
+                if ((item = cJSON_GetObjectItem(asset, "url")) && cJSON_IsString(item)) {
+                    strlcpy(a->url, item->valuestring, sizeof(a->url));
+                }
+                if ((item = cJSON_GetObjectItem(asset, "sha256")) && cJSON_IsString(item)) {
+                    strlcpy(a->sha256, item->valuestring, sizeof(a->sha256));
                 }
                 if ((item = cJSON_GetObjectItem(asset, "sizeBytes")) && cJSON_IsNumber(item)) {
-                    release->assets[i].size_bytes = (size_t)item->valuedouble;
+                    a->size_bytes = (size_t)item->valuedouble;
                 }
-                if ((item = cJSON_GetObjectItem(asset, "downloaded")) && cJSON_IsBool(item)) {
-                    release->assets[i].downloaded = cJSON_IsTrue(item);
+                if ((item = cJSON_GetObjectItem(asset, "state")) && cJSON_IsNumber(item)) {
+                    a->state = (update_job_state_t)item->valueint;
+                } else if ((item = cJSON_GetObjectItem(asset, "downloaded")) && cJSON_IsTrue(item)) {
+                    a->state = UPDATE_JOB_DONE;     // Written before mirror jobs
+                }
+                if ((item = cJSON_GetObjectItem(asset, "verified")) && cJSON_IsBool(item)) {
+                    a->verified = cJSON_IsTrue(item);
                 }
                 if ((item = cJSON_GetObjectItem(asset, "type")) && cJSON_IsNumber(item)) {
-                    release->assets[i].type = (update_asset_type_t)item->valueint;
+                    a->type = (update_asset_type_t)item->valueint;
                 }
             }
+
+            // Interrupted downloads resume from their .part file
+            if (a->state == UPDATE_JOB_ACTIVE) {
+                a->state = UPDATE_JOB_PENDING;
+            }
+            if (a->state == UPDATE_JOB_DONE) {
+                a->bytes_done = a->size_bytes;
+            }
         }
     }
 
@@ -224,161 +360,708 @@ static esp_err_t load_release_json(update_release_t *release)
 }
 
 /**
- * @brief Download a binary file from URL to SD card
+ * @brief Check for 64 hex digits (a SHA-256 digest)
+ */
+static bool is_sha256_hex(const char *s, size_t len)
+{
+    if (len != 64) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!isxdigit((unsigned char)s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Whether a name from a release document is safe as one path component
+ *
+ * Versions and asset filenames come from GitHub or an unauthenticated mesh
+ * parent and end up in UPDATES_BASE_PATH "/" version "/" filename.
+ */
+static bool is_safe_path_component(const char *s)
+{
+    return s[0] != '\0' && s[0] != '.' && strpbrk(s, "/\\") == NULL && strstr(s, "..") == NULL;
+}
+
+/**
+ * @brief Whether a release asset is a checksum list (SHA256SUMS, checksums.txt, ...)
+ */
+static bool is_checksums_name(const char *filename)
+{
+    char lower[64];
+    size_t i;
+    for (i = 0; filename[i] && i < sizeof(lower) - 1; i++) {
+        lower[i] = (char)tolower((unsigned char)filename[i]);
+    }
+    lower[i] = '\0';
+    return strstr(lower, "sha256") != NULL || strstr(lower, "checksum") != NULL;
+}
+
+/**
+ * @brief Scanner callback: pick the release and asset fields out of the
+ *        GitHub response, stopping as soon as the tag turns out to be known
+ */
+static bool release_scan_event(geo_json_scanner_t *scanner, geo_json_scan_event_t event,
+                               geo_json_type_t type, const char *value, size_t len, void *ctx)
+{
+    release_scan_t *scan = (release_scan_t *)ctx;
+    update_release_t *release = &scan->release;
+    const char *key = geo_json_scanner_key(scanner, scanner->depth);
+
+    if (scanner->depth == 1) {
+        if (event != GEO_JSON_SCAN_VALUE || type != GEO_JSON_STRING) {
+            return true;
+        }
+        if (strcmp(key, "tag_name") == 0) {
+            // Version is the tag without its 'v' prefix
+            strlcpy(release->tag_name, value, sizeof(release->tag_name));
+            strlcpy(release->version, value[0] == 'v' ? value + 1 : value, sizeof(release->version));
+            if (!is_safe_path_component(release->tag_name) || !is_safe_path_component(release->version)) {
+                ESP_LOGW(TAG, "Ignoring release with unusable tag: %.32s", value);
+                scan->failed = true;
+                return false;
+            }
+            scan->have_tag = true;
+            if (s_release.valid && strcmp(s_release.version, release->version) == 0) {
+                scan->unchanged = true;
+                return false;
+            }
+        } else if (strcmp(key, "name") == 0) {
+            strlcpy(release->name, value, sizeof(release->name));
+        } else if (strcmp(key, "published_at") == 0) {
+            strlcpy(release->published_at, value, sizeof(release->published_at));
+        } else if (strcmp(key, "html_url") == 0) {
+            strlcpy(release->html_url, value, sizeof(release->html_url));
+        }
+        return true;
+    }
+
+    // Everything below is inside "assets": [ { ... }, ... ]
+    if (strcmp(geo_json_scanner_key(scanner, 1), "assets") != 0) {
+        return true;
+    }
+
+    if (scanner->depth == 2 && type == GEO_JSON_OBJECT) {
+        if (event == GEO_JSON_SCAN_BEGIN) {
+            scan->asset_name[0] = '\0';
+            scan->asset_url[0] = '\0';
+            scan->asset_digest[0] = '\0';
+            scan->asset_size = 0;
+            return true;
+        }
+        if (event != GEO_JSON_SCAN_END || scan->asset_name[0] == '\0' || scan->asset_url[0] == '\0') {
+            return true;
+        }
+
+        if (!is_safe_path_component(scan->asset_name)) {
+            ESP_LOGW(TAG, "Skipping asset with unusable name: %.32s", scan->asset_name);
+            return true;
+        }
+
+        // Only keep known asset types (APK is most important for mobile clients)
+        update_asset_type_t asset_type = updates_asset_type_from_filename(scan->asset_name);
+        if (asset_type == UPDATE_ASSET_UNKNOWN) {
+            if (is_checksums_name(scan->asset_name)) {
+                strlcpy(scan->checksums_url, scan->asset_url, sizeof(scan->checksums_url));
+            }
+            return true;
+        }
+        if (release->asset_count >= UPDATE_ASSET_COUNT) {
+            return true;
+        }
+
+        update_asset_t *asset = &release->assets[release->asset_count++];
+        strlcpy(asset->filename, scan->asset_name, sizeof(asset->filename));
+        strlcpy(asset->url, scan->asset_url, sizeof(asset->url));
+        strlcpy(asset->sha256, scan->asset_digest, sizeof(asset->sha256));
+        asset->type = asset_type;
+        asset->size_bytes = scan->asset_size;
+        return true;
+    }
+
+    if (scanner->depth == 3 && event == GEO_JSON_SCAN_VALUE) {
+        if (strcmp(key, "name") == 0 && type == GEO_JSON_STRING) {
+            strlcpy(scan->asset_name, value, sizeof(scan->asset_name));
+        } else if (strcmp(key, "browser_download_url") == 0 && type == GEO_JSON_STRING) {
+            if (scanner->truncated) {
+                ESP_LOGW(TAG, "Skipping asset with an overlong URL: %.64s...", value);
+            } else {
+                strlcpy(scan->asset_url, value, sizeof(scan->asset_url));
+            }
+        } else if (strcmp(key, "size") == 0 && type == GEO_JSON_PRIMITIVE) {
+            scan->asset_size = (size_t)strtoul(value, NULL, 10);
+        } else if (strcmp(key, "digest") == 0 && type == GEO_JSON_STRING) {
+            // "sha256:<hex>"; other algorithms are ignored
+            if (strncmp(value, "sha256:", 7) == 0 && is_sha256_hex(value + 7, len - 7)) {
+                strlcpy(scan->asset_digest, value + 7, sizeof(scan->asset_digest));
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Body callback: feed the GitHub response to the scanner
  */
-static esp_err_t download_binary(const char *url, const char *local_path, size_t *downloaded_size)
+static bool release_scan_data(const uint8_t *data, size_t len, void *ctx)
 {
-    ESP_LOGI(TAG, "Downloading: %s", url);
+    release_scan_t *scan = (release_scan_t *)ctx;
+    int ret = geo_json_scanner_feed(&scan->scanner, (const char *)data, len);
+    if (ret == GEO_JSON_ERROR_INVAL) {
+        scan->failed = true;
+    }
+    return ret == 0;
+}
+
+/**
+ * @brief Scanner callback: read the /api/updates/latest document of an
+ *        upstream station (only assets it has finished are listed)
+ */
+static bool upstream_scan_event(geo_json_scanner_t *scanner, geo_json_scan_event_t event,
+                                geo_json_type_t type, const char *value, size_t len, void *ctx)
+{
+    release_scan_t *scan = (release_scan_t *)ctx;
+    update_release_t *release = &scan->release;
+    const char *key = geo_json_scanner_key(scanner, scanner->depth);
+
+    if (scanner->depth == 1) {
+        if (event != GEO_JSON_SCAN_VALUE || type != GEO_JSON_STRING) {
+            return true;
+        }
+        bool is_version = strcmp(key, "version") == 0;
+        if ((is_version || strcmp(key, "tagName") == 0) && !is_safe_path_component(value)) {
+            ESP_LOGW(TAG, "Ignoring release with unusable %s: %.32s", key, value);
+            scan->failed = true;
+            return false;
+        }
+        if (is_version) {
+            strlcpy(release->version, value, sizeof(release->version));
+            scan->have_tag = true;
+        } else if (strcmp(key, "tagName") == 0) {
+            strlcpy(release->tag_name, value, sizeof(release->tag_name));
+        } else if (strcmp(key, "name") == 0) {
+            strlcpy(release->name, value, sizeof(release->name));
+        } else if (strcmp(key, "publishedAt") == 0) {
+            strlcpy(release->published_at, value, sizeof(release->published_at));
+        } else if (strcmp(key, "htmlUrl") == 0) {
+            strlcpy(release->html_url, value, sizeof(release->html_url));
+        }
+        return true;
+    }
+
+    if (strcmp(geo_json_scanner_key(scanner, 1), "assets") != 0) {
+        return true;
+    }
+
+    if (scanner->depth == 2 && type == GEO_JSON_OBJECT) {
+        if (event == GEO_JSON_SCAN_BEGIN) {
+            scan->asset_name[0] = '\0';
+            scan->asset_url[0] = '\0';
+            scan->asset_digest[0] = '\0';
+            scan->asset_size = 0;
+            return true;
+        }
+        if (event != GEO_JSON_SCAN_END || scan->asset_name[0] == '\0' || scan->asset_url[0] != '/') {
+            return true;
+        }
+
+        if (!is_safe_path_component(scan->asset_name)) {
+            ESP_LOGW(TAG, "Skipping asset with unusable name: %.32s", scan->asset_name);
+            return true;
+        }
+
+        update_asset_type_t asset_type = updates_asset_type_from_filename(scan->asset_name);
+        if (asset_type == UPDATE_ASSET_UNKNOWN || release->asset_count >= UPDATE_ASSET_COUNT) {
+            return true;
+        }
 
-    uint8_t *buffer = malloc(DOWNLOAD_BUFFER_SIZE);
+        update_asset_t *asset = &release->assets[release->asset_count++];
+        strlcpy(asset->filename, scan->asset_name, sizeof(asset->filename));
+        snprintf(asset->url, sizeof(asset->url), "%s%s", scan->base, scan->asset_url);
+        strlcpy(asset->sha256, scan->asset_digest, sizeof(asset->sha256));
+        asset->type = asset_type;
+        asset->size_bytes = scan->asset_size;
+        return true;
+    }
+
+    if (scanner->depth == 3 && event == GEO_JSON_SCAN_VALUE) {
+        if (strcmp(key, "filename") == 0 && type == GEO_JSON_STRING) {
+            strlcpy(scan->asset_name, value, sizeof(scan->asset_name));
+        } else if (strcmp(key, "url") == 0 && type == GEO_JSON_STRING && !scanner->truncated) {
+            strlcpy(scan->asset_url, value, sizeof(scan->asset_url));
+        } else if (strcmp(key, "size") == 0 && type == GEO_JSON_PRIMITIVE) {
+            scan->asset_size = (size_t)strtoul(value, NULL, 10);
+        } else if (strcmp(key, "sha256") == 0 && type == GEO_JSON_STRING && is_sha256_hex(value, len)) {
+            strlcpy(scan->asset_digest, value, sizeof(scan->asset_digest));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Remember the validators of the response the cached release matches
+ */
+static bool keep_validators(const http_client_response_t *response)
+{
+    if (strcmp(s_etag, response->etag) == 0 &&
+        strcmp(s_last_modified, response->last_modified) == 0) {
+        return false;
+    }
+    strlcpy(s_etag, response->etag, sizeof(s_etag));
+    strlcpy(s_last_modified, response->last_modified, sizeof(s_last_modified));
+    return true;
+}
+
+/**
+ * @brief Fill missing asset digests from the release's checksum list
+ *
+ * Lines are "<sha256 hex>  <filename>" (sha256sum output, '*' marks binary mode).
+ */
+static void fetch_checksums(release_scan_t *scan)
+{
+    update_release_t *release = &scan->release;
+    bool missing = false;
+    for (int i = 0; i < release->asset_count; i++) {
+        missing |= release->assets[i].sha256[0] == '\0';
+    }
+    if (!missing || scan->checksums_url[0] == '\0') {
+        return;
+    }
+
+    uint8_t *buffer = malloc(CHECKSUMS_MAX_SIZE);
     if (buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate download buffer");
-        return ESP_ERR_NO_MEM;
+        return;
     }
 
     http_client_request_t request = http_client_default_config();
-    request.url = url;
-    request.timeout_ms = 60000;  // 60 second timeout for large files
+    request.url = scan->checksums_url;
+    request.timeout_ms = MIRROR_TIMEOUT_MS;
     request.user_agent = "Geogram-ESP32/1.0";
 
     http_client_response_t response = {
         .data = buffer,
-        .buffer_size = DOWNLOAD_BUFFER_SIZE,
+        .buffer_size = CHECKSUMS_MAX_SIZE - 1,     // Room for the terminator
         .data_len = 0,
         .status_code = 0,
     };
 
-    s_stats.downloads_started++;
-
-    esp_err_t ret = http_client_get_async(&request, &response);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Download failed: %s", esp_err_to_name(ret));
+    if (http_client_get_async(&request, &response) != ESP_OK || response.status_code != 200) {
+        ESP_LOGW(TAG, "Could not fetch checksum list (status %d)", response.status_code);
         free(buffer);
-        s_stats.downloads_failed++;
-        return ret;
+        return;
     }
 
-    if (response.status_code != 200) {
-        ESP_LOGE(TAG, "HTTP error %d", response.status_code);
-        free(buffer);
-        s_stats.downloads_failed++;
-        return ESP_FAIL;
+    buffer[response.data_len] = '\0';
+    char *save = NULL;
+    for (char *line = strtok_r((char *)buffer, "\r\n", &save); line; line = strtok_r(NULL, "\r\n", &save)) {
+        if (strlen(line) < 66 || !is_sha256_hex(line, 64) || (line[64] != ' ' && line[64] != '\t')) {
+            continue;
+        }
+        const char *name = line + 65;
+        while (*name == ' ' || *name == '\t' || *name == '*') {
+            name++;
+        }
+        for (int i = 0; i < release->asset_count; i++) {
+            update_asset_t *a = &release->assets[i];
+            if (a->sha256[0] == '\0' && strcmp(a->filename, name) == 0) {
+                memcpy(a->sha256, line, 64);
+                a->sha256[64] = '\0';
+            }
+        }
     }
-
-    // Save to SD card
-    ret = sdcard_write_file(local_path, buffer, response.data_len);
     free(buffer);
+}
 
+/**
+ * @brief Make a newly found release current and queue its assets for mirroring
+ */
+static esp_err_t mirror_release(release_scan_t *scan)
+{
+    update_release_t *release = &scan->release;
+
+    // The scanners drop unsafe names; nothing else may reach the paths below
+    bool safe = is_safe_path_component(release->version);
+    for (int i = 0; i < release->asset_count; i++) {
+        safe &= is_safe_path_component(release->assets[i].filename);
+    }
+    if (!safe) {
+        ESP_LOGE(TAG, "Refusing release with unsafe version or filename");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Create version directory
+    char version_dir[128];
+    snprintf(version_dir, sizeof(version_dir), "%s/%s", UPDATES_BASE_PATH, release->version);
+    esp_err_t ret = ensure_dir(version_dir);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save file: %s", local_path);
-        s_stats.downloads_failed++;
         return ret;
     }
 
-    *downloaded_size = response.data_len;
-    s_stats.downloads_completed++;
+    fetch_checksums(scan);
+    for (int i = 0; i < release->asset_count; i++) {
+        update_asset_t *a = &release->assets[i];
+        snprintf(a->local_path, sizeof(a->local_path), "%s/%s", version_dir, a->filename);
+        a->state = UPDATE_JOB_PENDING;
+        if (a->sha256[0] == '\0') {
+            ESP_LOGW(TAG, "No SHA-256 published for %s", a->filename);
+        }
+    }
+    release->valid = true;
 
-    ESP_LOGI(TAG, "Downloaded %zu bytes to %s", response.data_len, local_path);
-    return ESP_OK;
+    xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+    if (s_release.valid && strcmp(s_release.version, release->version) == 0) {
+        // Same release: an upstream station lists assets as it finishes them
+        ret = ESP_ERR_NOT_FOUND;
+        for (int i = 0; i < release->asset_count; i++) {
+            const update_asset_t *a = &release->assets[i];
+            int j = 0;
+            while (j < s_release.asset_count && strcmp(s_release.assets[j].filename, a->filename) != 0) {
+                j++;
+            }
+            if (j < s_release.asset_count) {
+                // Unfinished jobs follow the source (the mesh parent may change)
+                if (s_release.assets[j].state != UPDATE_JOB_DONE) {
+                    strlcpy(s_release.assets[j].url, a->url, sizeof(s_release.assets[j].url));
+                }
+            } else if (s_release.asset_count < UPDATE_ASSET_COUNT) {
+                ESP_LOGI(TAG, "New asset for %s: %s", release->version, a->filename);
+                s_retry_at[s_release.asset_count] = 0;
+                s_release.assets[s_release.asset_count++] = *a;
+                ret = ESP_OK;
+            }
+        }
+    } else {
+        // Workers still busy with the old release drop their results
+        ESP_LOGI(TAG, "New release found: %s", release->version);
+        s_mirror_generation++;
+        memcpy(&s_release, release, sizeof(update_release_t));
+        memset(s_retry_at, 0, sizeof(s_retry_at));
+    }
+    if (ret == ESP_OK) {
+        save_release_json(&s_release);
+    }
+    xSemaphoreGive(s_mirror_lock);
+    return ret;
 }
 
+// Download state of one worker, allocated for the worker's lifetime
+typedef struct {
+    int index;                  // Asset index in s_release
+    uint32_t generation;        // s_mirror_generation when the job was taken
+    char url[256];
+    char path[192];
+    char part_path[200];
+    char sha256[65];
+    size_t size;                // Expected size, 0 if unknown
+    size_t offset;              // Bytes in the .part file
+    FILE *file;
+    bool write_failed;
+    mbedtls_sha256_context sha;
+    uint8_t buffer[MIRROR_CHUNK_SIZE];
+} mirror_job_t;
+
 /**
- * @brief Parse GitHub release JSON and download assets
+ * @brief Publish download progress; false once the job's release was replaced
  */
-static esp_err_t parse_and_download_release(const char *json_str)
+static bool mirror_progress(mirror_job_t *job, size_t len)
 {
-    cJSON *root = cJSON_Parse(json_str);
-    if (root == NULL) {
-        ESP_LOGE(TAG, "Failed to parse GitHub API response");
-        return ESP_FAIL;
+    int64_t now = esp_timer_get_time();
+    bool current;
+
+    xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+    if (s_rate_start == 0) {
+        s_rate_start = now;
+    }
+    s_rate_bytes += len;
+    if (now - s_rate_start >= 1000000) {
+        s_rate = (uint32_t)(s_rate_bytes * 1000000 / (uint64_t)(now - s_rate_start));
+        s_rate_start = now;
+        s_rate_bytes = 0;
+    }
+    current = job->generation == s_mirror_generation;
+    if (current) {
+        s_release.assets[job->index].bytes_done = job->offset;
     }
+    xSemaphoreGive(s_mirror_lock);
+    return current;
+}
 
-    update_release_t new_release = {0};
+/**
+ * @brief Body callback: append to the .part file and the running hash
+ */
+static bool mirror_write(const uint8_t *data, size_t len, void *ctx)
+{
+    mirror_job_t *job = (mirror_job_t *)ctx;
+    if (fwrite(data, 1, len, job->file) != len) {
+        job->write_failed = true;
+        return false;
+    }
+    mbedtls_sha256_update(&job->sha, data, len);
+    job->offset += len;
+    return mirror_progress(job, len);
+}
 
-    // Parse version from tag_name (strip 'v' prefix)
-    cJSON *tag_name = cJSON_GetObjectItem(root, "tag_name");
-    if (tag_name && cJSON_IsString(tag_name)) {
-        const char *tag = tag_name->valuestring;
-        if (tag[0] == 'v') tag++;
-        strlcpy(new_release.version, tag, sizeof(new_release.version));
-        strlcpy(new_release.tag_name, tag_name->valuestring, sizeof(new_release.tag_name));
+/**
+ * @brief Hash the bytes already in the .part file before resuming
+ */
+static esp_err_t hash_part(mirror_job_t *job)
+{
+    FILE *f = fopen(job->part_path, "rb");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+    size_t n, total = 0;
+    while ((n = fread(job->buffer, 1, sizeof(job->buffer), f)) > 0) {
+        mbedtls_sha256_update(&job->sha, job->buffer, n);
+        total += n;
     }
+    fclose(f);
+    return total == job->offset ? ESP_OK : ESP_FAIL;
+}
 
-    // Check if we already have this version
-    if (s_release.valid && strcmp(s_release.version, new_release.version) == 0) {
-        ESP_LOGI(TAG, "Already have version %s", new_release.version);
-        cJSON_Delete(root);
-        return ESP_ERR_NOT_FOUND;
+/**
+ * @brief Download (or finish) one asset into its .part file, verify it and
+ *        rename it into place
+ *
+ * @return ESP_OK when the asset is in place, ESP_ERR_INVALID_CRC on a hash
+ *         mismatch and ESP_ERR_NOT_SUPPORTED for an asset with neither size
+ *         nor hash (the part is discarded), other errors leave the part to resume
+ */
+static esp_err_t mirror_download(mirror_job_t *job, bool *resumed)
+{
+    struct stat st;
+    job->offset = stat(job->part_path, &st) == 0 ? (size_t)st.st_size : 0;
+    job->write_failed = false;
+    *resumed = false;
+
+    mbedtls_sha256_init(&job->sha);
+    mbedtls_sha256_starts(&job->sha, 0);
+    if (job->offset > 0 && ((job->size > 0 && job->offset > job->size) || hash_part(job) != ESP_OK)) {
+        ESP_LOGW(TAG, "Discarding unusable %s", job->part_path);
+        remove(job->part_path);
+        job->offset = 0;
+        mbedtls_sha256_starts(&job->sha, 0);
     }
 
-    ESP_LOGI(TAG, "New release found: %s", new_release.version);
+    esp_err_t ret = ESP_OK;
+    if (job->size == 0 || job->offset < job->size) {
+        if (job->offset > 0) {
+            ESP_LOGI(TAG, "Resuming %s at %zu bytes", job->path, job->offset);
+            *resumed = true;
+        } else {
+            ESP_LOGI(TAG, "Downloading: %s", job->url);
+        }
 
-    // Parse other fields
-    cJSON *item;
-    if ((item = cJSON_GetObjectItem(root, "name")) && cJSON_IsString(item)) {
-        strlcpy(new_release.name, item->valuestring, sizeof(new_release.name));
+        job->file = fopen(job->part_path, "ab");
+        if (job->file == NULL) {
+            ESP_LOGE(TAG, "Failed to open %s", job->part_path);
+            ret = ESP_FAIL;
+            goto out;
+        }
+
+        http_client_request_t request = http_client_default_config();
+        request.url = job->url;
+        request.timeout_ms = MIRROR_TIMEOUT_MS;
+        request.user_agent = "Geogram-ESP32/1.0";
+        request.range_start = job->offset;
+        request.on_data = mirror_write;
+        request.on_data_ctx = job;
+
+        http_client_response_t response = {
+            .data = job->buffer,
+            .buffer_size = sizeof(job->buffer),
+            .data_len = 0,
+            .status_code = 0,
+        };
+
+        ret = http_client_get_async(&request, &response);
+        fclose(job->file);
+        job->file = NULL;
+
+        // A stream stopped by mirror_write or cut short fails with
+        // ESP_ERR_NOT_FINISHED and keeps what it got to resume from
+
+        if (ret == ESP_ERR_INVALID_RESPONSE) {
+            // Server ignored the range; start over on the next attempt
+            remove(job->part_path);
+        } else if (ret != ESP_OK && response.status_code == 416 && job->offset > 0) {
+            ret = ESP_OK;   // Part already complete
+        } else if (ret == ESP_OK && response.status_code != 200 && response.status_code != 206) {
+            ESP_LOGE(TAG, "Download failed: HTTP %d", response.status_code);
+            ret = ESP_FAIL;
+        }
+        if (job->write_failed) {
+            ESP_LOGE(TAG, "Write to %s failed", job->part_path);
+            ret = ESP_FAIL;
+        }
+        if (ret != ESP_OK) {
+            goto out;
+        }
     }
-    if ((item = cJSON_GetObjectItem(root, "published_at")) && cJSON_IsString(item)) {
-        strlcpy(new_release.published_at, item->valuestring, sizeof(new_release.published_at));
+
+    if (job->size > 0 && job->offset != job->size) {
+        ESP_LOGW(TAG, "%s: got %zu of %zu bytes", job->path, job->offset, job->size);
+        ret = ESP_ERR_INVALID_SIZE;
+        goto out;
     }
-    if ((item = cJSON_GetObjectItem(root, "html_url")) && cJSON_IsString(item)) {
-        strlcpy(new_release.html_url, item->valuestring, sizeof(new_release.html_url));
+    if (job->size == 0 && job->sha256[0] == '\0') {
+        // Nothing to tell a complete file from a truncated one
+        ESP_LOGE(TAG, "%s has neither size nor SHA-256, not mirrored", job->path);
+        remove(job->part_path);
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto out;
     }
 
-    // Create version directory
-    char version_dir[128];
-    snprintf(version_dir, sizeof(version_dir), "%s/%s", UPDATES_BASE_PATH, new_release.version);
-    ensure_dir(version_dir);
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_sha256_finish(&job->sha, digest);
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+    if (job->sha256[0] != '\0' && strcasecmp(hex, job->sha256) != 0) {
+        ESP_LOGE(TAG, "SHA-256 mismatch for %s: %s", job->path, hex);
+        remove(job->part_path);
+        ret = ESP_ERR_INVALID_CRC;
+        goto out;
+    }
 
-    // Parse and download assets
-    cJSON *assets = cJSON_GetObjectItem(root, "assets");
-    if (assets && cJSON_IsArray(assets)) {
-        int asset_idx = 0;
-        cJSON *asset;
-        cJSON_ArrayForEach(asset, assets) {
-            if (asset_idx >= UPDATE_ASSET_COUNT) break;
+    remove(job->path);
+    if (rename(job->part_path, job->path) != 0) {
+        ESP_LOGE(TAG, "Failed to rename %s", job->part_path);
+        ret = ESP_FAIL;
+        goto out;
+    }
+    ESP_LOGI(TAG, "Mirrored %s (%zu bytes%s)", job->path, job->offset,
+             job->sha256[0] ? ", verified" : "");
 
-            cJSON *name = cJSON_GetObjectItem(asset, "name");
-            cJSON *download_url = cJSON_GetObjectItem(asset, "browser_download_url");
-            cJSON *size = cJSON_GetObjectItem(asset, "size");
+out:
+    mbedtls_sha256_free(&job->sha);
+    return ret;
+}
 
-            if (name && cJSON_IsString(name) && download_url && cJSON_IsString(download_url)) {
-                update_asset_type_t type = updates_asset_type_from_filename(name->valuestring);
+/**
+ * @brief Next job ready to run, -1 if none; call with s_mirror_lock held
+ *
+ * @param waiting Set when jobs remain that wait for their retry time
+ */
+static int mirror_next_job(bool *waiting)
+{
+    int64_t now = esp_timer_get_time();
+    *waiting = false;
+    for (int i = 0; i < s_release.asset_count; i++) {
+        if (s_release.assets[i].state != UPDATE_JOB_PENDING) {
+            continue;
+        }
+        if (s_retry_at[i] <= now) {
+            return i;
+        }
+        *waiting = true;
+    }
+    return -1;
+}
 
-                // Only download known asset types (APK is most important for mobile clients)
-                if (type == UPDATE_ASSET_UNKNOWN) {
-                    continue;
-                }
+/**
+ * @brief Download worker: runs jobs until none are left
+ */
+static void mirror_worker(void *arg)
+{
+    mirror_job_t *job = malloc(sizeof(mirror_job_t));
+
+    while (true) {
+        bool waiting = false;
+        xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+        int idx = job ? mirror_next_job(&waiting) : -1;
+        if (idx < 0 && !waiting) {
+            s_mirror_workers--;
+            xSemaphoreGive(s_mirror_lock);
+            break;
+        }
+        if (idx < 0) {
+            xSemaphoreGive(s_mirror_lock);
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
 
-                update_asset_t *a = &new_release.assets[asset_idx];
-                strlcpy(a->filename, name->valuestring, sizeof(a->filename));
-                // Use version_dir to avoid overlap warning
-                snprintf(a->local_path, sizeof(a->local_path), "%s/%s",
-                         version_dir, name->valuestring);
-                a->type = type;
-                a->size_bytes = size ? (size_t)size->valuedouble : 0;
-
-                // Download the binary
-                size_t downloaded = 0;
-                if (download_binary(download_url->valuestring, a->local_path, &downloaded) == ESP_OK) {
-                    a->downloaded = true;
-                    a->size_bytes = downloaded;
+        update_asset_t *a = &s_release.assets[idx];
+        a->state = UPDATE_JOB_ACTIVE;
+        job->index = idx;
+        job->generation = s_mirror_generation;
+        strlcpy(job->url, a->url, sizeof(job->url));
+        strlcpy(job->path, a->local_path, sizeof(job->path));
+        snprintf(job->part_path, sizeof(job->part_path), "%s%s", a->local_path, PART_SUFFIX);
+        strlcpy(job->sha256, a->sha256, sizeof(job->sha256));
+        job->size = a->size_bytes;
+        s_stats.downloads_started++;
+        xSemaphoreGive(s_mirror_lock);
+
+        bool resumed;
+        esp_err_t ret = mirror_download(job, &resumed);
+
+        xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+        if (resumed) {
+            s_stats.downloads_resumed++;
+        }
+        if (ret == ESP_ERR_INVALID_CRC) {
+            s_stats.verify_failures++;
+        }
+        if (job->generation == s_mirror_generation) {
+            a = &s_release.assets[idx];
+            if (ret == ESP_OK) {
+                a->state = UPDATE_JOB_DONE;
+                a->verified = job->sha256[0] != '\0';
+                a->size_bytes = job->offset;
+                a->bytes_done = job->offset;
+                s_stats.downloads_completed++;
+            } else {
+                // A mismatch or an unverifiable asset would repeat with the
+                // same bytes; wait for the next poll
+                bool final = ret == ESP_ERR_INVALID_CRC || ret == ESP_ERR_NOT_SUPPORTED;
+                a->attempts = final ? UPDATES_MIRROR_ATTEMPTS : a->attempts + 1;
+                a->state = a->attempts >= UPDATES_MIRROR_ATTEMPTS ? UPDATE_JOB_FAILED : UPDATE_JOB_PENDING;
+                if (final || ret == ESP_ERR_INVALID_RESPONSE) {
+                    a->bytes_done = 0;      // Part was discarded
                 }
-
-                asset_idx++;
+                s_retry_at[idx] = esp_timer_get_time() +
+                                  (int64_t)MIRROR_RETRY_DELAY_MS * 1000 * a->attempts;
+                s_stats.downloads_failed++;
             }
+            save_release_json(&s_release);
         }
-        new_release.asset_count = asset_idx;
+        xSemaphoreGive(s_mirror_lock);
     }
 
-    cJSON_Delete(root);
+    free(job);
+    vTaskDelete(NULL);
+}
 
-    // Save and cache the new release
-    new_release.valid = true;
-    memcpy(&s_release, &new_release, sizeof(update_release_t));
-    save_release_json(&s_release);
+/**
+ * @brief Queue unfinished and failed assets again and start workers for them
+ */
+static void mirror_resume(void)
+{
+    xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+    int queued = 0;
+    for (int i = 0; i < s_release.asset_count; i++) {
+        update_asset_t *a = &s_release.assets[i];
+        if (a->state == UPDATE_JOB_FAILED) {
+            a->state = UPDATE_JOB_PENDING;
+            a->attempts = 0;
+            s_retry_at[i] = 0;
+        }
+        queued += a->state == UPDATE_JOB_PENDING;
+    }
 
-    return ESP_OK;
+    while (s_mirror_workers < UPDATES_MIRROR_WORKERS && s_mirror_workers < queued) {
+        if (xTaskCreate(mirror_worker, "updates_dl", MIRROR_STACK_SIZE, NULL, 3, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create download task");
+            break;
+        }
+        s_mirror_workers++;
+    }
+    xSemaphoreGive(s_mirror_lock);
 }
 
 esp_err_t updates_init(void)
@@ -398,12 +1081,21 @@ esp_err_t updates_init(void)
         return ret;
     }
 
-    // Try to load cached release
+    s_mirror_lock = xSemaphoreCreateMutex();
+    if (s_mirror_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Try to load cached release; unfinished downloads resume on the next poll
     if (load_release_json(&s_release) == ESP_OK) {
         ESP_LOGI(TAG, "Loaded cached release: %s (%d assets)",
                  s_release.version, s_release.asset_count);
     }
 
+    geogram_metrics_register_all(s_metrics, sizeof(s_metrics) / sizeof(s_metrics[0]));
+    geogram_metrics_register_histogram(&s_check_github_latency);
+    geogram_metrics_register_histogram(&s_check_upstream_latency);
+
     s_initialized = true;
     ESP_LOGI(TAG, "Update mirror initialized at %s", UPDATES_BASE_PATH);
     return ESP_OK;
@@ -423,54 +1115,173 @@ esp_err_t updates_check_github(void)
     ESP_LOGI(TAG, "Checking GitHub for updates...");
     s_stats.checks_performed++;
 
-    uint8_t *buffer = malloc(API_RESPONSE_SIZE);
-    if (buffer == NULL) {
+    release_scan_t *scan = calloc(1, sizeof(release_scan_t));
+    if (scan == NULL) {
         return ESP_ERR_NO_MEM;
     }
+    geo_json_scanner_init(&scan->scanner, release_scan_event, scan);
 
     http_client_request_t request = http_client_default_config();
     request.url = GITHUB_API_URL;
     request.timeout_ms = 30000;
     request.user_agent = "Geogram-ESP32/1.0";
+    request.on_data = release_scan_data;
+    request.on_data_ctx = scan;
+    if (s_release.valid) {
+        request.if_none_match = s_etag;
+        request.if_modified_since = s_last_modified;
+    }
 
     http_client_response_t response = {
-        .data = buffer,
-        .buffer_size = API_RESPONSE_SIZE - 1,
+        .data = scan->chunk,
+        .buffer_size = sizeof(scan->chunk),
         .data_len = 0,
         .status_code = 0,
     };
 
+    int64_t start_us = esp_timer_get_time();
     esp_err_t ret = http_client_get_async(&request, &response);
+    geogram_histogram_observe(&s_check_github_latency, esp_timer_get_time() - start_us);
+    if (ret == ESP_ERR_NOT_FINISHED && scan->unchanged) {
+        ret = ESP_OK;   // The scanner stopped once it saw the known tag
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "GitHub API request failed: %s", esp_err_to_name(ret));
-        free(buffer);
-        return ret;
+    } else if (response.status_code == 304) {
+        ESP_LOGI(TAG, "Release unchanged (not modified)");
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (response.status_code != 200) {
+        ESP_LOGE(TAG, "GitHub API error: %d", response.status_code);
+        ret = ESP_FAIL;
+    } else if (scan->unchanged) {
+        ESP_LOGI(TAG, "Already have version %s (read %zu bytes)",
+                 scan->release.version, response.data_len);
+        xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+        if (keep_validators(&response)) {
+            save_release_json(&s_release);
+        }
+        xSemaphoreGive(s_mirror_lock);
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (scan->failed || !scan->have_tag || !geo_json_scanner_done(&scan->scanner)) {
+        ESP_LOGE(TAG, "Failed to parse GitHub API response");
+        ret = ESP_FAIL;
+    } else {
+        keep_validators(&response);
+        ret = mirror_release(scan);
     }
+    free(scan);
 
-    if (response.status_code != 200) {
-        ESP_LOGE(TAG, "GitHub API error: %d", response.status_code);
-        free(buffer);
-        return ESP_FAIL;
+    // Also retries what failed before, without waiting for a new release
+    if (ret == ESP_OK || ret == ESP_ERR_NOT_FOUND) {
+        mirror_resume();
     }
+    return ret;
+}
 
-    buffer[response.data_len] = '\0';
-    ret = parse_and_download_release((char *)buffer);
-    free(buffer);
+/**
+ * @brief Ask an upstream station for the release it mirrors
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the station has no update mirror (404,
+ *         redirect, or a body that is not a release document), so the
+ *         caller asks GitHub instead
+ */
+static esp_err_t check_upstream(const char *base)
+{
+    ESP_LOGI(TAG, "Checking %s for updates...", base);
+    s_stats.checks_performed++;
+
+    release_scan_t *scan = calloc(1, sizeof(release_scan_t));
+    if (scan == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    geo_json_scanner_init(&scan->scanner, upstream_scan_event, scan);
+    scan->base = base;
 
+    char url[sizeof(s_upstream) + sizeof(UPSTREAM_LATEST_PATH)];
+    snprintf(url, sizeof(url), "%s%s", base, UPSTREAM_LATEST_PATH);
+
+    http_client_request_t request = http_client_default_config();
+    request.url = url;
+    request.timeout_ms = 10000;
+    request.user_agent = "Geogram-ESP32/1.0";
+    request.on_data = release_scan_data;
+    request.on_data_ctx = scan;
+
+    http_client_response_t response = {
+        .data = scan->chunk,
+        .buffer_size = sizeof(scan->chunk),
+        .data_len = 0,
+        .status_code = 0,
+    };
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = http_client_get_async(&request, &response);
+    geogram_histogram_observe(&s_check_upstream_latency, esp_timer_get_time() - start_us);
+    // A station without a mirror answers 404, or redirects unknown paths to
+    // its captive portal (302, or an HTML page once the redirect is followed)
+    bool no_mirror = response.status_code == 404 ||
+                     (response.status_code >= 300 && response.status_code < 400 && response.status_code != 304);
+    if (no_mirror) {
+        ESP_LOGW(TAG, "%s does not mirror updates (status %d)", base, response.status_code);
+        ret = ESP_ERR_NOT_SUPPORTED;
+    } else if (ret != ESP_OK && !(ret == ESP_ERR_NOT_FINISHED && scan->failed)) {
+        ESP_LOGE(TAG, "Upstream request failed: %s (status %d)", esp_err_to_name(ret), response.status_code);
+    } else if (scan->failed || !geo_json_scanner_done(&scan->scanner)) {
+        ESP_LOGW(TAG, "%s does not mirror updates (no release document)", base);
+        ret = ESP_ERR_NOT_SUPPORTED;
+    } else if (!scan->have_tag) {
+        ESP_LOGI(TAG, "Upstream has no release yet");
+        ret = ESP_ERR_NOT_FOUND;
+    } else {
+        ret = mirror_release(scan);
+    }
+    free(scan);
+
+    if (ret == ESP_OK || ret == ESP_ERR_NOT_FOUND) {
+        mirror_resume();
+    }
     return ret;
 }
 
+esp_err_t updates_set_upstream(const char *base_url)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (base_url != NULL && strlen(base_url) >= sizeof(s_upstream)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+    bool changed = strcmp(s_upstream, base_url ? base_url : "") != 0;
+    strlcpy(s_upstream, base_url ? base_url : "", sizeof(s_upstream));
+    xSemaphoreGive(s_mirror_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "Release source: %s", base_url && base_url[0] ? base_url : "GitHub");
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief Polling task
  */
 static void poll_task(void *arg)
 {
     // Initial delay before first check (1 minute after boot)
-    ESP_LOGI(TAG, "First GitHub check in 60 seconds...");
+    ESP_LOGI(TAG, "First update check in 60 seconds...");
     vTaskDelay(pdMS_TO_TICKS(60000));
 
     while (s_polling_active) {
-        updates_check_github();
+        char upstream[sizeof(s_upstream)];
+        xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
+        strlcpy(upstream, s_upstream, sizeof(upstream));
+        xSemaphoreGive(s_mirror_lock);
+
+        // Stations without a mirror upstream of us leave GitHub to us
+        if (upstream[0] == '\0' || check_upstream(upstream) == ESP_ERR_NOT_SUPPORTED) {
+            updates_check_github();
+        }
 
         // Wait for next poll interval
         for (int i = 0; i < s_poll_interval && s_polling_active; i++) {
@@ -488,15 +1299,17 @@ esp_err_t updates_start_polling(int interval_seconds)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (s_poll_task != NULL) {
-        ESP_LOGW(TAG, "Polling already active");
-        return ESP_OK;
-    }
-
     if (interval_seconds < 60) {
         interval_seconds = 60;  // Minimum 1 minute
     }
 
+    if (s_poll_task != NULL) {
+        // Takes effect after the current wait
+        s_poll_interval = interval_seconds;
+        ESP_LOGI(TAG, "Polling already active (interval now %d seconds)", interval_seconds);
+        return ESP_OK;
+    }
+
     s_poll_interval = interval_seconds;
     s_polling_active = true;
 
@@ -524,7 +1337,9 @@ esp_err_t updates_get_release(update_release_t *release)
     }
 
     if (release != NULL) {
+        xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
         memcpy(release, &s_release, sizeof(update_release_t));
+        xSemaphoreGive(s_mirror_lock);
     }
     return ESP_OK;
 }
@@ -534,46 +1349,93 @@ esp_err_t updates_get_stats(update_stats_t *stats)
     if (stats == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (s_mirror_lock == NULL) {
+        memcpy(stats, &s_stats, sizeof(update_stats_t));
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(s_mirror_lock, portMAX_DELAY);
     memcpy(stats, &s_stats, sizeof(update_stats_t));
+    for (int i = 0; i < s_release.asset_count; i++) {
+        const update_asset_t *a = &s_release.assets[i];
+        stats->jobs_total++;
+        stats->jobs_done += a->state == UPDATE_JOB_DONE;
+        stats->jobs_active += a->state == UPDATE_JOB_ACTIVE;
+        stats->jobs_failed += a->state == UPDATE_JOB_FAILED;
+        stats->mirror_bytes_total += a->size_bytes;
+        stats->mirror_bytes_done += a->bytes_done;
+    }
+    // The rate goes stale when downloads stop
+    bool recent = s_rate_start != 0 && esp_timer_get_time() - s_rate_start < 3000000;
+    stats->download_rate = stats->jobs_active > 0 && recent ? s_rate : 0;
+    xSemaphoreGive(s_mirror_lock);
     return ESP_OK;
 }
 
-size_t updates_build_latest_json(char *buffer, size_t buffer_size)
+void updates_write_latest_json(geo_json_builder_t *builder)
 {
-    geo_json_builder_t builder;
-    geo_json_init(&builder, buffer, buffer_size);
+    // Mirror workers and the release check write s_release under the lock;
+    // build from a copy rather than hold the lock while the output streams
+    update_release_t *release = malloc(sizeof(update_release_t));
 
-    geo_json_object_start(&builder);
+    geo_json_object_start(builder);
 
-    if (!s_release.valid) {
-        geo_json_add_string(&builder, "status", "no_updates_cached");
+    if (release == NULL) {
+        ESP_LOGE(TAG, "No memory for the release snapshot");
+        geo_json_add_string(builder, "status", "error");
+    } else if (updates_get_release(release) != ESP_OK) {
+        geo_json_add_string(builder, "status", "no_updates_cached");
     } else {
-        geo_json_add_string(&builder, "status", "available");
-        geo_json_add_string(&builder, "version", s_release.version);
-        geo_json_add_string(&builder, "tagName", s_release.tag_name);
-        geo_json_add_string(&builder, "name", s_release.name);
-        geo_json_add_string(&builder, "publishedAt", s_release.published_at);
-        geo_json_add_string(&builder, "htmlUrl", s_release.html_url);
+        geo_json_add_string(builder, "status", "available");
+        geo_json_add_string(builder, "version", release->version);
+        geo_json_add_string(builder, "tagName", release->tag_name);
+        geo_json_add_string(builder, "name", release->name);
+        geo_json_add_string(builder, "publishedAt", release->published_at);
+        geo_json_add_string(builder, "htmlUrl", release->html_url);
 
         // Build assets array with objects
-        geo_json_array_start(&builder, "assets");
-        for (int i = 0; i < s_release.asset_count; i++) {
-            if (s_release.assets[i].downloaded) {
-                geo_json_object_start(&builder);
-                geo_json_add_string(&builder, "type", updates_asset_type_to_string(s_release.assets[i].type));
+        geo_json_array_start(builder, "assets");
+        for (int i = 0; i < release->asset_count; i++) {
+            const update_asset_t *a = &release->assets[i];
+            if (a->state == UPDATE_JOB_DONE) {
+                geo_json_object_start(builder);
+                geo_json_add_string(builder, "type", updates_asset_type_to_string(a->type));
                 char url[128];
-                snprintf(url, sizeof(url), "/updates/%s/%s",
-                         s_release.version, s_release.assets[i].filename);
-                geo_json_add_string(&builder, "url", url);
-                geo_json_add_string(&builder, "filename", s_release.assets[i].filename);
-                geo_json_object_end(&builder);
+                snprintf(url, sizeof(url), "/updates/%s/%s", release->version, a->filename);
+                geo_json_add_string(builder, "url", url);
+                geo_json_add_string(builder, "filename", a->filename);
+                geo_json_add_uint(builder, "size", (uint32_t)a->size_bytes);
+                if (a->verified) {
+                    geo_json_add_string(builder, "sha256", a->sha256);
+                }
+                geo_json_object_end(builder);
             }
         }
-        geo_json_array_end(&builder);
+        geo_json_array_end(builder);
     }
 
-    geo_json_object_end(&builder);
-    return geo_json_get_length(&builder);
+    geo_json_object_end(builder);
+    free(release);
+}
+
+size_t updates_build_latest_json(char *buffer, size_t buffer_size)
+{
+    geo_json_builder_t builder;
+    geo_json_init(&builder, buffer, buffer_size);
+    updates_write_latest_json(&builder);
+    return geo_json_flush(&builder) ? geo_json_get_length(&builder) : 0;
+}
+
+/**
+ * @brief Builder flush callback: send output as HTTP chunks
+ */
+static bool send_json_chunk(const char *data, size_t len, bool final, void *ctx)
+{
+    httpd_req_t *req = (httpd_req_t *)ctx;
+    if (len > 0 && httpd_resp_send_chunk(req, data, len) != ESP_OK) {
+        return false;
+    }
+    return !final || httpd_resp_send_chunk(req, NULL, 0) == ESP_OK;
 }
 
 /**
@@ -581,17 +1443,90 @@ size_t updates_build_latest_json(char *buffer, size_t buffer_size)
  */
 static esp_err_t updates_latest_handler(httpd_req_t *req)
 {
-    char response[1024];
-    size_t len = updates_build_latest_json(response, sizeof(response));
+    // The asset list has no fixed size; stream it in chunks
+    char chunk[GEO_JSON_STREAM_CHUNK];
+    geo_json_builder_t builder;
+    geo_json_init_stream(&builder, chunk, sizeof(chunk), send_json_chunk, req);
 
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, response, len);
+    updates_write_latest_json(&builder);
+    return geo_json_flush(&builder) ? ESP_OK : ESP_FAIL;
+}
+
+typedef enum {
+    RANGE_NONE = 0,         // No usable Range header: send the whole file
+    RANGE_OK,
+    RANGE_UNSATISFIABLE,
+} range_result_t;
+
+/**
+ * @brief Parse "bytes=N-" or "bytes=N-M" against a file size
+ *
+ * Other forms (suffix ranges, several ranges) are ignored, which RFC 9110
+ * allows: the client gets the whole file with 200.
+ *
+ * @param first First byte to send
+ * @param last Last byte to send (inclusive)
+ */
+static range_result_t parse_range(const char *value, size_t size, size_t *first, size_t *last)
+{
+    if (strncmp(value, "bytes=", 6) != 0 || !isdigit((unsigned char)value[6])) {
+        return RANGE_NONE;
+    }
+
+    char *end;
+    unsigned long long start = strtoull(value + 6, &end, 10);
+    if (*end != '-') {
+        return RANGE_NONE;
+    }
+    end++;
+
+    unsigned long long stop = size > 0 ? size - 1 : 0;
+    if (isdigit((unsigned char)*end)) {
+        stop = strtoull(end, &end, 10);
+        if (stop < start) {
+            return RANGE_NONE;
+        }
+        if (stop >= size) {
+            stop = size > 0 ? size - 1 : 0;
+        }
+    }
+    if (*end != '\0') {
+        return RANGE_NONE;
+    }
+    if (start >= size) {
+        return RANGE_UNSATISFIABLE;
+    }
+
+    *first = (size_t)start;
+    *last = (size_t)stop;
+    return RANGE_OK;
+}
+
+/**
+ * @brief Send raw bytes, looping over partial sends
+ */
+static esp_err_t send_all(httpd_req_t *req, const char *data, size_t len)
+{
+    while (len > 0) {
+        int sent = httpd_send(req, data, len);
+        if (sent <= 0) {
+            return ESP_FAIL;
+        }
+        data += sent;
+        len -= (size_t)sent;
+    }
     return ESP_OK;
 }
 
 /**
  * @brief HTTP handler for /updates/{version}/{filename}
+ *
+ * Streams the file from SD with a Content-Length, so children can check
+ * the size, and honors "Range: bytes=N-" for resumed downloads. The
+ * response head is written by hand: httpd_resp_send_chunk() would add
+ * chunked framing, which must not be combined with Content-Length.
  */
 static esp_err_t updates_file_handler(httpd_req_t *req)
 {
@@ -608,18 +1543,28 @@ static esp_err_t updates_file_handler(httpd_req_t *req)
     char *query = strchr(uri, '?');
     if (query) *query = '\0';
 
+    // Only /updates/{version}/{filename}, never a way out of UPDATES_BASE_PATH
+    if (strstr(uri, "..") != NULL || strchr(uri, '\\') != NULL) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
+        return ESP_FAIL;
+    }
+
     // Build local path: /sdcard/updates/... (max 7 + 127 = 134 < 256)
     char local_path[256];
     snprintf(local_path, sizeof(local_path), "/sdcard%.*s", (int)(sizeof(local_path) - 8), uri);
 
-    // Check if file exists
-    if (!sdcard_file_exists(local_path)) {
+    // Partial downloads are not served; the finished file appears once verified
+    size_t path_len = strlen(local_path);
+    size_t suffix_len = strlen(PART_SUFFIX);
+    bool partial = path_len >= suffix_len && strcmp(local_path + path_len - suffix_len, PART_SUFFIX) == 0;
+
+    struct stat st;
+    if (partial || stat(local_path, &st) != 0 || !S_ISREG(st.st_mode)) {
         ESP_LOGW(TAG, "File not found: %s", local_path);
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
         return ESP_FAIL;
     }
-
-    ESP_LOGI(TAG, "Serving file: %s", local_path);
+    size_t file_size = (size_t)st.st_size;
 
     // Determine content type
     const char *content_type = "application/octet-stream";
@@ -640,37 +1585,86 @@ static esp_err_t updates_file_handler(httpd_req_t *req)
     if (filename) filename++;
     else filename = "download";
 
-    // Read and send file
-    uint8_t *buffer = malloc(DOWNLOAD_BUFFER_SIZE);
-    if (buffer == NULL) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    size_t first = 0;
+    size_t last = file_size > 0 ? file_size - 1 : 0;
+    range_result_t range = RANGE_NONE;
+    char range_hdr[64];
+    if (httpd_req_get_hdr_value_str(req, "Range", range_hdr, sizeof(range_hdr)) == ESP_OK) {
+        range = parse_range(range_hdr, file_size, &first, &last);
     }
 
-    size_t file_size = 0;
-    esp_err_t ret = sdcard_read_file(local_path, buffer, DOWNLOAD_BUFFER_SIZE, &file_size);
-    if (ret != ESP_OK) {
-        free(buffer);
+    if (range == RANGE_UNSATISFIABLE) {
+        char content_range[40];
+        snprintf(content_range, sizeof(content_range), "bytes */%zu", file_size);
+        httpd_resp_set_status(req, "416 Range Not Satisfiable");
+        httpd_resp_set_hdr(req, "Content-Range", content_range);
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    FILE *file = fopen(local_path, "rb");
+    if (file == NULL || (first > 0 && fseek(file, (long)first, SEEK_SET) != 0)) {
+        if (file != NULL) {
+            fclose(file);
+        }
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read file");
         return ESP_FAIL;
     }
 
-    // Set headers
-    httpd_resp_set_type(req, content_type);
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    char *buffer = malloc(SERVE_CHUNK_SIZE);
+    if (buffer == NULL) {
+        fclose(file);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+        return ESP_FAIL;
+    }
 
-    char disposition[128];
-    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s\"", filename);
-    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+    size_t remaining = file_size > 0 ? last - first + 1 : 0;
+    char content_range[64] = "";
+    if (range == RANGE_OK) {
+        snprintf(content_range, sizeof(content_range), "Content-Range: bytes %zu-%zu/%zu\r\n",
+                 first, last, file_size);
+    }
+    int head_len = snprintf(buffer, SERVE_CHUNK_SIZE,
+                            "HTTP/1.1 %s\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %zu\r\n"
+                            "%s"
+                            "Accept-Ranges: bytes\r\n"
+                            "Access-Control-Allow-Origin: *\r\n"
+                            "Content-Disposition: attachment; filename=\"%s\"\r\n"
+                            "\r\n",
+                            range == RANGE_OK ? "206 Partial Content" : "200 OK",
+                            content_type, remaining, content_range, filename);
+
+    esp_err_t ret = send_all(req, buffer, (size_t)head_len);
+    size_t sent = 0;
+    while (ret == ESP_OK && sent < remaining) {
+        size_t want = remaining - sent < SERVE_CHUNK_SIZE ? remaining - sent : SERVE_CHUNK_SIZE;
+        size_t got = fread(buffer, 1, want, file);
+        if (got == 0) {
+            // The length is already promised; only closing the connection can tell the client
+            ESP_LOGE(TAG, "Read error in %s at %zu", local_path, first + sent);
+            ret = ESP_FAIL;
+            break;
+        }
+        ret = send_all(req, buffer, got);
+        if (ret == ESP_OK) {
+            sent += got;
+        }
+    }
 
-    // Send file
-    httpd_resp_send(req, (char *)buffer, file_size);
     free(buffer);
+    fclose(file);
 
-    s_stats.files_served++;
-    s_stats.bytes_served += file_size;
+    s_stats.bytes_served += sent;
+    if (ret != ESP_OK) {
+        GEOGRAM_DLOGW(TAG, "Serving %s stopped after %zu of %zu bytes", filename, sent, remaining);
+        return ESP_FAIL;
+    }
 
-    ESP_LOGI(TAG, "Served %zu bytes", file_size);
+    s_stats.files_served++;
+    GEOGRAM_DLOGI(TAG, "Served %s (%zu bytes from %zu)", filename, sent, first);
     return ESP_OK;
 }
 
@@ -694,13 +1688,13 @@ esp_err_t updates_register_http_handlers(httpd_handle_t server)
         return ESP_ERR_INVALID_ARG;
     }
 
-    esp_err_t ret = httpd_register_uri_handler(server, &updates_latest_uri);
+    esp_err_t ret = http_route_register(server, &updates_latest_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register /api/updates/latest handler");
         return ret;
     }
 
-    ret = httpd_register_uri_handler(server, &updates_file_uri);
+    ret = http_route_register(server, &updates_file_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register /updates/* handler");
         return ret;
@@ -13,11 +13,15 @@
 #include <stdbool.h>
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "json_utils.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define UPDATES_MIRROR_WORKERS      2   /**< Concurrent asset downloads */
+#define UPDATES_MIRROR_ATTEMPTS     5   /**< Attempts per asset and poll */
+
 /**
  * @brief Release asset types
  */
@@ -34,15 +38,35 @@ typedef enum {
     UPDATE_ASSET_COUNT
 } update_asset_type_t;
 
+/**
+ * @brief Mirror job state of a release asset
+ *
+ * Each asset of the current release is a download job, kept in release.json
+ * so mirroring continues after a reboot. Downloads go to "<local_path>.part"
+ * and resume from there; the file is renamed into place once its SHA-256
+ * matches.
+ */
+typedef enum {
+    UPDATE_JOB_PENDING,         /**< Queued (a .part file may already exist) */
+    UPDATE_JOB_ACTIVE,          /**< Being downloaded */
+    UPDATE_JOB_DONE,            /**< Downloaded and verified, served to clients */
+    UPDATE_JOB_FAILED,          /**< Out of attempts; queued again on the next poll */
+} update_job_state_t;
+
 /**
  * @brief Release asset information
  */
 typedef struct {
     char filename[64];          /**< Original filename from GitHub */
     char local_path[192];       /**< Local path on SD card */
+    char url[256];              /**< Download URL */
+    char sha256[65];            /**< Expected SHA-256 (hex), "" if not published */
     size_t size_bytes;          /**< File size in bytes */
-    bool downloaded;            /**< Whether file is downloaded */
+    size_t bytes_done;          /**< Bytes on SD card so far */
     update_asset_type_t type;   /**< Asset type */
+    update_job_state_t state;   /**< Mirror job state */
+    uint8_t attempts;           /**< Failed download attempts */
+    bool verified;              /**< SHA-256 checked (false if none was published) */
 } update_asset_t;
 
 /**
@@ -67,8 +91,18 @@ typedef struct {
     uint32_t downloads_started;     /**< Number of downloads started */
     uint32_t downloads_completed;   /**< Number of downloads completed */
     uint32_t downloads_failed;      /**< Number of downloads failed */
+    uint32_t downloads_resumed;     /**< Downloads continued from a .part file */
+    uint32_t verify_failures;       /**< Downloads discarded on SHA-256 mismatch */
     uint32_t files_served;          /**< Number of files served to clients */
     uint64_t bytes_served;          /**< Total bytes served to clients */
+    // Mirroring progress of the current release
+    uint8_t jobs_total;             /**< Assets to mirror */
+    uint8_t jobs_done;              /**< Assets downloaded and verified */
+    uint8_t jobs_active;            /**< Downloads in progress */
+    uint8_t jobs_failed;            /**< Assets waiting for the next poll */
+    uint64_t mirror_bytes_total;    /**< Size of all assets (where known) */
+    uint64_t mirror_bytes_done;     /**< Bytes of them on SD card */
+    uint32_t download_rate;         /**< Bytes per second over all downloads */
 } update_stats_t;
 
 /**
@@ -90,18 +124,37 @@ bool updates_is_available(void);
 /**
  * @brief Check for new release from GitHub
  *
- * Downloads release metadata from GitHub API. If a new version is found,
- * triggers background download of binaries.
+ * Asks the GitHub API for the latest release, conditional on the ETag of
+ * the cached one, and parses the answer while it arrives: reading stops at
+ * tag_name when the version is already known. If a new version is found,
+ * its assets are queued as mirror jobs; either way, unfinished and failed
+ * jobs are (re)started in the background.
  *
  * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no new version
  */
 esp_err_t updates_check_github(void);
 
+/**
+ * @brief Mirror another station instead of GitHub
+ *
+ * Releases are then read from the station's /api/updates/latest and assets
+ * downloaded from it (and verified against the SHA-256 it lists), so a mesh
+ * fetches each release from the WAN once: only the root polls GitHub and
+ * every other node mirrors its parent. Falls back to GitHub when the
+ * station has no update mirror.
+ *
+ * @param base_url Station URL (e.g. "http://192.168.10.1"), NULL or "" for GitHub
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the URL is too long
+ */
+esp_err_t updates_set_upstream(const char *base_url);
+
 /**
  * @brief Start background update polling
  *
- * Starts a task that periodically checks GitHub for new releases
- * and downloads binaries in the background.
+ * Starts a task that periodically checks GitHub (or the upstream station)
+ * for new releases; if already running, only the interval changes. Assets
+ * are mirrored by up to UPDATES_MIRROR_WORKERS download tasks; unfinished
+ * or failed ones are queued again on every poll.
  *
  * @param interval_seconds Polling interval (minimum 60 seconds)
  * @return ESP_OK on success
@@ -134,10 +187,19 @@ esp_err_t updates_get_stats(update_stats_t *stats);
  *
  * @param buffer Output buffer
  * @param buffer_size Buffer size
- * @return Number of bytes written
+ * @return Number of bytes written, 0 if the buffer is too small
  */
 size_t updates_build_latest_json(char *buffer, size_t buffer_size);
 
+/**
+ * @brief Write the /api/updates/latest document to a builder
+ *
+ * Use with a streaming builder to send any number of assets in bounded memory.
+ *
+ * @param builder JSON builder (fixed or streaming)
+ */
+void updates_write_latest_json(geo_json_builder_t *builder);
+
 /**
  * @brief Register HTTP handlers for update endpoints
  *
@@ -7,6 +7,7 @@
  * - File availability announcements
  * - WebRTC signaling (offer/answer/ICE)
  * - Mesh network forwarding of file requests
+ * - Signed NOSTR events (verified in batches, then relayed)
  */
 
 #include "ws_server.h"
@@ -15,6 +16,10 @@
 #include <esp_http_server.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "nostr_event.h"
+#include "json_tokenizer.h"
+#include "geogram_metrics.h"
+#include "http_route.h"
 
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
 #include "mesh_bsp.h"
@@ -23,6 +28,9 @@
 
 static const char *TAG = "WS";
 
+// Top-level fields of a signaling frame (two tokens per field)
+#define WS_JSON_MAX_TOKENS      32
+
 // Mesh file request magic number
 #define WS_MESH_FILE_REQ_MAGIC  0x46494C45  // "FILE"
 
@@ -39,39 +47,41 @@ typedef struct __attribute__((packed)) {
 static ws_client_t s_clients[WS_MAX_CLIENTS];
 static SemaphoreHandle_t s_mutex = NULL;
 static httpd_handle_t s_server = NULL;
+static uint32_t s_next_session = 0;     // Guarded by s_mutex
+
+// A text frame tokenized once; nested values (event, candidate) stay whole
+typedef struct {
+    const char *data;
+    geo_json_token_t tokens[WS_JSON_MAX_TOKENS];
+    int count;
+} ws_frame_t;
 
-// Simple JSON helper to extract string value
-static bool json_get_string(const char *json, const char *key, char *value, size_t value_len)
+static bool parse_frame(ws_frame_t *frame, const char *data, size_t len)
 {
-    char search[64];
-    snprintf(search, sizeof(search), "\"%s\":\"", key);
-    const char *pos = strstr(json, search);
-    if (!pos) {
-        // Try without quotes for non-string values
-        snprintf(search, sizeof(search), "\"%s\":", key);
-        pos = strstr(json, search);
-        if (!pos) return false;
-        pos += strlen(search);
-        while (*pos == ' ') pos++;
-        // Copy until comma, brace, or bracket
-        size_t i = 0;
-        while (*pos && *pos != ',' && *pos != '}' && *pos != ']' && i < value_len - 1) {
-            value[i++] = *pos++;
-        }
-        value[i] = '\0';
-        return i > 0;
-    }
+    geo_json_parser_t parser;
+    geo_json_parser_init(&parser, 2);
+    frame->data = data;
+    frame->count = geo_json_parse(&parser, data, len, frame->tokens, WS_JSON_MAX_TOKENS);
+    return frame->count > 0 && frame->tokens[0].type == GEO_JSON_OBJECT;
+}
 
-    pos += strlen(search);
-    size_t i = 0;
-    while (*pos && *pos != '"' && i < value_len - 1) {
-        if (*pos == '\\' && pos[1]) {
-            pos++;
-        }
-        value[i++] = *pos++;
+// Copy a top-level string (unescaped) or primitive (as written) field
+static bool frame_get(const ws_frame_t *frame, const char *key, char *value, size_t value_len)
+{
+    int i = geo_json_object_get(frame->data, frame->tokens, frame->count, 0, key);
+    if (i < 0) return false;
+
+    const geo_json_token_t *tok = &frame->tokens[i];
+    if (tok->type == GEO_JSON_STRING) {
+        return geo_json_token_to_string(frame->data, tok, value, value_len) >= 0;
     }
-    value[i] = '\0';
-    return true;
+    if (tok->type != GEO_JSON_PRIMITIVE) return false;
+
+    size_t n = (size_t)(tok->end - tok->start);
+    if (n >= value_len) n = value_len - 1;
+    memcpy(value, frame->data + tok->start, n);
+    value[n] = '\0';
+    return n > 0;
 }
 
 // Find client by fd
@@ -104,6 +114,7 @@ static int add_client(int fd)
         if (!s_clients[i].active) {
             s_clients[i].fd = fd;
             s_clients[i].id[0] = '\0';
+            s_clients[i].session = ++s_next_session;
             s_clients[i].active = true;
             ESP_LOGI(TAG, "Client added: fd=%d, slot=%d", fd, i);
             xSemaphoreGive(s_mutex);
@@ -129,6 +140,16 @@ static void remove_client(int fd)
     xSemaphoreGive(s_mutex);
 }
 
+// Session of the client on fd, 0 if none
+static uint32_t client_session(int fd)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int idx = find_client_by_fd(fd);
+    uint32_t session = idx >= 0 ? s_clients[idx].session : 0;
+    xSemaphoreGive(s_mutex);
+    return session;
+}
+
 // Set client ID from hello message
 static void set_client_id(int fd, const char *id)
 {
@@ -142,13 +163,11 @@ static void set_client_id(int fd, const char *id)
     xSemaphoreGive(s_mutex);
 }
 
-// Parse message type from JSON
-ws_message_type_t ws_parse_message_type(const char *data, size_t len)
+// Message type of a parsed frame
+static ws_message_type_t frame_message_type(const ws_frame_t *frame)
 {
-    if (!data || len == 0) return WS_MSG_UNKNOWN;
-
     char type[32] = {0};
-    if (!json_get_string(data, "type", type, sizeof(type))) {
+    if (!frame_get(frame, "type", type, sizeof(type))) {
         return WS_MSG_UNKNOWN;
     }
 
@@ -162,10 +181,23 @@ ws_message_type_t ws_parse_message_type(const char *data, size_t len)
     if (strcmp(type, "rtc_answer") == 0) return WS_MSG_RTC_ANSWER;
     if (strcmp(type, "rtc_ice") == 0) return WS_MSG_RTC_ICE;
     if (strcmp(type, "ping") == 0) return WS_MSG_PING;
+    if (strcmp(type, "event") == 0) return WS_MSG_EVENT;
 
     return WS_MSG_UNKNOWN;
 }
 
+// Parse message type from JSON
+ws_message_type_t ws_parse_message_type(const char *data, size_t len)
+{
+    if (!data || len == 0) return WS_MSG_UNKNOWN;
+
+    ws_frame_t frame;
+    if (!parse_frame(&frame, data, len)) {
+        return WS_MSG_UNKNOWN;
+    }
+    return frame_message_type(&frame);
+}
+
 // Send text to specific client
 esp_err_t ws_send_text(httpd_handle_t server, int fd, const char *message, size_t len)
 {
@@ -186,6 +218,28 @@ esp_err_t ws_send_text(httpd_handle_t server, int fd, const char *message, size_
     return ret;
 }
 
+bool ws_stream_flush(const char *data, size_t len, bool final, void *ctx)
+{
+    ws_stream_t *stream = (ws_stream_t *)ctx;
+
+    // A document that fits one chunk goes out as a plain frame
+    httpd_ws_frame_t ws_pkt = {
+        .type = stream->started ? HTTPD_WS_TYPE_CONTINUE : HTTPD_WS_TYPE_TEXT,
+        .fragmented = stream->started || !final,
+        .final = final,
+        .payload = (uint8_t *)data,
+        .len = len
+    };
+    stream->started = true;
+
+    esp_err_t ret = httpd_ws_send_frame_async(stream->server, stream->fd, &ws_pkt);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to stream to fd=%d: %s", stream->fd, esp_err_to_name(ret));
+        return false;
+    }
+    return true;
+}
+
 // Send to client by ID
 esp_err_t ws_send_to_client(httpd_handle_t server, const char *client_id, const char *message, size_t len)
 {
@@ -239,6 +293,15 @@ int ws_get_client_count(void)
     return count;
 }
 
+static int64_t read_client_count(const geogram_metric_t *metric)
+{
+    (void)metric;
+    return ws_get_client_count();
+}
+
+static geogram_metric_t s_clients_metric = GEOGRAM_METRIC_READ_INIT(
+    GEOGRAM_METRIC_GAUGE, "geogram_ws_clients", "WebSocket clients connected", read_client_count, 0);
+
 // Parse SHA1 hex string to bytes
 static bool parse_sha1_hex(const char *hex, uint8_t *out)
 {
@@ -343,16 +406,63 @@ void ws_handle_mesh_file_request(const uint8_t *src_mac, const void *data, size_
 }
 #endif
 
+// Event frame waiting for verification
+typedef struct {
+    int fd;
+    uint32_t session;       // Sender's connection; the fd may be reused by the time it is verified
+    size_t len;
+    char data[];
+} ws_event_job_t;
+
+// Verify task callback: acknowledge to the sender, relay if authentic
+static void on_event_verified(esp_err_t result, const nostr_event_t *event, void *ctx)
+{
+    ws_event_job_t *job = (ws_event_job_t *)ctx;
+    char reply[128];
+    int reply_len;
+
+    // The sender may have left while the event waited in the queue
+    bool sender_connected = job->session != 0 && client_session(job->fd) == job->session;
+
+    if (result == ESP_OK) {
+        char id_hex[NOSTR_EVENT_ID_LEN * 2 + 1];
+        for (int i = 0; i < NOSTR_EVENT_ID_LEN; i++) {
+            sprintf(id_hex + i * 2, "%02x", event->id[i]);
+        }
+        reply_len = snprintf(reply, sizeof(reply),
+                             "{\"type\":\"event_ok\",\"id\":\"%s\",\"ok\":true}", id_hex);
+        broadcast_except(s_server, sender_connected ? job->fd : -2, job->data, job->len);
+    } else {
+        ESP_LOGW(TAG, "Rejected event from fd=%d: %s", job->fd, esp_err_to_name(result));
+        reply_len = snprintf(reply, sizeof(reply), "{\"type\":\"event_ok\",\"ok\":false}");
+    }
+
+    // Reply only to the same connection, never to a newer client on its fd
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int idx = find_client_by_fd(job->fd);
+    if (idx >= 0 && s_clients[idx].session == job->session) {
+        ws_send_text(s_server, job->fd, reply, reply_len);
+    }
+    xSemaphoreGive(s_mutex);
+    free(job);
+}
+
 // Handle incoming WebSocket message
 static void handle_ws_message(httpd_handle_t server, int fd, const char *data, size_t len)
 {
-    ws_message_type_t msg_type = ws_parse_message_type(data, len);
+    ws_frame_t frame;
+    if (!parse_frame(&frame, data, len)) {
+        ESP_LOGD(TAG, "Malformed frame from fd=%d", fd);
+        return;
+    }
+
+    ws_message_type_t msg_type = frame_message_type(&frame);
     char value[128];
 
     switch (msg_type) {
         case WS_MSG_HELLO:
             // Client identifies itself
-            if (json_get_string(data, "id", value, sizeof(value))) {
+            if (frame_get(&frame, "id", value, sizeof(value))) {
                 ESP_LOGI(TAG, "WS hello: id=%s fd=%d", value, fd);
                 set_client_id(fd, value);
             }
@@ -363,8 +473,8 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
             {
                 char sha1[64] = {0};
                 char from_id[16] = {0};
-                json_get_string(data, "sha1", sha1, sizeof(sha1));
-                json_get_string(data, "from", from_id, sizeof(from_id));
+                frame_get(&frame, "sha1", sha1, sizeof(sha1));
+                frame_get(&frame, "from", from_id, sizeof(from_id));
                 ESP_LOGI(TAG, "File request: sha1=%s from=%s", sha1[0] ? sha1 : "unknown",
                          from_id[0] ? from_id : "unknown");
             }
@@ -375,8 +485,8 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
             {
                 char sha1[64] = {0};
                 char from_id[16] = {0};
-                if (json_get_string(data, "sha1", sha1, sizeof(sha1))) {
-                    json_get_string(data, "from", from_id, sizeof(from_id));
+                if (frame_get(&frame, "sha1", sha1, sizeof(sha1))) {
+                    frame_get(&frame, "from", from_id, sizeof(from_id));
                     forward_file_request_to_mesh(sha1, from_id);
                 }
             }
@@ -388,8 +498,8 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
             {
                 char sha1[64] = {0};
                 char from_id[16] = {0};
-                json_get_string(data, "sha1", sha1, sizeof(sha1));
-                json_get_string(data, "from", from_id, sizeof(from_id));
+                frame_get(&frame, "sha1", sha1, sizeof(sha1));
+                frame_get(&frame, "from", from_id, sizeof(from_id));
                 ESP_LOGI(TAG, "File available: sha1=%s from=%s", sha1[0] ? sha1 : "unknown",
                          from_id[0] ? from_id : "unknown");
             }
@@ -399,14 +509,14 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
         case WS_MSG_FILE_FETCH:
         case WS_MSG_FILE_CHUNK:
         case WS_MSG_FILE_COMPLETE:
-            if (json_get_string(data, "to", value, sizeof(value))) {
+            if (frame_get(&frame, "to", value, sizeof(value))) {
                 char sha1[64] = {0};
                 char from_id[16] = {0};
                 char seq[16] = {0};
-                json_get_string(data, "sha1", sha1, sizeof(sha1));
-                json_get_string(data, "from", from_id, sizeof(from_id));
+                frame_get(&frame, "sha1", sha1, sizeof(sha1));
+                frame_get(&frame, "from", from_id, sizeof(from_id));
                 if (msg_type == WS_MSG_FILE_CHUNK) {
-                    json_get_string(data, "seq", seq, sizeof(seq));
+                    frame_get(&frame, "seq", seq, sizeof(seq));
                 }
                 ESP_LOGI(TAG, "File relay: type=%s sha1=%s from=%s to=%s seq=%s",
                          msg_type == WS_MSG_FILE_FETCH ? "fetch" :
@@ -423,7 +533,7 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
         case WS_MSG_RTC_ANSWER:
         case WS_MSG_RTC_ICE:
             // Route WebRTC signaling to specific client
-            if (json_get_string(data, "to", value, sizeof(value))) {
+            if (frame_get(&frame, "to", value, sizeof(value))) {
                 ESP_LOGI(TAG, "Routing %s to %s",
                          msg_type == WS_MSG_RTC_OFFER ? "offer" :
                          msg_type == WS_MSG_RTC_ANSWER ? "answer" : "ICE",
@@ -435,6 +545,33 @@ static void handle_ws_message(httpd_handle_t server, int fd, const char *data, s
             }
             break;
 
+        case WS_MSG_EVENT:
+            // Verify off the httpd task; bursts are checked as one batch
+            {
+                int ev = geo_json_object_get(data, frame.tokens, frame.count, 0, "event");
+                const char *event = NULL;
+                size_t event_len = 0;
+                if (ev >= 0 && frame.tokens[ev].type == GEO_JSON_OBJECT) {
+                    event = data + frame.tokens[ev].start;
+                    event_len = (size_t)(frame.tokens[ev].end - frame.tokens[ev].start);
+                }
+                ws_event_job_t *job = event_len ? malloc(sizeof(ws_event_job_t) + len) : NULL;
+                if (!job) {
+                    ws_send_text(server, fd, "{\"type\":\"event_ok\",\"ok\":false}", 30);
+                    break;
+                }
+                job->fd = fd;
+                job->session = client_session(fd);
+                job->len = len;
+                memcpy(job->data, data, len);
+                if (nostr_event_verify_async(event, event_len, on_event_verified, job) != ESP_OK) {
+                    ESP_LOGW(TAG, "Event queue full, dropping event from fd=%d", fd);
+                    ws_send_text(server, fd, "{\"type\":\"event_ok\",\"ok\":false}", 30);
+                    free(job);
+                }
+            }
+            break;
+
         case WS_MSG_PING:
             // Respond with pong
             ws_send_text(server, fd, "{\"type\":\"pong\"}", 15);
@@ -550,12 +687,14 @@ esp_err_t ws_server_register(httpd_handle_t server)
         .handle_ws_control_frames = true
     };
 
-    esp_err_t ret = httpd_register_uri_handler(server, &ws_uri);
+    esp_err_t ret = http_route_register(server, &ws_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register WebSocket handler: %s", esp_err_to_name(ret));
         return ret;
     }
 
+    geogram_metrics_register(&s_clients_metric);
+
     ESP_LOGI(TAG, "WebSocket server registered at /ws");
     return ESP_OK;
 }
@@ -3,6 +3,7 @@
 
 #include <esp_http_server.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,7 @@ typedef enum {
     WS_MSG_RTC_ANSWER,      // WebRTC answer
     WS_MSG_RTC_ICE,         // WebRTC ICE candidate
     WS_MSG_PING,
+    WS_MSG_EVENT,           // Signed NOSTR event to verify and relay
     WS_MSG_UNKNOWN
 } ws_message_type_t;
 
@@ -33,6 +35,7 @@ typedef enum {
 typedef struct {
     int fd;                 // Socket file descriptor
     char id[16];           // Client-assigned ID
+    uint32_t session;       // Tells apart connections that reuse an fd
     bool active;
 } ws_client_t;
 
@@ -42,6 +45,17 @@ esp_err_t ws_server_register(httpd_handle_t server);
 // Send text message to a specific client
 esp_err_t ws_send_text(httpd_handle_t server, int fd, const char *message, size_t len);
 
+// Streaming JSON builder sink: sends the output to one client as a single
+// (fragmented) text message. Zero-initialize, set server and fd, then pass
+// ws_stream_flush and the context to geo_json_init_stream().
+typedef struct {
+    httpd_handle_t server;
+    int fd;
+    bool started;           // First fragment sent
+} ws_stream_t;
+
+bool ws_stream_flush(const char *data, size_t len, bool final, void *ctx);
+
 // Broadcast text message to all connected clients (except sender)
 void ws_broadcast_text(httpd_handle_t server, const char *message, size_t len);
 
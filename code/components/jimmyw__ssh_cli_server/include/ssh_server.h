@@ -8,9 +8,10 @@
  *
  * Features:
  * - Password and public key authentication
- * - Multiple concurrent SSH sessions
+ * - Multiple concurrent SSH sessions, each with its own task and memory budget
  * - VFS integration for shell access
  * - Session tracking and client information
+ * - SFTP subsystem for file transfers
  * - Configurable shell functions
  *
  * @author ESP-IDF SSH Server Library
@@ -20,6 +21,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "esp_err.h"
@@ -28,6 +30,8 @@
 extern "C" {
 #endif
 
+#define SSH_SERVER_MAX_SESSIONS 4 ///< Upper bound for ssh_server_config_t::max_sessions
+
 /**
  * @brief SSH session information structure
  *
@@ -88,6 +92,29 @@ typedef struct {
     void *shell_func_ctx;        ///< User context data passed to shell function
     uint32_t shell_task_size;    ///< Stack size in bytes for shell task (recommended: 8192)
 
+    /**
+     * @brief Per-channel buffer sizes in bytes (0 for the defaults, 8 KB write / 1 KB read)
+     *
+     * Allocated from PSRAM when available, internal RAM otherwise. The write
+     * buffer holds shell output waiting for the SSH channel window.
+     */
+    size_t write_buffer_size;
+    size_t read_buffer_size;
+
+    const char *sftp_root; ///< Directory served by the "sftp" subsystem as "/" (NULL disables SFTP)
+
+    /**
+     * @brief Concurrent sessions (0 for 1, at most SSH_SERVER_MAX_SESSIONS)
+     *
+     * Each session runs its own task and event loop. Connections beyond the
+     * limit, or arriving while free heap is below one session's stack plus
+     * the buffers and shell stack of its first channel, are closed right away.
+     */
+    uint8_t max_sessions;
+    uint32_t session_task_size;   ///< Stack in bytes per session task (0 for 10 KB)
+    size_t session_memory_budget; ///< Channel buffers, shell and SFTP memory per session (0 for no limit)
+    uint32_t idle_timeout_s;      ///< Disconnect sessions without channel traffic for this long (0 never)
+
     /**
      * @brief Whether to forcefully kill shell task on disconnect
      *
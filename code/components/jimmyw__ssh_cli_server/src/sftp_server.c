@@ -0,0 +1,850 @@
+/**
+ * @file sftp_server.c
+ * @brief SFTP version 3 (draft-ietf-secsh-filexfer-02) over an SSH channel
+ *
+ * Paths are resolved against the root directory and cannot leave it.
+ * Reads and writes move up to SFTP_MAX_DATA bytes per request, which
+ * clients learn through the limits@openssh.com extension.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "sftp_server.h"
+
+#define SFTP_VERSION 3
+#define SFTP_MAX_DATA SFTP_SERVER_MAX_DATA
+#define SFTP_MAX_PACKET (SFTP_MAX_DATA + 1024) // Largest request, excluding the length
+#define SFTP_MAX_HANDLES 8
+#define SFTP_PATH_MAX 256
+#define SFTP_READDIR_BATCH 32
+
+// Packet types
+#define SSH_FXP_INIT 1
+#define SSH_FXP_VERSION 2
+#define SSH_FXP_OPEN 3
+#define SSH_FXP_CLOSE 4
+#define SSH_FXP_READ 5
+#define SSH_FXP_WRITE 6
+#define SSH_FXP_LSTAT 7
+#define SSH_FXP_FSTAT 8
+#define SSH_FXP_SETSTAT 9
+#define SSH_FXP_FSETSTAT 10
+#define SSH_FXP_OPENDIR 11
+#define SSH_FXP_READDIR 12
+#define SSH_FXP_REMOVE 13
+#define SSH_FXP_MKDIR 14
+#define SSH_FXP_RMDIR 15
+#define SSH_FXP_REALPATH 16
+#define SSH_FXP_STAT 17
+#define SSH_FXP_RENAME 18
+#define SSH_FXP_STATUS 101
+#define SSH_FXP_HANDLE 102
+#define SSH_FXP_DATA 103
+#define SSH_FXP_NAME 104
+#define SSH_FXP_ATTRS 105
+#define SSH_FXP_EXTENDED 200
+#define SSH_FXP_EXTENDED_REPLY 201
+
+// Status codes
+#define SSH_FX_OK 0
+#define SSH_FX_EOF 1
+#define SSH_FX_NO_SUCH_FILE 2
+#define SSH_FX_PERMISSION_DENIED 3
+#define SSH_FX_FAILURE 4
+#define SSH_FX_BAD_MESSAGE 5
+#define SSH_FX_OP_UNSUPPORTED 8
+
+// Attribute flags
+#define SSH_FILEXFER_ATTR_SIZE 0x00000001
+#define SSH_FILEXFER_ATTR_UIDGID 0x00000002
+#define SSH_FILEXFER_ATTR_PERMISSIONS 0x00000004
+#define SSH_FILEXFER_ATTR_ACMODTIME 0x00000008
+#define SSH_FILEXFER_ATTR_EXTENDED 0x80000000
+
+// OPEN flags
+#define SSH_FXF_READ 0x01
+#define SSH_FXF_WRITE 0x02
+#define SSH_FXF_APPEND 0x04
+#define SSH_FXF_CREAT 0x08
+#define SSH_FXF_TRUNC 0x10
+#define SSH_FXF_EXCL 0x20
+
+#define LIMITS_EXTENSION "limits@openssh.com"
+
+static const char *TAG = "sftp";
+
+typedef struct {
+    uint32_t flags;
+    uint64_t size;
+    uint32_t permissions;
+    uint32_t atime;
+    uint32_t mtime;
+} sftp_attrs_t;
+
+typedef struct {
+    bool used;
+    int fd;                   // -1 for a directory
+    DIR *dir;
+    off_t pos;                // File position, saves a seek on sequential transfers
+    bool append;              // Opened with SSH_FXF_APPEND, writes go to EOF
+    char path[SFTP_PATH_MAX]; // Local path
+} sftp_handle_t;
+
+typedef struct {
+    const sftp_server_io_t *io;
+    uint8_t *in;
+    uint8_t *out;
+    size_t out_len;
+    sftp_handle_t handles[SFTP_MAX_HANDLES];
+} sftp_session_t;
+
+typedef struct {
+    const uint8_t *p;
+    size_t left;
+    bool bad;
+} sftp_reader_t;
+
+static uint8_t *alloc_buffer(size_t size)
+{
+    uint8_t *buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        buf = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return buf;
+}
+
+static uint32_t get_u32(sftp_reader_t *r)
+{
+    if (r->left < 4) {
+        r->bad = true;
+        return 0;
+    }
+    uint32_t v = ((uint32_t)r->p[0] << 24) | ((uint32_t)r->p[1] << 16) | ((uint32_t)r->p[2] << 8) | r->p[3];
+    r->p += 4;
+    r->left -= 4;
+    return v;
+}
+
+static uint64_t get_u64(sftp_reader_t *r)
+{
+    uint64_t hi = get_u32(r);
+    return (hi << 32) | get_u32(r);
+}
+
+static const uint8_t *get_string(sftp_reader_t *r, uint32_t *len)
+{
+    *len = get_u32(r);
+    if (r->bad || *len > r->left) {
+        r->bad = true;
+        *len = 0;
+        return NULL;
+    }
+    const uint8_t *s = r->p;
+    r->p += *len;
+    r->left -= *len;
+    return s;
+}
+
+static void get_attrs(sftp_reader_t *r, sftp_attrs_t *attrs)
+{
+    memset(attrs, 0, sizeof(*attrs));
+    attrs->flags = get_u32(r);
+    if (attrs->flags & SSH_FILEXFER_ATTR_SIZE) {
+        attrs->size = get_u64(r);
+    }
+    if (attrs->flags & SSH_FILEXFER_ATTR_UIDGID) {
+        get_u32(r);
+        get_u32(r);
+    }
+    if (attrs->flags & SSH_FILEXFER_ATTR_PERMISSIONS) {
+        attrs->permissions = get_u32(r);
+    }
+    if (attrs->flags & SSH_FILEXFER_ATTR_ACMODTIME) {
+        attrs->atime = get_u32(r);
+        attrs->mtime = get_u32(r);
+    }
+    if (attrs->flags & SSH_FILEXFER_ATTR_EXTENDED) {
+        uint32_t count = get_u32(r);
+        for (uint32_t i = 0; i < count && !r->bad; i++) {
+            uint32_t len;
+            get_string(r, &len);
+            get_string(r, &len);
+        }
+    }
+}
+
+/*
+ * Replies are built in s->out behind a 4 byte length. Every reply fits:
+ * DATA is bounded by SFTP_MAX_DATA and READDIR stops while room is left.
+ */
+
+static void put_u8(sftp_session_t *s, uint8_t v)
+{
+    s->out[s->out_len++] = v;
+}
+
+static void put_u32(sftp_session_t *s, uint32_t v)
+{
+    s->out[s->out_len++] = v >> 24;
+    s->out[s->out_len++] = v >> 16;
+    s->out[s->out_len++] = v >> 8;
+    s->out[s->out_len++] = v;
+}
+
+static void put_u64(sftp_session_t *s, uint64_t v)
+{
+    put_u32(s, v >> 32);
+    put_u32(s, (uint32_t)v);
+}
+
+static void put_string(sftp_session_t *s, const void *data, size_t len)
+{
+    put_u32(s, len);
+    memcpy(s->out + s->out_len, data, len);
+    s->out_len += len;
+}
+
+static void put_attrs(sftp_session_t *s, const struct stat *st)
+{
+    if (!st) {
+        put_u32(s, 0);
+        return;
+    }
+    put_u32(s, SSH_FILEXFER_ATTR_SIZE | SSH_FILEXFER_ATTR_PERMISSIONS | SSH_FILEXFER_ATTR_ACMODTIME);
+    put_u64(s, st->st_size);
+    put_u32(s, st->st_mode);
+    put_u32(s, st->st_atime);
+    put_u32(s, st->st_mtime);
+}
+
+static void begin_reply(sftp_session_t *s, uint8_t type, uint32_t id)
+{
+    s->out_len = 4;
+    put_u8(s, type);
+    put_u32(s, id);
+}
+
+static bool send_reply(sftp_session_t *s)
+{
+    uint32_t len = s->out_len - 4;
+    s->out[0] = len >> 24;
+    s->out[1] = len >> 16;
+    s->out[2] = len >> 8;
+    s->out[3] = len;
+    return s->io->write(s->io->ctx, s->out, s->out_len) >= 0;
+}
+
+static bool send_status(sftp_session_t *s, uint32_t id, uint32_t code)
+{
+    static const char *messages[] = {
+        "Success", "End of file", "No such file", "Permission denied", "Failure", "Bad message", "No connection", "Connection lost", "Operation unsupported",
+    };
+    const char *msg = code < sizeof(messages) / sizeof(messages[0]) ? messages[code] : "Failure";
+
+    begin_reply(s, SSH_FXP_STATUS, id);
+    put_u32(s, code);
+    put_string(s, msg, strlen(msg));
+    put_string(s, "en", 2);
+    return send_reply(s);
+}
+
+static bool send_errno(sftp_session_t *s, uint32_t id, int err)
+{
+    switch (err) {
+    case ENOENT:
+    case ENOTDIR:
+        return send_status(s, id, SSH_FX_NO_SUCH_FILE);
+    case EACCES:
+    case EPERM:
+    case EROFS:
+        return send_status(s, id, SSH_FX_PERMISSION_DENIED);
+    default:
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+}
+
+/**
+ * @brief Resolve a client path to an absolute path under the root ("/" is the root)
+ *
+ * "." and ".." are folded, so the result never climbs above the root.
+ */
+static bool normalize_path(const uint8_t *in, uint32_t len, char *out, size_t size)
+{
+    const char *p = (const char *)in;
+    const char *end = p + len;
+    size_t n = 0;
+
+    out[0] = '\0';
+    while (p < end) {
+        const char *part = p;
+        while (p < end && *p != '/') {
+            p++;
+        }
+        size_t part_len = p - part;
+        if (p < end) {
+            p++;
+        }
+
+        if (part_len == 0 || (part_len == 1 && part[0] == '.')) {
+            continue;
+        }
+        if (part_len == 2 && part[0] == '.' && part[1] == '.') {
+            while (n > 0 && out[n - 1] != '/') {
+                n--;
+            }
+            if (n > 0) {
+                n--;
+            }
+            out[n] = '\0';
+            continue;
+        }
+        if (memchr(part, '\0', part_len) || n + 1 + part_len + 1 > size) {
+            return false;
+        }
+        out[n++] = '/';
+        memcpy(out + n, part, part_len);
+        n += part_len;
+        out[n] = '\0';
+    }
+
+    if (n == 0) {
+        strcpy(out, "/");
+    }
+    return true;
+}
+
+/**
+ * @brief Read a path argument and map it to the local file system
+ */
+static bool get_path(sftp_session_t *s, sftp_reader_t *r, char *local, size_t size)
+{
+    char path[SFTP_PATH_MAX];
+    uint32_t len;
+    const uint8_t *str = get_string(r, &len);
+
+    if (r->bad || !normalize_path(str, len, path, sizeof(path))) {
+        return false;
+    }
+    int n = snprintf(local, size, "%s%s", s->io->root, strcmp(path, "/") == 0 ? "" : path);
+    return n > 0 && (size_t)n < size;
+}
+
+static int alloc_handle(sftp_session_t *s)
+{
+    for (int i = 0; i < SFTP_MAX_HANDLES; i++) {
+        if (!s->handles[i].used) {
+            s->handles[i] = (sftp_handle_t){.used = true, .fd = -1};
+            return i;
+        }
+    }
+    return -1;
+}
+
+static sftp_handle_t *get_handle(sftp_session_t *s, sftp_reader_t *r)
+{
+    uint32_t len;
+    const uint8_t *str = get_string(r, &len);
+
+    if (r->bad || len != 4) {
+        return NULL;
+    }
+    uint32_t idx = ((uint32_t)str[0] << 24) | ((uint32_t)str[1] << 16) | ((uint32_t)str[2] << 8) | str[3];
+    if (idx >= SFTP_MAX_HANDLES || !s->handles[idx].used) {
+        return NULL;
+    }
+    return &s->handles[idx];
+}
+
+static bool send_handle(sftp_session_t *s, uint32_t id, int idx)
+{
+    uint8_t handle[4] = {0, 0, 0, (uint8_t)idx};
+
+    begin_reply(s, SSH_FXP_HANDLE, id);
+    put_string(s, handle, sizeof(handle));
+    return send_reply(s);
+}
+
+static void close_handle(sftp_handle_t *h)
+{
+    if (h->dir) {
+        closedir(h->dir);
+    }
+    if (h->fd >= 0) {
+        close(h->fd);
+    }
+    h->used = false;
+}
+
+/**
+ * @brief ls -l style line, shown by clients in long listings
+ */
+static void put_longname(sftp_session_t *s, const char *name, const struct stat *st)
+{
+    char line[SFTP_PATH_MAX + 64];
+    char mode[11] = "----------";
+    char date[16] = "Jan  1 00:00";
+
+    if (st) {
+        mode[0] = S_ISDIR(st->st_mode) ? 'd' : '-';
+        for (int i = 0; i < 9; i++) {
+            if (st->st_mode & (0400 >> i)) {
+                mode[1 + i] = "rwxrwxrwx"[i];
+            }
+        }
+        struct tm tm;
+        time_t mtime = st->st_mtime;
+        gmtime_r(&mtime, &tm);
+        strftime(date, sizeof(date), "%b %e %H:%M", &tm);
+    }
+    int len = snprintf(line, sizeof(line), "%s    1 root     root     %8lu %s %s", mode, st ? (unsigned long)st->st_size : 0UL, date, name);
+    put_string(s, line, len < (int)sizeof(line) ? len : sizeof(line) - 1);
+}
+
+static bool handle_open(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    char path[SFTP_PATH_MAX];
+    sftp_attrs_t attrs;
+
+    bool path_ok = get_path(s, r, path, sizeof(path));
+    uint32_t pflags = get_u32(r);
+    get_attrs(r, &attrs);
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!path_ok) {
+        return send_status(s, id, SSH_FX_NO_SUCH_FILE);
+    }
+
+    int oflags;
+    if ((pflags & SSH_FXF_READ) && (pflags & SSH_FXF_WRITE)) {
+        oflags = O_RDWR;
+    } else if (pflags & SSH_FXF_WRITE) {
+        oflags = O_WRONLY;
+    } else {
+        oflags = O_RDONLY;
+    }
+    if (pflags & SSH_FXF_APPEND) {
+        oflags |= O_APPEND;
+    }
+    if (pflags & SSH_FXF_CREAT) {
+        oflags |= O_CREAT;
+    }
+    if (pflags & SSH_FXF_TRUNC) {
+        oflags |= O_TRUNC;
+    }
+    if (pflags & SSH_FXF_EXCL) {
+        oflags |= O_EXCL;
+    }
+
+    int idx = alloc_handle(s);
+    if (idx < 0) {
+        ESP_LOGW(TAG, "Out of handles");
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+    sftp_handle_t *h = &s->handles[idx];
+    h->fd = open(path, oflags, 0664);
+    if (h->fd < 0) {
+        int err = errno;
+        h->used = false;
+        return send_errno(s, id, err);
+    }
+    h->append = (pflags & SSH_FXF_APPEND) != 0;
+    strlcpy(h->path, path, sizeof(h->path));
+
+    ESP_LOGD(TAG, "Open %s (0x%lx)", path, (unsigned long)pflags);
+    return send_handle(s, id, idx);
+}
+
+static bool handle_read(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    sftp_handle_t *h = get_handle(s, r);
+    uint64_t offset = get_u64(r);
+    uint32_t len = get_u32(r);
+
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!h || h->fd < 0) {
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+    if (len > SFTP_MAX_DATA) {
+        len = SFTP_MAX_DATA;
+    }
+    if ((off_t)offset != h->pos) {
+        if (lseek(h->fd, (off_t)offset, SEEK_SET) < 0) {
+            return send_errno(s, id, errno);
+        }
+        h->pos = (off_t)offset;
+    }
+
+    // Read straight into the DATA reply, behind its string length
+    begin_reply(s, SSH_FXP_DATA, id);
+    ssize_t n = read(h->fd, s->out + s->out_len + 4, len);
+    if (n < 0) {
+        h->pos = -1;
+        return send_errno(s, id, errno);
+    }
+    if (n == 0) {
+        return send_status(s, id, SSH_FX_EOF);
+    }
+    h->pos += n;
+    put_u32(s, n);
+    s->out_len += n;
+    return send_reply(s);
+}
+
+static bool handle_write(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    sftp_handle_t *h = get_handle(s, r);
+    uint64_t offset = get_u64(r);
+    uint32_t len;
+    const uint8_t *data = get_string(r, &len);
+
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!h || h->fd < 0) {
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+    if (h->append) {
+        // Append writes ignore the offset and land at EOF, so take the
+        // position from the file rather than from the request
+        h->pos = lseek(h->fd, 0, SEEK_END);
+        if (h->pos < 0) {
+            return send_errno(s, id, errno);
+        }
+    } else if ((off_t)offset != h->pos) {
+        if (lseek(h->fd, (off_t)offset, SEEK_SET) < 0) {
+            return send_errno(s, id, errno);
+        }
+        h->pos = (off_t)offset;
+    }
+
+    while (len > 0) {
+        ssize_t n = write(h->fd, data, len);
+        if (n <= 0) {
+            h->pos = -1;
+            return send_errno(s, id, n < 0 ? errno : ENOSPC);
+        }
+        data += n;
+        len -= n;
+        h->pos += n;
+    }
+    return send_status(s, id, SSH_FX_OK);
+}
+
+static bool send_stat(sftp_session_t *s, uint32_t id, int rc, const struct stat *st)
+{
+    if (rc != 0) {
+        return send_errno(s, id, errno);
+    }
+    begin_reply(s, SSH_FXP_ATTRS, id);
+    put_attrs(s, st);
+    return send_reply(s);
+}
+
+/**
+ * @brief Apply size and times; ownership and permissions do not exist on FAT
+ */
+static int apply_attrs(const char *path, int fd, const sftp_attrs_t *attrs)
+{
+    if (attrs->flags & SSH_FILEXFER_ATTR_SIZE) {
+        int rc = fd >= 0 ? ftruncate(fd, (off_t)attrs->size) : truncate(path, (off_t)attrs->size);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    if (attrs->flags & SSH_FILEXFER_ATTR_ACMODTIME) {
+        struct utimbuf times = {.actime = attrs->atime, .modtime = attrs->mtime};
+        if (utime(path, &times) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static bool handle_opendir(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    char path[SFTP_PATH_MAX];
+
+    bool path_ok = get_path(s, r, path, sizeof(path));
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!path_ok) {
+        return send_status(s, id, SSH_FX_NO_SUCH_FILE);
+    }
+
+    int idx = alloc_handle(s);
+    if (idx < 0) {
+        ESP_LOGW(TAG, "Out of handles");
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+    sftp_handle_t *h = &s->handles[idx];
+    h->dir = opendir(path);
+    if (!h->dir) {
+        int err = errno;
+        h->used = false;
+        return send_errno(s, id, err);
+    }
+    strlcpy(h->path, path, sizeof(h->path));
+    return send_handle(s, id, idx);
+}
+
+static bool handle_readdir(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    sftp_handle_t *h = get_handle(s, r);
+
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!h || !h->dir) {
+        return send_status(s, id, SSH_FX_FAILURE);
+    }
+
+    begin_reply(s, SSH_FXP_NAME, id);
+    size_t count_at = s->out_len;
+    put_u32(s, 0);
+
+    // Each entry takes at most two names, a date line and attrs
+    uint32_t count = 0;
+    struct dirent *entry;
+    while (count < SFTP_READDIR_BATCH && SFTP_MAX_PACKET + 4 - s->out_len > 2 * SFTP_PATH_MAX + 128 && (entry = readdir(h->dir)) != NULL) {
+        char path[SFTP_PATH_MAX * 2];
+        struct stat st;
+        size_t name_len = strlen(entry->d_name);
+
+        if (name_len >= SFTP_PATH_MAX) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", h->path, entry->d_name);
+        bool have_stat = stat(path, &st) == 0;
+
+        put_string(s, entry->d_name, name_len);
+        put_longname(s, entry->d_name, have_stat ? &st : NULL);
+        put_attrs(s, have_stat ? &st : NULL);
+        count++;
+    }
+
+    if (count == 0) {
+        return send_status(s, id, SSH_FX_EOF);
+    }
+    size_t end = s->out_len;
+    s->out_len = count_at;
+    put_u32(s, count);
+    s->out_len = end;
+    return send_reply(s);
+}
+
+static bool handle_realpath(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    char path[SFTP_PATH_MAX];
+    uint32_t len;
+    const uint8_t *str = get_string(r, &len);
+
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (!normalize_path(str, len, path, sizeof(path))) {
+        return send_status(s, id, SSH_FX_NO_SUCH_FILE);
+    }
+
+    begin_reply(s, SSH_FXP_NAME, id);
+    put_u32(s, 1);
+    put_string(s, path, strlen(path));
+    put_string(s, path, strlen(path));
+    put_attrs(s, NULL);
+    return send_reply(s);
+}
+
+static bool handle_extended(sftp_session_t *s, uint32_t id, sftp_reader_t *r)
+{
+    uint32_t len;
+    const uint8_t *name = get_string(r, &len);
+
+    if (r->bad) {
+        return send_status(s, id, SSH_FX_BAD_MESSAGE);
+    }
+    if (len != strlen(LIMITS_EXTENSION) || memcmp(name, LIMITS_EXTENSION, len) != 0) {
+        return send_status(s, id, SSH_FX_OP_UNSUPPORTED);
+    }
+
+    begin_reply(s, SSH_FXP_EXTENDED_REPLY, id);
+    put_u64(s, SFTP_MAX_PACKET);
+    put_u64(s, SFTP_MAX_DATA);
+    put_u64(s, SFTP_MAX_DATA);
+    put_u64(s, SFTP_MAX_HANDLES);
+    return send_reply(s);
+}
+
+/**
+ * @brief Handle one request
+ *
+ * @return false if the reply could not be sent
+ */
+static bool handle_packet(sftp_session_t *s, size_t len)
+{
+    sftp_reader_t r = {.p = s->in + 1, .left = len - 1};
+    uint8_t type = s->in[0];
+
+    if (type == SSH_FXP_INIT) {
+        ESP_LOGD(TAG, "Client version %lu", (unsigned long)get_u32(&r));
+        s->out_len = 4;
+        put_u8(s, SSH_FXP_VERSION);
+        put_u32(s, SFTP_VERSION);
+        put_string(s, LIMITS_EXTENSION, strlen(LIMITS_EXTENSION));
+        put_string(s, "1", 1);
+        return send_reply(s);
+    }
+
+    uint32_t id = get_u32(&r);
+    if (r.bad) {
+        return send_status(s, 0, SSH_FX_BAD_MESSAGE);
+    }
+
+    char path[SFTP_PATH_MAX];
+    char path2[SFTP_PATH_MAX];
+    sftp_handle_t *h;
+    sftp_attrs_t attrs;
+    struct stat st;
+    bool path_ok;
+
+    switch (type) {
+    case SSH_FXP_OPEN:
+        return handle_open(s, id, &r);
+    case SSH_FXP_CLOSE:
+        h = get_handle(s, &r);
+        if (!h) {
+            return send_status(s, id, SSH_FX_FAILURE);
+        }
+        close_handle(h);
+        return send_status(s, id, SSH_FX_OK);
+    case SSH_FXP_READ:
+        return handle_read(s, id, &r);
+    case SSH_FXP_WRITE:
+        return handle_write(s, id, &r);
+    case SSH_FXP_LSTAT:
+    case SSH_FXP_STAT:
+        if (!get_path(s, &r, path, sizeof(path))) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return send_stat(s, id, stat(path, &st), &st);
+    case SSH_FXP_FSTAT:
+        h = get_handle(s, &r);
+        if (!h) {
+            return send_status(s, id, SSH_FX_FAILURE);
+        }
+        return send_stat(s, id, h->fd >= 0 ? fstat(h->fd, &st) : stat(h->path, &st), &st);
+    case SSH_FXP_SETSTAT:
+        path_ok = get_path(s, &r, path, sizeof(path));
+        get_attrs(&r, &attrs);
+        if (r.bad || !path_ok) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return apply_attrs(path, -1, &attrs) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_FSETSTAT:
+        h = get_handle(s, &r);
+        get_attrs(&r, &attrs);
+        if (r.bad || !h) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_FAILURE);
+        }
+        return apply_attrs(h->path, h->fd, &attrs) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_OPENDIR:
+        return handle_opendir(s, id, &r);
+    case SSH_FXP_READDIR:
+        return handle_readdir(s, id, &r);
+    case SSH_FXP_REMOVE:
+        if (!get_path(s, &r, path, sizeof(path))) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return unlink(path) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_MKDIR:
+        path_ok = get_path(s, &r, path, sizeof(path));
+        get_attrs(&r, &attrs);
+        if (r.bad || !path_ok) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return mkdir(path, 0775) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_RMDIR:
+        if (!get_path(s, &r, path, sizeof(path))) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return rmdir(path) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_REALPATH:
+        return handle_realpath(s, id, &r);
+    case SSH_FXP_RENAME:
+        path_ok = get_path(s, &r, path, sizeof(path));
+        path_ok &= get_path(s, &r, path2, sizeof(path2));
+        if (r.bad || !path_ok) {
+            return send_status(s, id, r.bad ? SSH_FX_BAD_MESSAGE : SSH_FX_NO_SUCH_FILE);
+        }
+        return rename(path, path2) == 0 ? send_status(s, id, SSH_FX_OK) : send_errno(s, id, errno);
+    case SSH_FXP_EXTENDED:
+        return handle_extended(s, id, &r);
+    default:
+        ESP_LOGD(TAG, "Unsupported request %u", type);
+        return send_status(s, id, SSH_FX_OP_UNSUPPORTED);
+    }
+}
+
+void sftp_server_run(const sftp_server_io_t *io)
+{
+    sftp_session_t *s = calloc(1, sizeof(sftp_session_t));
+    if (!s) {
+        ESP_LOGE(TAG, "No memory for SFTP session");
+        return;
+    }
+    s->io = io;
+    s->in = alloc_buffer(SFTP_MAX_PACKET);
+    s->out = alloc_buffer(SFTP_MAX_PACKET + 4);
+    if (!s->in || !s->out) {
+        ESP_LOGE(TAG, "No memory for SFTP buffers");
+        goto done;
+    }
+
+    ESP_LOGI(TAG, "SFTP session started, root %s", io->root);
+
+    while (true) {
+        uint8_t header[4];
+        if (io->read(io->ctx, header, sizeof(header)) < 0) {
+            break;
+        }
+        uint32_t len = ((uint32_t)header[0] << 24) | ((uint32_t)header[1] << 16) | ((uint32_t)header[2] << 8) | header[3];
+        if (len < 1 || len > SFTP_MAX_PACKET) {
+            ESP_LOGW(TAG, "Bad packet length %lu", (unsigned long)len);
+            break;
+        }
+        if (io->read(io->ctx, s->in, len) < 0) {
+            break;
+        }
+        if (!handle_packet(s, len)) {
+            break;
+        }
+    }
+
+    ESP_LOGI(TAG, "SFTP session ended");
+
+done:
+    for (int i = 0; i < SFTP_MAX_HANDLES; i++) {
+        if (s->handles[i].used) {
+            close_handle(&s->handles[i]);
+        }
+    }
+    heap_caps_free(s->in);
+    heap_caps_free(s->out);
+    free(s);
+}
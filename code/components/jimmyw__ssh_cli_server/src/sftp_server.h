@@ -0,0 +1,46 @@
+/**
+ * @file sftp_server.h
+ * @brief SFTP (version 3) subsystem served over an SSH channel
+ *
+ * Protocol handling only; the SSH server supplies the channel byte stream.
+ * Requests are answered in arrival order, so clients may keep many
+ * outstanding (pipelined) reads and writes.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SFTP_SERVER_MAX_DATA (32 * 1024) ///< Largest READ answer and WRITE accepted
+
+/** Heap taken by the request and reply buffers of one session */
+#define SFTP_SERVER_MEMORY (2 * (SFTP_SERVER_MAX_DATA + 1024) + 4)
+
+/**
+ * @brief Channel stream of one SFTP session
+ */
+typedef struct {
+    /** Read exactly len bytes; negative once the channel is closed */
+    int (*read)(void *ctx, void *buf, size_t len);
+    /** Queue len bytes of output; negative once the channel is closed */
+    int (*write)(void *ctx, const void *buf, size_t len);
+    void *ctx;
+    const char *root; ///< Directory shown to the client as "/"
+} sftp_server_io_t;
+
+/**
+ * @brief Serve SFTP requests until the client goes away
+ *
+ * Closes every file and directory the client left open before returning.
+ *
+ * @param io Channel stream and root directory
+ */
+void sftp_server_run(const sftp_server_io_t *io);
+
+#ifdef __cplusplus
+}
+#endif
@@ -13,23 +13,35 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_vfs.h"
 #include "esp_vfs_eventfd.h"
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/message_buffer.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
 #include "freertos/task.h"
 
+#include "sftp_server.h"
 #include "ssh_server.h"
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 
 #define MAX_SSH_CHANNELS 10
 #define MAX_SSH_SIGNALS 3
-#define WRITE_BUFFER_SIZE 256
-#define READ_BUFFER_SIZE 256
+#ifndef SSH_SERVER_WRITE_BUFFER_SIZE
+#define SSH_SERVER_WRITE_BUFFER_SIZE (8 * 1024) // Default VFS → SSH buffer per channel
+#endif
+#ifndef SSH_SERVER_READ_BUFFER_SIZE
+#define SSH_SERVER_READ_BUFFER_SIZE 1024 // Default SSH → VFS buffer per channel
+#endif
+#define WRITE_CHUNK_SIZE 2048   // Largest single ssh_channel_write from the event loop
+#define DRAIN_PASS_BYTES (8 * 1024) // Sent per channel before the other channels get a turn
+#define SESSION_TASK_STACK_SIZE (10 * 1024) // Key exchange and packet handling of one session
+#define SFTP_TASK_STACK_SIZE 8192
+#define SFTP_CLOSE_WAIT_MS 5000 // Time for an SFTP task to finish its request on close
 #define VFS_FD_TO_CHANNEL_INDEX(fd) ((fd) >> 1)
 #define VFS_FD_IS_WRITE(fd) ((fd) & 1)
 #define VFS_FD_IS_READ(fd) (!((fd) & 1))
@@ -38,8 +50,25 @@
 static const char *TAG = "ssh_server";
 
 static esp_vfs_id_t s_pipe_vfs_id = -1;
-static int wakeup_eventfd = -1;                  // Event FD for waking up SSH event loop
-static const char *last_auth_method = "unknown"; // Track the last authentication method used
+static SemaphoreHandle_t s_slots_lock = NULL; // Session and channel slots, taken by several session tasks
+
+/**
+ * @brief One client connection, served by its own task and event loop
+ */
+typedef struct {
+    bool in_use;
+    ssh_session session;
+    ssh_server_config_t *config;
+    int wakeup_fd;              // Event FD for waking up the session's event loop
+    const char *auth_method;    // Method that authenticated this session
+    int auth_tries;
+    size_t memory_used;         // Channel buffers and task stacks charged to the budget
+    int64_t last_activity_us;   // Last channel traffic, for idle reaping
+    char client_ip[INET_ADDRSTRLEN];
+    char client_version[128];
+} ssh_conn_t;
+
+static ssh_conn_t conns[SSH_SERVER_MAX_SESSIONS];
 
 typedef struct {
     esp_vfs_select_sem_t sem;
@@ -54,10 +83,20 @@ typedef struct {
     int stdout_fd;
     // int stderr_fd;
     TaskHandle_t shell_task_handle;
-    MessageBufferHandle_t read_buffer;  // For SSH → VFS data flow
-    MessageBufferHandle_t write_buffer; // For VFS → SSH data flow
+    TaskHandle_t sftp_task_handle;
+    SemaphoreHandle_t sftp_done;       // Given by the SFTP task as it exits
+    volatile bool sftp_closing;        // Channel closing, the SFTP task must stop
+    volatile bool sftp_exited;         // SFTP task has returned and no longer reads
+    volatile bool output_done;         // Close the channel once write_buffer is drained
+    StreamBufferHandle_t read_buffer;  // For SSH → VFS data flow
+    StreamBufferHandle_t write_buffer; // For VFS → SSH data flow
+    uint8_t *write_chunk;              // Taken from write_buffer, not yet accepted by the channel
+    size_t write_chunk_off;
+    size_t write_chunk_len;
     signal_context_t signals[MAX_SSH_SIGNALS];
     ssh_server_config_t *config;
+    ssh_conn_t *conn;                  // Session that owns the channel
+    size_t memory;                     // Charged to the session budget
     struct ssh_channel_callbacks_struct *channel_cb;
     ssh_server_session_t session;
 } ssh_vfs_context_t;
@@ -71,8 +110,10 @@ static void trigger_select_for_channel(int fd, bool read, bool write, bool excep
 /**
  * @brief Populate session information from SSH session
  */
-static void populate_session_info(ssh_server_session_t *session_info, ssh_session ssh_session, ssh_server_config_t *config)
+static void populate_session_info(ssh_server_session_t *session_info, ssh_conn_t *conn)
 {
+    ssh_session ssh_session = conn->session;
+    ssh_server_config_t *config = conn->config;
     static uint32_t session_counter = 0;
 
     // Initialize all fields to safe defaults
@@ -87,10 +128,9 @@ static void populate_session_info(ssh_server_session_t *session_info, ssh_sessio
         if (getpeername(sock, (struct sockaddr *)&client_addr, &addr_len) == 0) {
             if (client_addr.ss_family == AF_INET) {
                 struct sockaddr_in *addr_in = (struct sockaddr_in *)&client_addr;
-                // Store IP in a static buffer (note: this is not thread-safe for multiple sessions)
-                static char ip_buffer[INET_ADDRSTRLEN];
-                inet_ntop(AF_INET, &addr_in->sin_addr, ip_buffer, sizeof(ip_buffer));
-                session_info->client_ip = ip_buffer;
+                // Stored with the connection, which outlives its channels
+                inet_ntop(AF_INET, &addr_in->sin_addr, conn->client_ip, sizeof(conn->client_ip));
+                session_info->client_ip = conn->client_ip;
                 session_info->client_port = ntohs(addr_in->sin_port);
             }
             // Note: IPv6 support could be added here if needed
@@ -106,16 +146,15 @@ static void populate_session_info(ssh_server_session_t *session_info, ssh_sessio
     // Get client version if available
     const char *client_banner = ssh_get_clientbanner(ssh_session);
     if (client_banner) {
-        static char version_buffer[128];
-        strncpy(version_buffer, client_banner, sizeof(version_buffer) - 1);
-        version_buffer[sizeof(version_buffer) - 1] = '\0';
-        session_info->client_version = version_buffer;
+        strncpy(conn->client_version, client_banner, sizeof(conn->client_version) - 1);
+        conn->client_version[sizeof(conn->client_version) - 1] = '\0';
+        session_info->client_version = conn->client_version;
     } else {
         session_info->client_version = "unknown";
     }
 
     // Set auth method - use the tracked method from authentication
-    session_info->auth_method = last_auth_method;
+    session_info->auth_method = conn->auth_method;
 
     ESP_LOGI(TAG, "Session info populated - Client: %s:%u, User: %s, Auth: %s, Version: %s, ID: %u",
              session_info->client_ip ? session_info->client_ip : "unknown", session_info->client_port, session_info->username, session_info->auth_method,
@@ -134,21 +173,125 @@ static ssh_vfs_context_t *allocate_new_channel_context()
     return NULL;
 }
 
+/**
+ * @brief Create a channel buffer, in PSRAM when there is some
+ */
+static StreamBufferHandle_t create_channel_buffer(size_t size)
+{
+    StreamBufferHandle_t buffer = xStreamBufferCreateWithCaps(size, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buffer) {
+        buffer = xStreamBufferCreateWithCaps(size, 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Release the channel buffers of a context
+ */
+static void free_channel_buffers(ssh_vfs_context_t *ctx)
+{
+    if (ctx->read_buffer) {
+        vStreamBufferDeleteWithCaps(ctx->read_buffer);
+        ctx->read_buffer = NULL;
+    }
+    if (ctx->write_buffer) {
+        vStreamBufferDeleteWithCaps(ctx->write_buffer);
+        ctx->write_buffer = NULL;
+    }
+    if (ctx->write_chunk) {
+        heap_caps_free(ctx->write_chunk);
+        ctx->write_chunk = NULL;
+    }
+    ctx->write_chunk_off = 0;
+    ctx->write_chunk_len = 0;
+}
+
+static void wake_event_loop(ssh_conn_t *conn)
+{
+    if (conn->wakeup_fd >= 0) {
+        uint64_t signal = 1;
+        write(conn->wakeup_fd, &signal, sizeof(signal));
+    }
+}
+
+/**
+ * @brief Move one channel's buffered output to SSH
+ *
+ * Writes until the buffer is empty, the remote window is full or
+ * DRAIN_PASS_BYTES went out. Bytes the channel did not accept stay in
+ * write_chunk for the next pass.
+ *
+ * @param ctx Channel
+ * @param yielded Set when the pass budget ran out with output left
+ * @return true if output is still waiting
+ */
+static bool drain_channel(ssh_vfs_context_t *ctx, bool *yielded)
+{
+    size_t sent = 0;
+
+    while (true) {
+        if (sent >= DRAIN_PASS_BYTES) {
+            *yielded = true;
+            break;
+        }
+        if (ctx->write_chunk_len == 0) {
+            // Never take more than the channel can accept right now
+            size_t window = ssh_channel_window_size(ctx->channel);
+            if (window == 0) {
+                break;
+            }
+            size_t want = window < WRITE_CHUNK_SIZE ? window : WRITE_CHUNK_SIZE;
+            ctx->write_chunk_len = xStreamBufferReceive(ctx->write_buffer, ctx->write_chunk, want, 0);
+            ctx->write_chunk_off = 0;
+            if (ctx->write_chunk_len == 0) {
+                break;
+            }
+        }
+
+        int bytes_written = ssh_channel_write(ctx->channel, ctx->write_chunk + ctx->write_chunk_off, ctx->write_chunk_len);
+        if (bytes_written < 0) {
+            ESP_LOGW(TAG, "SSH channel write failed: %d", bytes_written);
+            ctx->write_chunk_len = 0;
+            trigger_select_for_channel(ctx->stdout_fd, false, false, true);
+            return false;
+        }
+
+        ctx->write_chunk_off += bytes_written;
+        ctx->write_chunk_len -= bytes_written;
+        sent += bytes_written;
+        if (ctx->write_chunk_len > 0) {
+            ESP_LOGD(TAG, "Channel window full, %zu bytes kept", ctx->write_chunk_len);
+            break;
+        }
+    }
+
+    if (sent > 0) {
+        // Room freed in write_buffer
+        ctx->conn->last_activity_us = esp_timer_get_time();
+        trigger_select_for_channel(ctx->stdout_fd, false, true, false);
+    }
+    return ctx->write_chunk_len > 0 || xStreamBufferBytesAvailable(ctx->write_buffer) > 0;
+}
+
 /**
  * @brief Drain write buffers and send data to SSH channels
  *
- * This function is called from the SSH event loop to check all channels
- * for pending write data and send it. This ensures all SSH operations
- * happen from the same thread context.
+ * This function is called from a session's event loop to check its
+ * channels for pending write data and send it. This ensures all SSH
+ * operations of a session happen from the same thread context. Channels
+ * take turns of DRAIN_PASS_BYTES; the loop wakes itself for another round
+ * while any channel has output ready.
+ *
+ * @param conn Session whose channels to drain
  */
-static void drain_write_buffers(void)
+static void drain_write_buffers(ssh_conn_t *conn)
 {
-    char write_data[WRITE_BUFFER_SIZE];
+    bool yielded = false;
 
     for (int i = 0; i < ARRAY_SIZE(channels); i++) {
         ssh_vfs_context_t *ctx = &channels[i];
 
-        if (ctx->channel == NULL || ctx->write_buffer == NULL) {
+        if (ctx->channel == NULL || ctx->conn != conn || ctx->write_buffer == NULL) {
             continue;
         }
 
@@ -158,28 +301,67 @@ static void drain_write_buffers(void)
             continue;
         }
 
-        // Try to read data from write buffer (non-blocking)
-        size_t bytes_received = xMessageBufferReceive(ctx->write_buffer, write_data, sizeof(write_data),
-                                                      0 // Non-blocking
-        );
+        bool pending = drain_channel(ctx, &yielded);
+        if (!pending && ctx->output_done) {
+            // The subsystem has finished and all of its output went out
+            ctx->output_done = false;
+            ssh_channel_send_eof(ctx->channel);
+            ssh_channel_close(ctx->channel);
+        }
+    }
 
-        if (bytes_received > 0) {
-            // Send data to SSH channel (we're in the SSH thread context now!)
-            int bytes_written = ssh_channel_write(ctx->channel, write_data, bytes_received);
+    if (yielded) {
+        wake_event_loop(conn);
+    }
+}
 
-            if (bytes_written < 0) {
-                ESP_LOGW(TAG, "SSH channel write failed: %d", bytes_written);
-            } else if (bytes_written < bytes_received) {
-                ESP_LOGW(TAG, "Partial SSH write: %d/%zu bytes", bytes_written, bytes_received);
-                // TODO: Handle partial writes by putting remaining data back in buffer
-            } else {
-                ESP_LOGD(TAG, "Wrote %d bytes to SSH channel from event loop", bytes_written);
-                trigger_select_for_channel(ctx->stdout_fd, false, true, false);
-            }
-        } else {
-            ESP_LOGD(TAG, "No data to write for channel %d", i);
+/**
+ * @brief Queue output for the event loop to send (called from channel tasks)
+ *
+ * Output larger than the free space goes in pieces, waking the event loop
+ * after each so it can drain.
+ *
+ * @return Bytes queued, short only if the channel closed
+ */
+static size_t queue_output(ssh_vfs_context_t *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    size_t bytes_sent = 0;
+
+    while (true) {
+        bytes_sent += xStreamBufferSend(ctx->write_buffer, p + bytes_sent, len - bytes_sent, 0);
+
+        // Wake up the SSH event loop to process the write immediately
+        wake_event_loop(ctx->conn);
+
+        if (bytes_sent == len || ctx->sftp_closing || !ssh_channel_is_open(ctx->channel)) {
+            break;
         }
+
+        // Wait for the event loop to free up to a chunk
+        size_t remaining = len - bytes_sent;
+        bytes_sent += xStreamBufferSend(ctx->write_buffer, p + bytes_sent, remaining < WRITE_CHUNK_SIZE ? remaining : WRITE_CHUNK_SIZE, pdMS_TO_TICKS(100));
+    }
+    return bytes_sent;
+}
+
+/**
+ * @brief Charge memory for a channel to its session's budget
+ *
+ * @return false if the budget would be exceeded
+ */
+static bool charge_budget(ssh_vfs_context_t *ctx, size_t bytes)
+{
+    ssh_conn_t *conn = ctx->conn;
+    size_t budget = conn->config->session_memory_budget;
+
+    if (budget && conn->memory_used + bytes > budget) {
+        ESP_LOGW(TAG, "Session %s is at its memory budget (%zu of %zu bytes)", conn->client_ip, conn->memory_used, budget);
+        return false;
     }
+    conn->memory_used += bytes;
+    ctx->memory += bytes;
+    return true;
 }
 
 static void ssh_shell(void *arg)
@@ -242,6 +424,10 @@ static int shell_request(ssh_session session, ssh_channel channel, void *userdat
     ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)userdata;
     int ch_idx = CHANNEL_INDEX_FROM_PTR(ctx);
 
+    if (ctx->shell_task_handle || ctx->sftp_done || !charge_budget(ctx, ctx->config->shell_task_size)) {
+        return SSH_ERROR;
+    }
+
     ESP_LOGD(TAG, "Channel %d registering VFS fd", ch_idx);
 
     esp_err_t res = esp_vfs_register_fd_with_local_fd(s_pipe_vfs_id, CHANNEL_INDEX_TO_VFS_FD(ch_idx, false), false, &ctx->stdin_fd);
@@ -260,11 +446,104 @@ static int shell_request(ssh_session session, ssh_channel channel, void *userdat
     return SSH_OK;
 }
 
+static int sftp_io_read(void *arg, void *buf, size_t len)
+{
+    ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)arg;
+    size_t got = 0;
+
+    while (got < len) {
+        got += xStreamBufferReceive(ctx->read_buffer, (uint8_t *)buf + got, len - got, pdMS_TO_TICKS(100));
+        if (got < len && (ctx->sftp_closing || !ssh_channel_is_open(ctx->channel) ||
+                          (ssh_channel_is_eof(ctx->channel) && xStreamBufferBytesAvailable(ctx->read_buffer) == 0))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int sftp_io_write(void *arg, const void *buf, size_t len)
+{
+    ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)arg;
+    return queue_output(ctx, buf, len) == len ? 0 : -1;
+}
+
+static void ssh_sftp(void *arg)
+{
+    ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)arg;
+    sftp_server_io_t io = {
+        .read = sftp_io_read,
+        .write = sftp_io_write,
+        .ctx = ctx,
+        .root = ctx->config->sftp_root,
+    };
+
+    sftp_server_run(&io);
+
+    // The context is released once sftp_done is given
+    SemaphoreHandle_t done = ctx->sftp_done;
+    ctx->sftp_exited = true;
+    ctx->output_done = true;
+    wake_event_loop(ctx->conn);
+    xSemaphoreGive(done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief SSH subsystem request callback
+ *
+ * Starts the SFTP server on the channel when the config has an sftp_root.
+ * SFTP bytes bypass the VFS layer and its line ending translation.
+ *
+ * @param session The SSH session
+ * @param channel The SSH channel for this subsystem
+ * @param subsystem Requested subsystem name
+ * @param userdata Channel context
+ * @return SSH_OK to accept the request, SSH_ERROR to reject it
+ */
+static int subsystem_request(ssh_session session, ssh_channel channel, const char *subsystem, void *userdata)
+{
+    ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)userdata;
+
+    ESP_LOGD(TAG, "Subsystem %s requested", subsystem);
+    if (strcmp(subsystem, "sftp") != 0 || !ctx->config->sftp_root || ctx->sftp_done || ctx->shell_task_handle) {
+        return SSH_ERROR;
+    }
+    if (!charge_budget(ctx, SFTP_TASK_STACK_SIZE + SFTP_SERVER_MEMORY)) {
+        return SSH_ERROR;
+    }
+
+    ctx->sftp_done = xSemaphoreCreateBinary();
+    if (!ctx->sftp_done) {
+        return SSH_ERROR;
+    }
+    if (xTaskCreate(&ssh_sftp, "ssh_sftp", SFTP_TASK_STACK_SIZE, (void *)ctx, 5, &ctx->sftp_task_handle) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create SFTP task");
+        vSemaphoreDelete(ctx->sftp_done);
+        ctx->sftp_done = NULL;
+        return SSH_ERROR;
+    }
+    return SSH_OK;
+}
+
+/**
+ * @brief Whether a shell or SFTP task is still consuming the read buffer
+ */
+static bool channel_has_reader(ssh_vfs_context_t *ctx)
+{
+    if (!ssh_channel_is_open(ctx->channel)) {
+        return false;
+    }
+    if (ctx->sftp_done) {
+        return !ctx->sftp_exited;
+    }
+    return ctx->shell_task_handle != NULL;
+}
+
 /**
  * @brief SSH channel data callback
  *
  * This callback is invoked when data is received on an SSH channel.
- * It feeds the data into the message buffer for the VFS layer to consume.
+ * It feeds the data into the read buffer for the VFS layer to consume.
  * This provides thread-safe communication between the SSH event loop
  * and the shell task.
  *
@@ -281,13 +560,30 @@ static int channel_data(ssh_session session, ssh_channel channel, void *data, ui
     ssh_vfs_context_t *ctx = (ssh_vfs_context_t *)userdata;
     (void)session;
     (void)is_stderr;
-    (void)userdata;
 
-    // Send data to message buffer (non-blocking), blocking time max
-    size_t bytes_sent = xMessageBufferSend(ctx->read_buffer, data, len, portMAX_DELAY);
+    ctx->conn->last_activity_us = esp_timer_get_time();
+
+    // Send data to the read buffer, waiting for the shell to make room. The
+    // reader may itself wait for its output to drain, so keep draining it.
+    // A full buffer with nobody left to read it never empties: drop the rest
+    // and close the channel rather than spin here.
+    size_t bytes_sent = 0;
+    while (bytes_sent < len) {
+        bytes_sent += xStreamBufferSend(ctx->read_buffer, (uint8_t *)data + bytes_sent, len - bytes_sent, pdMS_TO_TICKS(10));
+        if (bytes_sent == len) {
+            break;
+        }
+        if (!channel_has_reader(ctx)) {
+            break;
+        }
+        bool yielded = false;
+        drain_channel(ctx, &yielded);
+    }
 
     if (bytes_sent != len) {
-        ESP_LOGW(TAG, "Message buffer full, sent %zu/%u bytes", bytes_sent, len);
+        ESP_LOGW(TAG, "No reader for the channel, dropped %u bytes", (unsigned)(len - bytes_sent));
+        ctx->output_done = true;
+        wake_event_loop(ctx->conn);
     } else {
         ESP_LOGD(TAG, "Sent %u bytes to read_buffer", len);
     }
@@ -324,6 +620,9 @@ static int pty_request(ssh_session session, ssh_channel channel, const char *ter
 
 static void trigger_select_for_channel(int fd, bool read, bool write, bool except)
 {
+    if (fd < 0) {
+        return;
+    }
     for (int i = 0; i < ARRAY_SIZE(channels); i++) {
         ssh_vfs_context_t *ctx = &channels[i];
         if (ctx->channel == NULL) {
@@ -351,7 +650,7 @@ static void trigger_select_for_channel(int fd, bool read, bool write, bool excep
  * @brief Start select operation for SSH channels
  *
  * This function is called when select() is invoked on SSH file descriptors.
- * It checks the message buffers to determine if data is available for reading
+ * It checks the channel buffers to determine if data is available for reading
  * or if there's space for writing, and signals the select semaphore accordingly.
  *
  * @param nfds Highest numbered file descriptor + 1
@@ -388,9 +687,7 @@ static esp_err_t ssh_vfs_start_select(int nfds, fd_set *readfds, fd_set *writefd
         if (readfds && FD_ISSET(i, readfds)) {
             // Check if read buffer has data available
             if (ctx->read_buffer) {
-                size_t available = xMessageBufferSpacesAvailable(ctx->read_buffer);
-                // If buffer is not full, it means there's data to read
-                if (available < READ_BUFFER_SIZE) {
+                if (xStreamBufferBytesAvailable(ctx->read_buffer) > 0) {
                     fd_ready = true;
                 } else {
                     FD_CLR(i, readfds);
@@ -409,7 +706,7 @@ static esp_err_t ssh_vfs_start_select(int nfds, fd_set *readfds, fd_set *writefd
         if (writefds && FD_ISSET(i, writefds)) {
             // Check if write buffer has space available
             if (ctx->write_buffer) {
-                size_t available = xMessageBufferSpacesAvailable(ctx->write_buffer);
+                size_t available = xStreamBufferSpacesAvailable(ctx->write_buffer);
                 // If buffer has space, writing is possible
                 if (available > 0) {
                     fd_ready = true;
@@ -473,9 +770,7 @@ static esp_err_t ssh_vfs_end_select(void *end_select_args)
                 clear = true;
                 // Check if read buffer has data available
                 if (channels[i].read_buffer) {
-                    size_t available = xMessageBufferSpacesAvailable(channels[i].read_buffer);
-                    // If buffer is not full, it means there's data to read
-                    if (available >= READ_BUFFER_SIZE) {
+                    if (xStreamBufferBytesAvailable(channels[i].read_buffer) == 0) {
                         FD_CLR(i, sig_ctx->read_fds);
                     }
                 }
@@ -491,7 +786,7 @@ static esp_err_t ssh_vfs_end_select(void *end_select_args)
                 clear = true;
                 // Check if write buffer has space available
                 if (channels[i].write_buffer) {
-                    size_t available = xMessageBufferSpacesAvailable(channels[i].write_buffer);
+                    size_t available = xStreamBufferSpacesAvailable(channels[i].write_buffer);
                     // If buffer has space, writing is possible
                     if (available == 0) {
                         FD_CLR(i, sig_ctx->write_fds);
@@ -527,7 +822,7 @@ static esp_err_t ssh_vfs_end_select(void *end_select_args)
  *
  * This function is called when data is read from a file descriptor
  * that corresponds to an SSH channel (via the VFS layer).
- * It reads data from the message buffer that's fed by the SSH event loop.
+ * It reads data from the stream buffer that's fed by the SSH event loop.
  * This provides thread-safe access to SSH data.
  *
  * @param fd File descriptor (index into channels array)
@@ -545,7 +840,7 @@ static ssize_t ssh_vfs_read(int fd, void *data, size_t size)
     }
 
     // Block until data is available (with timeout)
-    size_t bytes_received = xMessageBufferReceive(channels[ch_idx].read_buffer, data, size,
+    size_t bytes_received = xStreamBufferReceive(channels[ch_idx].read_buffer, data, size,
                                                   portMAX_DELAY // 1 second timeout
     );
 
@@ -565,7 +860,7 @@ static ssize_t ssh_vfs_read(int fd, void *data, size_t size)
         }
     }
 
-    ESP_LOGD(TAG, "VFS read %zu bytes from message buffer", bytes_received);
+    ESP_LOGD(TAG, "VFS read %zu bytes from read buffer", bytes_received);
     return bytes_received;
 }
 
@@ -575,7 +870,7 @@ static ssize_t ssh_vfs_read(int fd, void *data, size_t size)
  * This function is called when data is written to a file descriptor
  * that corresponds to an SSH channel (via the VFS layer).
  * It translates LF (\n) to CRLF (\r\n) for proper terminal output,
- * then puts data into a message buffer for the SSH event loop to consume.
+ * then puts data into a stream buffer for the SSH event loop to consume.
  *
  * @param fd File descriptor (index into channels array)
  * @param data Buffer containing data to write
@@ -649,8 +944,8 @@ static ssize_t ssh_vfs_write(int fd, const void *data, size_t size)
         size_to_send = dst_idx;
     }
 
-    // Send translated data to write buffer (blocking with max delay)
-    size_t bytes_sent = xMessageBufferSend(channels[ch_idx].write_buffer, data_to_send, size_to_send, portMAX_DELAY);
+    // Send translated data to write buffer
+    size_t bytes_sent = queue_output(&channels[ch_idx], data_to_send, size_to_send);
 
     // If we allocated a new buffer, free it
     if (data_to_send != data) {
@@ -658,20 +953,14 @@ static ssize_t ssh_vfs_write(int fd, const void *data, size_t size)
     }
 
     if (bytes_sent != size_to_send) {
-        // Buffer is full - this is a flow control issue
+        // Channel closed before the output could be queued
         ESP_LOGW(TAG, "Write buffer full, sent %zu/%zu bytes", bytes_sent, size_to_send);
         if (bytes_sent == 0) {
-            errno = EAGAIN;
+            errno = EPIPE;
             return -1;
         }
     }
 
-    // Wake up the SSH event loop to process the write immediately
-    if (wakeup_eventfd >= 0) {
-        uint64_t signal = 1;
-        write(wakeup_eventfd, &signal, sizeof(signal));
-    }
-
     return size;
 }
 
@@ -680,7 +969,7 @@ static ssize_t ssh_vfs_write(int fd, const void *data, size_t size)
  *
  * This function is called when a file descriptor corresponding to
  * an SSH channel is closed. It properly closes the SSH channel
- * and cleans up resources including both message buffers.
+ * and cleans up resources including the channel buffers.
  *
  * @param fd File descriptor (index into channels array)
  * @return 0 on success, -1 on error
@@ -696,15 +985,8 @@ static int ssh_vfs_close(int fd)
 
     ssh_channel channel = channels[ch_idx].channel;
 
-    // Clean up message buffers
-    if (channels[ch_idx].read_buffer) {
-        vMessageBufferDelete(channels[ch_idx].read_buffer);
-        channels[ch_idx].read_buffer = NULL;
-    }
-    if (channels[ch_idx].write_buffer) {
-        vMessageBufferDelete(channels[ch_idx].write_buffer);
-        channels[ch_idx].write_buffer = NULL;
-    }
+    // Clean up channel buffers
+    free_channel_buffers(&channels[ch_idx]);
 
     // Clean up SSH channel
     ssh_channel_send_eof(channel);
@@ -782,7 +1064,8 @@ static const esp_vfs_t vfs = {
  */
 static int auth_none(ssh_session session, const char *user, void *userdata)
 {
-    ssh_server_config_t *config = (ssh_server_config_t *)userdata;
+    ssh_conn_t *conn = (ssh_conn_t *)userdata;
+    ssh_server_config_t *config = conn->config;
     ESP_LOGD(TAG, "Auth none requested for user: %s", user);
 
     // Authentication methods
@@ -823,25 +1106,25 @@ static int auth_none(ssh_session session, const char *user, void *userdata)
  */
 static int auth_password(ssh_session session, const char *user, const char *password, void *userdata)
 {
-    static int tries = 0;
-    ssh_server_config_t *config = (ssh_server_config_t *)userdata;
+    ssh_conn_t *conn = (ssh_conn_t *)userdata;
+    ssh_server_config_t *config = conn->config;
 
     ESP_LOGD(TAG, "Password auth attempt for user: %s", user);
 
     if (strcmp(user, config->username) == 0 && strcmp(password, config->password) == 0) {
         ESP_LOGD(TAG, "Authentication successful for user: %s", user);
-        tries = 0;                     // Reset tries on success
-        last_auth_method = "password"; // Track successful auth method
+        conn->auth_tries = 0;            // Reset tries on success
+        conn->auth_method = "password"; // Track successful auth method
         return SSH_AUTH_SUCCESS;
     }
 
-    if (tries++ >= 3) {
+    if (conn->auth_tries++ >= 3) {
         ESP_LOGD(TAG, "Too many authentication attempts");
         ssh_disconnect(session);
         return SSH_AUTH_DENIED;
     }
 
-    ESP_LOGD(TAG, "Authentication failed (attempt %d/3)", tries);
+    ESP_LOGD(TAG, "Authentication failed (attempt %d/3)", conn->auth_tries);
     return SSH_AUTH_DENIED;
 }
 #endif // CONFIG_EXAMPLE_ALLOW_PASSWORD_AUTH
@@ -850,7 +1133,8 @@ static int auth_password(ssh_session session, const char *user, const char *pass
 /* Public key authentication using in-memory authorized_keys list */
 static int auth_publickey(ssh_session session, const char *user, struct ssh_key_struct *pubkey, char signature_state, void *userdata)
 {
-    ssh_server_config_t *config = (ssh_server_config_t *)userdata;
+    ssh_conn_t *conn = (ssh_conn_t *)userdata;
+    ssh_server_config_t *config = conn->config;
 
     if (user == NULL || strcmp(user, config->username) != 0) {
         return SSH_AUTH_DENIED;
@@ -965,7 +1249,7 @@ static int auth_publickey(ssh_session session, const char *user, struct ssh_key_
 
             if (signature_state == SSH_PUBLICKEY_STATE_VALID) {
                 ESP_LOGI("DEBUG", "Public key authentication successful for user: %s", user);
-                last_auth_method = "publickey"; // Track successful auth method
+                conn->auth_method = "publickey"; // Track successful auth method
                 return SSH_AUTH_SUCCESS;
             }
 
@@ -988,6 +1272,18 @@ static void vfs_channel_close(ssh_session session, ssh_channel channel, void *us
     trigger_select_for_channel(ctx->stdin_fd, false, false, true);
     trigger_select_for_channel(ctx->stdout_fd, false, false, true);
 
+    // Let the SFTP task finish its request before its buffers go away
+    if (ctx->sftp_done) {
+        ctx->sftp_closing = true;
+        if (xSemaphoreTake(ctx->sftp_done, pdMS_TO_TICKS(SFTP_CLOSE_WAIT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "SFTP task did not stop, killing it");
+            vTaskDelete(ctx->sftp_task_handle);
+        }
+        vSemaphoreDelete(ctx->sftp_done);
+        ctx->sftp_done = NULL;
+        ctx->sftp_task_handle = NULL;
+    }
+
     // Close the VFS fds
     if (ctx->config->shell_task_kill_on_disconnect && ctx->shell_task_handle && ctx->shell_task_handle != xTaskGetCurrentTaskHandle()) {
         vTaskDelete(ctx->shell_task_handle);
@@ -1003,14 +1299,7 @@ static void vfs_channel_close(ssh_session session, ssh_channel channel, void *us
         esp_vfs_unregister_fd(s_pipe_vfs_id, ctx->stdout_fd);
         ctx->stdout_fd = -1;
     }
-    if (ctx->read_buffer) {
-        vMessageBufferDelete(ctx->read_buffer);
-        ctx->read_buffer = NULL;
-    }
-    if (ctx->write_buffer) {
-        vMessageBufferDelete(ctx->write_buffer);
-        ctx->write_buffer = NULL;
-    }
+    free_channel_buffers(ctx);
     if (ctx->channel_cb) {
         free(ctx->channel_cb);
         ctx->channel_cb = NULL;
@@ -1025,6 +1314,7 @@ static void vfs_channel_close(ssh_session session, ssh_channel channel, void *us
     //}
 
     // Free the channel context
+    ctx->conn->memory_used -= ctx->memory;
     memset(ctx, 0, sizeof(ssh_vfs_context_t));
 }
 
@@ -1047,42 +1337,55 @@ static void vfs_channel_close(ssh_session session, ssh_channel channel, void *us
  */
 static ssh_channel channel_open(ssh_session session, void *userdata)
 {
-    ssh_server_config_t *config = (ssh_server_config_t *)userdata;
+    ssh_conn_t *conn = (ssh_conn_t *)userdata;
+    ssh_server_config_t *config = conn->config;
 
+    // Session tasks open channels concurrently; claim the slot under the lock
+    xSemaphoreTake(s_slots_lock, portMAX_DELAY);
     ssh_vfs_context_t *ctx = allocate_new_channel_context();
+    if (ctx) {
+        ctx->channel = ssh_channel_new(session);
+    }
+    xSemaphoreGive(s_slots_lock);
     if (ctx == NULL) {
         ESP_LOGD(TAG, "No free channel found");
         return NULL;
     }
-
-    ESP_LOGD(TAG, "Opening new channel");
-    ctx->config = config;
-    ctx->channel = ssh_channel_new(session);
     if (!ctx->channel) {
         ESP_LOGD(TAG, "Failed to create new channel");
         return NULL;
     }
 
+    ESP_LOGD(TAG, "Opening new channel");
+    ctx->config = config;
+    ctx->conn = conn;
+    ctx->stdin_fd = -1;
+    ctx->stdout_fd = -1;
+    conn->last_activity_us = esp_timer_get_time();
+
     // Populate session information for the shell function
-    populate_session_info(&ctx->session, session, config);
+    populate_session_info(&ctx->session, conn);
 
-    // Create message buffer for this channel (4KB buffer)
-    ctx->read_buffer = xMessageBufferCreate(READ_BUFFER_SIZE);
-    if (!ctx->read_buffer) {
-        ESP_LOGD(TAG, "Failed to create read message buffer");
+    // Create the channel buffers, sized by the config
+    size_t read_size = config->read_buffer_size ? config->read_buffer_size : SSH_SERVER_READ_BUFFER_SIZE;
+    size_t write_size = config->write_buffer_size ? config->write_buffer_size : SSH_SERVER_WRITE_BUFFER_SIZE;
+    if (!charge_budget(ctx, read_size + write_size + WRITE_CHUNK_SIZE)) {
         ssh_channel_free(ctx->channel);
-        ctx->channel = NULL;
+        memset(ctx, 0, sizeof(ssh_vfs_context_t));
         return NULL;
     }
-
-    // Create write message buffer for this channel (4KB buffer)
-    ctx->write_buffer = xMessageBufferCreate(WRITE_BUFFER_SIZE);
-    if (!ctx->write_buffer) {
-        ESP_LOGD(TAG, "Failed to create write message buffer");
-        vMessageBufferDelete(ctx->read_buffer);
-        ctx->read_buffer = NULL;
+    ctx->read_buffer = create_channel_buffer(read_size);
+    ctx->write_buffer = create_channel_buffer(write_size);
+    ctx->write_chunk = heap_caps_malloc(WRITE_CHUNK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ctx->write_chunk) {
+        ctx->write_chunk = heap_caps_malloc(WRITE_CHUNK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!ctx->read_buffer || !ctx->write_buffer || !ctx->write_chunk) {
+        ESP_LOGD(TAG, "Failed to create channel buffers (%zu/%zu bytes)", read_size, write_size);
+        free_channel_buffers(ctx);
         ssh_channel_free(ctx->channel);
-        ctx->channel = NULL;
+        conn->memory_used -= ctx->memory;
+        memset(ctx, 0, sizeof(ssh_vfs_context_t));
         return NULL;
     }
 
@@ -1091,16 +1394,19 @@ static ssh_channel channel_open(ssh_session session, void *userdata)
     ctx->channel_cb = malloc(sizeof(struct ssh_channel_callbacks_struct));
     if (!ctx->channel_cb) {
         ESP_LOGD(TAG, "Failed to allocate memory for channel callbacks");
+        free_channel_buffers(ctx);
         ssh_channel_free(ctx->channel);
-        ctx->channel = NULL;
+        conn->memory_used -= ctx->memory;
+        memset(ctx, 0, sizeof(ssh_vfs_context_t));
         return NULL;
     }
     *ctx->channel_cb = (struct ssh_channel_callbacks_struct){
         .userdata = ctx,
         .channel_pty_request_function = pty_request,
         .channel_shell_request_function = shell_request,
+        .channel_subsystem_request_function = subsystem_request,
         .channel_close_function = vfs_channel_close,
-        .channel_data_function = channel_data, // Add data handler for message buffer
+        .channel_data_function = channel_data, // Add data handler for the read buffer
     };
     ssh_callbacks_init(ctx->channel_cb);
     ssh_set_channel_callbacks(ctx->channel, ctx->channel_cb);
@@ -1112,28 +1418,224 @@ static ssh_channel channel_open(ssh_session session, void *userdata)
 
 static int ssh_event_fd_wrapper_callback(socket_t fd, int revents, void *userdata)
 {
+    ssh_conn_t *conn = (ssh_conn_t *)userdata;
     (void)fd;
-    (void)userdata;
 
     if (revents & POLLIN) {
         uint64_t value;
-        read(wakeup_eventfd, &value, sizeof(value));
+        read(conn->wakeup_fd, &value, sizeof(value));
         ESP_LOGD(TAG, "Woke up SSH event loop from eventfd, value=%llu", value);
         // Drain write buffers after processing SSH events (same thread context!)
-        for (uint32_t i = 0; i < value; i++) {
-            drain_write_buffers();
-        }
+        drain_write_buffers(conn);
     }
 
     return SSH_OK;
 }
 
+/**
+ * @brief Claim a session slot, within the session limit and memory budget
+ */
+static ssh_conn_t *allocate_conn(ssh_server_config_t *config)
+{
+    int max_sessions = config->max_sessions ? config->max_sessions : 1;
+    if (max_sessions > SSH_SERVER_MAX_SESSIONS) {
+        max_sessions = SSH_SERVER_MAX_SESSIONS;
+    }
+
+    // A new session must fit its task and a first shell channel. Later
+    // channels are checked against the budget as they open.
+    size_t task_size = config->session_task_size ? config->session_task_size : SESSION_TASK_STACK_SIZE;
+    size_t read_size = config->read_buffer_size ? config->read_buffer_size : SSH_SERVER_READ_BUFFER_SIZE;
+    size_t write_size = config->write_buffer_size ? config->write_buffer_size : SSH_SERVER_WRITE_BUFFER_SIZE;
+    size_t first_channel = read_size + write_size + WRITE_CHUNK_SIZE + config->shell_task_size;
+    if (config->session_memory_budget && config->session_memory_budget < first_channel) {
+        first_channel = config->session_memory_budget;
+    }
+    size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (free_heap < task_size + first_channel) {
+        ESP_LOGW(TAG, "Not enough memory for another session (%zu bytes free)", free_heap);
+        return NULL;
+    }
+
+    ssh_conn_t *conn = NULL;
+    int active = 0;
+    xSemaphoreTake(s_slots_lock, portMAX_DELAY);
+    for (int i = 0; i < max_sessions; i++) {
+        if (conns[i].in_use) {
+            active++;
+        } else if (!conn) {
+            conn = &conns[i];
+        }
+    }
+    if (conn) {
+        *conn = (ssh_conn_t){
+            .in_use = true,
+            .config = config,
+            .wakeup_fd = -1,
+            .auth_method = "unknown",
+            .client_ip = "unknown",
+        };
+    }
+    xSemaphoreGive(s_slots_lock);
+
+    if (!conn) {
+        ESP_LOGW(TAG, "Session limit reached (%d active)", active);
+    }
+    return conn;
+}
+
+static void release_conn(ssh_conn_t *conn)
+{
+    if (conn->wakeup_fd >= 0) {
+        close(conn->wakeup_fd);
+    }
+    xSemaphoreTake(s_slots_lock, portMAX_DELAY);
+    conn->in_use = false;
+    xSemaphoreGive(s_slots_lock);
+}
+
+/**
+ * @brief Serve one client: key exchange, authentication and its channels
+ *
+ * Each session runs its own event loop, so a busy or slow session does not
+ * hold up the others, and sessions at the same priority share the CPU.
+ */
+static void ssh_session_task(void *arg)
+{
+    ssh_conn_t *conn = (ssh_conn_t *)arg;
+    ssh_server_config_t *config = conn->config;
+    ssh_session session = conn->session;
+    ssh_event event = NULL;
+    int rc;
+
+    // Set up server callbacks
+    struct ssh_server_callbacks_struct server_cb = {
+        .userdata = conn,
+        .auth_none_function = auth_none,
+#if CONFIG_EXAMPLE_ALLOW_PASSWORD_AUTH
+        .auth_password_function = auth_password,
+#endif
+#if CONFIG_EXAMPLE_ALLOW_PUBLICKEY_AUTH
+        .auth_pubkey_function = auth_publickey,
+#endif
+        .channel_open_request_session_function = channel_open,
+    };
+
+    ssh_callbacks_init(&server_cb);
+    ssh_set_server_callbacks(session, &server_cb);
+    ESP_LOGD(TAG, "Server callbacks set");
+
+    // Handle key exchange
+    // Note: ssh_handle_key_exchange() can return:
+    // - SSH_OK: Key exchange completed successfully
+    // - SSH_AGAIN: Key exchange in progress, need to call again
+    // - SSH_ERROR: Fatal error occurred
+    rc = ssh_handle_key_exchange(session);
+    ESP_LOGD(TAG, "Key exchange result: rc=%d ", rc);
+    if (rc == SSH_ERROR) {
+        ESP_LOGE(TAG, "Key exchange failed: %s", ssh_get_error(session));
+        goto done;
+    }
+
+    ESP_LOGD(TAG, "Key exchange completed or in progress");
+
+    // Set up authentication methods
+    auth_none(session, config->username, conn);
+    ESP_LOGD(TAG, "Authentication methods set");
+
+    // Create event for session handling
+    event = ssh_event_new();
+    if (event == NULL) {
+        ESP_LOGE(TAG, "Failed to create event");
+        goto done;
+    }
+
+    // Add wakeup eventfd to the event loop
+    if (ssh_event_add_fd(event, conn->wakeup_fd, POLLIN, ssh_event_fd_wrapper_callback, conn) != SSH_OK) {
+        ESP_LOGE(TAG, "Failed to add wakeup eventfd to event");
+        goto done;
+    }
+
+    // Add session to event
+    if (ssh_event_add_session(event, session) != SSH_OK) {
+        ESP_LOGE(TAG, "Failed to add session to event");
+        goto done;
+    }
+
+    ESP_LOGD(TAG, "Session added to event, starting main loop");
+
+    int poll_errors = 0;
+    int64_t idle_limit_us = (int64_t)config->idle_timeout_s * 1000000;
+    conn->last_activity_us = esp_timer_get_time();
+
+    while (true) {
+
+        int session_status = ssh_get_status(session);
+        ESP_LOGD(TAG, "Session status: 0x%02x", session_status);
+        if (session_status & SSH_CLOSED) {
+            ESP_LOGD(TAG, "Session is closed");
+            break;
+        }
+        if (session_status & SSH_CLOSED_ERROR) {
+            ESP_LOGD(TAG, "Session is closed by error");
+            break;
+        }
+
+        // Reap sessions without channel traffic
+        int timeout_ms = 10000;
+        if (idle_limit_us > 0) {
+            int64_t idle_us = esp_timer_get_time() - conn->last_activity_us;
+            if (idle_us >= idle_limit_us) {
+                ESP_LOGI(TAG, "Session %s idle for %lu s, disconnecting", conn->client_ip, (unsigned long)config->idle_timeout_s);
+                break;
+            }
+            if ((idle_limit_us - idle_us) / 1000 + 1 < timeout_ms) {
+                timeout_ms = (idle_limit_us - idle_us) / 1000 + 1;
+            }
+        }
+
+        // Poll for SSH events (auth, channel requests, data, etc.)
+        int poll_result = ssh_event_dopoll(event, timeout_ms);
+
+        if (poll_result == SSH_ERROR) {
+            poll_errors++;
+            ESP_LOGD(TAG, "Error polling events (count: %d): %s", poll_errors, ssh_get_error(session));
+
+            // Allow a few poll errors before giving up
+            if (poll_errors >= 10) {
+                ESP_LOGD(TAG, "Too many poll errors, terminating session");
+                break;
+            }
+        } else if (poll_result == SSH_OK) {
+            // Reset error counter on successful poll
+            poll_errors = 0;
+            // A window adjust may have let held-back output through
+            drain_write_buffers(conn);
+        }
+    }
+
+done:
+    // Release channels the client did not close
+    for (int i = 0; i < ARRAY_SIZE(channels); i++) {
+        if (channels[i].channel && channels[i].conn == conn) {
+            vfs_channel_close(session, channels[i].channel, &channels[i]);
+        }
+    }
+    if (event) {
+        ssh_event_free(event);
+    }
+    ssh_disconnect(session);
+    ssh_free(session);
+    ESP_LOGI(TAG, "Session %s ended", conn->client_ip);
+    release_conn(conn);
+    vTaskDelete(NULL);
+}
+
 static void ssh_server_internal(ssh_server_config_t *config)
 {
 
     ssh_bind sshbind;
     ssh_session session;
-    ssh_event event;
     int rc;
 
     // Wait a bit more to ensure network stack is fully ready
@@ -1141,6 +1643,14 @@ static void ssh_server_internal(ssh_server_config_t *config)
     vTaskDelay(pdMS_TO_TICKS(2000));
     ESP_LOGD(TAG, "Network wait complete, initializing SSH server...");
 
+    if (!s_slots_lock) {
+        s_slots_lock = xSemaphoreCreateMutex();
+        if (!s_slots_lock) {
+            ESP_LOGE(TAG, "Failed to create session lock");
+            return;
+        }
+    }
+
     // Initialize libssh
     rc = ssh_init();
     if (rc != SSH_OK) {
@@ -1154,15 +1664,6 @@ static void ssh_server_internal(ssh_server_config_t *config)
         return;
     }
 
-    // Create eventfd for waking up the SSH event loop when data is written
-    wakeup_eventfd = eventfd(0, 0);
-    if (wakeup_eventfd == -1) {
-        ESP_LOGE(TAG, "Failed to create eventfd: %d", errno);
-        esp_vfs_unregister_with_id(s_pipe_vfs_id);
-        return;
-    }
-    ESP_LOGD(TAG, "Created wakeup eventfd: %d", wakeup_eventfd);
-
     // Create SSH bind object
     sshbind = ssh_bind_new();
     if (sshbind == NULL) {
@@ -1198,11 +1699,13 @@ static void ssh_server_internal(ssh_server_config_t *config)
     ESP_LOGD(TAG, "Default credentials: %s/%s", config->username, config->password);
 #endif
 
-    // Accept connections
+    // Accept connections; each one gets its own session task
+    size_t task_size = config->session_task_size ? config->session_task_size : SESSION_TASK_STACK_SIZE;
     while (1) {
         session = ssh_new();
         if (session == NULL) {
             ESP_LOGE(TAG, "Failed to create session");
+            vTaskDelay(pdMS_TO_TICKS(1000));
             continue;
         }
 
@@ -1215,125 +1718,33 @@ static void ssh_server_internal(ssh_server_config_t *config)
 
         ESP_LOGD(TAG, "New connection accepted");
 
-        // Set up server callbacks
-        struct ssh_server_callbacks_struct server_cb = {
-            .userdata = config,
-            .auth_none_function = auth_none,
-#if CONFIG_EXAMPLE_ALLOW_PASSWORD_AUTH
-            .auth_password_function = auth_password,
-#endif
-#if CONFIG_EXAMPLE_ALLOW_PUBLICKEY_AUTH
-            .auth_pubkey_function = auth_publickey,
-#endif
-            .channel_open_request_session_function = channel_open,
-        };
-
-        ssh_callbacks_init(&server_cb);
-        ssh_set_server_callbacks(session, &server_cb);
-        ESP_LOGD(TAG, "Server callbacks set");
-
-        // Handle key exchange
-        // Note: ssh_handle_key_exchange() can return:
-        // - SSH_OK: Key exchange completed successfully
-        // - SSH_AGAIN: Key exchange in progress, need to call again
-        // - SSH_ERROR: Fatal error occurred
-        rc = ssh_handle_key_exchange(session);
-        ESP_LOGD(TAG, "Key exchange result: rc=%d ", rc);
-        if (rc == SSH_OK) {
-            ESP_LOGD(TAG, "(SSH_OK - completed successfully)");
-        } else if (rc == SSH_AGAIN) {
-            ESP_LOGD(TAG, "(SSH_AGAIN - in progress)");
-        } else if (rc == SSH_ERROR) {
-            ESP_LOGD(TAG, "(SSH_ERROR - fatal error)");
-        } else {
-            ESP_LOGD(TAG, "(unknown return code %d)", rc);
-        }
-
-        if (rc == SSH_ERROR) {
-            ESP_LOGE(TAG, "Key exchange failed: %s (bind: %s)", ssh_get_error(session), ssh_get_error(sshbind));
+        ssh_conn_t *conn = allocate_conn(config);
+        if (conn == NULL) {
             ssh_disconnect(session);
             ssh_free(session);
             continue;
         }
+        conn->session = session;
 
-        ESP_LOGD(TAG, "Key exchange completed or in progress");
-
-        // Set up authentication methods
-        auth_none(session, config->username, config);
-        ESP_LOGD(TAG, "Authentication methods set");
-
-        // Create event for session handling
-        event = ssh_event_new();
-        if (event == NULL) {
-            ESP_LOGE(TAG, "Failed to create event");
-            ssh_disconnect(session);
-            ssh_free(session);
-            continue;
-        }
-
-        // Add wakeup eventfd to the event loop
-        if (ssh_event_add_fd(event, wakeup_eventfd, POLLIN, ssh_event_fd_wrapper_callback, NULL) != SSH_OK) {
-            ESP_LOGE(TAG, "Failed to add wakeup eventfd to event");
-            ssh_event_free(event);
+        // Create eventfd for waking up the session's event loop when data is written
+        conn->wakeup_fd = eventfd(0, 0);
+        if (conn->wakeup_fd == -1) {
+            ESP_LOGE(TAG, "Failed to create eventfd: %d", errno);
+            release_conn(conn);
             ssh_disconnect(session);
             ssh_free(session);
             continue;
         }
 
-        // Add session to event
-        if (ssh_event_add_session(event, session) != SSH_OK) {
-            ESP_LOGE(TAG, "Failed to add session to event");
-            ssh_event_free(event);
+        if (xTaskCreate(&ssh_session_task, "ssh_session", task_size, conn, 5, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create session task");
+            release_conn(conn);
             ssh_disconnect(session);
             ssh_free(session);
-            continue;
-        }
-
-        ESP_LOGD(TAG, "Session added to event, starting main loop");
-
-        int poll_errors = 0;
-
-        while (true) {
-
-            int session_status = ssh_get_status(session);
-            ESP_LOGD(TAG, "Session status: 0x%02x", session_status);
-            if (session_status & SSH_CLOSED) {
-                ESP_LOGD(TAG, "Session is closed");
-                break;
-            }
-            if (session_status & SSH_CLOSED_ERROR) {
-                ESP_LOGD(TAG, "Session is closed by error");
-                break;
-            }
-
-            // Poll for SSH events (auth, channel requests, data, etc.)
-            int poll_result = ssh_event_dopoll(event, 10000); // 10 second timeout
-
-            if (poll_result == SSH_ERROR) {
-                poll_errors++;
-                ESP_LOGD(TAG, "Error polling events (count: %d): %s", poll_errors, ssh_get_error(session));
-
-                // Allow a few poll errors before giving up
-                if (poll_errors >= 10) {
-                    ESP_LOGD(TAG, "Too many poll errors, terminating session");
-                    break;
-                }
-            } else if (poll_result == SSH_OK) {
-                // Reset error counter on successful poll
-                poll_errors = 0;
-            }
         }
-
-        ssh_event_free(event);
-        ssh_disconnect(session);
-        ssh_free(session);
     }
 
     // Clean up
-    if (wakeup_eventfd >= 0) {
-        close(wakeup_eventfd);
-        wakeup_eventfd = -1;
-    }
     if (s_pipe_vfs_id != -1) {
         esp_vfs_unregister_with_id(s_pipe_vfs_id);
         s_pipe_vfs_id = -1;
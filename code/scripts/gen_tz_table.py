@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Generate components/geogram_geoloc/geoloc_tz.c from a tzdata installation.
+
+Usage: gen_tz_table.py [--zoneinfo DIR] [--output FILE]
+
+Every zone listed in DIR/zone.tab, plus Etc/UTC, is mapped to the POSIX TZ
+string stored in the footer of its compiled TZif file (RFC 8536, version 2
+and later), which is what newlib's tzset() understands. The tzdata version
+is read from DIR/tzdata.zi and recorded in the file header.
+
+Run it again after a tzdata release that changes rules, e.g. against a
+system zoneinfo or a "make install" of the tz distribution.
+"""
+
+import argparse
+import os
+import sys
+
+EXTRA_ZONES = ["Etc/UTC"]
+RULE_COLUMN = 47            # Rule strings are padded to this width before the index comment
+
+
+def tzdata_version(zoneinfo):
+    try:
+        with open(os.path.join(zoneinfo, "tzdata.zi")) as f:
+            first = f.readline().split()
+    except OSError:
+        return None
+    if len(first) == 3 and first[:2] == ["#", "version"]:
+        return first[2]
+    return None
+
+
+def zone_names(zoneinfo):
+    names = set(EXTRA_ZONES)
+    with open(os.path.join(zoneinfo, "zone.tab")) as f:
+        for line in f:
+            if line.startswith("#") or not line.strip():
+                continue
+            names.add(line.split("\t")[2].strip())
+    return sorted(names)
+
+
+def posix_rule(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"TZif" or data[4:5] not in (b"2", b"3", b"4"):
+        raise ValueError(f"{path}: no version 2+ TZif data")
+    # The footer is the last line, enclosed in newlines
+    end = data.rindex(b"\n")
+    start = data.rindex(b"\n", 0, end)
+    rule = data[start + 1:end].decode("ascii")
+    if not rule:
+        raise ValueError(f"{path}: empty TZ footer")
+    return rule
+
+
+def render(version, zones, rules):
+    index = {rule: i for i, rule in enumerate(rules)}
+    out = []
+    out.append("/**")
+    out.append(" * @file geoloc_tz.c")
+    out.append(" * @brief IANA timezone name to POSIX TZ string table")
+    out.append(" *")
+    out.append(f" * Generated by scripts/gen_tz_table.py from the footers of the tzdata {version}")
+    out.append(" * zoneinfo files for every zone in zone.tab, plus Etc/UTC. Zones share the")
+    out.append(" * rule strings, so each entry costs a name pointer and one index byte.")
+    out.append(" * Do not edit by hand; regenerate after a tzdata update.")
+    out.append(" */")
+    out.append("")
+    out.append('#include "geoloc_tz.h"')
+    out.append("#include <stdint.h>")
+    out.append("#include <stdlib.h>")
+    out.append("#include <string.h>")
+    out.append("")
+    out.append("// Distinct POSIX rules, referenced by index from the zone table")
+    out.append("static const char *const s_rules[] = {")
+    for i, rule in enumerate(rules):
+        out.append(f"    {(chr(34) + rule + chr(34) + ','):<{RULE_COLUMN}}// {i}")
+    out.append("};")
+    out.append("")
+    out.append("typedef struct {")
+    out.append("    const char *name;")
+    out.append("    uint8_t rule;")
+    out.append("} tz_zone_t;")
+    out.append("")
+    out.append("// Sorted by name (strcmp order) for bsearch")
+    out.append("static const tz_zone_t s_zones[] = {")
+    for name, rule in zones:
+        out.append(f'    {{ "{name}", {index[rule]} }},')
+    out.append("};")
+    out.append("")
+    out.append("static int compare_zone(const void *key, const void *element)")
+    out.append("{")
+    out.append("    return strcmp((const char *)key, ((const tz_zone_t *)element)->name);")
+    out.append("}")
+    out.append("")
+    out.append("const char *geoloc_tz_lookup(const char *iana_tz)")
+    out.append("{")
+    out.append("    if (iana_tz == NULL) {")
+    out.append("        return NULL;")
+    out.append("    }")
+    out.append("    const tz_zone_t *zone = bsearch(iana_tz, s_zones, sizeof(s_zones) / sizeof(s_zones[0]),")
+    out.append("                                    sizeof(s_zones[0]), compare_zone);")
+    out.append("    return zone ? s_rules[zone->rule] : NULL;")
+    out.append("}")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Generate the IANA to POSIX TZ table")
+    parser.add_argument("--zoneinfo", default="/usr/share/zoneinfo", help="compiled tzdata directory")
+    parser.add_argument("--output", default=os.path.join(here, "..", "components", "geogram_geoloc",
+                                                         "geoloc_tz.c"))
+    args = parser.parse_args()
+
+    version = tzdata_version(args.zoneinfo)
+    if version is None:
+        sys.exit(f"{args.zoneinfo}/tzdata.zi missing or without a version line")
+
+    # strcmp order: Python compares str by code point, the same for ASCII names
+    zones = [(name, posix_rule(os.path.join(args.zoneinfo, name))) for name in zone_names(args.zoneinfo)]
+    rules = sorted({rule for _, rule in zones})
+    if len(rules) > 255:
+        sys.exit(f"{len(rules)} distinct rules do not fit the uint8_t index")
+
+    with open(args.output, "w") as f:
+        f.write(render(version, zones, rules))
+    print(f"tzdata {version}: {len(zones)} zones, {len(rules)} rules -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+Pack a directory of web UI files into a Geogram web bundle.
+
+Usage: pack_www.py <directory> <bundle.bin> [--version N] [--immutable GLOB ...]
+
+Copy the result to /sdcard/www/bundle.bin on the device; it is loaded when
+the HTTP server starts and takes precedence over the pages built into the
+firmware. Files are served under their path relative to <directory>
+("css/app.css" -> "/css/app.css"); "index.html" also answers for its
+directory. Compressible files are stored gzip-compressed as well.
+
+Paths matching an --immutable glob are cached by browsers for a year, so
+only use it for versioned names such as "nostr-tools-1.17.0.js".
+
+The layout must match web_assets.h.
+"""
+
+import argparse
+import fnmatch
+import gzip
+import os
+import struct
+import sys
+import time
+
+MAGIC = 0x57575747          # "GWWW"
+FORMAT = 1
+MAX_ENTRIES = 128
+PATH_LEN = 40               # Including NUL
+
+HEADER = struct.Struct('<IHHII')
+ENTRY = struct.Struct('<%dsIIIIIBBH' % PATH_LEN)
+
+FLAG_IMMUTABLE = 0x01
+
+# Extension -> (web_mime_t, compress)
+MIME = {
+    '.html': (1, True),
+    '.htm': (1, True),
+    '.js': (2, True),
+    '.css': (3, True),
+    '.json': (4, True),
+    '.png': (5, False),
+    '.jpg': (6, False),
+    '.jpeg': (6, False),
+    '.svg': (7, True),
+    '.ico': (8, True),
+    '.woff2': (9, False),
+    '.txt': (10, True),
+}
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def collect(root):
+    files = []
+    for dirpath, _, names in os.walk(root):
+        for name in names:
+            full = os.path.join(dirpath, name)
+            rel = os.path.relpath(full, root).replace(os.sep, '/')
+            files.append(('/' + rel, full))
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pack a Geogram web bundle')
+    parser.add_argument('directory')
+    parser.add_argument('output')
+    parser.add_argument('--version', type=int, default=int(time.time()),
+                        help='bundle version (default: current Unix time)')
+    parser.add_argument('--immutable', action='append', default=[],
+                        help='glob of versioned paths to cache for a year')
+    args = parser.parse_args()
+
+    files = sorted(collect(args.directory), key=lambda f: f[0].encode())
+    if not files:
+        print('No files in %s' % args.directory, file=sys.stderr)
+        return 1
+    if len(files) > MAX_ENTRIES:
+        print('Too many files: %d (max %d)' % (len(files), MAX_ENTRIES), file=sys.stderr)
+        return 1
+
+    data = bytearray()
+    data_start = HEADER.size + ENTRY.size * len(files)
+    entries = []
+
+    for path, full in files:
+        encoded = path.encode()
+        if len(encoded) >= PATH_LEN:
+            print('Path too long (max %d bytes): %s' % (PATH_LEN - 1, path), file=sys.stderr)
+            return 1
+
+        with open(full, 'rb') as f:
+            content = f.read()
+        mime, compress = MIME.get(os.path.splitext(path)[1].lower(), (0, False))
+        flags = FLAG_IMMUTABLE if any(fnmatch.fnmatch(path, g) for g in args.immutable) else 0
+
+        offset = data_start + len(data)
+        data += content
+
+        gz_offset = gz_length = 0
+        if compress:
+            packed = gzip.compress(content, compresslevel=9, mtime=0)
+            if len(packed) < len(content):
+                gz_offset = data_start + len(data)
+                gz_length = len(packed)
+                data += packed
+
+        entries.append(ENTRY.pack(encoded, offset, len(content), gz_offset, gz_length,
+                                  fnv1a(content), mime, flags, 0))
+        print('%-40s %8d %8s' % (path, len(content), gz_length or '-'))
+
+    with open(args.output, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, FORMAT, len(entries), args.version & 0xFFFFFFFF, 0))
+        f.writelines(entries)
+        f.write(data)
+
+    print('Bundle v%d: %d files, %d bytes' % (args.version, len(entries), data_start + len(data)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -2,6 +2,35 @@ Import("env")
 import os
 import shutil
 
+def app_slot_size(env):
+    """
+    Size of the smallest app partition in the board's partition table
+    """
+    table = env.GetProjectOption("board_build.partitions", "partitions.csv")
+    path = os.path.join(env.subst("$PROJECT_DIR"), table)
+    sizes = []
+    with open(path) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[1] == "app":
+                sizes.append(int(fields[4], 0))
+    return min(sizes) if sizes else None
+
+def check_app_size(bin_path, env):
+    """
+    Fail the build if the image does not fit in an OTA slot
+    """
+    slot = app_slot_size(env)
+    if slot is None:
+        return
+    size = os.path.getsize(bin_path)
+    print(f"[Geogram] Firmware {size} bytes, app slot {slot} bytes ({100 * size // slot}% used)")
+    if size > slot:
+        print(f"[Geogram] ERROR: firmware is {size - slot} bytes larger than the app slot")
+        env.Exit(1)
+    elif size > slot * 9 // 10:
+        print(f"[Geogram] WARNING: less than 10% of the app slot left ({slot - size} bytes)")
+
 def post_build_action(source, target, env):
     """
     Post-build script to rename firmware to custom name
@@ -20,6 +49,9 @@ def post_build_action(source, target, env):
     bin_dst = os.path.join(output_dir, f"{firmware_name}.bin")
     elf_dst = os.path.join(output_dir, f"{firmware_name}.elf")
 
+    if os.path.exists(bin_src):
+        check_app_size(bin_src, env)
+
     # Copy and rename
     if os.path.exists(bin_src):
         shutil.copy2(bin_src, bin_dst)
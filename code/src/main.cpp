@@ -23,14 +23,22 @@
 // SSH server
 #include "geogram_ssh.h"
 
-// DNS server for captive portal
+// DNS server (local names, upstream forwarding, captive portal)
 #include "dns_server.h"
 
 // IP geolocation for timezone
 #include "geoloc.h"
 
-// Plain log helper (no ANSI)
+// Plain log helper (no ANSI) and deferred logging
 #include "geogram_log_plain.h"
+#include "geogram_dlog.h"
+#include "geogram_logstore.h"
+
+// Firmware updates (rollback confirmation)
+#include "ota.h"
+
+// Parallel boot stages and boot profile
+#include "boot.h"
 
 // Mesh networking (optional, enabled via CONFIG_GEOGRAM_MESH_ENABLED)
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
@@ -85,6 +93,52 @@ static bool s_mesh_connected = false;
 static bool s_mesh_services_started = false;
 static bool s_http_server_started = false;  // Track if HTTP server started early
 
+/**
+ * @brief Rebuild the local DNS names from the mesh node table
+ *
+ * This station answers as station.geogram and <callsign>.mesh on its own
+ * AP. Other nodes are named node-<subnet>.mesh after the gateway of their
+ * 192.168.(10 + subnet).0/24 subnet.
+ */
+static void update_dns_zone(void)
+{
+    uint32_t ap_ip = 0;
+    if (geogram_mesh_get_external_ap_ip_addr(&ap_ip) != ESP_OK) {
+        return;
+    }
+
+    // Built aside and swapped in whole, so queries never meet an empty zone.
+    // Only called from the mesh event callback.
+    static dns_server_record_t records[DNS_SERVER_MAX_RECORDS];
+    size_t n = 0;
+
+    snprintf(records[n].name, sizeof(records[n].name), "station.geogram");
+    records[n++].ip = ap_ip;
+
+    const char *callsign = nostr_keys_get_callsign();
+    if (callsign && callsign[0] != '\0') {
+        snprintf(records[n].name, sizeof(records[n].name), "%s.mesh", callsign);
+        records[n++].ip = ap_ip;
+    }
+
+    geogram_mesh_node_t nodes[DNS_SERVER_MAX_RECORDS];
+    size_t count = 0;
+    if (geogram_mesh_get_nodes(nodes, DNS_SERVER_MAX_RECORDS - 2, &count) != ESP_OK) {
+        count = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (nodes[i].subnet_id == geogram_mesh_get_subnet_id()) {
+            continue;  // This station, named above
+        }
+        snprintf(records[n].name, sizeof(records[n].name), "node-%u.mesh", nodes[i].subnet_id);
+        ip4_addr_t gateway;
+        IP4_ADDR(&gateway, 192, 168, 10 + nodes[i].subnet_id, 1);
+        records[n++].ip = gateway.addr;
+    }
+
+    dns_server_set_records(records, n);
+}
+
 static void start_mesh_services(void)
 {
     if (s_mesh_services_started) {
@@ -97,6 +151,7 @@ static void start_mesh_services(void)
 
     uint32_t ap_ip = 0;
     if (geogram_mesh_get_external_ap_ip_addr(&ap_ip) == ESP_OK) {
+        update_dns_zone();
         dns_server_start(ap_ip);
     }
 
@@ -117,11 +172,43 @@ static void start_mesh_services(void)
     s_mesh_services_started = true;
 }
 
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+/**
+ * @brief Choose where the update mirror gets releases from
+ *
+ * Only the root (the node with the uplink) polls GitHub. Every other node
+ * mirrors its parent over the mesh, so a release crosses the WAN once and
+ * flows down the tree. A node that left the mesh goes back to GitHub
+ * instead of polling a parent it no longer has.
+ */
+static void select_update_source(void)
+{
+    if (!updates_is_available()) {
+        return;
+    }
+
+    char parent_ip[16];
+    if (s_mesh_connected && !geogram_mesh_is_root() &&
+        geogram_mesh_get_parent_ip(parent_ip, sizeof(parent_ip)) == ESP_OK) {
+        char upstream[32];
+        snprintf(upstream, sizeof(upstream), "http://%s", parent_ip);
+        updates_set_upstream(upstream);
+        updates_start_polling(15 * 60);  // Local link, poll more often
+    } else {
+        updates_set_upstream(NULL);
+        updates_start_polling(60 * 60);  // 1 hour
+    }
+}
+#endif
+
 /**
  * @brief Mesh event callback
  */
 static void mesh_event_cb(geogram_mesh_event_t event, void *event_data)
 {
+    // Mesh fields in /api/status (connected, root, layer, nodes)
+    station_mark_status_dirty();
+
     switch (event) {
         case GEOGRAM_MESH_EVENT_CONNECTED:
             ESP_LOGI(TAG, "Mesh connected, layer: %d", geogram_mesh_get_layer());
@@ -130,6 +217,9 @@ static void mesh_event_cb(geogram_mesh_event_t event, void *event_data)
                      geogram_mesh_is_root() ? "root" : "child");
             s_mesh_connected = true;
 
+            // Names outside the local zone go to the uplink's resolver
+            dns_server_set_forwarding(true);
+
 #if BOARD_MODEL == MODEL_ESP32C3_MINI && HAS_LED
             // System OK - solid green LED
             led_set_state(LED_STATE_OK);
@@ -140,12 +230,16 @@ static void mesh_event_cb(geogram_mesh_event_t event, void *event_data)
             // Enable IP bridging
             geogram_mesh_enable_bridge();
 
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+            select_update_source();
+#endif
             break;
 
         case GEOGRAM_MESH_EVENT_DISCONNECTED:
             ESP_LOGW(TAG, "Mesh disconnected");
             ESP_LOGI(TAG, "Mesh nodes now: %zu", geogram_mesh_get_node_count());
             s_mesh_connected = false;
+            dns_server_set_forwarding(false);
 
 #if BOARD_MODEL == MODEL_ESP32C3_MINI && HAS_LED
             // Error state - blinking red LED
@@ -159,11 +253,27 @@ static void mesh_event_cb(geogram_mesh_event_t event, void *event_data)
             geogram_mesh_disable_bridge();
             geogram_mesh_stop_external_ap();
             s_mesh_services_started = false;
+
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+            select_update_source();
+#endif
             break;
 
         case GEOGRAM_MESH_EVENT_ROOT_CHANGED:
             ESP_LOGI(TAG, "Root status changed: %s",
                      geogram_mesh_is_root() ? "I am ROOT" : "I am CHILD");
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+            if (s_mesh_connected) {
+                select_update_source();
+            }
+#endif
+            break;
+
+        case GEOGRAM_MESH_EVENT_CHILD_CONNECTED:
+        case GEOGRAM_MESH_EVENT_CHILD_DISCONNECTED:
+            if (s_mesh_services_started) {
+                update_dns_zone();
+            }
             break;
 
         case GEOGRAM_MESH_EVENT_EXTERNAL_STA_CONNECTED:
@@ -313,6 +423,7 @@ static void device_shutdown(void)
     board_power_audio_off();
 
     ESP_LOGI(TAG, "Entering deep sleep - press power button to wake");
+    geogram_logstore_stop();
 
     // Enter deep sleep with power button wake-up (0 = external wake only)
     board_power_deep_sleep(0);
@@ -395,6 +506,16 @@ static void init_sntp(void)
     esp_sntp_init();
 }
 
+/**
+ * @brief Geolocation refreshed: update station location for the API
+ */
+static void on_geoloc_update(const geoloc_data_t *geoloc)
+{
+    ESP_LOGI(TAG, "Location: %s, %s", geoloc->city, geoloc->country);
+    station_set_location(geoloc->latitude, geoloc->longitude,
+                         geoloc->city, geoloc->country, geoloc->timezone);
+}
+
 /**
  * @brief Background task for network services (geolocation, NTP)
  *
@@ -408,26 +529,17 @@ static void network_services_task(void *pvParameter)
     // Small delay to let WiFi stack stabilize
     vTaskDelay(pdMS_TO_TICKS(500));
 
-    // Step 1: Fetch geolocation (sets timezone)
-    ESP_LOGI(TAG, "[Background] Fetching geolocation...");
-    geogram_ui_show_status("Getting location...");
-    geogram_ui_refresh(false);
-
-    geoloc_data_t geoloc;
-    if (geoloc_fetch(&geoloc) == ESP_OK) {
-        geoloc_apply_timezone();
-        ESP_LOGI(TAG, "[Background] Location: %s, %s", geoloc.city, geoloc.country);
-
-        // Update station with location data for API
-        station_set_location(geoloc.latitude, geoloc.longitude,
-                            geoloc.city, geoloc.country, geoloc.timezone);
-    } else {
-        ESP_LOGW(TAG, "[Background] Geolocation failed, using UTC");
-        setenv("TZ", "UTC0", 1);
-        tzset();
+    // Step 1: Geolocation. The timezone saved at boot is already in effect;
+    // the lookup refreshes it (and the station location) in its own task
+    const geoloc_data_t *last = geoloc_get_cached();
+    if (last) {
+        station_set_location(last->latitude, last->longitude,
+                             last->city, last->country, last->timezone);
     }
+    ESP_LOGI(TAG, "[Background] Refreshing geolocation...");
+    geoloc_start_refresh(on_geoloc_update);
 
-    // Step 2: Initialize NTP (now that timezone is set)
+    // Step 2: Initialize NTP
     ESP_LOGI(TAG, "[Background] Initializing NTP...");
     geogram_ui_show_status("Syncing time...");
     geogram_ui_refresh(false);
@@ -459,6 +571,28 @@ static void network_services_task(void *pvParameter)
 // Forward declaration
 static void start_ap_mode(void);
 
+/**
+ * @brief Start the network services that serve files from the SD card
+ *
+ * Called when WiFi gets an IP; the http boot stage that connects only
+ * runs once the SD card stage has finished.
+ */
+static void start_sd_network_services(void)
+{
+    // Start update mirror polling (check GitHub every hour, first check after 1 minute)
+    if (updates_is_available()) {
+        updates_start_polling(60 * 60);  // 1 hour
+        ESP_LOGI(TAG, "Update mirror polling started (hourly)");
+    }
+
+    // Start FTP server if SD card is mounted
+    if (sdcard_is_mounted()) {
+        if (ftp_server_start(FTP_DEFAULT_PORT) == ESP_OK) {
+            ESP_LOGI(TAG, "FTP server started on port %d", FTP_DEFAULT_PORT);
+        }
+    }
+}
+
 /**
  * @brief WiFi event callback
  */
@@ -496,18 +630,8 @@ static void wifi_event_cb(geogram_wifi_status_t status, void *event_data)
             //     ESP_LOGI(TAG, "SSH server started on port %d", GEOGRAM_SSH_DEFAULT_PORT);
             // }
 
-            // Start update mirror polling (check GitHub every hour, first check after 1 minute)
-            if (updates_is_available()) {
-                updates_start_polling(60 * 60);  // 1 hour
-                ESP_LOGI(TAG, "Update mirror polling started (hourly)");
-            }
-
-            // Start FTP server if SD card is mounted
-            if (sdcard_is_mounted()) {
-                if (ftp_server_start(FTP_DEFAULT_PORT) == ESP_OK) {
-                    ESP_LOGI(TAG, "FTP server started on port %d", FTP_DEFAULT_PORT);
-                }
-            }
+            // Update mirror and FTP, if the SD card is already mounted
+            start_sd_network_services();
 
             // Start network services in background (geolocation, NTP)
             // This avoids blocking the WiFi callback with slow HTTP requests
@@ -731,48 +855,40 @@ static void rtc_task(void *pvParameter)
 
 #endif  // BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
 
-extern "C" void app_main(void)
-{
-    ESP_LOGI(TAG, "=====================================");
-    geogram_log_plain(TAG, "  Offline-First Communication");
-    geogram_log_plain(TAG, "   · · · ·   ───   · ── ·   ·");
-    geogram_log_plain(TAG, "    Wi-Fi  ·  BLE  ·  NOSTR");
-    ESP_LOGI(TAG, "  Geogram Firmware v%s", GEOGRAM_VERSION);
-    ESP_LOGI(TAG, "  Board: %s", BOARD_NAME);
-    ESP_LOGI(TAG, "  Model: %s", MODEL_NAME);
-    ESP_LOGI(TAG, "=====================================");
+// ============================================================================
+// Boot stages
+// ============================================================================
 
-    // Initialize board-specific hardware
+// Stages allowed to run at once (the main task is one of them)
+#define BOOT_WORKERS    3
+
+/**
+ * @brief Board hardware, then the last known timezone
+ */
+static esp_err_t boot_board(void)
+{
     esp_err_t ret = model_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Board initialization failed: %s", esp_err_to_name(ret));
-        return;
+        return ret;
     }
 
     ESP_LOGI(TAG, "Board initialized successfully");
 
-#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
-    // Initialize tile cache if SD card is available
-    if (sdcard_is_mounted()) {
-        ret = tiles_init();
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "Tile cache initialized");
-        } else {
-            ESP_LOGW(TAG, "Tile cache init failed: %s", esp_err_to_name(ret));
-        }
-
-        // Initialize update mirror service
-        ret = updates_init();
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "Update mirror service initialized");
-        } else {
-            ESP_LOGW(TAG, "Update mirror init failed: %s", esp_err_to_name(ret));
-        }
+    // Local time from the last known location, without waiting on the WAN
+    if (geoloc_load() == ESP_OK) {
+        geoloc_apply_timezone();
     }
+
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+    s_rtc_handle = model_get_rtc();
 #endif
+    return ESP_OK;
+}
 
-    // Initialize serial console
-    ret = console_init();
+static esp_err_t boot_console(void)
+{
+    esp_err_t ret = console_init();
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to initialize console: %s", esp_err_to_name(ret));
     } else {
@@ -784,25 +900,69 @@ extern "C" void app_main(void)
 #else
     geogram_log_plain(TAG, "Mesh support: DISABLED in this build");
 #endif
+    return ESP_OK;
+}
 
-#if defined(CONFIG_GEOGRAM_MESH_ENABLED) && BOARD_MODEL == MODEL_ESP32C3_MINI
-    geogram_log_plain(TAG, "Starting mesh mode by default");
-    start_mesh_mode();
+#if BOARD_MODEL != MODEL_ESP32_GENERIC
+/**
+ * @brief NOSTR keys (needed for AP SSID with callsign)
+ */
+static esp_err_t boot_keys(void)
+{
+    esp_err_t ret = nostr_keys_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize NOSTR keys: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "Station callsign: %s", nostr_keys_get_callsign());
+    }
+    return ESP_OK;
+}
 #endif
 
 #if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
-    // Get hardware handles
-    epaper_1in54_handle_t display = model_get_display();
-    shtc3_handle_t env_sensor = model_get_env_sensor();
-    pcf85063_handle_t rtc = model_get_rtc();
+/**
+ * @brief SD card, then the services that keep their data on it
+ */
+static esp_err_t boot_sdcard(void)
+{
+    model_init_storage();
+    if (!sdcard_is_mounted()) {
+        return ESP_OK;
+    }
+
+    // Keep the log on the card from here on (lines before this are serial only)
+    esp_err_t ret = geogram_logstore_start("/sdcard/logs");
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Log store not started: %s", esp_err_to_name(ret));
+    }
 
-    // Store handles for callbacks
-    s_rtc_handle = rtc;
-    s_display_handle = display;
+    ret = tiles_init();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Tile cache initialized");
+    } else {
+        ESP_LOGW(TAG, "Tile cache init failed: %s", esp_err_to_name(ret));
+    }
 
-    if (display == NULL) {
+    // Initialize update mirror service
+    ret = updates_init();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Update mirror service initialized");
+    } else {
+        ESP_LOGW(TAG, "Update mirror init failed: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief E-paper panel, power button, LVGL and the UI
+ */
+static esp_err_t boot_display(void)
+{
+    esp_err_t ret = model_init_display();
+    s_display_handle = model_get_display();
+    if (ret != ESP_OK || s_display_handle == NULL) {
         ESP_LOGE(TAG, "Failed to get display handle");
-        return;
+        return ret != ESP_OK ? ret : ESP_FAIL;
     }
 
     // Initialize power button for shutdown on long press
@@ -820,119 +980,215 @@ extern "C" void app_main(void)
     }
 
     ESP_LOGI(TAG, "E-paper display: %dx%d",
-             epaper_1in54_get_width(display),
-             epaper_1in54_get_height(display));
+             epaper_1in54_get_width(s_display_handle),
+             epaper_1in54_get_height(s_display_handle));
 
     // Initialize LVGL with e-paper display
-    ret = lvgl_port_init(display);
+    ret = lvgl_port_init(s_display_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize LVGL: %s", esp_err_to_name(ret));
-        return;
+        return ret;
     }
 
     // Initialize UI
     ret = geogram_ui_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize UI: %s", esp_err_to_name(ret));
-        return;
+        return ret;
+    }
+
+    // WiFi comes up alongside the display; show where it got to so far
+    if (s_wifi_connected) {
+        geogram_ui_update_wifi(UI_WIFI_STATUS_CONNECTED, s_current_ip, NULL);
+    } else if (s_ap_mode_active) {
+        char ap_ssid[32];
+        const char *callsign = nostr_keys_get_callsign();
+        if (callsign && strlen(callsign) > 0) {
+            snprintf(ap_ssid, sizeof(ap_ssid), "geogram-%s", callsign);
+        } else {
+            snprintf(ap_ssid, sizeof(ap_ssid), "geogram-setup");
+        }
+        geogram_ui_update_wifi(UI_WIFI_STATUS_AP_MODE, s_current_ip, ap_ssid);
     }
 
     // Initial display refresh
     geogram_ui_show_status("Starting...");
     geogram_ui_refresh(true);  // Full refresh on startup
+    return ESP_OK;
+}
 
-    // Initialize NOSTR keys early (needed for AP SSID with callsign)
-    ret = nostr_keys_init();
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to initialize NOSTR keys: %s", esp_err_to_name(ret));
-    } else {
-        ESP_LOGI(TAG, "Station callsign: %s", nostr_keys_get_callsign());
-    }
-
-    // Initialize WiFi
-    ret = geogram_wifi_init();
+/**
+ * @brief WiFi driver, brought up while the SD card mounts
+ */
+static esp_err_t boot_wifi(void)
+{
+    esp_err_t ret = geogram_wifi_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize WiFi: %s", esp_err_to_name(ret));
         geogram_ui_show_status("WiFi Init Failed");
         geogram_ui_refresh(false);
-    } else {
-        // Try to connect with saved credentials, otherwise start AP mode
-        if (!try_saved_credentials()) {
-            start_ap_mode();
-        }
     }
+    return ret;
+}
 
+/**
+ * @brief WiFi with saved credentials, or AP mode for configuration
+ *
+ * Both paths start the HTTP server, which registers the tile and update
+ * routes and loads the web bundle from the card only when it starts, so
+ * this waits for the sdcard stage.
+ */
+static esp_err_t boot_http(void)
+{
+    if (!try_saved_credentials()) {
+        start_ap_mode();
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Sensor and RTC tasks (they draw on the UI)
+ */
+static esp_err_t boot_sensors(void)
+{
     // Start sensor reading task
+    shtc3_handle_t env_sensor = model_get_env_sensor();
     if (env_sensor != NULL) {
         xTaskCreate(sensor_task, "sensor_task", 4096, env_sensor, 5, NULL);
     }
 
     // Start RTC update task
-    if (rtc != NULL) {
-        xTaskCreate(rtc_task, "rtc_task", 2048, rtc, 4, NULL);
+    if (s_rtc_handle != NULL) {
+        xTaskCreate(rtc_task, "rtc_task", 2048, s_rtc_handle, 4, NULL);
     }
+    return ESP_OK;
+}
 
-#endif  // BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+static const geogram_boot_stage_t s_boot_stages[] = {
+    { "board",   boot_board,   { NULL }, true },
+    { "display", boot_display, { "board" } },
+    { "keys",    boot_keys,    { "board" } },
+    { "wifi",    boot_wifi,    { "keys" } },
+    { "sdcard",  boot_sdcard,  { "board" } },
+    { "http",    boot_http,    { "wifi", "sdcard" } },
+    { "console", boot_console, { "board" } },
+    { "sensors", boot_sensors, { "display" } },
+};
 
-#if BOARD_MODEL == MODEL_ESP32C3_MINI && !defined(CONFIG_GEOGRAM_MESH_ENABLED)
-    // Standalone WiFi AP mode for ESP32C3 when mesh is disabled
-    // When mesh is enabled, mesh_bsp handles all WiFi/netif initialization
+#elif BOARD_MODEL == MODEL_ESP32C3_MINI
 
-    // Initialize NOSTR keys (needed for AP SSID with callsign)
-    ret = nostr_keys_init();
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to initialize NOSTR keys: %s", esp_err_to_name(ret));
-    } else {
-        ESP_LOGI(TAG, "Station callsign: %s", nostr_keys_get_callsign());
-    }
+#ifdef CONFIG_GEOGRAM_MESH_ENABLED
+static esp_err_t boot_mesh(void)
+{
+    geogram_log_plain(TAG, "Starting mesh mode by default");
+    start_mesh_mode();
+    return ESP_OK;
+}
 
-    // Initialize WiFi
-    ret = geogram_wifi_init();
+static const geogram_boot_stage_t s_boot_stages[] = {
+    { "board",   boot_board,   { NULL }, true },
+    { "keys",    boot_keys,    { "board" } },
+    { "mesh",    boot_mesh,    { "board" } },
+    { "console", boot_console, { "board" } },
+};
+#else
+/**
+ * @brief Standalone WiFi AP for ESP32C3 when mesh is disabled
+ *
+ * When mesh is enabled, mesh_bsp handles all WiFi/netif initialization.
+ */
+static esp_err_t boot_wifi_ap(void)
+{
+    esp_err_t ret = geogram_wifi_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize WiFi: %s", esp_err_to_name(ret));
 #if HAS_LED
         led_set_state(LED_STATE_ERROR);
 #endif
-    } else {
-        // Start WiFi AP mode
-        geogram_wifi_ap_config_t ap_config = {};
-        strncpy(ap_config.ssid, "geogram", sizeof(ap_config.ssid) - 1);
-        ap_config.password[0] = '\0';  // Open network
-        ap_config.channel = 1;
-        ap_config.max_connections = 4;
-        ap_config.callback = NULL;
-
-        ret = geogram_wifi_start_ap(&ap_config);
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "WiFi AP started: geogram");
-
-            // Start DNS server for captive portal
-            uint32_t ap_ip = 0;
-            if (geogram_wifi_get_ap_ip_addr(&ap_ip) == ESP_OK) {
-                dns_server_start(ap_ip);
-            }
-
-            // Initialize Station API and HTTP server
-            station_init();
-            http_server_start_ex(NULL, true);
-            ESP_LOGI(TAG, "HTTP server started");
+        return ESP_OK;
+    }
 
-            // Start Telnet server
-            if (telnet_server_start(TELNET_DEFAULT_PORT) == ESP_OK) {
-                ESP_LOGI(TAG, "Telnet server started on port %d", TELNET_DEFAULT_PORT);
-            }
+    // Start WiFi AP mode
+    geogram_wifi_ap_config_t ap_config = {};
+    strncpy(ap_config.ssid, "geogram", sizeof(ap_config.ssid) - 1);
+    ap_config.password[0] = '\0';  // Open network
+    ap_config.channel = 1;
+    ap_config.max_connections = 4;
+    ap_config.callback = NULL;
 
+    ret = geogram_wifi_start_ap(&ap_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start WiFi AP: %s", esp_err_to_name(ret));
 #if HAS_LED
-            led_set_state(LED_STATE_OK);
+        led_set_state(LED_STATE_ERROR);
 #endif
-        } else {
-            ESP_LOGE(TAG, "Failed to start WiFi AP: %s", esp_err_to_name(ret));
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "WiFi AP started: geogram");
+
+    // Start DNS server for captive portal
+    uint32_t ap_ip = 0;
+    if (geogram_wifi_get_ap_ip_addr(&ap_ip) == ESP_OK) {
+        dns_server_start(ap_ip);
+    }
+
+    // Initialize Station API and HTTP server
+    station_init();
+    http_server_start_ex(NULL, true);
+    ESP_LOGI(TAG, "HTTP server started");
+
+    // Start Telnet server
+    if (telnet_server_start(TELNET_DEFAULT_PORT) == ESP_OK) {
+        ESP_LOGI(TAG, "Telnet server started on port %d", TELNET_DEFAULT_PORT);
+    }
+
 #if HAS_LED
-            led_set_state(LED_STATE_ERROR);
+    led_set_state(LED_STATE_OK);
 #endif
-        }
+    return ESP_OK;
+}
+
+static const geogram_boot_stage_t s_boot_stages[] = {
+    { "board",   boot_board,   { NULL }, true },
+    { "keys",    boot_keys,    { "board" } },
+    { "wifi",    boot_wifi_ap, { "keys" } },
+    { "console", boot_console, { "board" } },
+};
+#endif  // CONFIG_GEOGRAM_MESH_ENABLED
+
+#else  // MODEL_ESP32_GENERIC
+
+static const geogram_boot_stage_t s_boot_stages[] = {
+    { "board",   boot_board,   { NULL }, true },
+    { "console", boot_console, { "board" } },
+};
+
+#endif  // BOARD_MODEL
+
+extern "C" void app_main(void)
+{
+    ESP_LOGI(TAG, "=====================================");
+    geogram_log_plain(TAG, "  Offline-First Communication");
+    geogram_log_plain(TAG, "   · · · ·   ───   · ── ·   ·");
+    geogram_log_plain(TAG, "    Wi-Fi  ·  BLE  ·  NOSTR");
+    ESP_LOGI(TAG, "  Geogram Firmware v%s", GEOGRAM_VERSION);
+    ESP_LOGI(TAG, "  Board: %s", BOARD_NAME);
+    ESP_LOGI(TAG, "  Model: %s", MODEL_NAME);
+    ESP_LOGI(TAG, "=====================================");
+
+    // Writer for deferred (hot path) log records
+    geogram_dlog_start();
+
+    // Bring subsystems up in parallel; each stage waits only for its dependencies
+    esp_err_t ret = geogram_boot_run(s_boot_stages, sizeof(s_boot_stages) / sizeof(s_boot_stages[0]),
+                                     BOOT_WORKERS);
+    if (ret == ESP_OK) {
+        // Critical stages came up: keep this firmware if it was just installed
+        geogram_ota_confirm();
+    } else {
+        // Stay up for the console and power button; an unconfirmed OTA image rolls back on reset
+        ESP_LOGE(TAG, "Boot failed: %s", esp_err_to_name(ret));
     }
-#endif  // BOARD_MODEL == MODEL_ESP32C3_MINI && !CONFIG_GEOGRAM_MESH_ENABLED
 
     // Main loop
     ESP_LOGI(TAG, "Entering main loop...");
@@ -0,0 +1,177 @@
+/**
+ * @file bech32_fuzz.c
+ * @brief Host fuzz and throughput comparison of bech32.c against bech32_ref.c
+ *
+ * Random payloads (0-36 bytes) under several HRPs are encoded by both
+ * codecs, which must agree byte for byte. A third of the strings then get
+ * one random symbol replaced before decoding, and both decoders must agree
+ * on acceptance, HRP and payload. The timing part encodes and decodes 64
+ * npub keys repeatedly with the old codec, the new one and the batch
+ * encoder.
+ *
+ * Usage:
+ *     make bech32                 # 200000 cases
+ *     ./build/bech32_fuzz 1000000
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bech32.h"
+
+esp_err_t bech32_ref_encode(const char *hrp, const uint8_t *data, size_t data_len,
+                            char *output, size_t output_len);
+esp_err_t bech32_ref_decode(const char *input, char *hrp, uint8_t *data, size_t *data_len);
+
+#define MAX_PAYLOAD     36      // Longest payload the old decoder's symbol array holds
+#define BENCH_KEYS      64
+#define BENCH_ROUNDS    2000
+
+static const char *const k_hrps[] = { "npub", "nsec", "note", "a", "bc", "tb" };
+static const char k_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+static double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static int fuzz(long cases)
+{
+    int mismatches = 0;
+    long encoded = 0;
+
+    for (long it = 0; it < cases; it++) {
+        uint8_t data[MAX_PAYLOAD];
+        size_t data_len = (size_t)(rand() % (MAX_PAYLOAD + 1));
+        for (size_t i = 0; i < data_len; i++) {
+            data[i] = (uint8_t)rand();
+        }
+        const char *hrp = k_hrps[rand() % (int)(sizeof(k_hrps) / sizeof(k_hrps[0]))];
+
+        char ref[128], out[128];
+        esp_err_t ref_ret = bech32_ref_encode(hrp, data, data_len, ref, sizeof(ref));
+        esp_err_t ret = bech32_encode(hrp, data, data_len, out, sizeof(out));
+        if (ref_ret != ret || (ret == ESP_OK && strcmp(ref, out) != 0)) {
+            if (mismatches++ < 5) {
+                printf("encode mismatch: %s vs %s\n", ref, out);
+            }
+            continue;
+        }
+        if (ret != ESP_OK) {
+            continue;
+        }
+        encoded++;
+
+        bool corrupted = rand() % 3 == 0;
+        if (corrupted) {
+            size_t hrp_len = strlen(hrp);
+            size_t pos = hrp_len + 1 + (size_t)rand() % (strlen(out) - hrp_len - 1);
+            out[pos] = k_charset[rand() % 32];
+        }
+
+        char ref_hrp[BECH32_MAX_HRP_LEN + 1], new_hrp[BECH32_MAX_HRP_LEN + 1];
+        uint8_t ref_data[64], new_data[64];
+        size_t ref_len = sizeof(ref_data), new_len = sizeof(new_data);
+        esp_err_t ref_dec = bech32_ref_decode(out, ref_hrp, ref_data, &ref_len);
+        esp_err_t new_dec = bech32_decode(out, new_hrp, new_data, &new_len);
+
+        bool agree = (ref_dec == ESP_OK) == (new_dec == ESP_OK);
+        if (agree && new_dec == ESP_OK) {
+            agree = ref_len == new_len && memcmp(ref_data, new_data, new_len) == 0 &&
+                    strcmp(ref_hrp, new_hrp) == 0;
+        }
+        // An untouched string must decode back to the payload
+        if (agree && strcmp(ref, out) == 0) {
+            agree = new_dec == ESP_OK && new_len == data_len && memcmp(new_data, data, data_len) == 0;
+        }
+        if (!agree && mismatches++ < 5) {
+            printf("decode mismatch: %s (%d vs %d)\n", out, ref_dec, new_dec);
+        }
+    }
+
+    printf("fuzz: %ld cases encoded, %d mismatches\n", encoded, mismatches);
+    return mismatches;
+}
+
+static int bench(void)
+{
+    static uint8_t keys[BENCH_KEYS * 32];
+    static char batch[BENCH_KEYS][80];
+    for (size_t i = 0; i < sizeof(keys); i++) {
+        keys[i] = (uint8_t)rand();
+    }
+
+    const double ops = (double)BENCH_KEYS * BENCH_ROUNDS;
+    char s[80];
+    int mismatches = 0;
+
+    clock_t start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_KEYS; i++) {
+            bech32_ref_encode("npub", keys + i * 32, 32, s, sizeof(s));
+        }
+    }
+    double t_ref_enc = elapsed(start);
+
+    start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_KEYS; i++) {
+            bech32_encode("npub", keys + i * 32, 32, s, sizeof(s));
+        }
+    }
+    double t_enc = elapsed(start);
+
+    start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        bech32_encode_batch("npub", keys, 32, BENCH_KEYS, batch[0], sizeof(batch[0]));
+    }
+    double t_batch = elapsed(start);
+
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        bech32_ref_encode("npub", keys + i * 32, 32, s, sizeof(s));
+        if (strcmp(s, batch[i]) != 0) {
+            mismatches++;
+        }
+    }
+
+    char hrp[BECH32_MAX_HRP_LEN + 1];
+    uint8_t data[64];
+    size_t len;
+
+    start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_KEYS; i++) {
+            len = sizeof(data);
+            bech32_ref_decode(batch[i], hrp, data, &len);
+        }
+    }
+    double t_ref_dec = elapsed(start);
+
+    start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_KEYS; i++) {
+            len = sizeof(data);
+            bech32_decode(batch[i], hrp, data, &len);
+        }
+    }
+    double t_dec = elapsed(start);
+
+    printf("encode: old %.0f/s, new %.0f/s, batch %.0f/s\n", ops / t_ref_enc, ops / t_enc, ops / t_batch);
+    printf("decode: old %.0f/s, new %.0f/s\n", ops / t_ref_dec, ops / t_dec);
+    if (mismatches) {
+        printf("batch: %d keys differ from the reference\n", mismatches);
+    }
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    long cases = argc > 1 ? atol(argv[1]) : 200000;
+    srand(3);
+
+    int failures = fuzz(cases);
+    failures += bench();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""
+Reference BIP-340 Schnorr signatures for the host harnesses.
+
+Usage:
+    bip340_ref.py vectors > schnorr_vectors.txt
+    ./build/schnorr_sign | bip340_ref.py check
+
+"vectors" writes the test vectors read by schnorr_verify.c: signatures from
+seeded keys, messages and aux randomness with one-bit forgeries of each,
+out-of-range and off-curve encodings, and NIP-01 events. The output is the
+same on every run.
+
+"check" reads harness output and independently verifies every line of the
+form "sign <seckey> <pubkey> <msg> <sig>" (the public key must match the
+secret key) and "event <json>" (the id must match the NIP-01 serialization).
+Other lines are passed through. Exits non-zero if anything fails.
+
+Plain Python integers, written for clarity, not speed.
+"""
+
+import hashlib
+import json
+import random
+import sys
+
+P = 2**256 - 2**32 - 977
+N = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141
+G = (0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798,
+     0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8)
+
+
+def point_add(a, b):
+    if a is None:
+        return b
+    if b is None:
+        return a
+    if a[0] == b[0] and a[1] != b[1]:
+        return None
+    if a == b:
+        lam = 3 * a[0] * a[0] * pow(2 * a[1], P - 2, P) % P
+    else:
+        lam = (b[1] - a[1]) * pow(b[0] - a[0], P - 2, P) % P
+    x = (lam * lam - a[0] - b[0]) % P
+    return (x, (lam * (a[0] - x) - a[1]) % P)
+
+
+def point_mul(point, k):
+    result = None
+    for i in range(256):
+        if (k >> i) & 1:
+            result = point_add(result, point)
+        point = point_add(point, point)
+    return result
+
+
+def b32(x):
+    return x.to_bytes(32, "big")
+
+
+def num(b):
+    return int.from_bytes(b, "big")
+
+
+def tagged_hash(tag, msg):
+    tag_hash = hashlib.sha256(tag.encode()).digest()
+    return hashlib.sha256(tag_hash + tag_hash + msg).digest()
+
+
+def lift_x(x):
+    if x >= P:
+        return None
+    y_sq = (pow(x, 3, P) + 7) % P
+    y = pow(y_sq, (P + 1) // 4, P)
+    if pow(y, 2, P) != y_sq:
+        return None
+    return (x, y if y % 2 == 0 else P - y)
+
+
+def pubkey(seckey):
+    return b32(point_mul(G, seckey)[0])
+
+
+def sign(seckey, msg, aux):
+    pub = point_mul(G, seckey)
+    d = seckey if pub[1] % 2 == 0 else N - seckey
+    t = bytes(x ^ y for x, y in zip(b32(d), tagged_hash("BIP0340/aux", aux)))
+    k0 = num(tagged_hash("BIP0340/nonce", t + b32(pub[0]) + msg)) % N
+    R = point_mul(G, k0)
+    k = k0 if R[1] % 2 == 0 else N - k0
+    e = num(tagged_hash("BIP0340/challenge", b32(R[0]) + b32(pub[0]) + msg)) % N
+    return b32(R[0]) + b32((k + e * d) % N)
+
+
+def verify(pub, msg, sig):
+    point = lift_x(num(pub))
+    r, s = num(sig[:32]), num(sig[32:])
+    if point is None or r >= P or s >= N:
+        return False
+    e = num(tagged_hash("BIP0340/challenge", sig[:32] + pub + msg)) % N
+    R = point_add(point_mul(G, s), point_mul(point, N - e))
+    return R is not None and R[1] % 2 == 0 and R[0] == r
+
+
+def event_id(event):
+    serialized = json.dumps([0, event["pubkey"], event["created_at"], event["kind"],
+                             event["tags"], event["content"]],
+                            separators=(",", ":"), ensure_ascii=False)
+    return hashlib.sha256(serialized.encode()).digest()
+
+
+def signed_event(seckey, aux, kind, created_at, tags, content):
+    event = {"pubkey": pubkey(seckey).hex(), "created_at": created_at, "kind": kind,
+             "tags": tags, "content": content}
+    eid = event_id(event)
+    event["id"] = eid.hex()
+    event["sig"] = sign(seckey, eid, aux).hex()
+    return event
+
+def raw_event(out, seckey, aux, created_at, kind):
+    pub = pubkey(seckey).hex()
+    content = json.dumps("x")
+    serialized = f'[0,"{pub}",{created_at},{kind},[],{content}]'
+    eid = hashlib.sha256(serialized.encode()).digest()
+    sig = sign(seckey, eid, aux).hex()
+    out.write(f'event 0 {{"id":"{eid.hex()}","pubkey":"{pub}","created_at":{created_at},'
+              f'"kind":{kind},"tags":[],"content":{content},"sig":"{sig}"}}\n')
+
+
+def flip_bit(data, bit):
+    out = bytearray(data)
+    out[bit // 8] ^= 1 << (bit % 8)
+    return bytes(out)
+
+
+def write_vectors(out):
+    rng = random.Random(340)
+
+    def rand_bytes(n):
+        return bytes(rng.getrandbits(8) for _ in range(n))
+
+    out.write("# BIP-340 vectors for schnorr_verify.c, written by bip340_ref.py vectors\n")
+    out.write("# sig <pubkey> <msg> <sig> <valid>\n")
+    out.write("# event <valid> <json>\n")
+
+    # BIP-340 test vector 0: secret key 3, zero message and aux
+    pub = pubkey(3)
+    out.write(f"sig {pub.hex()} {bytes(32).hex()} {sign(3, bytes(32), bytes(32)).hex()} 1\n")
+
+    for _ in range(24):
+        seckey = rng.randrange(1, N)
+        msg = rand_bytes(32)
+        pub = pubkey(seckey)
+        sig = sign(seckey, msg, rand_bytes(32))
+        out.write(f"sig {pub.hex()} {msg.hex()} {sig.hex()} 1\n")
+        forged = flip_bit(sig, rng.randrange(512))
+        out.write(f"sig {pub.hex()} {msg.hex()} {forged.hex()} {int(verify(pub, msg, forged))}\n")
+        other = flip_bit(msg, rng.randrange(256))
+        out.write(f"sig {pub.hex()} {other.hex()} {sig.hex()} 0\n")
+
+    # Encodings the verifier must reject before any curve arithmetic
+    seckey = rng.randrange(1, N)
+    msg = rand_bytes(32)
+    pub = pubkey(seckey)
+    sig = sign(seckey, msg, rand_bytes(32))
+    out.write(f"sig {pub.hex()} {msg.hex()} {(b32(P) + sig[32:]).hex()} 0\n")
+    out.write(f"sig {pub.hex()} {msg.hex()} {(sig[:32] + b32(N)).hex()} 0\n")
+    out.write(f"sig {b32(P).hex()} {msg.hex()} {sig.hex()} 0\n")
+    x = 5
+    while lift_x(x) is not None:
+        x += 1
+    out.write(f"sig {b32(x).hex()} {msg.hex()} {sig.hex()} 0\n")
+
+    # Events: forgeries first, since a verified id is cached and later
+    # copies with the same content are accepted without a signature check
+    seckey = rng.randrange(1, N)
+    event = signed_event(seckey, rand_bytes(32), 1, 1700000000, [["t", "geogram"]],
+                         "Hello \"mesh\"\n\té\U0001F600 \\ ok")
+    bad_content = dict(event, content=event["content"] + "!")
+    bad_sig = dict(event, sig=flip_bit(bytes.fromhex(event["sig"]), 300).hex())
+    bad_id = dict(event, id=flip_bit(bytes.fromhex(event["id"]), 7).hex())
+    for e, valid in ((bad_content, 0), (bad_sig, 0), (bad_id, 0), (event, 1)):
+        out.write(f"event {valid} {json.dumps(e, separators=(',', ':'), ensure_ascii=False)}\n")
+    plain = signed_event(rng.randrange(1, N), rand_bytes(32), 30078, 1700000123,
+                         [["d", "geogram-status"]], "{\"callsign\":\"X1ABCD\"}")
+    out.write(f"event 1 {json.dumps(plain, separators=(',', ':'))}\n")
+
+    # Integers outside JSON's grammar, signed over the serialization they
+    # would hash to, so only the number check can reject them
+    seckey = rng.randrange(1, N)
+    for created_at, kind in (("-", "1"), ("01700000000", "1"), ("1700000000", "-")):
+        raw_event(out, seckey, rand_bytes(32), created_at, kind)
+
+    # Valid events in other legal formatting: whitespace, members out of
+    # order, \uXXXX for non-ASCII and control characters, "\/" for "/".
+    # The id is still that of the canonical serialization.
+    event = signed_event(rng.randrange(1, N), rand_bytes(32), 1, 1700000456,
+                         [["t", "a/b"], ["client_time", "2026-01-01T00:00:00Z"]],
+                         "caf\u00e9 a/b\n\U0001F600 \"q\"")
+    bad_content = dict(event, content=event["content"].replace("a/b", "a/c"))
+    for e, valid in ((bad_content, 0), (event, 1)):
+        loose = {k: e[k] for k in ("sig", "content", "tags", "kind", "created_at", "pubkey", "id")}
+        text = json.dumps(loose, separators=(" , ", " : "))
+        text = text.replace("/", "\\/").replace("\\n", "\\u000A")
+        assert json.loads(text) == loose
+        out.write(f"event {valid} {text}\n")
+
+
+
+def check(lines):
+    failures = 0
+    checked = 0
+    for line in lines:
+        line = line.rstrip("\n")
+        kind, _, rest = line.partition(" ")
+        if kind == "sign":
+            seckey, pub, msg, sig = (bytes.fromhex(f) for f in rest.split())
+            ok = pubkey(num(seckey)) == pub and verify(pub, msg, sig)
+        elif kind == "event":
+            event = json.loads(rest)
+            eid = event_id(event)
+            ok = (eid.hex() == event["id"] and
+                  verify(bytes.fromhex(event["pubkey"]), eid, bytes.fromhex(event["sig"])))
+        else:
+            print(line)
+            continue
+        checked += 1
+        if not ok:
+            failures += 1
+            print(f"reference rejects: {line}")
+    print(f"reference: {checked} signatures checked, {failures} rejected")
+    return failures == 0 and checked > 0
+
+
+def main():
+    mode = sys.argv[1] if len(sys.argv) > 1 else ""
+    if mode == "vectors":
+        write_vectors(sys.stdout)
+    elif mode == "check":
+        sys.exit(0 if check(sys.stdin) else 1)
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,470 @@
+/**
+ * @file json_bench.c
+ * @brief Host cross-check and throughput comparison of json_tokenizer.c
+ *        against the strstr getters it replaced (json_ref.c)
+ *
+ * The corpus written by json_corpus.py is tokenized whole, then again fed
+ * in random 1-64 byte pieces; both times the tokens are turned back into
+ * the canonical form Python wrote and must match it byte for byte. Every
+ * top-level member is also looked up by key.
+ *
+ * The timing part reads the fields a relay needs from a WebSocket
+ * file_chunk frame and from a signed NOSTR event, once with the old
+ * getters and once with the tokenizer (whole and in 128-byte chunks). The
+ * two must agree on these messages, which the old getters handle.
+ *
+ * Usage:
+ *     make json                               # 3000 documents
+ *     ./build/json_bench corpus.txt [rounds]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "json_tokenizer.h"
+
+bool json_ref_get_field_string(const char *json, const char *field, char *output, size_t output_size);
+bool json_ref_get_field_int(const char *json, const char *field, int *output);
+bool json_ref_get_tag_value(const char *json, const char *tag_key, char *output, size_t output_size);
+bool json_ref_ws_get_string(const char *json, const char *key, char *value, size_t value_len);
+
+#define MAX_TOKENS      2048
+#define BENCH_ROUNDS    200000
+#define BENCH_CHUNK     128     // Streaming feed size, like a short httpd_req_recv()
+#define BENCH_DATA_LEN  1024    // Base64 payload of the sample file chunk
+
+static geo_json_token_t s_tokens[MAX_TOKENS];
+
+static double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// ============================================================================
+// Corpus cross-check
+// ============================================================================
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} text_t;
+
+static void put(text_t *t, const char *s, size_t n)
+{
+    if (t->len + n + 1 > t->cap) {
+        t->cap = (t->len + n + 1) * 2;
+        t->data = realloc(t->data, t->cap);
+        if (t->data == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    memcpy(t->data + t->len, s, n);
+    t->len += n;
+    t->data[t->len] = '\0';
+}
+
+static bool put_string(text_t *t, const char *js, const geo_json_token_t *tok)
+{
+    size_t raw = (size_t)(tok->end - tok->start);
+    char *buf = malloc(raw + 1);
+    int n = geo_json_token_to_string(js, tok, buf, raw + 1);
+    if (n < 0 || (size_t)n > raw) {
+        free(buf);
+        return false;
+    }
+
+    put(t, "\"", 1);
+    for (int i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)buf[i];
+        char esc[8];
+        if (c == '"' || c == '\\') {
+            esc[0] = '\\';
+            esc[1] = (char)c;
+            put(t, esc, 2);
+        } else if (c < 0x20) {
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            put(t, esc, 6);
+        } else {
+            put(t, (const char *)&c, 1);
+        }
+    }
+    put(t, "\"", 1);
+    free(buf);
+    return true;
+}
+
+/**
+ * @brief Write the value at index in canonical form
+ *
+ * @return Index of the next value, or -1 if the tokens are inconsistent
+ */
+static int canon(text_t *t, const char *js, const geo_json_token_t *tokens, int count, int index)
+{
+    if (index < 0 || index >= count) {
+        return -1;
+    }
+    const geo_json_token_t *tok = &tokens[index];
+    switch (tok->type) {
+        case GEO_JSON_STRING:
+            return put_string(t, js, tok) ? index + 1 : -1;
+        case GEO_JSON_PRIMITIVE:
+            put(t, js + tok->start, (size_t)(tok->end - tok->start));
+            return index + 1;
+        case GEO_JSON_OBJECT:
+        case GEO_JSON_ARRAY: {
+            bool object = tok->type == GEO_JSON_OBJECT;
+            put(t, object ? "{" : "[", 1);
+            int i = index + 1;
+            for (int n = 0; n < tok->size; n++) {
+                if (n > 0) {
+                    put(t, ",", 1);
+                }
+                if (object) {
+                    if (i >= count || tokens[i].type != GEO_JSON_STRING || tokens[i].size != 1 ||
+                        !put_string(t, js, &tokens[i])) {
+                        return -1;
+                    }
+                    put(t, ":", 1);
+                    i++;
+                }
+                i = canon(t, js, tokens, count, i);
+                if (i < 0) {
+                    return -1;
+                }
+            }
+            put(t, object ? "}" : "]", 1);
+            return i;
+        }
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief Check that every top-level member is found under its key
+ */
+static bool check_lookups(const char *js, int count)
+{
+    if (s_tokens[0].type != GEO_JSON_OBJECT) {
+        return true;
+    }
+    int i = 1;
+    for (int n = 0; n < s_tokens[0].size; n++) {
+        size_t raw = (size_t)(s_tokens[i].end - s_tokens[i].start);
+        char *key = malloc(raw + 1);
+        int len = geo_json_token_to_string(js, &s_tokens[i], key, raw + 1);
+        // Keys with escapes or NULs can't be passed as C strings
+        bool plain = len == (int)raw && memchr(key, '\0', (size_t)len) == NULL;
+        if (plain) {
+            // A repeated key resolves to its first occurrence
+            int found = geo_json_object_get(js, s_tokens, count, 0, key);
+            int first = 1;
+            while (!geo_json_token_equals(js, &s_tokens[first], key)) {
+                first = geo_json_next(s_tokens, count, first);
+            }
+            if (found != first + 1) {
+                free(key);
+                return false;
+            }
+        }
+        free(key);
+        i = geo_json_next(s_tokens, count, i);
+    }
+    return true;
+}
+
+static int check_doc(const char *doc, size_t len, const char *expected, bool chunked)
+{
+    geo_json_parser_t parser;
+    geo_json_parser_init(&parser, 0);
+
+    int count = GEO_JSON_ERROR_PART;
+    if (!chunked) {
+        count = geo_json_parse(&parser, doc, len, s_tokens, MAX_TOKENS);
+    } else {
+        for (size_t got = 0; count == GEO_JSON_ERROR_PART && got < len; ) {
+            got += (size_t)(rand() % 64 + 1);
+            if (got > len) {
+                got = len;
+            }
+            count = geo_json_parse(&parser, doc, got, s_tokens, MAX_TOKENS);
+        }
+    }
+    if (count < 1) {
+        return count < 0 ? count : -100;
+    }
+
+    text_t t = { 0 };
+    put(&t, "", 0);
+    int end = canon(&t, doc, s_tokens, count, 0);
+    bool ok = end == count && strcmp(t.data, expected) == 0 && check_lookups(doc, count);
+    free(t.data);
+    return ok ? 0 : -101;
+}
+
+static int corpus(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    char *doc = NULL, *expected = NULL;
+    size_t doc_cap = 0, expected_cap = 0;
+    int docs = 0, mismatches = 0;
+    ssize_t doc_len;
+    while ((doc_len = getline(&doc, &doc_cap, f)) > 0) {
+        ssize_t expected_len = getline(&expected, &expected_cap, f);
+        if (expected_len <= 0) {
+            printf("corpus: %s ends after a document\n", path);
+            mismatches++;
+            break;
+        }
+        doc[--doc_len] = '\0';
+        expected[expected_len - 1] = '\0';
+        docs++;
+
+        for (int chunked = 0; chunked < 2; chunked++) {
+            int ret = check_doc(doc, (size_t)doc_len, expected, chunked);
+            if (ret != 0 && mismatches++ < 5) {
+                printf("%s mismatch (%d): %s\n", chunked ? "chunked" : "whole", ret, doc);
+            }
+        }
+    }
+    free(doc);
+    free(expected);
+    fclose(f);
+
+    printf("corpus: %d documents, whole and chunked, %d mismatches\n", docs, mismatches);
+    return docs == 0 || mismatches;
+}
+
+// ============================================================================
+// Field lookups: old getters against the tokenizer
+// ============================================================================
+
+// Fields a WebSocket relay reads from a file_chunk frame
+static const char *const k_frame_fields[] = { "type", "to", "sha1", "from", "seq" };
+#define FRAME_FIELDS    (sizeof(k_frame_fields) / sizeof(k_frame_fields[0]))
+
+// String fields of a signed event
+static const char *const k_event_fields[] = { "id", "pubkey", "content", "sig" };
+#define EVENT_FIELDS    (sizeof(k_event_fields) / sizeof(k_event_fields[0]))
+
+typedef struct {
+    char strings[FRAME_FIELDS > EVENT_FIELDS ? FRAME_FIELDS : EVENT_FIELDS][160];
+    int created_at;
+    int kind;
+    char tag[80];
+} fields_t;
+
+static int build_frame(char *frame, size_t size)
+{
+    // Signaling fields around a base64 payload, as sent by the file-sharing page
+    int len = snprintf(frame, size, "{\"type\":\"file_chunk\","
+                       "\"sha1\":\"2fd4e1c67a2d28fced849ee1bb76e7391b93eb12\",\"data\":\"");
+    for (int i = 0; i < BENCH_DATA_LEN; i++) {
+        frame[len++] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i % 64];
+    }
+    len += snprintf(frame + len, size - (size_t)len, "\",\"from\":\"X1ABCD\",\"to\":\"X1WXYZ\",\"seq\":42}");
+    return len;
+}
+
+static int build_event(char *event, size_t size)
+{
+    return snprintf(event, size,
+        "{\"id\":\"4376c65d2f232afbe9b882a35baa4f6fe8667c4e684749af565f981833ed6a65\","
+        "\"pubkey\":\"6e468422dfb74a5738702a8823b9b28168abab8655faacb6853cd0ee15deee93\","
+        "\"created_at\":1673347337,\"kind\":1,"
+        "\"tags\":[[\"e\",\"3da979448d9ba263864c4d6f14984c423a3838364ec255f03c7904b1ae77f206\"],"
+        "[\"p\",\"bf2376e17ba4ec269d10fcc996a4746b451152be9031fa48e74553dde5526bce\"]],"
+        "\"content\":\"Walled gardens became prisons, and nostr is the first step towards tearing down the prison walls.\","
+        "\"sig\":\"908a15e46fb4d8675bab026fc230a0e3542bfade63da02d542fb78b2a8513fcd"
+        "0092619a2c8c1221e581946e0191f2af505dfdf8657a414dbca329186f009262\"}");
+}
+
+static void frame_ref(const char *frame, fields_t *out)
+{
+    for (size_t f = 0; f < FRAME_FIELDS; f++) {
+        json_ref_ws_get_string(frame, k_frame_fields[f], out->strings[f], sizeof(out->strings[f]));
+    }
+}
+
+static void token_field(const char *js, int count, int index, char *out, size_t out_size)
+{
+    out[0] = '\0';
+    if (index < 0) {
+        return;
+    }
+    if (s_tokens[index].type == GEO_JSON_STRING) {
+        geo_json_token_to_string(js, &s_tokens[index], out, out_size);
+    } else {
+        snprintf(out, out_size, "%.*s", s_tokens[index].end - s_tokens[index].start,
+                 js + s_tokens[index].start);
+    }
+}
+
+static bool frame_tokens(const char *frame, int len, size_t chunk, fields_t *out)
+{
+    geo_json_parser_t parser;
+    geo_json_parser_init(&parser, 2);
+    int count = GEO_JSON_ERROR_PART;
+    for (int got = 0; count == GEO_JSON_ERROR_PART && got < len; ) {
+        got = got + (int)chunk < len ? got + (int)chunk : len;
+        count = geo_json_parse(&parser, frame, (size_t)got, s_tokens, MAX_TOKENS);
+    }
+    if (count < 1) {
+        return false;
+    }
+    for (size_t f = 0; f < FRAME_FIELDS; f++) {
+        int i = geo_json_object_get(frame, s_tokens, count, 0, k_frame_fields[f]);
+        token_field(frame, count, i, out->strings[f], sizeof(out->strings[f]));
+    }
+    return true;
+}
+
+static void event_ref(const char *event, fields_t *out)
+{
+    for (size_t f = 0; f < EVENT_FIELDS; f++) {
+        json_ref_get_field_string(event, k_event_fields[f], out->strings[f], sizeof(out->strings[f]));
+    }
+    json_ref_get_field_int(event, "created_at", &out->created_at);
+    json_ref_get_field_int(event, "kind", &out->kind);
+    json_ref_get_tag_value(event, "p", out->tag, sizeof(out->tag));
+}
+
+static bool event_tokens(const char *event, int len, size_t chunk, fields_t *out)
+{
+    geo_json_parser_t parser;
+    geo_json_parser_init(&parser, 0);
+    int count = GEO_JSON_ERROR_PART;
+    for (int got = 0; count == GEO_JSON_ERROR_PART && got < len; ) {
+        got = got + (int)chunk < len ? got + (int)chunk : len;
+        count = geo_json_parse(&parser, event, (size_t)got, s_tokens, MAX_TOKENS);
+    }
+    if (count < 1) {
+        return false;
+    }
+    for (size_t f = 0; f < EVENT_FIELDS; f++) {
+        int i = geo_json_object_get(event, s_tokens, count, 0, k_event_fields[f]);
+        token_field(event, count, i, out->strings[f], sizeof(out->strings[f]));
+    }
+    int i = geo_json_object_get(event, s_tokens, count, 0, "created_at");
+    if (i < 0 || !geo_json_token_to_int(event, &s_tokens[i], &out->created_at)) {
+        return false;
+    }
+    i = geo_json_object_get(event, s_tokens, count, 0, "kind");
+    if (i < 0 || !geo_json_token_to_int(event, &s_tokens[i], &out->kind)) {
+        return false;
+    }
+
+    // First ["p", value] entry of the tags array
+    out->tag[0] = '\0';
+    int tags = geo_json_object_get(event, s_tokens, count, 0, "tags");
+    if (tags < 0 || s_tokens[tags].type != GEO_JSON_ARRAY) {
+        return false;
+    }
+    int t = tags + 1;
+    for (int n = 0; n < s_tokens[tags].size; n++) {
+        if (s_tokens[t].type == GEO_JSON_ARRAY && s_tokens[t].size >= 2 &&
+            geo_json_token_equals(event, &s_tokens[t + 1], "p")) {
+            geo_json_token_to_string(event, &s_tokens[t + 2], out->tag, sizeof(out->tag));
+            break;
+        }
+        t = geo_json_next(s_tokens, count, t);
+    }
+    return true;
+}
+
+static void print_rate(const char *label, int rounds, double seconds)
+{
+    printf("%-16s %7.2f us/msg %10.0f msgs/s\n", label, seconds * 1e6 / rounds, rounds / seconds);
+}
+
+static int bench(int rounds)
+{
+    static char frame[BENCH_DATA_LEN + 256];
+    static char event[1024];
+    int frame_len = build_frame(frame, sizeof(frame));
+    int event_len = build_event(event, sizeof(event));
+    static const size_t chunks[] = { 0, BENCH_CHUNK, 7, 1 };    // 0: whole message
+    fields_t ref, out;
+    int mismatches = 0;
+
+    // Both approaches must agree before timing them
+    memset(&ref, 0, sizeof(ref));
+    frame_ref(frame, &ref);
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        size_t chunk = chunks[c] ? chunks[c] : (size_t)frame_len;
+        memset(&out, 0, sizeof(out));
+        if (!frame_tokens(frame, frame_len, chunk, &out) || memcmp(&ref, &out, sizeof(ref)) != 0) {
+            printf("frame: fields differ (chunk %zu)\n", chunk);
+            mismatches++;
+        }
+    }
+    memset(&ref, 0, sizeof(ref));
+    event_ref(event, &ref);
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        size_t chunk = chunks[c] ? chunks[c] : (size_t)event_len;
+        memset(&out, 0, sizeof(out));
+        if (!event_tokens(event, event_len, chunk, &out) || memcmp(&ref, &out, sizeof(ref)) != 0) {
+            printf("event: fields differ (chunk %zu)\n", chunk);
+            mismatches++;
+        }
+    }
+
+    printf("file_chunk frame, %d bytes, %u fields\n", frame_len, (unsigned)FRAME_FIELDS);
+    clock_t start = clock();
+    for (int r = 0; r < rounds; r++) {
+        frame_ref(frame, &out);
+    }
+    print_rate("  strstr", rounds, elapsed(start));
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        frame_tokens(frame, frame_len, (size_t)frame_len, &out);
+    }
+    print_rate("  tokens", rounds, elapsed(start));
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        frame_tokens(frame, frame_len, BENCH_CHUNK, &out);
+    }
+    print_rate("  tokens chunked", rounds, elapsed(start));
+
+    printf("signed event, %d bytes, %u fields and a tag\n", event_len, (unsigned)EVENT_FIELDS + 2);
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        event_ref(event, &out);
+    }
+    print_rate("  strstr", rounds, elapsed(start));
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        event_tokens(event, event_len, (size_t)event_len, &out);
+    }
+    print_rate("  tokens", rounds, elapsed(start));
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        event_tokens(event, event_len, BENCH_CHUNK, &out);
+    }
+    print_rate("  tokens chunked", rounds, elapsed(start));
+
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s corpus.txt [rounds]\n", argv[0]);
+        return 2;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : BENCH_ROUNDS;
+    srand(5);
+
+    int failures = corpus(argv[1]);
+    failures += bench(rounds > 0 ? rounds : BENCH_ROUNDS);
+    return failures ? 1 : 0;
+}
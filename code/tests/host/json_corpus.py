@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Random JSON documents for the tokenizer cross-check in json_bench.c.
+
+Usage:
+    json_corpus.py [count] [seed] > build/json_corpus.txt
+
+Each document takes two lines. The first is the document as json.dumps()
+writes it, with random separators and ASCII escaping. The second is the
+same value in the canonical form json_bench.c rebuilds from the tokens:
+no whitespace, members in document order, strings with only '"', '\\' and
+control characters escaped (as \\u00XX) and everything else as raw UTF-8,
+numbers, true, false and null as written in the document.
+
+Every document is read back with Python's json module and must give the
+value it was written from, so the module is the judge of what the
+document means. The top level is always an object or an array. The output
+is the same on every run for a given seed.
+"""
+
+import json
+import random
+import sys
+
+# Characters a string is drawn from: plain text, everything JSON escapes,
+# two- three- and four-byte UTF-8 (the last needs a surrogate pair as \\u)
+ALPHABET = (list("abcdefghijklmnopqrstuvwxyz ABCXYZ0123456789-_.:,{}[]")
+            + ['"', "\\", "/", "\n", "\r", "\t", "\b", "\f", "\x01", "\x1f", "\x7f", "\x00"]
+            + ["é", "ß", "中", "€", "\U0001F600", "\U00010348"])
+KEYS = ["id", "type", "pubkey", "content", "tags", "sig", "kind", "created_at",
+        "a", "b", "x y", "k\"q", "über", "", "data", "seq"]
+
+
+def random_string(rng):
+    return "".join(rng.choice(ALPHABET) for _ in range(rng.randrange(0, 24)))
+
+
+def random_number(rng):
+    kind = rng.randrange(5)
+    if kind == 0:
+        return rng.randrange(-10, 10)
+    if kind == 1:
+        return rng.randrange(-2**63, 2**64)
+    if kind == 2:
+        return rng.uniform(-1000, 1000)
+    if kind == 3:
+        return rng.uniform(-1, 1) * 10.0 ** rng.randrange(-30, 30)
+    return float(rng.randrange(-5, 5))
+
+
+def random_value(rng, depth):
+    kind = rng.randrange(8 if depth < 4 else 6)
+    if kind == 0:
+        return random_string(rng)
+    if kind == 1:
+        return random_number(rng)
+    if kind == 2:
+        return rng.choice([True, False])
+    if kind == 3:
+        return None
+    if kind in (4, 5):
+        return random_string(rng) if depth >= 4 else random_container(rng, depth + 1)
+    return random_container(rng, depth + 1)
+
+
+def random_container(rng, depth):
+    n = rng.randrange(0, 7)
+    if rng.randrange(2):
+        return [random_value(rng, depth) for _ in range(n)]
+    obj = {}
+    for _ in range(n):
+        key = rng.choice(KEYS) if rng.randrange(2) else random_string(rng)
+        obj[key] = random_value(rng, depth)
+    return obj
+
+
+def canon_string(s):
+    out = []
+    for c in s:
+        if c == '"':
+            out.append('\\"')
+        elif c == "\\":
+            out.append("\\\\")
+        elif ord(c) < 0x20:
+            out.append("\\u%04x" % ord(c))
+        else:
+            out.append(c)
+    return '"' + "".join(out) + '"'
+
+
+def canon(value):
+    if isinstance(value, dict):
+        return "{" + ",".join(canon_string(k) + ":" + canon(v) for k, v in value.items()) + "}"
+    if isinstance(value, list):
+        return "[" + ",".join(canon(v) for v in value) + "]"
+    if isinstance(value, str):
+        return canon_string(value)
+    return json.dumps(value)
+
+
+def main():
+    count = int(sys.argv[1]) if len(sys.argv) > 1 else 3000
+    rng = random.Random(int(sys.argv[2]) if len(sys.argv) > 2 else 1)
+    out = sys.stdout.buffer
+
+    for _ in range(count):
+        value = random_container(rng, 0)
+        separators = rng.choice([(",", ":"), (", ", ": "), (" ,", " :  ")])
+        doc = json.dumps(value, ensure_ascii=bool(rng.randrange(2)), separators=separators)
+        if json.loads(doc) != value:
+            sys.exit("json module disagrees with itself on %r" % doc)
+        out.write(doc.encode("utf-8") + b"\n")
+        out.write(canon(value).encode("utf-8") + b"\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,168 @@
+/**
+ * @file json_ref.c
+ * @brief Previous strstr field getters, kept as the reference for json_bench.c
+ *
+ * These are geo_json_get_field_string/_int and geo_json_get_tag_value from
+ * geogram_json/json_utils.c, and json_get_string from geogram_ws/ws_server.c,
+ * as they were before the tokenizer replaced them, renamed so they can be
+ * linked next to it. Do not fix or speed them up: their value is being the
+ * old behavior.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Simple JSON field extraction (no full parser, just string search)
+bool json_ref_get_field_string(const char *json, const char *field, char *output, size_t output_size) {
+    if (!json || !field || !output || output_size == 0) {
+        return false;
+    }
+
+    // Build search pattern: "field":"
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", field);
+
+    const char *start = strstr(json, pattern);
+    if (!start) {
+        return false;
+    }
+
+    start += strlen(pattern);
+
+    // Find end quote (handle escaped quotes)
+    const char *end = start;
+    while (*end && *end != '"') {
+        if (*end == '\\' && *(end + 1)) {
+            end += 2;  // Skip escaped char
+        } else {
+            end++;
+        }
+    }
+
+    size_t len = end - start;
+    if (len >= output_size) {
+        len = output_size - 1;
+    }
+
+    strncpy(output, start, len);
+    output[len] = '\0';
+
+    return true;
+}
+
+bool json_ref_get_field_int(const char *json, const char *field, int *output) {
+    if (!json || !field || !output) {
+        return false;
+    }
+
+    // Build search pattern: "field":
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", field);
+
+    const char *start = strstr(json, pattern);
+    if (!start) {
+        return false;
+    }
+
+    start += strlen(pattern);
+
+    // Skip whitespace
+    while (*start == ' ' || *start == '\t') {
+        start++;
+    }
+
+    *output = atoi(start);
+    return true;
+}
+
+// Extract value from tags array: [["key", "value"], ["key2", "value2"]]
+bool json_ref_get_tag_value(const char *json, const char *tag_key, char *output, size_t output_size) {
+    if (!json || !tag_key || !output || output_size == 0) {
+        return false;
+    }
+
+    // Find "tags": array
+    const char *tags = strstr(json, "\"tags\":");
+    if (!tags) {
+        return false;
+    }
+
+    // Build search pattern: ["key","
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "[\"%s\",\"", tag_key);
+
+    const char *start = strstr(tags, pattern);
+    if (!start) {
+        // Try alternate format: ["key", " (with space)
+        snprintf(pattern, sizeof(pattern), "[\"%s\", \"", tag_key);
+        start = strstr(tags, pattern);
+        if (!start) {
+            return false;
+        }
+    }
+
+    // Find the value after the key
+    start = strchr(start + 2, ',');  // Skip past key
+    if (!start) {
+        return false;
+    }
+
+    // Skip to opening quote of value
+    start = strchr(start, '"');
+    if (!start) {
+        return false;
+    }
+    start++;  // Skip the quote
+
+    // Find closing quote
+    const char *end = strchr(start, '"');
+    if (!end) {
+        return false;
+    }
+
+    size_t len = end - start;
+    if (len >= output_size) {
+        len = output_size - 1;
+    }
+
+    strncpy(output, start, len);
+    output[len] = '\0';
+
+    return true;
+}
+
+// Simple JSON helper to extract string value
+bool json_ref_ws_get_string(const char *json, const char *key, char *value, size_t value_len)
+{
+    char search[64];
+    snprintf(search, sizeof(search), "\"%s\":\"", key);
+    const char *pos = strstr(json, search);
+    if (!pos) {
+        // Try without quotes for non-string values
+        snprintf(search, sizeof(search), "\"%s\":", key);
+        pos = strstr(json, search);
+        if (!pos) return false;
+        pos += strlen(search);
+        while (*pos == ' ') pos++;
+        // Copy until comma, brace, or bracket
+        size_t i = 0;
+        while (*pos && *pos != ',' && *pos != '}' && *pos != ']' && i < value_len - 1) {
+            value[i++] = *pos++;
+        }
+        value[i] = '\0';
+        return i > 0;
+    }
+
+    pos += strlen(search);
+    size_t i = 0;
+    while (*pos && *pos != '"' && i < value_len - 1) {
+        if (*pos == '\\' && pos[1]) {
+            pos++;
+        }
+        value[i++] = *pos++;
+    }
+    value[i] = '\0';
+    return true;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file schnorr_sign.c
+ * @brief Host check and throughput of BIP-340 signing (nostr_schnorr.c, nostr_event.c)
+ *
+ * Signs messages under seeded keys, plus the edge keys 1 and n-1, and
+ * events with nostr_sign_event(). Each result must pass the firmware's
+ * own verifier, and is printed as a "sign" or "event" line for
+ * bip340_ref.py to verify independently. Then it times nostr_schnorr_sign()
+ * and nostr_sign_event() against nostr_schnorr_verify().
+ *
+ * Usage:
+ *     make sign                   # piped through bip340_ref.py check
+ *     ./build/schnorr_sign [keys] [rounds]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "nostr_event.h"
+#include "nostr_schnorr.h"
+
+#define EVENT_JSON_LEN  1024
+
+// n - 1, the largest valid secret key
+static const uint8_t k_max_seckey[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+    0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x40
+};
+
+static void print_hex(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", data[i]);
+    }
+}
+
+static void random_bytes(uint8_t *out, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (uint8_t)rand();
+    }
+}
+
+static int check_key(const uint8_t *seckey, int messages)
+{
+    uint8_t pubkey[32];
+    if (nostr_schnorr_set_signing_key(seckey, pubkey) != ESP_OK) {
+        printf("set_signing_key failed\n");
+        return 1;
+    }
+
+    int failures = 0;
+    for (int m = 0; m < messages; m++) {
+        uint8_t msg[32], sig[64];
+        random_bytes(msg, sizeof(msg));
+        if (nostr_schnorr_sign(msg, sig) != ESP_OK || nostr_schnorr_verify(sig, msg, pubkey) != ESP_OK) {
+            printf("sign/verify failed\n");
+            failures++;
+            continue;
+        }
+        printf("sign ");
+        print_hex(seckey, 32);
+        printf(" ");
+        print_hex(pubkey, 32);
+        printf(" ");
+        print_hex(msg, 32);
+        printf(" ");
+        print_hex(sig, 64);
+        printf("\n");
+    }
+    return failures;
+}
+
+static int check_events(void)
+{
+    static const char *const contents[] = {
+        "Hello \"mesh\"\n\tx\x01 \xc3\xa9\xf0\x9f\x98\x80 \\ ok",
+        "{\"callsign\":\"X1ABCD\",\"uptime\":0}",
+        "",
+    };
+    char json[EVENT_JSON_LEN];
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(contents) / sizeof(contents[0]); i++) {
+        if (nostr_sign_event(1, 1700000000 + (int64_t)i, "[[\"t\",\"geogram\"]]", contents[i],
+                             json, sizeof(json)) != ESP_OK ||
+            nostr_event_verify_json(json, NULL) != ESP_OK) {
+            printf("sign_event %zu failed\n", i);
+            failures++;
+            continue;
+        }
+        printf("event %s\n", json);
+    }
+
+    // Tags as a caller may write them; the id is over their canonical form
+    if (nostr_sign_event(1, 1700000100, "[ [\"t\" , \"a\\/b\"] ]", "tags", json, sizeof(json)) != ESP_OK ||
+        nostr_event_verify_json(json, NULL) != ESP_OK) {
+        printf("sign_event with spaced tags failed\n");
+        failures++;
+    } else {
+        printf("event %s\n", json);
+    }
+
+    // Too small a buffer must fail cleanly
+    if (nostr_sign_event(1, 0, NULL, "x", json, 100) != ESP_ERR_INVALID_SIZE) {
+        printf("sign_event accepted a short buffer\n");
+        failures++;
+    }
+    return failures;
+}
+
+static void print_rate(const char *label, int count, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    printf("bench %-10s %8.0f/s\n", label, (double)count * 1000000.0 / (double)elapsed_us);
+}
+
+static void bench(int rounds)
+{
+    uint8_t pubkey[32], msg[32] = { 0 }, sig[64];
+    char json[EVENT_JSON_LEN];
+    nostr_schnorr_get_signing_pubkey(pubkey);
+
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        msg[0] = (uint8_t)r;
+        msg[1] = (uint8_t)(r >> 8);
+        nostr_schnorr_sign(msg, sig);
+    }
+    print_rate("sign", rounds, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        nostr_sign_event(30078, 1700000000 + r, "[[\"d\",\"geogram-status\"]]",
+                         "{\"callsign\":\"X1ABCD\"}", json, sizeof(json));
+    }
+    print_rate("sign_event", rounds, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        nostr_schnorr_verify(sig, msg, pubkey);
+    }
+    print_rate("verify", rounds, esp_timer_get_time() - start);
+}
+
+int main(int argc, char **argv)
+{
+    int keys = argc > 1 ? atoi(argv[1]) : 16;
+    int rounds = argc > 2 ? atoi(argv[2]) : 2000;
+    srand(53);
+
+    if (nostr_schnorr_init() != ESP_OK || nostr_event_init() != ESP_OK) {
+        printf("init failed\n");
+        return 1;
+    }
+
+    uint8_t seckey[32] = { 0 };
+    seckey[31] = 1;
+    int failures = check_key(seckey, 2);
+    failures += check_key(k_max_seckey, 2);
+    for (int k = 0; k < keys; k++) {
+        random_bytes(seckey, sizeof(seckey));
+        failures += check_key(seckey, 4);
+    }
+    failures += check_events();
+    printf("signing: %d failures\n", failures);
+
+    bench(rounds > 0 ? rounds : 1);
+    return failures ? 1 : 0;
+}
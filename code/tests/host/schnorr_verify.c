@@ -0,0 +1,213 @@
+/**
+ * @file schnorr_verify.c
+ * @brief Host check and throughput of BIP-340 verification (nostr_schnorr.c, nostr_event.c)
+ *
+ * Every vector in schnorr_vectors.txt (written by bip340_ref.py) is checked
+ * with nostr_schnorr_verify() and again through nostr_schnorr_verify_batch()
+ * in batches of NOSTR_VERIFY_BATCH_MAX; the event lines go through
+ * nostr_event_verify_json(). Then it times verification of one signature
+ * repeatedly (the key stays in the lifted-key cache, as with "nostr bench"
+ * on the device) and of batches of distinct keys against single checks.
+ *
+ * Usage:
+ *     make schnorr
+ *     ./build/schnorr_verify [vectors] [rounds]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "nostr_event.h"
+#include "nostr_schnorr.h"
+
+#define MAX_VECTORS     128
+#define MAX_EVENTS      16
+#define EVENT_JSON_LEN  1024
+
+typedef struct {
+    uint8_t pubkey[32];
+    uint8_t msg[32];
+    uint8_t sig[64];
+    bool valid;
+} vector_t;
+
+typedef struct {
+    char json[EVENT_JSON_LEN];
+    bool valid;
+} event_vector_t;
+
+static vector_t s_vectors[MAX_VECTORS];
+static event_vector_t s_events[MAX_EVENTS];
+static int s_vector_count;
+static int s_event_count;
+
+static bool parse_hex(const char *hex, uint8_t *out, size_t len)
+{
+    if (strlen(hex) != len * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            return false;
+        }
+        out[i] = (uint8_t)byte;
+    }
+    return true;
+}
+
+static bool load_vectors(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+
+    static char line[EVENT_JSON_LEN + 16];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') {
+            continue;
+        }
+
+        if (strncmp(line, "sig ", 4) == 0 && s_vector_count < MAX_VECTORS) {
+            char pubkey[80], msg[80], sig[144];
+            int valid;
+            vector_t *v = &s_vectors[s_vector_count++];
+            ok = sscanf(line + 4, "%79s %79s %143s %d", pubkey, msg, sig, &valid) == 4 &&
+                 parse_hex(pubkey, v->pubkey, 32) && parse_hex(msg, v->msg, 32) &&
+                 parse_hex(sig, v->sig, 64);
+            v->valid = valid != 0;
+        } else if (strncmp(line, "event ", 6) == 0 && s_event_count < MAX_EVENTS) {
+            event_vector_t *e = &s_events[s_event_count++];
+            e->valid = line[6] == '1';
+            ok = line[7] == ' ' && strlen(line + 8) < sizeof(e->json);
+            if (ok) {
+                strcpy(e->json, line + 8);
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printf("%s: bad line: %.60s\n", path, line);
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+static int check_vectors(void)
+{
+    int mismatches = 0;
+
+    for (int i = 0; i < s_vector_count; i++) {
+        const vector_t *v = &s_vectors[i];
+        bool ok = nostr_schnorr_verify(v->sig, v->msg, v->pubkey) == ESP_OK;
+        if (ok != v->valid) {
+            printf("verify: vector %d %s\n", i, ok ? "accepted" : "rejected");
+            mismatches++;
+        }
+    }
+
+    for (int i = 0; i < s_vector_count; i += NOSTR_VERIFY_BATCH_MAX) {
+        nostr_schnorr_item_t items[NOSTR_VERIFY_BATCH_MAX];
+        esp_err_t results[NOSTR_VERIFY_BATCH_MAX];
+        int n = s_vector_count - i < NOSTR_VERIFY_BATCH_MAX ? s_vector_count - i : NOSTR_VERIFY_BATCH_MAX;
+        for (int j = 0; j < n; j++) {
+            items[j].sig = s_vectors[i + j].sig;
+            items[j].msg = s_vectors[i + j].msg;
+            items[j].pubkey = s_vectors[i + j].pubkey;
+        }
+        nostr_schnorr_verify_batch(items, n, results);
+        for (int j = 0; j < n; j++) {
+            bool ok = results[j] == ESP_OK;
+            if (ok != s_vectors[i + j].valid) {
+                printf("batch: vector %d %s\n", i + j, ok ? "accepted" : "rejected");
+                mismatches++;
+            }
+        }
+    }
+
+    for (int i = 0; i < s_event_count; i++) {
+        nostr_event_t event;
+        esp_err_t ret = nostr_event_verify_json(s_events[i].json, &event);
+        if ((ret == ESP_OK) != s_events[i].valid) {
+            printf("event %d: result %d\n", i, ret);
+            mismatches++;
+        }
+    }
+
+    printf("vectors: %d signatures, %d events, %d mismatches\n",
+           s_vector_count, s_event_count, mismatches);
+    return mismatches;
+}
+
+static void print_rate(const char *label, int count, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    printf("%-14s %8.0f/s\n", label, (double)count * 1000000.0 / (double)elapsed_us);
+}
+
+static void bench(int rounds)
+{
+    // Valid vectors with distinct keys, as a burst from several chat users would be
+    nostr_schnorr_item_t items[NOSTR_VERIFY_BATCH_MAX];
+    esp_err_t results[NOSTR_VERIFY_BATCH_MAX];
+    int n = 0;
+    for (int i = 0; i < s_vector_count && n < NOSTR_VERIFY_BATCH_MAX; i++) {
+        if (s_vectors[i].valid) {
+            items[n].sig = s_vectors[i].sig;
+            items[n].msg = s_vectors[i].msg;
+            items[n].pubkey = s_vectors[i].pubkey;
+            n++;
+        }
+    }
+    if (n == 0) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        nostr_schnorr_verify(items[0].sig, items[0].msg, items[0].pubkey);
+    }
+    print_rate("verify", rounds, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int r = 0; r < rounds / n; r++) {
+        for (int i = 0; i < n; i++) {
+            nostr_schnorr_verify(items[i].sig, items[i].msg, items[i].pubkey);
+        }
+    }
+    print_rate("verify x8 keys", rounds / n * n, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int r = 0; r < rounds / n; r++) {
+        nostr_schnorr_verify_batch(items, n, results);
+    }
+    print_rate("batch of 8", rounds / n * n, esp_timer_get_time() - start);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "schnorr_vectors.txt";
+    int rounds = argc > 2 ? atoi(argv[2]) : 2000;
+    srand(51);
+
+    if (nostr_schnorr_init() != ESP_OK || nostr_event_init() != ESP_OK) {
+        printf("init failed\n");
+        return 1;
+    }
+    if (!load_vectors(path)) {
+        return 1;
+    }
+
+    int failures = check_vectors();
+    bench(rounds > 0 ? rounds : 1);
+    return failures ? 1 : 0;
+}
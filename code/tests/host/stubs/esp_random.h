@@ -0,0 +1,27 @@
+/**
+ * @file esp_random.h
+ * @brief Host stand-in for the hardware RNG, backed by rand()
+ *
+ * Not random at all; harnesses seed it with srand() for repeatable runs.
+ */
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t esp_random(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static inline void esp_fill_random(void *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        ((uint8_t *)buf)[i] = (uint8_t)rand();
+    }
+}
+
+#endif // HOST_ESP_RANDOM_H
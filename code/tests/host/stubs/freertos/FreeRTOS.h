@@ -0,0 +1,23 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS types used by the harnessed modules
+ *
+ * The harnesses are single-threaded, so mutexes always succeed, queues
+ * stay empty and created tasks never run.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              1
+#define portMAX_DELAY       0xffffffffu
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,42 @@
+/**
+ * @file queue.h
+ * @brief Host stand-in for FreeRTOS queues: always empty, sends fail
+ */
+
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(unsigned length, unsigned item_size)
+{
+    static int queue;
+    (void)length;
+    (void)item_size;
+    return &queue;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    (void)q;
+    (void)item;
+    (void)ticks;
+    return pdFALSE;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    (void)q;
+    (void)item;
+    (void)ticks;
+    return pdFALSE;
+}
+
+static inline void vQueueDelete(QueueHandle_t q)
+{
+    (void)q;
+}
+
+#endif // HOST_FREERTOS_QUEUE_H
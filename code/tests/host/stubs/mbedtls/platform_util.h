@@ -0,0 +1,21 @@
+/**
+ * @file platform_util.h
+ * @brief Host stand-in for mbedtls_platform_zeroize()
+ */
+
+#ifndef HOST_MBEDTLS_PLATFORM_UTIL_H
+#define HOST_MBEDTLS_PLATFORM_UTIL_H
+
+#include <stddef.h>
+#include <string.h>
+
+// Called through a volatile pointer so the wipe is not optimised away
+static void *(*const volatile host_zeroize_memset)(void *, int, size_t) = memset;
+
+static inline void mbedtls_platform_zeroize(void *buf, size_t len) {
+    if (len > 0) {
+        host_zeroize_memset(buf, 0, len);
+    }
+}
+
+#endif // HOST_MBEDTLS_PLATFORM_UTIL_H